@@ -21,6 +21,7 @@ parser.add_argument('--keep_cache', help='Do not refresh CMake cache', action='s
 parser.add_argument('--debug', help='Builds in debug mode', action='store_true')
 parser.add_argument('--sanitize', help='Builds in release mode with sanitize flags', action='store_true')
 parser.add_argument('--static', help='Builds using static libraries', action='store_true')
+parser.add_argument('--portable', help='Builds for any x86-64 CPU rather than the host CPU', action='store_true')
 parser.add_argument('--threads', help='The number of threads to use for building', type=int)
 parser.add_argument('--boost', help='The Boost library root')
 parser.add_argument('--verbose', help='Ouput verbose make information', action='store_true')
@@ -73,6 +74,8 @@ else:
     cmake_options.append("-DCMAKE_BUILD_TYPE=Release")
 if args["static"]:
     cmake_options.append("-DBUILD_SHARED_LIBS=OFF")
+if args["portable"]:
+    cmake_options.append("-DBUILD_PORTABLE=ON")
 if args["boost"]:
     cmake_options.append("-DBOOST_ROOT=" + args["boost"])
 if args["verbose"]:
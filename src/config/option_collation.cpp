@@ -25,6 +25,7 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/repeat_finder.hpp"
+#include "utils/repeat_index.hpp"
 #include "utils/append.hpp"
 #include "utils/maths.hpp"
 #include "basics/phred.hpp"
@@ -68,7 +69,18 @@ unsigned as_unsigned(const std::string& option, const OptionMap& options)
 
 bool is_run_command(const OptionMap& options)
 {
-    return !is_set("help", options) && !is_set("version", options);
+    return !is_set("help", options) && !is_set("version", options) && !is_build_repeat_index_command(options)
+           && !is_merge_shards_command(options);
+}
+
+bool is_build_repeat_index_command(const OptionMap& options)
+{
+    return is_set("build-repeat-index", options);
+}
+
+bool is_merge_shards_command(const OptionMap& options)
+{
+    return is_set("merge-shards", options);
 }
 
 bool is_debug_mode(const OptionMap& options)
@@ -134,6 +146,11 @@ fs::path resolve_path(const fs::path& path, const OptionMap& options)
     return ::octopus::resolve_path(path, get_working_directory(options));
 }
 
+fs::path get_repeat_index_build_path(const OptionMap& options)
+{
+    return resolve_path(options.at("build-repeat-index").as<fs::path>(), options);
+}
+
 struct Line
 {
     std::string line_data;
@@ -256,6 +273,14 @@ MemoryFootprint get_target_read_buffer_size(const OptionMap& options)
     return options.at("target-read-buffer-footprint").as<MemoryFootprint>();
 }
 
+boost::optional<MemoryFootprint> get_target_working_memory(const OptionMap& options)
+{
+    if (options.count("target-working-memory") == 1) {
+        return options.at("target-working-memory").as<MemoryFootprint>();
+    }
+    return boost::none;
+}
+
 boost::optional<fs::path> get_debug_log_file_name(const OptionMap& options)
 {
     if (is_debug_mode(options)) {
@@ -274,6 +299,190 @@ boost::optional<fs::path> get_trace_log_file_name(const OptionMap& options)
     }
 }
 
+boost::optional<fs::path> get_checkpoint_directory(const OptionMap& options)
+{
+    if (is_set("checkpoint", options)) {
+        return resolve_path(options.at("checkpoint").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+bool resume_from_checkpoint(const OptionMap& options)
+{
+    return options.at("resume").as<bool>();
+}
+
+boost::optional<GenomeShard> get_shard(const OptionMap& options)
+{
+    if (is_set("shard", options)) {
+        return options.at("shard").as<GenomeShard>();
+    } else {
+        return boost::none;
+    }
+}
+
+std::vector<fs::path> get_shard_outputs(const OptionMap& options)
+{
+    std::vector<fs::path> result {};
+    if (is_set("merge-shards", options)) {
+        for (const auto& path : options.at("merge-shards").as<std::vector<fs::path>>()) {
+            result.push_back(resolve_path(path, options));
+        }
+    }
+    return result;
+}
+
+boost::optional<fs::path> get_input_digest_path(const OptionMap& options)
+{
+    if (is_set("input-digest", options)) {
+        return resolve_path(options.at("input-digest").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+boost::optional<fs::path> get_previous_output(const OptionMap& options)
+{
+    if (is_set("previous-output", options)) {
+        return resolve_path(options.at("previous-output").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+boost::optional<fs::path> get_previous_input_digest(const OptionMap& options)
+{
+    if (is_set("previous-input-digest", options)) {
+        return resolve_path(options.at("previous-input-digest").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+namespace {
+
+// Options that change where calls are made or written, or how quickly, but not the calls themselves.
+// The inputs these name are digested directly.
+const std::vector<std::string> nonCallingOptions {
+    "help", "version", "config", "debug", "trace", "profile", "working-directory", "checkpoint", "resume",
+    "shard", "merge-shards", "threads", "max-reference-cache-footprint", "target-read-buffer-footprint",
+    "target-working-memory", "max-open-read-files", "reference", "repeat-index", "reads", "reads-file",
+    "one-based-indexing", "regions", "regions-file", "skip-regions", "skip-regions-file", "samples",
+    "samples-file", "ignore-unmapped-contigs", "output", "legacy", "keep-unfiltered-calls",
+    "input-digest", "previous-output", "previous-input-digest"
+};
+
+template <typename T>
+bool write_if(const boost::any& value, std::ostream& os)
+{
+    const auto typed = boost::any_cast<T>(&value);
+    if (typed) os << *typed;
+    return typed != nullptr;
+}
+
+template <typename T>
+bool write_vector_if(const boost::any& value, std::ostream& os)
+{
+    const auto typed = boost::any_cast<std::vector<T>>(&value);
+    if (typed) {
+        for (const auto& element : *typed) os << element << ',';
+    }
+    return typed != nullptr;
+}
+
+void write_option_value(const boost::any& value, std::ostream& os)
+{
+    const bool written = write_if<bool>(value, os) || write_if<int>(value, os) || write_if<float>(value, os)
+        || write_if<double>(value, os) || write_if<std::string>(value, os) || write_if<fs::path>(value, os)
+        || write_if<MemoryFootprint>(value, os) || write_if<Phred<double>>(value, os)
+        || write_if<ContigOutputOrder>(value, os) || write_if<RefCallType>(value, os)
+        || write_if<ExtensionLevel>(value, os) || write_if<PhasingLevel>(value, os)
+        || write_if<NormalContaminationRisk>(value, os) || write_vector_if<int>(value, os)
+        || write_vector_if<std::string>(value, os) || write_vector_if<fs::path>(value, os)
+        || write_vector_if<ContigPloidy>(value, os);
+    if (!written) os << value.type().name();
+}
+
+} // namespace
+
+std::string get_calling_configuration(const OptionMap& options)
+{
+    std::ostringstream ss {};
+    for (const auto& p : options) { // ordered by name
+        if (std::find(std::cbegin(nonCallingOptions), std::cend(nonCallingOptions), p.first) != std::cend(nonCallingOptions)) {
+            continue;
+        }
+        ss << p.first << '=';
+        write_option_value(p.second.value(), ss);
+        ss << ';';
+    }
+    return ss.str();
+}
+
+namespace {
+
+const std::vector<std::string> inputSelectionOptions {
+    "reference", "reads", "reads-file", "one-based-indexing", "regions", "regions-file", "skip-regions",
+    "skip-regions-file", "samples", "samples-file", "ignore-unmapped-contigs"
+};
+
+void write_file_identity(const fs::path& path, std::ostream& os)
+{
+    boost::system::error_code ec {};
+    const auto size = fs::file_size(path, ec);
+    const auto last_write_time = ec ? std::time_t {} : fs::last_write_time(path, ec);
+    os << path.string() << ':';
+    if (ec) {
+        os << "missing";
+    } else {
+        os << size << ':' << last_write_time;
+    }
+    os << ';';
+}
+
+} // namespace
+
+std::string get_calling_inputs(const OptionMap& options)
+{
+    std::ostringstream ss {};
+    ss << get_calling_configuration(options);
+    for (const auto& option : inputSelectionOptions) {
+        if (is_set(option, options)) {
+            ss << option << '=';
+            write_option_value(options.at(option).value(), ss);
+            ss << ';';
+        }
+    }
+    write_file_identity(resolve_path(options.at("reference").as<std::string>(), options), ss);
+    if (is_set("reads", options)) {
+        for (const auto& path : resolve_paths(options.at("reads").as<std::vector<fs::path>>(), options)) {
+            write_file_identity(path, ss);
+        }
+    }
+    if (is_set("reads-file", options)) {
+        for (const auto& reads_file : options.at("reads-file").as<std::vector<fs::path>>()) {
+            const auto resolved_reads_file = resolve_path(reads_file, options);
+            write_file_identity(resolved_reads_file, ss);
+            if (fs::exists(resolved_reads_file)) {
+                for (const auto& path : get_resolved_paths_from_file(resolved_reads_file, options)) {
+                    write_file_identity(path, ss);
+                }
+            }
+        }
+    }
+    return ss.str();
+}
+
+boost::optional<fs::path> get_profile_file_name(const OptionMap& options)
+{
+    if (is_set("profile", options)) {
+        return resolve_path(options.at("profile").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
 bool is_fast_mode(const OptionMap& options)
 {
     return options.at("fast").as<bool>() || options.at("very-fast").as<bool>();
@@ -741,13 +950,18 @@ boost::optional<readpipe::Downsampler> make_downsampler(const OptionMap& options
 ReadPipe make_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples, const OptionMap& options)
 {
     auto transformers = make_read_transformers(options);
-    if (transformers.second.num_transforms() > 0) {
-        return ReadPipe {read_manager, std::move(transformers.first), make_read_filterer(options),
-                         std::move(transformers.second), make_downsampler(options), std::move(samples)};
-    } else {
-        return ReadPipe {read_manager, std::move(transformers.first), make_read_filterer(options),
-                         make_downsampler(options), std::move(samples)};
-    }
+    auto result = [&] () {
+        if (transformers.second.num_transforms() > 0) {
+            return ReadPipe {read_manager, std::move(transformers.first), make_read_filterer(options),
+                             std::move(transformers.second), make_downsampler(options), std::move(samples)};
+        } else {
+            return ReadPipe {read_manager, std::move(transformers.first), make_read_filterer(options),
+                             make_downsampler(options), std::move(samples)};
+        }
+    }();
+    // Parallelism is bounded by the shared thread budget, so allowed whenever more than one thread is
+    result.set_execution_policy(is_threading_allowed(options) ? ExecutionPolicy::par : ExecutionPolicy::seq);
+    return result;
 }
 
 auto get_default_inclusion_predicate()
@@ -829,6 +1043,69 @@ struct DefaultRepeatGenerator
     }
 };
 
+struct IndexedRepeatGenerator
+{
+    std::vector<GenomicRegion> operator()(const ReferenceGenome& reference, GenomicRegion region) const
+    {
+        if (repeat_index->has_contig(region.contig_name())) {
+            return repeat_index->fetch_repeat_regions(region);
+        }
+        return find_repeat_regions(reference, region);
+    }
+    
+    std::shared_ptr<const RepeatIndex> repeat_index;
+};
+
+class MissingRepeatIndex : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "make_repeat_index";
+    }
+public:
+    MissingRepeatIndex(fs::path p) : MissingFileError {std::move(p), "repeat index"} {};
+};
+
+class MismatchedRepeatIndex : public UserError
+{
+    std::string do_where() const override
+    {
+        return "make_repeat_index";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "The repeat index " << path_ << " was not built from the given reference";
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Rebuild the repeat index with --build-repeat-index";
+    }
+    
+    fs::path path_;
+public:
+    MismatchedRepeatIndex(fs::path p) : path_ {std::move(p)} {};
+};
+
+std::shared_ptr<const RepeatIndex> make_repeat_index(const ReferenceGenome& reference, const OptionMap& options)
+{
+    if (!is_set("repeat-index", options)) return nullptr;
+    auto path = resolve_path(options.at("repeat-index").as<fs::path>(), options);
+    if (!fs::exists(path)) {
+        throw MissingRepeatIndex {std::move(path)};
+    }
+    auto result = std::make_shared<const RepeatIndex>(path);
+    for (const auto& contig : reference.contig_names()) {
+        if (!result->has_contig(contig) || result->contig_size(contig) != reference.contig_size(contig)) {
+            throw MismatchedRepeatIndex {std::move(path)};
+        }
+    }
+    return result;
+}
+
 auto get_max_expected_heterozygosity(const OptionMap& options)
 {
     const auto snp_heterozygosity = options.at("snp-heterozygosity").as<float>();
@@ -838,7 +1115,7 @@ auto get_max_expected_heterozygosity(const OptionMap& options)
     return std::min(static_cast<double>(heterozygosity + 2 * heterozygosity_stdev), 0.9999);
 }
 
-auto make_variant_generator_builder(const OptionMap& options)
+auto make_variant_generator_builder(const OptionMap& options, std::shared_ptr<const RepeatIndex> repeat_index)
 {
     using namespace coretools;
     
@@ -862,7 +1139,11 @@ auto make_variant_generator_builder(const OptionMap& options)
         }
         scanner_options.match = get_default_match_predicate();
         scanner_options.use_clipped_coverage_tracking = true;
-        scanner_options.repeat_region_generator = DefaultRepeatGenerator {};
+        if (repeat_index) {
+            scanner_options.repeat_region_generator = IndexedRepeatGenerator {repeat_index};
+        } else {
+            scanner_options.repeat_region_generator = DefaultRepeatGenerator {};
+        }
         CigarScanner::Options::MisalignmentParameters misalign_params {};
         misalign_params.max_expected_mutation_rate = get_max_expected_heterozygosity(options);
         misalign_params.snv_threshold = as_unsigned("min-base-quality", options);
@@ -1090,6 +1371,8 @@ PloidyMap get_ploidy_map(const OptionMap& options)
 
 bool call_sites_only(const OptionMap& options)
 {
+    // Filtering is deferred to the shard merge, which needs the sample fields
+    if (is_set("shard", options) && is_call_filtering_requested(options)) return false;
     return options.at("sites-only").as<bool>();
 }
 
@@ -1361,28 +1644,28 @@ bool allow_flank_scoring(const OptionMap& options)
     return options.at("inactive-flank-scoring").as<bool>() && !is_very_fast_mode(options);
 }
 
-auto make_indel_error_model(const OptionMap& options)
+auto make_indel_error_model(const OptionMap& options, std::shared_ptr<const RepeatIndex> repeat_index)
 {
     if (is_set("sequence-error-model", options)) {
-        return octopus::make_indel_error_model(options.at("sequence-error-model").as<std::string>());
+        return octopus::make_indel_error_model(options.at("sequence-error-model").as<std::string>(), std::move(repeat_index));
     } else {
-        return octopus::make_indel_error_model();
+        return octopus::make_indel_error_model("HiSeq", std::move(repeat_index));
     }
 }
 
-auto make_snv_error_model(const OptionMap& options)
+auto make_snv_error_model(const OptionMap& options, std::shared_ptr<const RepeatIndex> repeat_index)
 {
     if (is_set("sequence-error-model", options)) {
-        return octopus::make_snv_error_model(options.at("sequence-error-model").as<std::string>());
+        return octopus::make_snv_error_model(options.at("sequence-error-model").as<std::string>(), std::move(repeat_index));
     } else {
-        return octopus::make_snv_error_model();
+        return octopus::make_snv_error_model("HiSeq", std::move(repeat_index));
     }
 }
 
-HaplotypeLikelihoodModel make_likelihood_model(const OptionMap& options)
+HaplotypeLikelihoodModel make_likelihood_model(const OptionMap& options, std::shared_ptr<const RepeatIndex> repeat_index)
 {
-    auto snv_error_model = make_snv_error_model(options);
-    auto indel_error_model = make_indel_error_model(options);
+    auto snv_error_model = make_snv_error_model(options, repeat_index);
+    auto indel_error_model = make_indel_error_model(options, std::move(repeat_index));
     auto model_mapping_quality = options.at("model-mapping-quality").as<bool>();
     auto use_flank_state = allow_flank_scoring(options);
     return HaplotypeLikelihoodModel {std::move(snv_error_model), std::move(indel_error_model),
@@ -1408,8 +1691,9 @@ auto get_normal_contamination_risk(const OptionMap& options)
 CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& read_pipe,
                                   const InputRegionMap& regions, const OptionMap& options)
 {
+    const auto repeat_index = make_repeat_index(reference, options);
     CallerBuilder vc_builder {reference, read_pipe,
-                              make_variant_generator_builder(options),
+                              make_variant_generator_builder(options, repeat_index),
                               make_haplotype_generator_builder(options)};
 	const auto pedigree = get_pedigree(options);
     const auto caller = get_caller_type(options, read_pipe.samples(), pedigree);
@@ -1484,7 +1768,9 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
     if (call_sites_only(options) && !is_call_filtering_requested(options)) {
         vc_builder.set_sites_only();
     }
-    vc_builder.set_likelihood_model(make_likelihood_model(options));
+    vc_builder.set_likelihood_model(make_likelihood_model(options, repeat_index));
+    // Model parallelism is bounded by the shared thread budget, so allowed whenever more than one thread is
+    vc_builder.set_execution_policy(is_threading_allowed(options) ? ExecutionPolicy::par : ExecutionPolicy::seq);
     return CallerFactory {std::move(vc_builder)};
 }
 
@@ -1518,7 +1804,7 @@ std::unique_ptr<VariantCallFilterFactory> make_call_filter_factory(const Referen
                                                                    ReadPipe& read_pipe,
                                                                    const OptionMap& options)
 {
-    if (is_call_filtering_requested(options)) {
+    if (is_call_filtering_requested(options) && !is_set("shard", options)) {
         if (is_csr_training(options)) {
             return std::make_unique<TrainingFilterFactory>(get_training_measures(options));
         } else {
@@ -1539,6 +1825,12 @@ bool keep_unfiltered_calls(const OptionMap& options) noexcept
     return options.at("keep-unfiltered-calls").as<bool>();
 }
 
+bool reuse_calling_read_assignments(const OptionMap& options) noexcept
+{
+    return is_call_filtering_requested(options) && !filter_request(options) && !is_set("shard", options)
+           && !is_merge_shards_command(options) && options.at("reuse-calling-read-assignments").as<bool>();
+}
+
 ReadPipe make_default_filter_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples)
 {
     using std::make_unique;
@@ -1611,7 +1903,7 @@ boost::optional<fs::path> create_temp_file_directory(const OptionMap& options)
 
 bool is_legacy_vcf_requested(const OptionMap& options)
 {
-    return options.at("legacy").as<bool>();
+    return options.at("legacy").as<bool>() && !is_set("shard", options);
 }
 
 bool is_csr_training_mode(const OptionMap& options)
@@ -14,6 +14,7 @@
 #include "common.hpp"
 #include "option_parser.hpp"
 #include "utils/memory_footprint.hpp"
+#include "utils/genome_shard.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "io/read/read_manager.hpp"
 #include "io/variant/vcf_writer.hpp"
@@ -27,16 +28,46 @@ namespace octopus { namespace options {
 
 bool is_run_command(const OptionMap& options);
 
+bool is_build_repeat_index_command(const OptionMap& options);
+
+bool is_merge_shards_command(const OptionMap& options);
+
+fs::path get_repeat_index_build_path(const OptionMap& options);
+
 bool is_debug_mode(const OptionMap& options);
 bool is_trace_mode(const OptionMap& options);
 
 boost::optional<fs::path> get_debug_log_file_name(const OptionMap& options);
 boost::optional<fs::path> get_trace_log_file_name(const OptionMap& options);
+boost::optional<fs::path> get_profile_file_name(const OptionMap& options);
 
 boost::optional<unsigned> get_num_threads(const OptionMap& options);
 
 MemoryFootprint get_target_read_buffer_size(const OptionMap& options);
 
+boost::optional<MemoryFootprint> get_target_working_memory(const OptionMap& options);
+
+boost::optional<fs::path> get_checkpoint_directory(const OptionMap& options);
+
+bool resume_from_checkpoint(const OptionMap& options);
+
+boost::optional<GenomeShard> get_shard(const OptionMap& options);
+
+std::vector<fs::path> get_shard_outputs(const OptionMap& options);
+
+boost::optional<fs::path> get_input_digest_path(const OptionMap& options);
+
+boost::optional<fs::path> get_previous_output(const OptionMap& options);
+
+boost::optional<fs::path> get_previous_input_digest(const OptionMap& options);
+
+// A canonical description of the options that can change calls
+std::string get_calling_configuration(const OptionMap& options);
+
+// The calling configuration, the options that select the inputs, and the size and modification
+// time of each input file. Cheap to make, as no input is read.
+std::string get_calling_inputs(const OptionMap& options);
+
 ReferenceGenome make_reference(const OptionMap& options);
 
 InputRegionMap get_search_regions(const OptionMap& options, const ReferenceGenome& reference);
@@ -66,6 +97,8 @@ bool use_calling_read_pipe_for_call_filtering(const OptionMap& options) noexcept
 
 bool keep_unfiltered_calls(const OptionMap& options) noexcept;
 
+bool reuse_calling_read_assignments(const OptionMap& options) noexcept;
+
 ReadPipe make_call_filter_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples,
                                     const OptionMap& options);
 
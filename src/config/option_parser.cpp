@@ -16,6 +16,7 @@
 
 #include "utils/path_utils.hpp"
 #include "utils/memory_footprint.hpp"
+#include "utils/genome_shard.hpp"
 #include "utils/string_utils.hpp"
 #include "basics/phred.hpp"
 #include "exceptions/user_error.hpp"
@@ -62,6 +63,10 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<fs::path>()->implicit_value("octopus_trace.log"),
      "Writes very verbose debug information to trace.log in the working directory")
     
+    ("profile",
+     po::value<fs::path>()->implicit_value("octopus_profile.json"),
+     "Writes a JSON report of the time spent in each calling stage, in total and for each task")
+    
     ("fast",
      po::bool_switch()->default_value(false),
      "Turns off some features to improve runtime, at the cost of decreased calling accuracy."
@@ -70,6 +75,11 @@ OptionMap parse_options(const int argc, const char** argv)
     ("very-fast",
      po::bool_switch()->default_value(false),
      "The same as fast but also disables inactive flank scoring")
+    
+    ("build-repeat-index",
+     po::value<fs::path>(),
+     "Builds a tandem repeat index of the reference to the given file and exits."
+     " The index can be given to later runs with --repeat-index")
     ;
     
     po::options_description backend("Backend");
@@ -78,6 +88,25 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<fs::path>(),
      "Sets the working directory")
     
+    ("checkpoint",
+     po::value<fs::path>(),
+     "Directory in which to record the progress of a multi-threaded run, so it can be continued with"
+     " --resume if interrupted")
+    
+    ("resume",
+     po::bool_switch()->default_value(false),
+     "Continues the run recorded in the --checkpoint directory, only calling regions that were not written")
+    
+    ("shard",
+     po::value<GenomeShard>(),
+     "Only calls the i-th of N near equal parts of the search regions (given as i/N), cut on calling task boundaries,"
+     " so a run can be spread over several processes. Shard outputs are unfiltered and must be combined with --merge-shards")
+    
+    ("merge-shards",
+     po::value<std::vector<fs::path>>()->multitoken(),
+     "Space-separated list of --shard outputs to merge into the final output and exit."
+     " Other options must be the same as the shard runs, without --shard")
+    
     ("threads",
      po::value<int>()->implicit_value(0),
      "Maximum number of threads to be used, enabling this option with no argument lets the application"
@@ -91,6 +120,11 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<MemoryFootprint>()->default_value(*parse_footprint("6GB"), "6GB"),
      "None binding request to limit the memory footprint of buffered read data")
     
+    ("target-working-memory",
+     po::value<MemoryFootprint>(),
+     "None binding request to limit the combined working memory of concurrent calling tasks."
+     " Tasks are split or deferred when their projected footprint would exceed it")
+    
     ("max-open-read-files",
      po::value<int>()->default_value(250),
      "Limits the number of read files that can be open simultaneously")
@@ -103,6 +137,11 @@ OptionMap parse_options(const int argc, const char** argv)
      "FASTA format reference genome file to be analysed. Target regions"
      " will be extracted from the reference index if not provded explicitly")
     
+    ("repeat-index",
+     po::value<fs::path>(),
+     "Tandem repeat index of the reference made with --build-repeat-index, used to"
+     " speed up repeat annotation of haplotypes and candidate generation")
+    
     ("reads,I",
      po::value<std::vector<fs::path>>()->multitoken(),
      "Space-separated list of BAM/CRAM files to be analysed."
@@ -167,6 +206,20 @@ OptionMap parse_options(const int argc, const char** argv)
      po::bool_switch()->default_value(false),
      "Outputs a legacy version of the final callset in addition to the native version")
     
+    ("input-digest",
+     po::value<fs::path>(),
+     "Writes a digest of the calling inputs of each block of the search regions to this file, so a later"
+     " run can reuse the calls of blocks whose inputs have not changed")
+    
+    ("previous-output",
+     po::value<fs::path>(),
+     "Indexed calls of a previous run, reused for regions whose inputs have not changed since."
+     " Must be the unfiltered calls (see --keep-unfiltered-calls) if call filtering is enabled")
+    
+    ("previous-input-digest",
+     po::value<fs::path>(),
+     "The --input-digest written by the run that made --previous-output")
+    
     ("regenotype",
      po::value<fs::path>(),
      "VCF file specifying calls to regenotype, only sites in this files will appear in the"
@@ -577,6 +630,11 @@ OptionMap parse_options(const int argc, const char** argv)
      po::bool_switch()->default_value(false),
      "Keep a copy of unfiltered calls")
     
+    ("reuse-calling-read-assignments",
+     po::value<bool>()->default_value(false),
+     "Record read-haplotype assignments made during calling and reuse them for filtering rather than"
+     " recomputing them")
+    
     ("csr-training",
      po::value<std::vector<std::string>>()->multitoken(),
      "Activates CSR training mode with the given measures - outputs all calls as PASS and annotates output VCF with measure values")
@@ -869,6 +927,7 @@ void option_dependency(const OptionMap& vm, const std::string& given, const std:
 
 void check_reads_present(const OptionMap& vm)
 {
+    if (vm.count("build-repeat-index") == 1) return;
     if (vm.count("reads") == 0 && vm.count("reads-file") == 0) {
         throw MissingRequiredCommandLineArguement {std::vector<std::string> {"reads", "reads-file"}};
     }
@@ -953,6 +1012,14 @@ void validate(const OptionMap& vm)
     };
     conflicting_options(vm, "maternal-sample", "normal-sample");
     conflicting_options(vm, "paternal-sample", "normal-sample");
+    option_dependency(vm, "resume", "checkpoint");
+    conflicting_options(vm, "shard", "merge-shards");
+    conflicting_options(vm, "shard", "filter-vcf");
+    conflicting_options(vm, "merge-shards", "filter-vcf");
+    option_dependency(vm, "previous-output", "previous-input-digest");
+    option_dependency(vm, "previous-input-digest", "previous-output");
+    conflicting_options(vm, "previous-output", "filter-vcf");
+    conflicting_options(vm, "previous-output", "merge-shards");
     for (const auto& option : positive_int_options) {
         check_positive(option, vm);
     }
@@ -12,6 +12,7 @@
 #include <vector>
 #include <type_traits>
 #include <stdexcept>
+#include <cassert>
 
 #include <boost/container/flat_set.hpp>
 
@@ -25,6 +26,10 @@ namespace octopus {
 /*
  MappableFlatMultiSet is a container designed to allow fast retrieval of MappableType elements with minimal
  memory overhead.
+ 
+ If the elements are not bidirectionally sorted (i.e. the end positions are not sorted), the running maximum
+ end position is stored alongside the elements. This is an implicit interval index: the first element that can
+ overlap a query is found with a binary search, so overlap queries do not depend on the largest element size.
  */
 template <typename MappableType, typename Allocator = std::allocator<MappableType>>
 class MappableFlatMultiSet : public Comparable<MappableFlatMultiSet<MappableType, Allocator>>
@@ -178,9 +183,16 @@ public:
     friend void swap(MappableFlatMultiSet<M, A>& lhs, MappableFlatMultiSet<M, A>& rhs) noexcept;
     
 private:
+    using Position = typename RegionType<MappableType>::Position;
+    
     base_t elements_;
     bool is_bidirectionally_sorted_;
-    typename RegionType<MappableType>::Position max_element_size_;
+    Position max_element_size_;
+    std::vector<Position> max_ends_; // empty if is_bidirectionally_sorted_
+    
+    void update_max_ends(size_type first_changed);
+    template <typename MappableType_>
+    const_iterator find_first_overlapped(const_iterator first, const_iterator last, const MappableType_& mappable) const;
 };
 
 template <typename MappableType, typename Allocator>
@@ -188,6 +200,7 @@ MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet()
 : elements_ {}
 , is_bidirectionally_sorted_ {true}
 , max_element_size_ {}
+, max_ends_ {}
 {}
 
 template <typename MappableType, typename Allocator>
@@ -196,14 +209,20 @@ MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(InputIterato
 : elements_ {first, second}
 , is_bidirectionally_sorted_ {is_bidirectionally_sorted(elements_)}
 , max_element_size_ {(elements_.empty()) ? 0 : region_size(*largest_mappable(elements_))}
-{}
+, max_ends_ {}
+{
+    update_max_ends(0);
+}
 
 template <typename MappableType, typename Allocator>
 MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(std::initializer_list<MappableType> mappables)
 : elements_ {mappables}
 , is_bidirectionally_sorted_ {is_bidirectionally_sorted(elements_)}
 , max_element_size_ {(elements_.empty()) ? 0 : region_size(*largest_mappable(elements_))}
-{}
+, max_ends_ {}
+{
+    update_max_ends(0);
+}
 
 template <typename MappableType, typename Allocator>
 typename MappableFlatMultiSet<MappableType, Allocator>::iterator
@@ -364,6 +383,7 @@ MappableFlatMultiSet<MappableType, Allocator>::emplace(Args... args)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(elements_.begin(), it));
     return it;
 }
 
@@ -377,6 +397,7 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(const MappableType& m)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(elements_.begin(), it));
     return it;
 }
 
@@ -390,6 +411,7 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(MappableType&& m)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(elements_.begin(), it));
     return it;
 }
 
@@ -402,7 +424,8 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(const_iterator hint, const
         const auto overlapped = overlap_range(*it2);
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
-    max_element_size_ = std::max(max_element_size_, region_size(m));
+    max_element_size_ = std::max(max_element_size_, region_size(*it2));
+    update_max_ends(std::distance(elements_.begin(), it2));
     return it2;
 }
 
@@ -415,7 +438,8 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(const_iterator hint, Mappa
         const auto overlapped = overlap_range(*it2);
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
-    max_element_size_ = std::max(max_element_size_, region_size(m));
+    max_element_size_ = std::max(max_element_size_, region_size(*it2));
+    update_max_ends(std::distance(elements_.begin(), it2));
     return it2;
 }
 
@@ -430,6 +454,7 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(InputIterator first, Input
         if (is_bidirectionally_sorted_) {
             is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
         }
+        update_max_ends(0);
     }
 }
 
@@ -444,6 +469,7 @@ MappableFlatMultiSet<MappableType, Allocator>::insert(std::initializer_list<Mapp
     if (is_bidirectionally_sorted_ && !il.empty() ) {
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
     }
+    update_max_ends(0);
     return result;
 }
 
@@ -453,6 +479,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator p)
 {
     if (p == cend()) return elements_.erase(p);
     const auto erased_size = region_size(*p);
+    const auto first_changed = std::distance(elements_.cbegin(), p);
     const auto result = elements_.erase(p);
     if (elements_.empty()) {
         max_element_size_ = 0;
@@ -462,6 +489,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator p)
             max_element_size_ = region_size(*largest_mappable(elements_));
         }
     }
+    update_max_ends(first_changed);
     return result;
 }
 
@@ -470,6 +498,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::size_type
 MappableFlatMultiSet<MappableType, Allocator>::erase(const MappableType& m)
 {
     const auto m_size = region_size(m);
+    const auto first_changed = std::distance(elements_.begin(), elements_.lower_bound(m));
     const auto result = elements_.erase(m);
     if (result > 0) {
         if (elements_.empty()) {
@@ -480,6 +509,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase(const MappableType& m)
                 max_element_size_ = region_size(*largest_mappable(elements_));
             }
         }
+        update_max_ends(first_changed);
         return result;
     }
     return 0;
@@ -491,6 +521,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator first, const
 {
     if (first == last) return elements_.erase(first, last);
     const auto max_erased_size = region_size(*largest_mappable(first, last));
+    const auto first_changed = std::distance(elements_.cbegin(), first);
     const auto result = elements_.erase(first, last);
     if (elements_.empty()) {
         max_element_size_ = 0;
@@ -500,6 +531,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator first, const
             max_element_size_ = region_size(*largest_mappable(elements_));
         }
     }
+    update_max_ends(first_changed);
     return result;
 }
 
@@ -535,6 +567,7 @@ MappableFlatMultiSet<MappableType, Allocator>::erase_all(InputIt first, InputIt
             max_element_size_ = 0;
             is_bidirectionally_sorted_ = true;
         }
+        update_max_ends(0);
     }
     return result;
 }
@@ -545,6 +578,7 @@ void MappableFlatMultiSet<MappableType, Allocator>::clear()
     elements_.clear();
     is_bidirectionally_sorted_ = true;
     max_element_size_ = 0;
+    max_ends_.clear();
 }
 
 template <typename MappableType, typename Allocator>
@@ -609,8 +643,7 @@ const MappableType& MappableFlatMultiSet<MappableType, Allocator>::rightmost() c
     if (is_bidirectionally_sorted_) {
         return last;
     } else {
-        using octopus::overlap_range;
-        const auto overlapped = overlap_range(cbegin(elements_), cend(elements_), last, max_element_size_);
+        const auto overlapped = overlap_range(cbegin(elements_), cend(elements_), last);
         return *rightmost_mappable(cbegin(overlapped), cend(overlapped));
     }
 }
@@ -620,11 +653,12 @@ template <typename MappableType_>
 bool
 MappableFlatMultiSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
 {
+    using octopus::has_overlapped;
     using octopus::has_overlapped;
     if (is_bidirectionally_sorted_) {
         return has_overlapped(std::begin(elements_), std::end(elements_), mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(std::begin(elements_), std::end(elements_), mappable);
+    return !overlap_range(mappable).empty();
 }
 
 template <typename MappableType, typename Allocator>
@@ -637,7 +671,7 @@ MappableFlatMultiSet<MappableType, Allocator>::has_overlapped(const_iterator fir
     if (is_bidirectionally_sorted_) {
         return has_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(first, last, mappable);
+    return !overlap_range(first, last, mappable).empty();
 }
 
 template <typename MappableType, typename Allocator>
@@ -658,7 +692,8 @@ MappableFlatMultiSet<MappableType, Allocator>::count_overlapped(const_iterator f
     if (is_bidirectionally_sorted_) {
         return count_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return count_overlapped(first, last, mappable, max_element_size_);
+    using octopus::size;
+    return size(overlap_range(first, last, mappable));
 }
 
 template <typename MappableType, typename Allocator>
@@ -679,7 +714,10 @@ MappableFlatMultiSet<MappableType, Allocator>::overlap_range(const_iterator firs
     if (is_bidirectionally_sorted_) {
         return overlap_range(first, last, mappable, BidirectionallySortedTag {});
     }
-    return overlap_range(first, last, mappable, max_element_size_);
+    const auto it1 = find_first_after(first, last, mappable);
+    auto it2 = find_first_overlapped(first, it1, mappable);
+    it2 = std::find_if(it2, it1, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    return make_overlap_range(it2, it1, mappable);
 }
 
 template <typename MappableType, typename Allocator>
@@ -838,6 +876,43 @@ MappableFlatMultiSet<MappableType, Allocator>::shared_range(const_iterator first
     return make_shared_range(itr.base(), std::next(end).base(), mappable1, mappable2);
 }
 
+// private methods
+
+template <typename MappableType, typename Allocator>
+void MappableFlatMultiSet<MappableType, Allocator>::update_max_ends(const size_type first_changed)
+{
+    if (is_bidirectionally_sorted_) {
+        max_ends_.clear();
+        return;
+    }
+    // max_ends_ is either empty or valid for the elements before first_changed
+    const auto first = std::min(first_changed, max_ends_.size());
+    max_ends_.resize(elements_.size());
+    Position max_end {first > 0 ? max_ends_[first - 1] : 0};
+    auto element_itr = std::next(std::cbegin(elements_), first);
+    for (auto i = first; i < max_ends_.size(); ++i, ++element_itr) {
+        max_end = std::max(max_end, mapped_end(*element_itr));
+        max_ends_[i] = max_end;
+    }
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableFlatMultiSet<MappableType, Allocator>::const_iterator
+MappableFlatMultiSet<MappableType, Allocator>::find_first_overlapped(const_iterator first, const_iterator last,
+                                                                     const MappableType_& mappable) const
+{
+    // The running maximum end is sorted, and no element before the first one reaching the
+    // query can overlap it.
+    assert(max_ends_.size() == elements_.size());
+    const auto first_max_end = std::next(std::cbegin(max_ends_), std::distance(std::cbegin(elements_), first));
+    const auto last_max_end = std::next(first_max_end, std::distance(first, last));
+    const auto query_begin = mapped_begin(mappable);
+    const auto itr = std::partition_point(first_max_end, last_max_end,
+                                          [query_begin] (const Position end) { return end < query_begin; });
+    return std::next(first, std::distance(first_max_end, itr));
+}
+
 // non-member methods
 
 template <typename MappableType, typename Allocator>
@@ -862,6 +937,7 @@ void swap(MappableFlatMultiSet<MappableType, Allocator>& lhs,
     swap(lhs.elements_, rhs.elements_);
     swap(lhs.is_bidirectionally_sorted_, rhs.is_bidirectionally_sorted_);
     swap(lhs.max_element_size_, rhs.max_element_size_);
+    swap(lhs.max_ends_, rhs.max_ends_);
 }
 
 template <typename ForwardIterator, typename MappableType1, typename MappableType2, typename Allocator>
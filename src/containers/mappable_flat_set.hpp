@@ -13,6 +13,7 @@
 #include <vector>
 #include <type_traits>
 #include <stdexcept>
+#include <cassert>
 
 #include "concepts/comparable.hpp"
 #include "concepts/mappable.hpp"
@@ -25,6 +26,10 @@ namespace octopus {
 /*
  MappableFlatSet is a container designed to allow fast retrieval of MappableType elements with minimal
  memory overhead.
+ 
+ If the elements are not bidirectionally sorted (i.e. the end positions are not sorted), the running maximum
+ end position is stored alongside the elements. This is an implicit interval index: the first element that can
+ overlap a query is found with a binary search, so overlap queries do not depend on the largest element size.
  */
 template <typename MappableType, typename Allocator = std::allocator<MappableType>>
 class MappableFlatSet : public Comparable<MappableFlatSet<MappableType, Allocator>>
@@ -159,9 +164,16 @@ public:
     friend void swap(MappableFlatSet<M, A>& lhs, MappableFlatSet<M, A>& rhs) noexcept;
     
 private:
+    using Position = typename RegionType<MappableType>::Position;
+    
     base_t elements_;
     bool is_bidirectionally_sorted_;
-    typename RegionType<MappableType>::Position max_element_size_;
+    Position max_element_size_;
+    std::vector<Position> max_ends_; // empty if is_bidirectionally_sorted_
+    
+    void update_max_ends(size_type first_changed);
+    template <typename MappableType_>
+    const_iterator find_first_overlapped(const_iterator first, const_iterator last, const MappableType_& mappable) const;
 };
 
 template <typename MappableType, typename Allocator>
@@ -169,6 +181,7 @@ MappableFlatSet<MappableType, Allocator>::MappableFlatSet()
 : elements_ {}
 , is_bidirectionally_sorted_ {true}
 , max_element_size_ {0}
+, max_ends_ {}
 {}
 
 template <typename MappableType, typename Allocator>
@@ -177,12 +190,14 @@ MappableFlatSet<MappableType, Allocator>::MappableFlatSet(InputIterator first, I
 : elements_ {first, second}
 , is_bidirectionally_sorted_ {true}
 , max_element_size_ {0}
+, max_ends_ {}
 {
     if (elements_.empty()) return;
     std::sort(std::begin(elements_), std::end(elements_));
     elements_.erase(std::unique(std::begin(elements_), std::end(elements_)), std::end(elements_));
     is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
     max_element_size_ = region_size(*largest_mappable(elements_));
+    update_max_ends(0);
 }
 
 template <typename MappableType, typename Allocator>
@@ -190,13 +205,15 @@ MappableFlatSet<MappableType, Allocator>::MappableFlatSet(std::initializer_list<
 :
 elements_ {mappables},
 is_bidirectionally_sorted_ {true},
-max_element_size_ {0}
+max_element_size_ {0},
+max_ends_ {}
 {
     if (elements_.empty()) return;
     std::sort(std::begin(elements_), std::end(elements_));
     elements_.erase(std::unique(std::begin(elements_), std::end(elements_)), std::end(elements_));
     is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
     max_element_size_ = region_size(*largest_mappable(elements_));
+    update_max_ends(0);
 }
 
 template <typename MappableType, typename Allocator>
@@ -366,6 +383,7 @@ MappableFlatSet<MappableType, Allocator>::emplace(Args... args)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(std::begin(elements_), it));
     return std::make_pair(it, true);
 }
 
@@ -384,6 +402,7 @@ MappableFlatSet<MappableType, Allocator>::insert(const MappableType& m)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(std::begin(elements_), it));
     return std::make_pair(it, true);
 }
 
@@ -402,6 +421,7 @@ MappableFlatSet<MappableType, Allocator>::insert(MappableType&& m)
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*it));
+    update_max_ends(std::distance(std::begin(elements_), it));
     return std::make_pair(it, true);
 }
 
@@ -455,6 +475,7 @@ MappableFlatSet<MappableType, Allocator>::insert(const_iterator hint, const Mapp
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(m));
+    update_max_ends(0);
     return result;
 }
 
@@ -507,6 +528,7 @@ MappableFlatSet<MappableType, Allocator>::insert(const_iterator hint, MappableTy
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
     }
     max_element_size_ = std::max(max_element_size_, region_size(*result));
+    update_max_ends(0);
     return result;
 }
 
@@ -531,6 +553,7 @@ void MappableFlatSet<MappableType, Allocator>::insert(InputIterator first, Input
     if (is_bidirectionally_sorted_) {
         is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
     }
+    update_max_ends(0);
 }
 
 template <typename MappableType, typename Allocator>
@@ -546,6 +569,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const_iterator p)
 {
     if (p == cend()) return elements_.erase(p);
     const auto erased_size = region_size(*p);
+    const auto first_changed = std::distance(std::cbegin(elements_), p);
     const auto result = elements_.erase(p);
     if (elements_.empty()) {
         max_element_size_ = 0;
@@ -555,6 +579,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const_iterator p)
             max_element_size_ = region_size(*largest_mappable(elements_));
         }
     }
+    update_max_ends(first_changed);
     return result;
 }
 
@@ -565,6 +590,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const MappableType& m)
     const auto it = std::lower_bound(std::cbegin(elements_), std::cend(elements_), m);
     if (it != std::cend(elements_) && *it == m) {
         const auto m_size = region_size(m);
+        const auto first_changed = std::distance(std::cbegin(elements_), it);
         elements_.erase(it);
         if (elements_.empty()) {
             max_element_size_ = 0;
@@ -574,6 +600,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const MappableType& m)
                 max_element_size_ = region_size(*largest_mappable(elements_));
             }
         }
+        update_max_ends(first_changed);
         return 1;
     }
     return 0;
@@ -585,6 +612,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const_iterator first, const_iter
 {
     if (first == last) return elements_.erase(first, last);
     const auto max_erased_size = region_size(*largest_mappable(first, last));
+    const auto first_changed = std::distance(std::cbegin(elements_), first);
     const auto result = elements_.erase(first, last);
     if (elements_.empty()) {
         max_element_size_ = 0;
@@ -594,6 +622,7 @@ MappableFlatSet<MappableType, Allocator>::erase(const_iterator first, const_iter
             max_element_size_ = region_size(*largest_mappable(elements_));
         }
     }
+    update_max_ends(first_changed);
     return result;
 }
 
@@ -654,6 +683,7 @@ MappableFlatSet<MappableType, Allocator>::erase_all(BidirIt first, const BidirIt
             max_element_size_ = 0;
             is_bidirectionally_sorted_ = true;
         }
+        update_max_ends(0);
     }
     
     return num_erased;
@@ -665,6 +695,7 @@ void MappableFlatSet<MappableType, Allocator>::clear()
     elements_.clear();
     is_bidirectionally_sorted_ = true;
     max_element_size_ = 0;
+    max_ends_.clear();
 }
 
 template <typename MappableType, typename Allocator>
@@ -732,9 +763,7 @@ const MappableType& MappableFlatSet<MappableType, Allocator>::rightmost() const
     if (is_bidirectionally_sorted_) {
         return last;
     } else {
-        using octopus::overlap_range;
-        const auto overlapped = overlap_range(std::cbegin(elements_), std::cend(elements_), last,
-                                              max_element_size_);
+        const auto overlapped = overlap_range(std::cbegin(elements_), std::cend(elements_), last);
         return *rightmost_mappable(std::cbegin(overlapped), std::cend(overlapped));
     }
 }
@@ -748,7 +777,7 @@ MappableFlatSet<MappableType, Allocator>::has_overlapped(const MappableType_& ma
     if (is_bidirectionally_sorted_) {
         return has_overlapped(std::cbegin(elements_), std::cend(elements_), mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(std::cbegin(elements_), std::cend(elements_), mappable);
+    return !overlap_range(mappable).empty();
 }
 
 template <typename MappableType, typename Allocator>
@@ -761,7 +790,7 @@ MappableFlatSet<MappableType, Allocator>::has_overlapped(const_iterator first, c
     if (is_bidirectionally_sorted_) {
         return has_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(first, last, mappable, max_element_size_);
+    return !overlap_range(first, last, mappable).empty();
 }
 
 template <typename MappableType, typename Allocator>
@@ -782,7 +811,8 @@ MappableFlatSet<MappableType, Allocator>::count_overlapped(const_iterator first,
     if (is_bidirectionally_sorted_) {
         return count_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return count_overlapped(first, last, mappable, max_element_size_);
+    using octopus::size;
+    return size(overlap_range(first, last, mappable));
 }
 
 template <typename MappableType, typename Allocator>
@@ -803,7 +833,10 @@ MappableFlatSet<MappableType, Allocator>::overlap_range(const_iterator first, co
     if (is_bidirectionally_sorted_) {
         return overlap_range(first, last, mappable, BidirectionallySortedTag {});
     }
-    return overlap_range(first, last, mappable, max_element_size_);
+    const auto it1 = find_first_after(first, last, mappable);
+    auto it2 = find_first_overlapped(first, it1, mappable);
+    it2 = std::find_if(it2, it1, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    return make_overlap_range(it2, it1, mappable);
 }
 
 template <typename MappableType, typename Allocator>
@@ -892,6 +925,43 @@ void MappableFlatSet<MappableType, Allocator>::erase_contained(const MappableTyp
     }
 }
 
+// private methods
+
+template <typename MappableType, typename Allocator>
+void MappableFlatSet<MappableType, Allocator>::update_max_ends(const size_type first_changed)
+{
+    if (is_bidirectionally_sorted_) {
+        max_ends_.clear();
+        return;
+    }
+    // max_ends_ is either empty or valid for the elements before first_changed
+    const auto first = std::min(first_changed, max_ends_.size());
+    max_ends_.resize(elements_.size());
+    Position max_end {first > 0 ? max_ends_[first - 1] : 0};
+    auto element_itr = std::next(std::cbegin(elements_), first);
+    for (auto i = first; i < max_ends_.size(); ++i, ++element_itr) {
+        max_end = std::max(max_end, mapped_end(*element_itr));
+        max_ends_[i] = max_end;
+    }
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableFlatSet<MappableType, Allocator>::const_iterator
+MappableFlatSet<MappableType, Allocator>::find_first_overlapped(const_iterator first, const_iterator last,
+                                                                const MappableType_& mappable) const
+{
+    // The running maximum end is sorted, and no element before the first one reaching the
+    // query can overlap it.
+    assert(max_ends_.size() == elements_.size());
+    const auto first_max_end = std::next(std::cbegin(max_ends_), std::distance(std::cbegin(elements_), first));
+    const auto last_max_end = std::next(first_max_end, std::distance(first, last));
+    const auto query_begin = mapped_begin(mappable);
+    const auto itr = std::partition_point(first_max_end, last_max_end,
+                                          [query_begin] (const Position end) { return end < query_begin; });
+    return std::next(first, std::distance(first_max_end, itr));
+}
+
 // non-member methods
 
 template <typename MappableType, typename Allocator>
@@ -916,6 +986,7 @@ void swap(MappableFlatSet<MappableType, Allocator>& lhs,
     swap(lhs.elements_, rhs.elements_);
     swap(lhs.is_bidirectionally_sorted_, rhs.is_bidirectionally_sorted_);
     swap(lhs.max_element_size_, rhs.max_element_size_);
+    swap(lhs.max_ends_, rhs.max_ends_);
 }
 
 } // namespace octopus
@@ -10,20 +10,22 @@
 #include <stdexcept>
 #include <cassert>
 #include <iostream>
+#include <limits>
 
 #include "concepts/mappable.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/maths.hpp"
 #include "utils/append.hpp"
+#include "utils/read_size_estimator.hpp"
+#include "utils/task_memory.hpp"
 #include "core/models/haplotype_likelihood_model.hpp"
 #include "core/tools/haplotype_filter.hpp"
 #include "core/types/calls/call.hpp"
 #include "core/types/calls/call_wrapper.hpp"
 #include "core/types/calls/variant_call.hpp"
 #include "core/types/calls/reference_call.hpp"
-
-#include "timers.hpp"
+#include "logging/profiler.hpp"
 
 namespace octopus {
 
@@ -39,6 +41,7 @@ Caller::Caller(Components&& components, Parameters parameters)
 , haplotype_generator_builder_ {std::move(components.haplotype_generator_builder)}
 , likelihood_model_ {std::move(components.likelihood_model)}
 , phaser_ {std::move(components.phaser)}
+, read_support_writer_ {std::move(components.read_support_writer)}
 , parameters_ {std::move(parameters)}
 {
     if (parameters_.max_haplotypes == 0) {
@@ -132,11 +135,10 @@ auto convert_to_vcf(std::deque<CallWrapper>&& calls, const VcfRecordFactory& fac
 
 std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter) const
 {
-    resume(init_timer);
+    profiling::TaskScope task_profile {call_region};
     ReadMap reads;
     if (candidate_generator_.requires_reads()) {
         reads = read_pipe_.get().fetch_reads(expand(call_region, 100));
-        add_reads(reads, candidate_generator_);
         if (!refcalls_requested() && all_empty(reads)) {
             if (debug_log_) stream(*debug_log_) << "Stopping early as no reads found in call region " << call_region;
             return {};
@@ -144,7 +146,11 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
         if (debug_log_) stream(*debug_log_) << "Using " << count_reads(reads) << " reads in call region " << call_region;
     }
     const auto candidate_region = calculate_candidate_region(call_region, reads, reference_, candidate_generator_);
-    auto candidates = generate_candidate_variants(candidate_region);
+    auto candidates = profiling::timed(profiling::Stage::candidate_generation, [&] () {
+        if (candidate_generator_.requires_reads()) add_reads(reads, candidate_generator_);
+        return generate_candidate_variants(candidate_region);
+    });
+    profiling::count(profiling::Counter::candidates, candidates.size());
     if (debug_log_) debug::print_final_candidates(stream(*debug_log_), candidates, candidate_region);
     if (!refcalls_requested() && candidates.empty()) {
         progress_meter.log_completed(call_region);
@@ -154,7 +160,6 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
         // as we didn't fetch them earlier
         reads = read_pipe_.get().fetch_reads(extract_regions(candidates));
     }
-    pause(init_timer);
     auto calls = call_variants(call_region, candidates, reads, progress_meter);
     candidates.clear();
     candidates.shrink_to_fit();
@@ -257,6 +262,18 @@ void merge_unique(std::vector<T>&& src, std::vector<T>& dst)
     dst.erase(std::unique(std::begin(dst), std::end(dst)), std::end(dst));
 }
 
+// The active window holds a copy of the active reads, and a likelihood for every read and haplotype pair
+std::size_t estimate_window_footprint(const std::vector<Haplotype>& haplotypes, const ReadMap& active_reads)
+{
+    using LikelihoodType = HaplotypeLikelihoodCache::LikelihoodVector::value_type;
+    auto result = estimate_memory_footprint(active_reads);
+    result += count_reads(active_reads) * haplotypes.size() * sizeof(LikelihoodType);
+    for (const auto& haplotype : haplotypes) {
+        result += sizeof(Haplotype) + sequence_size(haplotype);
+    }
+    return result;
+}
+
 } // namespace
 
 std::deque<CallWrapper>
@@ -264,7 +281,11 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
                       const ReadMap& reads, ProgressMeter& progress_meter) const
 {
     auto haplotype_generator   = make_haplotype_generator(candidates, reads);
+    // Keeps its working storage between active windows, so should only be made once per task
     auto haplotype_likelihoods = make_haplotype_likelihood_cache();
+    // TODO: The haplotypes, genotypes and calls made for each active window still use the global allocator.
+    // A per-window arena (e.g. boost::container::pmr::monotonic_buffer_resource) needs Haplotype, Genotype
+    // and Variant to take allocators first.
     GeneratorStatus status;
     std::deque<CallWrapper> result {};
     std::vector<Haplotype> haplotypes {}, next_haplotypes {};
@@ -272,6 +293,8 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
     boost::optional<GenomicRegion> next_active_region {}, prev_called_region {};
     auto completed_region = head_region(call_region);
     std::deque<Haplotype> protected_haplotypes {};
+    const auto reads_footprint = estimate_memory_footprint(reads);
+    note_task_footprint(reads_footprint);
     while (true) {
         status = generate_active_haplotypes(call_region, haplotype_generator, active_region,
                                             next_active_region, haplotypes, next_haplotypes);
@@ -290,11 +313,15 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
             continue;
         }
         if (debug_log_) stream(*debug_log_) << "There are " << count_reads(active_reads) << " active reads in " << active_region;
+        // TODO: the haplotype filters rank haplotypes over all samples, so every sample's likelihoods must be
+        // held until they have run. Streaming samples through populate needs a streaming filter first.
         if (!populate(haplotype_likelihoods, active_region, haplotypes, candidates, active_reads)) {
             haplotype_generator.clear_progress();
             haplotype_likelihoods.clear();
             continue;
         }
+        const auto window_footprint = reads_footprint + estimate_window_footprint(haplotypes, active_reads);
+        note_task_footprint(window_footprint);
         if (!protected_haplotypes.empty()) {
             assert(!haplotypes.empty());
             std::sort(std::begin(haplotypes), std::end(haplotypes));
@@ -303,9 +330,10 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
         }
         auto has_removal_impact = filter_haplotypes(haplotypes, haplotype_generator, haplotype_likelihoods, protected_haplotypes);
         if (haplotypes.empty()) continue;
-        resume(latent_timer);
-        const auto caller_latents = infer_latents(haplotypes, haplotype_likelihoods);
-        pause(latent_timer);
+        note_task_footprint(window_footprint + estimate_genotypes_footprint(haplotypes.size()));
+        const auto caller_latents = profiling::timed(profiling::Stage::genotype_inference, [&] () {
+            return infer_latents(haplotypes, haplotype_likelihoods);
+        });
         if (trace_log_) {
             debug::print_haplotype_posteriors(stream(*trace_log_), *caller_latents->haplotype_posteriors(), -1);
         } else if (debug_log_) {
@@ -337,6 +365,13 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
     return result;
 }
 
+// Each genotype holds a pointer per haplotype copy, and has a posterior for each sample
+std::size_t Caller::genotypes_footprint(const std::size_t num_genotypes, const unsigned ploidy) const noexcept
+{
+    const auto genotype_size = sizeof(Genotype<Haplotype>) + ploidy * sizeof(std::shared_ptr<Haplotype>);
+    return num_genotypes * (genotype_size + samples_.size() * sizeof(double));
+}
+
 std::size_t Caller::do_remove_duplicates(std::vector<Haplotype>& haplotypes) const
 {
     return unique_least_complex(haplotypes, Haplotype {haplotype_region(haplotypes), reference_.get()});
@@ -625,14 +660,17 @@ void Caller::call_variants(const GenomicRegion& active_region,
         std::vector<GenomicRegion> called_regions;
         if (!active_candidates.empty()) {
             if (debug_log_) stream(*debug_log_) << "Calling variants in region " << uncalled_region;
-            resume(calling_timer);
-            auto variant_calls = wrap(call_variants(active_candidates, latents));
-            pause(calling_timer);
+            auto variant_calls = profiling::timed(profiling::Stage::variant_calling, [&] () {
+                return wrap(call_variants(active_candidates, latents));
+            });
             if (!variant_calls.empty()) {
                 set_model_posteriors(variant_calls, latents, haplotypes, haplotype_likelihoods);
                 called_regions = extract_covered_regions(variant_calls);
                 set_phasing(variant_calls, latents, haplotypes, call_region);
                 utils::append(std::move(variant_calls), result);
+                if (read_support_writer_) {
+                    write_read_support(latents, haplotypes, haplotype_likelihoods, reads);
+                }
             }
         }
         prev_called_region = uncalled_region;
@@ -667,6 +705,82 @@ std::deque<Haplotype> Caller::get_called_haplotypes(const Latents& latents) cons
     return result;
 }
 
+namespace {
+
+boost::optional<const Haplotype&> find_reference(const std::vector<Haplotype>& haplotypes)
+{
+    const auto itr = std::find_if(std::cbegin(haplotypes), std::cend(haplotypes),
+                                  [] (const auto& haplotype) { return is_reference(haplotype); });
+    if (itr != std::cend(haplotypes)) {
+        return *itr;
+    } else {
+        return boost::none;
+    }
+}
+
+bool is_homozygous_nonreference(const Genotype<Haplotype>& genotype)
+{
+    return genotype.is_homozygous() && !is_reference(genotype[0]);
+}
+
+} // namespace
+
+void Caller::write_read_support(const Latents& latents, const std::vector<Haplotype>& haplotypes,
+                                const HaplotypeLikelihoodCache& haplotype_likelihoods,
+                                const ReadMap& reads) const
+{
+    // Assign reads to the same haplotypes the call set refinement ReadAssignments facet would
+    // consider, i.e. the called genotype plus the reference if the genotype is homozygous non-reference.
+    ReadSupportRecord record {haplotype_region(haplotypes), {}};
+    record.samples.reserve(samples_.size());
+    const auto reference_haplotype = find_reference(haplotypes);
+    for (const auto& sample : samples_) {
+        const auto genotype = call_genotype(latents, sample);
+        auto assignable = genotype.copy_unique();
+        if (is_homozygous_nonreference(genotype) && reference_haplotype) {
+            assignable.push_back(*reference_haplotype);
+        }
+        if (!std::all_of(std::cbegin(assignable), std::cend(assignable),
+                         [&] (const auto& haplotype) { return haplotype_likelihoods.contains(haplotype); })) {
+            continue;
+        }
+        auto& support = record.samples[sample];
+        support.haplotypes.reserve(assignable.size());
+        std::vector<std::reference_wrapper<const HaplotypeLikelihoodCache::LikelihoodVector>> likelihoods {};
+        likelihoods.reserve(assignable.size());
+        for (const auto& haplotype : assignable) {
+            support.haplotypes.push_back(extract_nonreference_alleles(haplotype, reference_));
+            likelihoods.emplace_back(haplotype_likelihoods(sample, haplotype));
+        }
+        const auto& sample_reads = reads.at(sample);
+        support.reads.reserve(sample_reads.size());
+        std::size_t read_idx {0};
+        for (const auto& read : sample_reads) {
+            auto max_likelihood = std::numeric_limits<double>::lowest(), runner_up = max_likelihood;
+            auto best = ReadSupportRecord::unassigned;
+            for (std::uint32_t h {0}; h < likelihoods.size(); ++h) {
+                const auto curr = likelihoods[h].get()[read_idx];
+                if (curr > max_likelihood) {
+                    runner_up = max_likelihood;
+                    max_likelihood = curr;
+                    best = h;
+                } else if (curr > runner_up) {
+                    runner_up = curr;
+                }
+            }
+            if (likelihoods.size() > 1 && maths::almost_equal(max_likelihood, runner_up)) {
+                best = ReadSupportRecord::unassigned;
+            }
+            const auto margin = likelihoods.size() > 1 ? max_likelihood - runner_up : 0.0;
+            support.reads.push_back({make_read_support_id(read), best, static_cast<float>(margin)});
+            ++read_idx;
+        }
+        std::sort(std::begin(support.reads), std::end(support.reads),
+                  [] (const auto& lhs, const auto& rhs) { return lhs.id < rhs.id; });
+    }
+    read_support_writer_->write(record);
+}
+
 bool requires_model_evaluation(const std::vector<CallWrapper>& calls)
 {
     return std::any_of(std::cbegin(calls), std::cend(calls),
@@ -678,9 +792,9 @@ void Caller::set_model_posteriors(std::vector<CallWrapper>& calls, const Latents
                                   const HaplotypeLikelihoodCache& haplotype_likelihoods) const
 {
     if (parameters_.allow_model_filtering || requires_model_evaluation(calls)) {
-        resume(latent_timer);
-        const auto mp = calculate_model_posterior(haplotypes, haplotype_likelihoods, latents);
-        pause(latent_timer);
+        const auto mp = profiling::timed(profiling::Stage::genotype_inference, [&] () {
+            return calculate_model_posterior(haplotypes, haplotype_likelihoods, latents);
+        });
         if (mp) {
             for (auto& call : calls) {
                 call->set_model_posterior(probability_to_phred(1 - *mp));
@@ -743,10 +857,10 @@ void Caller::set_phasing(std::vector<CallWrapper>& calls, const Latents& latents
                          const std::vector<Haplotype>& haplotypes,
                          const GenomicRegion& call_region) const
 {
-    resume(phasing_timer);
-    const auto phase = phaser_.force_phase(haplotypes, *latents.genotype_posteriors(),
-                                           extract_regions(calls), get_genotype_calls(latents));
-    pause(phasing_timer);
+    const auto phase = profiling::timed(profiling::Stage::phasing, [&] () {
+        return phaser_.force_phase(haplotypes, *latents.genotype_posteriors(),
+                                   extract_regions(calls), get_genotype_calls(latents));
+    });
     if (debug_log_) debug::print_phase_sets(stream(*debug_log_), phase);
     octopus::set_phasing(calls, phase, call_region);
 }
@@ -854,9 +968,8 @@ bool Caller::populate(HaplotypeLikelihoodCache& haplotype_likelihoods,
         }
     }
     try {
-        resume(haplotype_likelihood_timer);
+        profiling::ScopedTimer timer {profiling::Stage::haplotype_likelihoods};
         haplotype_likelihoods.populate(active_reads, haplotypes, std::move(flank_state));
-        pause(haplotype_likelihood_timer);
     } catch(const HaplotypeLikelihoodModel::ShortHaplotypeError& e) {
         if (debug_log_) {
             stream(*debug_log_) << "Skipping " << active_region << " as a haplotype was too short by "
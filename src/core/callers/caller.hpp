@@ -28,6 +28,7 @@
 #include "logging/logging.hpp"
 #include "io/variant/vcf_record.hpp"
 #include "core/tools/vcf_record_factory.hpp"
+#include "core/tools/read_support_sidecar.hpp"
 
 namespace octopus {
 
@@ -91,6 +92,9 @@ protected:
         virtual std::shared_ptr<GenotypeProbabilityMap> genotype_posteriors() const = 0;
     };
     
+    // For estimate_genotypes_footprint
+    std::size_t genotypes_footprint(std::size_t num_genotypes, unsigned ploidy) const noexcept;
+    
 public:
     struct Components
     {
@@ -100,6 +104,7 @@ public:
         HaplotypeGenerator::Builder haplotype_generator_builder;
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
+        std::shared_ptr<ReadSupportSidecarWriter> read_support_writer = nullptr;
     };
     
     struct Parameters
@@ -121,6 +126,7 @@ private:
     HaplotypeGenerator::Builder haplotype_generator_builder_;
     HaplotypeLikelihoodModel likelihood_model_;
     Phaser phaser_;
+    std::shared_ptr<ReadSupportSidecarWriter> read_support_writer_;
     Parameters parameters_;
         
     // virtual methods
@@ -130,6 +136,9 @@ private:
     
     virtual std::size_t do_remove_duplicates(std::vector<Haplotype>& haplotypes) const;
     
+    // Roughly the memory taken by the genotypes, and their posteriors, evaluated over num_haplotypes haplotypes
+    virtual std::size_t estimate_genotypes_footprint(unsigned num_haplotypes) const = 0;
+    
     virtual std::unique_ptr<Latents>
     infer_latents(const std::vector<Haplotype>& haplotypes,
                   const HaplotypeLikelihoodCache& haplotype_likelihoods) const = 0;
@@ -194,6 +203,8 @@ private:
                        boost::optional<GenomicRegion>& prev_called_region, GenomicRegion& completed_region) const;
     GenotypeCallMap get_genotype_calls(const Latents& latents) const;
     std::deque<Haplotype> get_called_haplotypes(const Latents& latents) const;
+    void write_read_support(const Latents& latents, const std::vector<Haplotype>& haplotypes,
+                            const HaplotypeLikelihoodCache& haplotype_likelihoods, const ReadMap& reads) const;
     void set_model_posteriors(std::vector<CallWrapper>& calls, const Latents& latents,
                               const std::vector<Haplotype>& haplotypes,
                               const HaplotypeLikelihoodCache& haplotype_likelihoods) const;
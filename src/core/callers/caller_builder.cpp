@@ -14,7 +14,7 @@ namespace octopus {
 
 CallerBuilder::CallerBuilder(const ReferenceGenome& reference, const ReadPipe& read_pipe,
                              VariantGeneratorBuilder vgb, HaplotypeGenerator::Builder hgb)
-: components_ {reference, read_pipe, std::move(vgb), std::move(hgb), HaplotypeLikelihoodModel {}, Phaser {}}
+: components_ {reference, read_pipe, std::move(vgb), std::move(hgb), HaplotypeLikelihoodModel {}, Phaser {}, nullptr}
 , params_ {}
 , factory_ {}
 {
@@ -24,6 +24,7 @@ CallerBuilder::CallerBuilder(const ReferenceGenome& reference, const ReadPipe& r
     params_.general.haplotype_extension_threshold = Phred<> {150.0};
     params_.general.saturation_limit = Phred<> {10.0};
     params_.general.max_haplotypes = 200;
+    params_.execution_policy = ExecutionPolicy::seq;
     factory_ = generate_factory();
 }
 
@@ -156,12 +157,24 @@ CallerBuilder& CallerBuilder::set_max_joint_genotypes(unsigned max) noexcept
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_execution_policy(ExecutionPolicy policy) noexcept
+{
+    params_.execution_policy = policy;
+    return *this;
+}
+
 CallerBuilder& CallerBuilder::set_likelihood_model(HaplotypeLikelihoodModel model) noexcept
 {
     components_.likelihood_model = std::move(model);
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_read_support_writer(std::shared_ptr<ReadSupportSidecarWriter> writer) noexcept
+{
+    components_.read_support_writer = std::move(writer);
+    return *this;
+}
+
 // cancer
 
 CallerBuilder& CallerBuilder::set_normal_sample(SampleName normal_sample)
@@ -255,7 +268,8 @@ Caller::Components CallerBuilder::make_components() const
         components_.variant_generator_builder.build(components_.reference),
         components_.haplotype_generator_builder,
         components_.likelihood_model,
-        Phaser {params_.min_phase_score}
+        Phaser {params_.min_phase_score},
+        components_.read_support_writer
     };
 }
 
@@ -326,6 +340,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                           get_ploidies(samples, *requested_contig_, params_.ploidies),
                                                           make_population_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                                                           params_.max_joint_genotypes,
+                                                          params_.execution_policy
                                                       });
         }},
         {"cancer", [this, &samples] () {
@@ -359,7 +374,8 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                     params_.min_variant_posterior,
                                                     params_.min_denovo_posterior,
                                                     params_.min_refcall_posterior,
-                                                    params_.max_joint_genotypes
+                                                    params_.max_joint_genotypes,
+                                                    params_.execution_policy
                                                 });
         }}
     };
@@ -58,7 +58,9 @@ public:
     CallerBuilder& set_snp_heterozygosity(double heterozygosity) noexcept;
     CallerBuilder& set_indel_heterozygosity(double heterozygosity) noexcept;
     CallerBuilder& set_max_joint_genotypes(unsigned max) noexcept;
+    CallerBuilder& set_execution_policy(ExecutionPolicy policy) noexcept;
     CallerBuilder& set_likelihood_model(HaplotypeLikelihoodModel model) noexcept;
+    CallerBuilder& set_read_support_writer(std::shared_ptr<ReadSupportSidecarWriter> writer) noexcept;
     
     // cancer
     CallerBuilder& set_normal_sample(SampleName normal_sample);
@@ -90,6 +92,7 @@ private:
         HaplotypeGenerator::Builder haplotype_generator_builder;
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
+        std::shared_ptr<ReadSupportSidecarWriter> read_support_writer;
     };
     
     struct Parameters
@@ -101,6 +104,7 @@ private:
         boost::optional<double> snp_heterozygosity, indel_heterozygosity;
         Phred<double> min_phase_score;
         unsigned max_joint_genotypes;
+        ExecutionPolicy execution_policy;
         
         // cancer
         boost::optional<SampleName> normal_sample;
@@ -26,6 +26,12 @@ CallerFactory& CallerFactory::set_read_pipe(ReadPipe& read_pipe) noexcept
     return *this;
 }
 
+CallerFactory& CallerFactory::set_read_support_writer(std::shared_ptr<ReadSupportSidecarWriter> writer) noexcept
+{
+    template_builder_.set_read_support_writer(std::move(writer));
+    return *this;
+}
+
 std::unique_ptr<Caller> CallerFactory::make(const ContigName& contig) const
 {
     return template_builder_.build(contig);
@@ -34,6 +34,7 @@ public:
     
     CallerFactory& set_reference(const ReferenceGenome& reference) noexcept;
     CallerFactory& set_read_pipe(ReadPipe& read_pipe) noexcept;
+    CallerFactory& set_read_support_writer(std::shared_ptr<ReadSupportSidecarWriter> writer) noexcept;
     
     std::unique_ptr<Caller> make(const ContigName& contig) const;
     
@@ -25,6 +25,7 @@
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
 #include "core/models/genotype/coalescent_genotype_prior_model.hpp"
 #include "utils/read_stats.hpp"
+#include "utils/allele_membership.hpp"
 #include "utils/sequence_utils.hpp"
 #include "utils/merge_transform.hpp"
 #include "utils/mappable_algorithms.hpp"
@@ -81,6 +82,16 @@ CancerCaller::CallTypeSet CancerCaller::do_call_types() const
     };
 }
 
+// Germline genotypes, plus cancer genotypes with one somatic haplotype up to the genotype limit
+std::size_t CancerCaller::estimate_genotypes_footprint(const unsigned num_haplotypes) const
+{
+    const auto num_germline_genotypes = num_genotypes(num_haplotypes, parameters_.ploidy);
+    const auto num_cancer_genotypes = std::min<std::size_t>(num_genotypes(num_haplotypes, parameters_.ploidy + 1),
+                                                            parameters_.max_genotypes);
+    return genotypes_footprint(num_germline_genotypes, parameters_.ploidy)
+           + genotypes_footprint(num_cancer_genotypes, parameters_.ploidy + 1);
+}
+
 // private methods
 
 bool CancerCaller::has_normal_sample() const noexcept
@@ -565,25 +576,26 @@ auto find_map_genotype(const L& posteriors)
 
 // germline variant posterior calculations
 
-template <typename M>
-Phred<double> marginalise(const Allele& allele, const M& genotype_posteriors)
+auto extract_alt_alleles(const std::vector<Variant>& variants)
 {
-    auto p = std::accumulate(std::cbegin(genotype_posteriors),
-                             std::cend(genotype_posteriors),
-                             0.0, [&allele] (const auto curr, const auto& p) {
-                                 return curr + (contains(p.first, allele) ? 0.0 : p.second);
-                             });
-    return probability_to_phred(p);
+    std::vector<Allele> result {};
+    result.reserve(variants.size());
+    std::transform(std::cbegin(variants), std::cend(variants), std::back_inserter(result),
+                   [] (const auto& variant) { return variant.alt_allele(); });
+    return result;
 }
 
 template <typename M>
 VariantPosteriorVector compute_candidate_posteriors(const std::vector<Variant>& candidates,
                                                     const M& genotype_posteriors)
 {
+    const AlleleMembership contained_alleles {extract_alt_alleles(candidates),
+                                              std::cbegin(genotype_posteriors), std::cend(genotype_posteriors)};
+    const auto probabilities = extract_probabilities(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors));
     VariantPosteriorVector result {};
     result.reserve(candidates.size());
-    for (const auto& candidate : candidates) {
-        result.emplace_back(candidate, marginalise(candidate.alt_allele(), genotype_posteriors));
+    for (std::size_t i {0}; i < candidates.size(); ++i) {
+        result.emplace_back(candidates[i], probability_to_phred(contained_alleles.sum_excluded(i, probabilities)));
     }
     return result;
 }
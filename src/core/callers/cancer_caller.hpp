@@ -89,6 +89,7 @@ private:
     
     std::string do_name() const override;
     CallTypeSet do_call_types() const override;
+    std::size_t estimate_genotypes_footprint(unsigned num_haplotypes) const override;
     
     std::unique_ptr<Caller::Latents>
     infer_latents(const std::vector<Haplotype>& haplotypes,
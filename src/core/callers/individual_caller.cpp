@@ -20,6 +20,7 @@
 #include "utils/maths.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
+#include "utils/allele_membership.hpp"
 #include "containers/probability_matrix.hpp"
 #include "logging/logging.hpp"
 #include "core/types/calls/germline_variant_call.hpp"
@@ -28,8 +29,6 @@
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
 #include "core/models/genotype/coalescent_genotype_prior_model.hpp"
 
-#include "timers.hpp"
-
 namespace octopus {
 
 IndividualCaller::IndividualCaller(Caller::Components&& components,
@@ -53,6 +52,11 @@ IndividualCaller::CallTypeSet IndividualCaller::do_call_types() const
     return {std::type_index(typeid(GermlineVariantCall))};
 }
 
+std::size_t IndividualCaller::estimate_genotypes_footprint(const unsigned num_haplotypes) const
+{
+    return genotypes_footprint(num_genotypes(num_haplotypes, parameters_.ploidy), parameters_.ploidy);
+}
+
 // IndividualCaller::Latents public methods
 
 IndividualCaller::Latents::Latents(const SampleName& sample,
@@ -194,22 +198,25 @@ using GenotypeCalls = std::vector<GenotypeCall>;
 
 // allele posterior calculations
 
-auto compute_posterior(const Allele& allele, const GenotypeProbabilityMap& genotype_posteriors)
+auto extract_alt_alleles(const std::vector<Variant>& variants)
 {
-    auto p = std::accumulate(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
-                             0.0, [&allele] (const auto curr, const auto& p) {
-                                 return curr + (contains(p.first, allele) ? 0.0 : p.second);
-                             });
-    return probability_to_phred(p);
+    std::vector<Allele> result {};
+    result.reserve(variants.size());
+    std::transform(std::cbegin(variants), std::cend(variants), std::back_inserter(result),
+                   [] (const auto& variant) { return variant.alt_allele(); });
+    return result;
 }
 
 auto compute_candidate_posteriors(const std::vector<Variant>& candidates,
                                   const GenotypeProbabilityMap& genotype_posteriors)
 {
+    const AlleleMembership contained_alleles {extract_alt_alleles(candidates),
+                                              std::cbegin(genotype_posteriors), std::cend(genotype_posteriors)};
+    const auto probabilities = extract_probabilities(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors));
     VariantPosteriorVector result {};
     result.reserve(candidates.size());
-    for (const auto& candidate : candidates) {
-        result.emplace_back(candidate, compute_posterior(candidate.alt_allele(), genotype_posteriors));
+    for (std::size_t i {0}; i < candidates.size(); ++i) {
+        result.emplace_back(candidates[i], probability_to_phred(contained_alleles.sum_excluded(i, probabilities)));
     }
     return result;
 }
@@ -21,6 +21,7 @@
 #include "utils/maths.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
+#include "utils/allele_membership.hpp"
 #include "containers/probability_matrix.hpp"
 #include "core/models/genotype/individual_model.hpp"
 #include "core/models/genotype/uniform_population_prior_model.hpp"
@@ -60,6 +61,18 @@ PopulationCaller::CallTypeSet PopulationCaller::do_call_types() const
     return {std::type_index(typeid(GermlineVariantCall))};
 }
 
+std::size_t PopulationCaller::estimate_genotypes_footprint(const unsigned num_haplotypes) const
+{
+    std::size_t result {0};
+    auto ploidies = parameters_.ploidies;
+    std::sort(std::begin(ploidies), std::end(ploidies));
+    ploidies.erase(std::unique(std::begin(ploidies), std::end(ploidies)), std::end(ploidies));
+    for (const auto ploidy : ploidies) {
+        result += genotypes_footprint(num_genotypes(num_haplotypes, ploidy), ploidy);
+    }
+    return result;
+}
+
 // IndividualCaller::Latents public methods
 
 namespace {
@@ -243,7 +256,7 @@ PopulationCaller::infer_latents(const std::vector<Haplotype>& haplotypes,
     //const auto prior_model = make_prior_model(haplotypes);
     //const model::PopulationModel model {*prior_model, {parameters_.max_genotypes_per_sample}, debug_log_};
     const auto prior_model = make_independent_prior_model(haplotypes);
-    const model::IndependentPopulationModel model {*prior_model, debug_log_};
+    const model::IndependentPopulationModel model {*prior_model, parameters_.execution_policy, debug_log_};
     if (parameters_.ploidies.size() == 1) {
         auto genotypes = generate_all_genotypes(haplotypes, parameters_.ploidies.front());
         if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
@@ -337,24 +350,14 @@ using GenotypeCalls = std::vector<std::vector<GenotypeCall>>;
 using AlleleBools          = std::deque<bool>; // using std::deque because std::vector<bool> is evil
 using GenotypePropertyBools = std::vector<AlleleBools>;
 
-auto marginalise(const GenotypeProbabilityMap& genotype_posteriors,
-                 const AlleleBools& contained_alleles)
-{
-    auto p = std::inner_product(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
-                                std::cbegin(contained_alleles), 0.0, std::plus<> {},
-                                [] (const auto& p, const bool is_contained) {
-                                    return is_contained ? 0.0 : p.second;
-                                });
-    return probability_to_phred(p);
-}
-
 auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_posteriors,
-                                      const GenotypePropertyBools& contained_alleles)
+                                      const AlleleMembership& contained_alleles)
 {
+    const auto probabilities = extract_probabilities(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors));
     std::vector<Phred<double>> result {};
-    result.reserve(contained_alleles.size());
-    for (const auto& allele : contained_alleles) {
-        result.emplace_back(marginalise(genotype_posteriors, allele));
+    result.reserve(contained_alleles.num_alleles());
+    for (std::size_t allele {0}; allele < contained_alleles.num_alleles(); ++allele) {
+        result.emplace_back(probability_to_phred(contained_alleles.sum_excluded(allele, probabilities)));
     }
     return result;
 }
@@ -362,21 +365,12 @@ auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_pos
 auto get_contained_alleles(const PopulationGenotypeProbabilityMap& genotype_posteriors,
                            const std::vector<Allele>& alleles)
 {
-    const auto num_genotypes = genotype_posteriors.size2();
-    GenotypePropertyBools result {};
-    if (num_genotypes == 0 || genotype_posteriors.empty1() || alleles.empty()) {
-        return result;
-    }
-    result.reserve(alleles.size());
-    const auto& test_sample   = genotype_posteriors.begin()->first;
-    const auto genotype_begin = genotype_posteriors.begin(test_sample);
-    const auto genotype_end   = genotype_posteriors.end(test_sample);
-    for (const auto& allele : alleles) {
-        result.emplace_back(num_genotypes);
-        std::transform(genotype_begin, genotype_end, std::begin(result.back()),
-                       [&] (const auto& p) { return contains(p.first, allele); });
+    if (genotype_posteriors.size2() == 0 || genotype_posteriors.empty1() || alleles.empty()) {
+        return AlleleMembership {};
     }
-    return result;
+    // All samples have the same genotype order
+    const auto& test_sample = genotype_posteriors.begin()->first;
+    return AlleleMembership {alleles, genotype_posteriors.begin(test_sample), genotype_posteriors.end(test_sample)};
 }
 
 auto compute_posteriors(const std::vector<SampleName>& samples,
@@ -38,6 +38,7 @@ public:
         std::vector<unsigned> ploidies;
         boost::optional<CoalescentModel::Parameters> prior_model_params;
         unsigned max_genotypes_per_sample;
+        ExecutionPolicy execution_policy;
     };
     
     PopulationCaller() = delete;
@@ -60,6 +61,7 @@ private:
     
     std::string do_name() const override;
     CallTypeSet do_call_types() const override;
+    std::size_t estimate_genotypes_footprint(unsigned num_haplotypes) const override;
     
     std::unique_ptr<Caller::Latents>
     infer_latents(const std::vector<Haplotype>& haplotypes,
@@ -7,6 +7,7 @@
 #include <functional>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <map>
 #include <utility>
@@ -27,8 +28,6 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/maths.hpp"
 
-#include "timers.hpp"
-
 namespace octopus {
 
 TrioCaller::TrioCaller(Caller::Components&& components,
@@ -54,6 +53,16 @@ Caller::CallTypeSet TrioCaller::do_call_types() const
             std::type_index(typeid(DenovoReferenceReversionCall))};
 }
 
+// Each member's genotypes, plus the joint genotypes kept, which hold an index and probability per member
+std::size_t TrioCaller::estimate_genotypes_footprint(const unsigned num_haplotypes) const
+{
+    const auto max_ploidy = std::max({parameters_.maternal_ploidy, parameters_.paternal_ploidy, parameters_.child_ploidy});
+    const auto num_member_genotypes = num_genotypes(num_haplotypes, max_ploidy);
+    const auto num_joint_genotypes = std::min<double>(std::pow(num_member_genotypes, 3), parameters_.max_joint_genotypes);
+    return genotypes_footprint(num_member_genotypes, max_ploidy)
+           + static_cast<std::size_t>(num_joint_genotypes) * 3 * (sizeof(std::size_t) + sizeof(double));
+}
+
 // TrioCaller::Latents
 
 TrioCaller::Latents::Latents(const std::vector<Haplotype>& haplotypes,
@@ -236,7 +245,8 @@ TrioCaller::infer_latents(const std::vector<Haplotype>& haplotypes,
                           const HaplotypeLikelihoodCache& haplotype_likelihoods) const
 {
     auto germline_prior_model = make_prior_model(haplotypes);
-    DeNovoModel denovo_model {parameters_.denovo_model_params, haplotypes.size(), DeNovoModel::CachingStrategy::address};
+    DeNovoModel denovo_model {parameters_.denovo_model_params, haplotypes.size(), DeNovoModel::CachingStrategy::address,
+                              parameters_.execution_policy};
     const model::TrioModel model {
         parameters_.trio, *germline_prior_model, denovo_model,
         TrioModel::Options {parameters_.max_joint_genotypes},
@@ -298,7 +308,8 @@ TrioCaller::calculate_model_posterior(const std::vector<Haplotype>& haplotypes,
     std::vector<std::vector<unsigned>> genotype_indices {};
     const auto genotypes = generate_all_genotypes(haplotypes, max_ploidy + 1, genotype_indices);
     const auto germline_prior_model = make_prior_model(haplotypes);
-    DeNovoModel denovo_model {parameters_.denovo_model_params};
+    DeNovoModel denovo_model {parameters_.denovo_model_params, haplotypes.size(), DeNovoModel::CachingStrategy::value,
+                              parameters_.execution_policy};
     germline_prior_model->prime(haplotypes);
     denovo_model.prime(haplotypes);
     const model::TrioModel model {parameters_.trio, *germline_prior_model, denovo_model,
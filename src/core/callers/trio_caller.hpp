@@ -34,6 +34,7 @@ public:
         DeNovoModel::Parameters denovo_model_params;
         Phred<double> min_variant_posterior, min_denovo_posterior, min_refcall_posterior;
         unsigned max_joint_genotypes;
+        ExecutionPolicy execution_policy;
     };
     
     TrioCaller() = delete;
@@ -56,6 +57,7 @@ private:
     
     std::string do_name() const override;
     CallTypeSet do_call_types() const override;
+    std::size_t estimate_genotypes_footprint(unsigned num_haplotypes) const override;
     
     std::unique_ptr<Caller::Latents>
     infer_latents(const std::vector<Haplotype>& haplotypes,
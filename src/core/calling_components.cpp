@@ -7,13 +7,16 @@
 #include <utility>
 #include <iterator>
 #include <algorithm>
+#include <numeric>
 #include <functional>
 #include <exception>
+#include <thread>
 
 #include "config/config.hpp"
 #include "config/option_collation.hpp"
 #include "utils/read_size_estimator.hpp"
 #include "utils/map_utils.hpp"
+#include "utils/stable_hash.hpp"
 #include "logging/logging.hpp"
 #include "exceptions/user_error.hpp"
 
@@ -96,6 +99,11 @@ std::size_t GenomeCallingComponents::read_buffer_size() const noexcept
     return components_.read_buffer_size;
 }
 
+boost::optional<MemoryFootprint> GenomeCallingComponents::working_memory_budget() const noexcept
+{
+    return components_.working_memory_budget;
+}
+
 const boost::optional<GenomeCallingComponents::Path>& GenomeCallingComponents::temp_directory() const noexcept
 {
     return components_.temp_directory;
@@ -159,6 +167,36 @@ boost::optional<GenomeCallingComponents::Path> GenomeCallingComponents::filter_r
     return components_.filter_request_;
 }
 
+std::shared_ptr<ReadSupportSidecarWriter> GenomeCallingComponents::read_support_writer() const noexcept
+{
+    return components_.read_support_writer;
+}
+
+std::shared_ptr<CallingCheckpoint> GenomeCallingComponents::checkpoint() const noexcept
+{
+    return components_.checkpoint;
+}
+
+boost::optional<GenomeShard> GenomeCallingComponents::shard() const noexcept
+{
+    return components_.shard;
+}
+
+const boost::optional<InputDigest>& GenomeCallingComponents::input_digest() const noexcept
+{
+    return components_.input_digest;
+}
+
+boost::optional<GenomeCallingComponents::Path> GenomeCallingComponents::input_digest_path() const
+{
+    return components_.input_digest_path;
+}
+
+std::shared_ptr<const ReusableCalls> GenomeCallingComponents::reusable_calls() const noexcept
+{
+    return components_.reusable_calls;
+}
+
 bool GenomeCallingComponents::sites_only() const noexcept
 {
     return components_.sites_only;
@@ -359,7 +397,8 @@ bool require_temp_dir_for_filtering(const options::OptionMap& options)
 
 bool is_temp_directory_needed(const options::OptionMap& options)
 {
-    return is_multithreaded_run(options) || require_temp_dir_for_filtering(options);
+    return is_multithreaded_run(options) || require_temp_dir_for_filtering(options)
+           || options::reuse_calling_read_assignments(options);
 }
 
 boost::optional<fs::path> get_temp_directory(const options::OptionMap& options)
@@ -381,6 +420,41 @@ std::size_t calculate_max_num_reads(const std::size_t max_buffer_bytes,
     return std::max(max_buffer_bytes, minBufferBytes) / estimate_read_size(samples, input_regions, read_manager);
 }
 
+// As calculate_num_task_threads in octopus.cpp
+unsigned get_num_task_threads(const options::OptionMap& options, const ReadManager& read_manager)
+{
+    const auto num_threads = options::get_num_threads(options);
+    if (num_threads) return *num_threads;
+    const auto num_cores = std::thread::hardware_concurrency();
+    return num_cores > 0 ? num_cores : std::min(read_manager.num_files(), 8u);
+}
+
+// Shards are taken in output order, so the shard outputs can be merged by concatenation. Shards are cut on the
+// task boundaries of an unsharded run, with the same read buffer, so calls either side of a cut are resolved by
+// the merge just as they are between consecutive tasks.
+auto get_calling_regions(const options::OptionMap& options, const ReferenceGenome& reference, ReadManager& rm,
+                         const std::vector<SampleName>& samples)
+{
+    auto result = get_search_regions(options, reference, rm);
+    const auto shard = options::get_shard(options);
+    if (shard) {
+        const auto contigs = get_contigs(result, reference, options::get_contig_output_order(options));
+        if (samples.empty() || !rm.good()) {
+            return select_shard(result, contigs, *shard);
+        }
+        const auto read_buffer_size = calculate_max_num_reads(options::get_target_read_buffer_size(options).num_bytes(),
+                                                              samples, result, rm);
+        const auto num_task_threads = get_num_task_threads(options, rm);
+        boost::optional<GenomicRegion::Size> min_task_size {};
+        if (num_task_threads > 1) min_task_size = minTaskSize;
+        const auto propose_task = [&] (const GenomicRegion& remaining_region) {
+            return propose_call_subregion(rm, samples, read_buffer_size / num_task_threads, remaining_region, min_task_size);
+        };
+        result = select_shard(result, contigs, *shard, propose_task);
+    }
+    return result;
+}
+
 auto add_identifier(const fs::path& base, const std::string& identifier)
 {
     const auto old_stem  = base.stem();
@@ -452,7 +526,7 @@ GenomeCallingComponents::Components::Components(ReferenceGenome&& reference, Rea
 : reference {std::move(reference)}
 , read_manager {std::move(read_manager)}
 , samples {extract_samples(options, this->read_manager)}
-, regions {get_search_regions(options, this->reference, this->read_manager)}
+, regions {get_calling_regions(options, this->reference, this->read_manager, this->samples)}
 , contigs {get_contigs(this->regions, this->reference, options::get_contig_output_order(options))}
 , read_pipe {options::make_read_pipe(this->read_manager, this->samples, options)}
 , caller_factory {options::make_caller_factory(this->reference, this->read_pipe, this->regions, options)}
@@ -461,14 +535,22 @@ GenomeCallingComponents::Components::Components(ReferenceGenome&& reference, Rea
 , output {std::move(output)}
 , num_threads {options::get_num_threads(options)}
 , read_buffer_size {}
+, working_memory_budget {options::get_target_working_memory(options)}
 , temp_directory {get_temp_directory(options)}
 , progress_meter {regions}
 , sites_only {options::call_sites_only(options)}
 , filtered_output {}
 , legacy {}
 , filter_request_ {}
+, read_support_writer {}
+, checkpoint {}
+, shard {options::get_shard(options)}
+, input_digest {}
+, input_digest_path {}
+, reusable_calls {}
 {
     drop_unused_samples(this->samples, this->read_manager);
+    setup_incremental_calling(options);
     setup_progress_meter(options);
     set_read_buffer_size(options);
     setup_writers(options);
@@ -478,6 +560,8 @@ GenomeCallingComponents::Components::Components(ReferenceGenome&& reference, Rea
         if (temp_directory) fs::remove_all(*temp_directory);
         throw InputVCFError {*filter_request_};
     }
+    setup_read_support_writer(options);
+    setup_checkpoint(options);
 }
 
 void GenomeCallingComponents::Components::setup_progress_meter(const options::OptionMap& options)
@@ -495,8 +579,10 @@ void GenomeCallingComponents::Components::setup_progress_meter(const options::Op
 void GenomeCallingComponents::Components::set_read_buffer_size(const options::OptionMap& options)
 {
     if (!samples.empty() && !regions.empty() && read_manager.good()) {
+        // Shards use the buffer of an unsharded run, which their cuts were made with
+        const auto buffered_regions = shard ? get_search_regions(options, reference, read_manager) : regions;
         read_buffer_size = calculate_max_num_reads(options::get_target_read_buffer_size(options).num_bytes(),
-                                                   samples, regions, read_manager);
+                                                   samples, buffered_regions, read_manager);
     }
 }
 
@@ -533,6 +619,52 @@ void GenomeCallingComponents::Components::setup_filter_read_pipe(const options::
     }
 }
 
+void GenomeCallingComponents::Components::setup_read_support_writer(const options::OptionMap& options)
+{
+    if (options::reuse_calling_read_assignments(options)) {
+        assert(temp_directory);
+        read_support_writer = std::make_shared<ReadSupportSidecarWriter>(*temp_directory / "octopus_read_support.bin");
+        caller_factory.set_read_support_writer(read_support_writer);
+    }
+}
+
+void GenomeCallingComponents::Components::setup_incremental_calling(const options::OptionMap& options)
+{
+    input_digest_path = options::get_input_digest_path(options);
+    const auto previous_output = options::get_previous_output(options);
+    if (!input_digest_path && !previous_output) return;
+    logging::InfoLogger info_log {};
+    info_log << "Digesting calling inputs";
+    input_digest = InputDigest {options::get_calling_configuration(options), reference, read_manager, samples, regions};
+    if (previous_output) {
+        const InputDigest previous_input_digest {*options::get_previous_input_digest(options)};
+        const auto unchanged_blocks = input_digest->unchanged_blocks(previous_input_digest);
+        const auto num_unchanged_blocks = std::accumulate(std::cbegin(unchanged_blocks), std::cend(unchanged_blocks), std::size_t {0},
+                                                          [] (auto curr, const auto& p) { return curr + p.second.size(); });
+        stream(info_log) << "Reusing previous calls for " << num_unchanged_blocks << " of " << input_digest->num_blocks()
+                         << " blocks with unchanged inputs";
+        auto split_regions = split_reusable(regions, unchanged_blocks);
+        regions = std::move(split_regions.first);
+        reusable_calls = std::make_shared<ReusableCalls>(*previous_output, std::move(split_regions.second));
+    }
+}
+
+void GenomeCallingComponents::Components::setup_checkpoint(const options::OptionMap& options)
+{
+    const auto checkpoint_directory = options::get_checkpoint_directory(options);
+    if (checkpoint_directory) {
+        if (is_multithreaded_run(options)) {
+            utils::StableHasher inputs {};
+            inputs.update(options::get_calling_inputs(options));
+            checkpoint = std::make_shared<CallingCheckpoint>(*checkpoint_directory, samples, contigs, inputs.digest(),
+                                                             options::resume_from_checkpoint(options));
+        } else {
+            logging::WarningLogger warn_log {};
+            warn_log << "Checkpointing is only supported for multi-threaded runs, so --checkpoint will be ignored";
+        }
+    }
+}
+
 void GenomeCallingComponents::update_dependents() noexcept
 {
     components_.read_pipe.set_read_manager(components_.read_manager);
@@ -651,6 +783,7 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {genome_components.output()}
 , progress_meter {genome_components.progress_meter()}
+, reusable_calls {genome_components.reusable_calls()}
 {}
 
 ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName& contig, VcfWriter& output,
@@ -663,6 +796,47 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {output}
 , progress_meter {genome_components.progress_meter()}
+, reusable_calls {genome_components.reusable_calls()}
 {}
 
+namespace {
+
+auto find_max_window(const ReadManager& read_manager, const std::vector<SampleName>& samples,
+                     const std::size_t read_buffer_size, const GenomicRegion& remaining_call_region)
+{
+    if (!read_manager.has_reads(samples, remaining_call_region)) {
+        return remaining_call_region;
+    }
+    auto result = read_manager.find_covered_subregion(samples, remaining_call_region, read_buffer_size);
+    if (ends_before(result, remaining_call_region)) {
+        auto rest = right_overhang_region(remaining_call_region, result);
+        if (!read_manager.has_reads(samples, rest)) {
+            result = remaining_call_region;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+GenomicRegion propose_call_subregion(const ReadManager& read_manager, const std::vector<SampleName>& samples,
+                                     const std::size_t read_buffer_size, const GenomicRegion& remaining_call_region,
+                                     const boost::optional<GenomicRegion::Size> min_size)
+{
+    if (is_empty(remaining_call_region)) {
+        return remaining_call_region;
+    }
+    const auto max_window = find_max_window(read_manager, samples, read_buffer_size, remaining_call_region);
+    if (ends_before(remaining_call_region, max_window)) {
+        return remaining_call_region;
+    }
+    if (min_size && size(max_window) < *min_size) {
+        if (size(remaining_call_region) < *min_size) {
+            return remaining_call_region;
+        }
+        return expand_rhs(head_region(max_window), *min_size);
+    }
+    return max_window;
+}
+
 } // namespace octopus
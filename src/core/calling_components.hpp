@@ -15,12 +15,18 @@
 #include "config/common.hpp"
 #include "config/option_parser.hpp"
 #include "basics/genomic_region.hpp"
+#include "utils/memory_footprint.hpp"
+#include "utils/genome_shard.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "io/read/read_manager.hpp"
 #include "io/variant/vcf_writer.hpp"
 #include "readpipe/read_pipe_fwd.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/csr/filters/variant_call_filter_factory.hpp"
+#include "core/tools/read_support_sidecar.hpp"
+#include "core/tools/calling_checkpoint.hpp"
+#include "core/tools/input_digest.hpp"
+#include "core/tools/reusable_calls.hpp"
 #include "logging/progress_meter.hpp"
 
 namespace octopus {
@@ -53,6 +59,7 @@ public:
     VcfWriter& output() noexcept;
     const VcfWriter& output() const noexcept;
     std::size_t read_buffer_size() const noexcept;
+    boost::optional<MemoryFootprint> working_memory_budget() const noexcept;
     const boost::optional<Path>& temp_directory() const noexcept;
     boost::optional<unsigned> num_threads() const noexcept;
     const CallerFactory& caller_factory() const noexcept;
@@ -65,6 +72,12 @@ public:
     bool sites_only() const noexcept;
     boost::optional<Path> legacy() const;
     boost::optional<Path> filter_request() const;
+    std::shared_ptr<ReadSupportSidecarWriter> read_support_writer() const noexcept;
+    std::shared_ptr<CallingCheckpoint> checkpoint() const noexcept;
+    boost::optional<GenomeShard> shard() const noexcept;
+    const boost::optional<InputDigest>& input_digest() const noexcept;
+    boost::optional<Path> input_digest_path() const;
+    std::shared_ptr<const ReusableCalls> reusable_calls() const noexcept;
     
 private:
     struct Components
@@ -93,17 +106,27 @@ private:
         VcfWriter output;
         boost::optional<unsigned> num_threads;
         std::size_t read_buffer_size;
+        boost::optional<MemoryFootprint> working_memory_budget;
         boost::optional<Path> temp_directory;
         ProgressMeter progress_meter;
         bool sites_only;
         boost::optional<VcfWriter> filtered_output;
         boost::optional<Path> legacy;
         boost::optional<Path> filter_request_;
+        std::shared_ptr<ReadSupportSidecarWriter> read_support_writer;
+        std::shared_ptr<CallingCheckpoint> checkpoint;
+        boost::optional<GenomeShard> shard;
+        boost::optional<InputDigest> input_digest;
+        boost::optional<Path> input_digest_path;
+        std::shared_ptr<const ReusableCalls> reusable_calls;
         
         void setup_progress_meter(const options::OptionMap& options);
         void set_read_buffer_size(const options::OptionMap& options);
         void setup_writers(const options::OptionMap& options);
         void setup_filter_read_pipe(const options::OptionMap& options);
+        void setup_read_support_writer(const options::OptionMap& options);
+        void setup_checkpoint(const options::OptionMap& options);
+        void setup_incremental_calling(const options::OptionMap& options);
     };
     
     Components components_;
@@ -127,6 +150,7 @@ struct ContigCallingComponents
     std::size_t read_buffer_size;
     std::reference_wrapper<VcfWriter> output;
     std::reference_wrapper<ProgressMeter> progress_meter;
+    std::shared_ptr<const ReusableCalls> reusable_calls;
     
     ContigCallingComponents() = delete;
     
@@ -144,6 +168,15 @@ struct ContigCallingComponents
     ~ContigCallingComponents() = default;
 };
 
+// The smallest task made by multi-threaded runs
+constexpr GenomicRegion::Size minTaskSize {5'000};
+
+// The next calling task at the start of remaining_call_region, which ends where the reads would fill the read
+// buffer, and is at least min_size bases if possible
+GenomicRegion propose_call_subregion(const ReadManager& read_manager, const std::vector<SampleName>& samples,
+                                     std::size_t read_buffer_size, const GenomicRegion& remaining_call_region,
+                                     boost::optional<GenomicRegion::Size> min_size = boost::none);
+
 } // namespace octopus
 
 #endif
@@ -8,7 +8,6 @@
 #include <algorithm>
 #include <iterator>
 #include <array>
-#include <future>
 #include <cassert>
 
 #include "exceptions/program_error.hpp"
@@ -19,9 +18,11 @@
 
 namespace octopus { namespace csr {
 
-FacetFactory::FacetFactory(const ReferenceGenome& reference, BufferedReadPipe read_pipe)
+FacetFactory::FacetFactory(const ReferenceGenome& reference, BufferedReadPipe read_pipe,
+                           std::shared_ptr<const ReadSupportSidecarReader> calling_read_support)
 : reference_ {reference}
 , read_pipe_ {std::move(read_pipe)}
+, calling_read_support_ {std::move(calling_read_support)}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -30,6 +31,7 @@ FacetFactory::FacetFactory(const ReferenceGenome& reference, BufferedReadPipe re
 FacetFactory::FacetFactory(FacetFactory&& other)
 : reference_ {std::move(other.reference_)}
 , read_pipe_ {std::move(other.read_pipe_)}
+, calling_read_support_ {std::move(other.calling_read_support_)}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -40,6 +42,7 @@ FacetFactory& FacetFactory::operator=(FacetFactory&& other)
     using std::swap;
     swap(reference_, other.reference_);
     swap(read_pipe_, other.read_pipe_);
+    swap(calling_read_support_, other.calling_read_support_);
     setup_facet_makers();
     return *this;
 }
@@ -59,15 +62,13 @@ public:
 
 FacetWrapper FacetFactory::make(const std::string& name, const CallBlock& block) const
 {
-    const auto block_data = make_block_data({name}, block);
-    return make(name, block_data);
+    auto facets = make(std::vector<std::string> {name}, block);
+    return std::move(facets.front());
 }
 
 FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& names, const CallBlock& block) const
 {
-    if (names.empty()) return {};
-    const auto block_data = make_block_data(names, block);
-    return make(names, block_data);
+    return make(names, block, fetch(names, block));
 }
 
 namespace {
@@ -103,47 +104,30 @@ bool requires_genotypes(const std::vector<std::string>& facets) noexcept
 
 } // namespace
 
-std::vector<FacetFactory::FacetBlock> FacetFactory::make(const std::vector<std::string>& names,
-                                                         const std::vector<CallBlock>& blocks,
-                                                         ThreadPool& workers) const
-{
-    if (blocks.empty()) return {};
-    std::vector<FacetBlock> result {};
-    result.reserve(blocks.size());
-    if (blocks.size() > 1 && !workers.empty()) {
-        std::vector<std::future<FacetBlock>> futures {};
-        futures.reserve(blocks.size());
-        const auto fetch_reads = requires_reads(names);
-        const auto fetch_genotypes = requires_genotypes(names);
-        const auto& samples = read_pipe_.source().samples();
-        for (const auto& block : blocks) {
-            // It's faster to fetch reads serially from left to right, so do this outside the thread pool
-            BlockData data {};
-            if (!block.empty()) {
-                data.region = encompassing_region(block);
-                if (fetch_reads) {
-                    data.reads = read_pipe_.fetch_reads(*data.region);
-                }
-            }
-            futures.push_back(workers.push([this, &names, data {std::move(data)}, &block, &samples, fetch_genotypes] () mutable {
-                if (fetch_genotypes) {
-                    data.genotypes = extract_genotypes(block, samples, reference_);
-                }
-                return this->make(names, data);
-            }));
-        }
-        for (auto& fut : futures) {
-            result.push_back(fut.get());
+FacetFactory::BlockData FacetFactory::fetch(const std::vector<std::string>& names, const CallBlock& block) const
+{
+    BlockData result {};
+    if (!block.empty()) {
+        result.region = encompassing_region(block);
+        if (requires_reads(names)) {
+            result.reads = read_pipe_.fetch_reads(*result.region);
         }
-    } else {
-        for (const auto& block : blocks) {
-            const auto data = make_block_data(names, block);
-            result.push_back(make(names, data));
+        if (requires_genotypes(names) && calling_read_support_) {
+            result.calling_read_support = calling_read_support_->fetch(*result.region);
         }
     }
     return result;
 }
 
+FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& names, const CallBlock& block, BlockData data) const
+{
+    if (names.empty()) return {};
+    if (!block.empty() && requires_genotypes(names)) {
+        data.genotypes = extract_genotypes(block, read_pipe_.source().samples(), reference_);
+    }
+    return make(names, data);
+}
+
 // private methods
 
 void FacetFactory::setup_facet_makers()
@@ -156,7 +140,11 @@ void FacetFactory::setup_facet_makers()
     facet_makers_[name<ReadAssignments>()] = [this] (const BlockData& block) -> FacetWrapper
     {
         assert(block.reads && block.genotypes);
-        return {std::make_unique<ReadAssignments>(reference_, *block.genotypes, *block.reads)};
+        if (block.calling_read_support) {
+            return {std::make_unique<ReadAssignments>(reference_, *block.genotypes, *block.reads, *block.calling_read_support)};
+        } else {
+            return {std::make_unique<ReadAssignments>(reference_, *block.genotypes, *block.reads)};
+        }
     };
     facet_makers_[name<ReferenceContext>()] = [this] (const BlockData& block) -> FacetWrapper
     {
@@ -192,21 +180,5 @@ FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& name
     return result;
 }
 
-FacetFactory::BlockData FacetFactory::make_block_data(const std::vector<std::string>& names, const CallBlock& block) const
-{
-    BlockData result {};
-    assert(!names.empty());
-    if (!block.empty()) {
-        result.region = encompassing_region(block);
-        if (requires_reads(names)) {
-            result.reads = read_pipe_.fetch_reads(*result.region);
-        }
-        if (requires_genotypes(names)) {
-            result.genotypes = extract_genotypes(block, read_pipe_.source().samples(), reference_);
-        }
-    }
-    return result;
-}
-
 } // namespace csr
 } // namespace octopus
@@ -8,6 +8,7 @@
 #include <vector>
 #include <functional>
 #include <unordered_map>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -16,7 +17,7 @@
 #include "io/reference/reference_genome.hpp"
 #include "readpipe/buffered_read_pipe.hpp"
 #include "utils/genotype_reader.hpp"
-#include "utils/thread_pool.hpp"
+#include "core/tools/read_support_sidecar.hpp"
 #include "facet.hpp"
 
 namespace octopus { namespace csr {
@@ -29,7 +30,8 @@ public:
     
     FacetFactory() = delete;
     
-    FacetFactory(const ReferenceGenome& reference, BufferedReadPipe read_pipe);
+    FacetFactory(const ReferenceGenome& reference, BufferedReadPipe read_pipe,
+                 std::shared_ptr<const ReadSupportSidecarReader> calling_read_support = nullptr);
     
     FacetFactory(const FacetFactory&)            = delete;
     FacetFactory& operator=(const FacetFactory&) = delete;
@@ -38,28 +40,33 @@ public:
     
     ~FacetFactory() = default;
     
-    FacetWrapper make(const std::string& name, const CallBlock& block) const;
-    FacetBlock make(const std::vector<std::string>& names, const CallBlock& block) const;
-    std::vector<FacetBlock> make(const std::vector<std::string>& names, const std::vector<CallBlock>& blocks,
-                                 ThreadPool& workers) const;
-
-private:
+    // The data a block's facets are made from. Fetching is IO bound and must be done serially
+    // in genomic order, but facets can then be made concurrently from fetched data.
     struct BlockData
     {
         boost::optional<GenomicRegion> region;
         boost::optional<ReadMap> reads;
         boost::optional<GenotypeMap> genotypes;
+        boost::optional<std::vector<ReadSupportRecord>> calling_read_support;
     };
     
+    FacetWrapper make(const std::string& name, const CallBlock& block) const;
+    FacetBlock make(const std::vector<std::string>& names, const CallBlock& block) const;
+    
+    BlockData fetch(const std::vector<std::string>& names, const CallBlock& block) const;
+    FacetBlock make(const std::vector<std::string>& names, const CallBlock& block, BlockData data) const;
+
+private:
+    
     std::reference_wrapper<const ReferenceGenome> reference_;
     BufferedReadPipe read_pipe_;
+    std::shared_ptr<const ReadSupportSidecarReader> calling_read_support_;
     
     std::unordered_map<std::string, std::function<FacetWrapper(const BlockData& data)>> facet_makers_;
     
     void setup_facet_makers();
     FacetWrapper make(const std::string& name, const BlockData& block) const;
     FacetBlock make(const std::vector<std::string>& names, const BlockData& block) const;
-    BlockData make_block_data(const std::vector<std::string>& names, const CallBlock& block) const;
 };
 
 } // namespace csr
@@ -3,6 +3,10 @@
 
 #include "read_assignments.hpp"
 
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
 namespace octopus { namespace csr {
 
 const std::string ReadAssignments::name_ {"ReadAssignments"};
@@ -21,9 +25,83 @@ bool is_homozygous_nonreference(const Genotype<Haplotype>& genotype)
     return genotype.is_homozygous() && !is_reference(genotype[0]);
 }
 
+auto get_assignable_haplotypes(const Genotype<Haplotype>& genotype, const ReferenceGenome& reference)
+{
+    if (!is_homozygous_nonreference(genotype)) return genotype;
+    auto result = genotype;
+    result.emplace(Haplotype {mapped_region(genotype), reference});
+    return result;
+}
+
+// Maps each haplotype assigned during calling to the genotype haplotype it is locally equal to, if
+// every genotype haplotype is the image of some calling haplotype.
+boost::optional<std::vector<std::size_t>>
+map_calling_haplotypes(const ReadSupportRecord& record, const ReadSupportRecord::Sample& support,
+                       const Genotype<Haplotype>& assignable, const ReferenceGenome& reference)
+{
+    const auto& region = mapped_region(assignable);
+    if (support.haplotypes.empty() || !contains(record.region, region)) return boost::none;
+    std::vector<std::size_t> result {};
+    result.reserve(support.haplotypes.size());
+    std::vector<bool> mapped(assignable.ploidy(), false);
+    for (const auto& haplotype : make_haplotypes(record.region, support, reference)) {
+        const auto local = copy<Haplotype>(haplotype, region);
+        boost::optional<std::size_t> first_match {};
+        for (unsigned idx {0}; idx < assignable.ploidy(); ++idx) {
+            if (assignable[idx] == local) {
+                if (!first_match) first_match = idx;
+                mapped[idx] = true;
+            }
+        }
+        if (!first_match) return boost::none;
+        result.push_back(*first_match);
+    }
+    if (std::find(std::cbegin(mapped), std::cend(mapped), false) != std::cend(mapped)) return boost::none;
+    return result;
+}
+
+bool reuse_calling_support(const Genotype<Haplotype>& assignable, const std::vector<AlignedRead>& reads,
+                           const SampleName& sample, const std::vector<ReadSupportRecord>& calling_support,
+                           const ReferenceGenome& reference, HaplotypeSupportMap& result)
+{
+    for (const auto& record : calling_support) {
+        const auto support_itr = record.samples.find(sample);
+        if (support_itr == std::cend(record.samples)) continue;
+        const auto& support = support_itr->second;
+        const auto haplotype_map = map_calling_haplotypes(record, support, assignable, reference);
+        if (!haplotype_map) continue;
+        std::vector<AlignedRead> unseen_reads {};
+        for (const auto& read : reads) {
+            const auto assignment = find_read(support, make_read_support_id(read));
+            if (assignment) {
+                if (assignment->haplotype != ReadSupportRecord::unassigned) {
+                    result[assignable[(*haplotype_map)[assignment->haplotype]]].push_back(read);
+                }
+            } else {
+                unseen_reads.push_back(read);
+            }
+        }
+        if (!unseen_reads.empty()) {
+            for (auto& s : compute_haplotype_support(assignable, unseen_reads)) {
+                auto& haplotype_support = result[s.first];
+                haplotype_support.insert(std::end(haplotype_support),
+                                         std::make_move_iterator(std::begin(s.second)),
+                                         std::make_move_iterator(std::end(s.second)));
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
 } // namespace
 
 ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads)
+: ReadAssignments {reference, genotypes, reads, {}}
+{}
+
+ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads,
+                                 const std::vector<ReadSupportRecord>& calling_support)
 : result_ {}
 {
     result_.reserve(genotypes.size());
@@ -38,15 +116,13 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const Genotyp
                 result_[sample][haplotype] = {};
             }
             if (!local_reads.empty()) {
+                const auto assignable = get_assignable_haplotypes(genotype, reference);
+                if (is_homozygous_nonreference(genotype)) {
+                    result_[sample][Haplotype {mapped_region(genotype), reference}] = {};
+                }
                 HaplotypeSupportMap genotype_support {};
-                if (!is_homozygous_nonreference(genotype)) {
-                    genotype_support = compute_haplotype_support(genotype, local_reads);
-                } else {
-                    auto augmented_genotype = genotype;
-                    Haplotype ref {mapped_region(genotype), reference};
-                    result_[sample][ref] = {};
-                    augmented_genotype.emplace(std::move(ref));
-                    genotype_support = compute_haplotype_support(augmented_genotype, local_reads);
+                if (!reuse_calling_support(assignable, local_reads, sample, calling_support, reference, genotype_support)) {
+                    genotype_support = compute_haplotype_support(assignable, local_reads);
                 }
                 for (auto& s : genotype_support) {
                     result_[sample][s.first] = std::move(s.second);
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <string>
 #include <functional>
+#include <vector>
 
 #include <boost/optional.hpp>
 
@@ -15,6 +16,7 @@
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
 #include "core/tools/read_assigner.hpp"
+#include "core/tools/read_support_sidecar.hpp"
 #include "io/reference/reference_genome.hpp"
 
 namespace octopus { namespace csr {
@@ -30,6 +32,11 @@ public:
     
     ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads);
     
+    // Reuses read assignments made during calling where they are consistent with the genotypes,
+    // only computing support for reads that were not seen during calling.
+    ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads,
+                    const std::vector<ReadSupportRecord>& calling_support);
+    
 private:
     static const std::string name_;
     
@@ -17,18 +17,27 @@ DoublePassVariantCallFilter::DoublePassVariantCallFilter(FacetFactory facet_fact
                                                          std::vector<MeasureWrapper> measures,
                                                          OutputOptions output_config,
                                                          ConcurrencyPolicy threading,
+                                                         boost::optional<Path> temp_directory,
                                                          boost::optional<ProgressMeter&> progress)
 : VariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading}
+, temp_directory_ {std::move(temp_directory)}
 , info_log_ {logging::InfoLogger {}}
 , progress_ {progress}
 , current_contig_ {}
+, measure_store_ {}
 {}
 
 void DoublePassVariantCallFilter::filter(const VcfReader& source, VcfWriter& dest, const SampleList& samples) const
 {
     assert(dest.is_header_written());
     make_registration_pass(source, samples);
-    prepare_for_classification(info_log_);
+    if (measure_store_) {
+        measure_store_->finalise();
+        prepare_for_classification(*measure_store_, info_log_);
+    } else {
+        prepare_for_classification(MeasureStore {0}, info_log_);
+    }
+    measure_store_.reset(); // release the spill file before the filter pass
     make_filter_pass(source, dest);
 }
 
@@ -41,39 +50,66 @@ void DoublePassVariantCallFilter::make_registration_pass(const VcfReader& source
 {
     if (info_log_) log_registration_pass_start(*info_log_);
     if (progress_) progress_->start();
-    if (can_measure_single_call()) {
+    measure_store_.reset();
+    if (can_measure_multiple_blocks()) {
+        for (auto p = source.iterate(); p.first != p.second;) {
+            record(read_next_blocks(p.first, p.second, samples));
+        }
+    } else if (can_measure_single_call()) {
         auto p = source.iterate();
-        std::size_t idx {0};
-        std::for_each(std::move(p.first), std::move(p.second), [&] (const VcfRecord& call) { record(call, idx++); });
+        std::for_each(std::move(p.first), std::move(p.second), [&] (const VcfRecord& call) { record(call); });
     } else {
-        std::size_t idx {0};
         for (auto p = source.iterate(); p.first != p.second;) {
-            const auto calls = read_next_block(p.first, p.second, samples);
-            record(calls, idx);
-            idx += calls.size();
+            record(read_next_block(p.first, p.second, samples));
         }
     }
     if (progress_) progress_->stop();
 }
 
-void DoublePassVariantCallFilter::record(const VcfRecord& call, const std::size_t idx) const
+void DoublePassVariantCallFilter::record(const MeasureVector& measures) const
+{
+    if (!measure_store_) {
+        if (temp_directory_) {
+            measure_store_ = std::make_unique<MeasureStore>(measures.size(), *temp_directory_);
+        } else {
+            measure_store_ = std::make_unique<MeasureStore>(measures.size());
+        }
+    }
+    measure_store_->push_back(measures);
+}
+
+void DoublePassVariantCallFilter::record(const VcfRecord& call) const
 {
-    record(idx, measure(call));
+    record(measure(call));
     log_progress(mapped_region(call));
 }
 
-void DoublePassVariantCallFilter::record(const std::vector<VcfRecord>& calls, std::size_t first_idx) const
+void DoublePassVariantCallFilter::record(const std::vector<VcfRecord>& calls) const
 {
     if (!calls.empty()) {
         const auto measures = measure(calls);
         assert(measures.size() == calls.size());
         for (const auto& m : measures) {
-            record(first_idx++, m);
+            record(m);
         }
         log_progress(encompassing_region(calls));
     }
 }
 
+void DoublePassVariantCallFilter::record(const std::vector<CallBlock>& blocks) const
+{
+    const auto measures = measure(blocks);
+    assert(measures.size() == blocks.size());
+    for (const auto& block_measures : measures) {
+        for (const auto& m : block_measures) {
+            record(m);
+        }
+    }
+    for (const auto& block : blocks) {
+        if (!block.empty()) log_progress(encompassing_region(block));
+    }
+}
+
 void DoublePassVariantCallFilter::log_filter_pass_start(Log& log) const
 {
     log << "CSR: Starting filtering pass";
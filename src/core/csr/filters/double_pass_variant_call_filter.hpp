@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <cstddef>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -13,18 +14,25 @@
 #include "basics/genomic_region.hpp"
 #include "logging/logging.hpp"
 #include "variant_call_filter.hpp"
+#include "measure_store.hpp"
 
 namespace octopus { namespace csr {
 
+// The registration pass measures every call and caches the measures in a MeasureStore, which
+// spills to disk, so the filter pass only needs to stream the calls and classify them from the store.
+// The spill file is written to the run's temporary directory, if there is one.
 class DoublePassVariantCallFilter : public VariantCallFilter
 {
 public:
+    using Path = MeasureStore::Path;
+    
     DoublePassVariantCallFilter() = delete;
     
     DoublePassVariantCallFilter(FacetFactory facet_factory,
                                 std::vector<MeasureWrapper> measures,
                                 OutputOptions output_config,
                                 ConcurrencyPolicy threading,
+                                boost::optional<Path> temp_directory,
                                 boost::optional<ProgressMeter&> progress);
     
     DoublePassVariantCallFilter(const DoublePassVariantCallFilter&)            = delete;
@@ -38,21 +46,24 @@ protected:
     using Log = logging::InfoLogger;
     
 private:
+    boost::optional<Path> temp_directory_; // for the measure store spill file
     mutable boost::optional<Log> info_log_;
     mutable boost::optional<ProgressMeter&> progress_;
     mutable boost::optional<GenomicRegion::ContigName> current_contig_;
+    mutable std::unique_ptr<MeasureStore> measure_store_;
     
     virtual void log_registration_pass_start(Log& log) const;
-    virtual void record(std::size_t call_idx, MeasureVector measures) const = 0;
-    virtual void prepare_for_classification(boost::optional<Log>& log) const = 0;
+    virtual void prepare_for_classification(const MeasureStore& measures, boost::optional<Log>& log) const = 0;
     virtual void log_filter_pass_start(Log& log) const;
     virtual Classification classify(std::size_t call_idx) const = 0;
     
     void filter(const VcfReader& source, VcfWriter& dest, const SampleList& samples) const override;
     
     void make_registration_pass(const VcfReader& source, const SampleList& samples) const;
-    void record(const VcfRecord& call, std::size_t idx) const;
-    void record(const std::vector<VcfRecord>& calls, std::size_t first_idx) const;
+    void record(const MeasureVector& measures) const;
+    void record(const VcfRecord& call) const;
+    void record(const std::vector<VcfRecord>& calls) const;
+    void record(const std::vector<CallBlock>& blocks) const;
     void make_filter_pass(const VcfReader& source, VcfWriter& dest) const;
     void filter(const VcfRecord& call, std::size_t idx, VcfWriter& dest) const;
     void log_progress(const GenomicRegion& region) const;
@@ -0,0 +1,228 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "measure_store.hpp"
+
+#include <limits>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/filesystem/operations.hpp>
+
+namespace octopus { namespace csr {
+
+namespace {
+
+constexpr double missing_value {std::numeric_limits<double>::quiet_NaN()};
+
+struct MeasureToDoubleVisitor : public boost::static_visitor<double>
+{
+    double operator()(double value) const noexcept { return value; }
+    double operator()(std::size_t value) const noexcept { return static_cast<double>(value); }
+    double operator()(bool value) const noexcept { return value ? 1.0 : 0.0; }
+    double operator()(const boost::any&) const noexcept { return missing_value; }
+    template <typename T>
+    double operator()(const boost::optional<T>& value) const noexcept
+    {
+        return value ? (*this)(*value) : missing_value;
+    }
+};
+
+double to_double(const Measure::ResultType& value) noexcept
+{
+    return boost::apply_visitor(MeasureToDoubleVisitor {}, value);
+}
+
+using ValueType = MeasureStore::ValueType;
+
+struct ValueTypeVisitor : public boost::static_visitor<ValueType>
+{
+    ValueType operator()(double) const noexcept { return ValueType::real; }
+    ValueType operator()(const boost::optional<double>&) const noexcept { return ValueType::optional_real; }
+    ValueType operator()(std::size_t) const noexcept { return ValueType::count; }
+    ValueType operator()(const boost::optional<std::size_t>&) const noexcept { return ValueType::optional_count; }
+    ValueType operator()(bool) const noexcept { return ValueType::boolean; }
+    ValueType operator()(const boost::any&) const noexcept { return ValueType::unknown; }
+};
+
+ValueType get_value_type(const Measure::ResultType& value) noexcept
+{
+    return boost::apply_visitor(ValueTypeVisitor {}, value);
+}
+
+Measure::ResultType from_double(const double value, const ValueType type)
+{
+    const bool missing {std::isnan(value)};
+    switch (type) {
+        case ValueType::real: return value;
+        case ValueType::optional_real: return missing ? boost::optional<double> {} : boost::optional<double> {value};
+        case ValueType::count: return static_cast<std::size_t>(value);
+        case ValueType::optional_count: return missing ? boost::optional<std::size_t> {} : boost::optional<std::size_t> {static_cast<std::size_t>(value)};
+        case ValueType::boolean: return value != 0.0;
+        default: return boost::optional<double> {};
+    }
+}
+
+auto make_spill_file_path(const boost::filesystem::path& directory)
+{
+    namespace fs = boost::filesystem;
+    return directory / fs::unique_path("octopus-measures-%%%%-%%%%-%%%%.bin");
+}
+
+} // namespace
+
+MeasureStore::MeasureStore(const std::size_t num_measures, const std::size_t chunk_size)
+: MeasureStore {num_measures, boost::filesystem::temp_directory_path(), chunk_size}
+{}
+
+MeasureStore::MeasureStore(const std::size_t num_measures, const Path& spill_directory, const std::size_t chunk_size)
+: num_measures_ {num_measures}
+, chunk_size_ {std::max(chunk_size, std::size_t {1})}
+, size_ {0}
+, spill_file_ {make_spill_file_path(spill_directory)}
+, spill_ {}
+, buffer_ {}
+, types_(num_measures, ValueType::unknown)
+, mapped_ {}
+, data_ {nullptr}
+, finalised_ {false}
+{
+    buffer_.reserve(num_measures_ * chunk_size_);
+}
+
+MeasureStore::~MeasureStore()
+{
+    remove_spill_file();
+}
+
+std::size_t MeasureStore::num_measures() const noexcept
+{
+    return num_measures_;
+}
+
+std::size_t MeasureStore::size() const noexcept
+{
+    return size_;
+}
+
+bool MeasureStore::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+void MeasureStore::push_back(const MeasureVector& measures)
+{
+    if (measures.size() != num_measures_) {
+        throw std::invalid_argument {"MeasureStore: measure vector has wrong size"};
+    }
+    if (finalised_) {
+        throw std::logic_error {"MeasureStore: cannot add measures after finalise"};
+    }
+    if (num_measures_ == 0) {
+        ++size_;
+        return;
+    }
+    if (buffer_.empty()) {
+        buffer_.assign(num_measures_ * chunk_size_, missing_value);
+    }
+    const auto chunk_row = size_ % chunk_size_;
+    for (std::size_t measure {0}; measure < num_measures_; ++measure) {
+        const auto& value = measures[measure];
+        if (types_[measure] == ValueType::unknown && !csr::is_missing(value)) {
+            types_[measure] = get_value_type(value);
+        }
+        buffer_[measure * chunk_size_ + chunk_row] = to_double(value);
+    }
+    ++size_;
+    if (size_ % chunk_size_ == 0) spill();
+}
+
+void MeasureStore::finalise()
+{
+    if (finalised_) return;
+    finalised_ = true;
+    // Nothing was spilled, and empty files cannot be mapped
+    if (size_ == 0 || num_measures_ == 0) return;
+    if (!buffer_.empty()) spill();
+    spill_.close();
+    mapped_.open(spill_file_.string());
+    if (!mapped_.is_open()) {
+        throw std::runtime_error {"MeasureStore: could not map " + spill_file_.string()};
+    }
+    data_ = reinterpret_cast<const double*>(mapped_.data());
+}
+
+double MeasureStore::value(const std::size_t row, const std::size_t measure) const
+{
+    if (!finalised_) {
+        throw std::logic_error {"MeasureStore: cannot read measures before finalise"};
+    }
+    if (!data_) {
+        throw std::out_of_range {"MeasureStore: no measures stored"};
+    }
+    const auto chunk = row / chunk_size_;
+    return data_[(chunk * num_measures_ + measure) * chunk_size_ + row % chunk_size_];
+}
+
+bool MeasureStore::is_missing(const std::size_t row, const std::size_t measure) const
+{
+    return std::isnan(value(row, measure));
+}
+
+Measure::ResultType MeasureStore::get(const std::size_t row, const std::size_t measure) const
+{
+    return from_double(value(row, measure), types_[measure]);
+}
+
+MeasureStore::MeasureVector MeasureStore::get(const std::size_t row) const
+{
+    MeasureVector result {};
+    result.reserve(num_measures_);
+    for (std::size_t measure {0}; measure < num_measures_; ++measure) {
+        result.push_back(get(row, measure));
+    }
+    return result;
+}
+
+void MeasureStore::clear()
+{
+    remove_spill_file();
+    finalised_ = false;
+    size_ = 0;
+    buffer_.clear();
+    std::fill(std::begin(types_), std::end(types_), ValueType::unknown);
+}
+
+// private methods
+
+void MeasureStore::spill()
+{
+    if (!spill_.is_open()) {
+        spill_.open(spill_file_.string(), std::ios::binary | std::ios::trunc);
+        if (!spill_) {
+            throw std::runtime_error {"MeasureStore: could not open " + spill_file_.string()};
+        }
+    }
+    // Partial chunks are padded with missing values so every chunk has the same layout
+    spill_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size() * sizeof(double));
+    if (!spill_) {
+        throw std::runtime_error {"MeasureStore: failed writing to " + spill_file_.string()};
+    }
+    buffer_.clear();
+}
+
+void MeasureStore::remove_spill_file() noexcept
+{
+    data_ = nullptr;
+    try {
+        if (mapped_.is_open()) mapped_.close();
+        if (spill_.is_open()) spill_.close();
+        boost::system::error_code ec {};
+        boost::filesystem::remove(spill_file_, ec);
+    } catch (...) {}
+}
+
+} // namespace csr
+} // namespace octopus
@@ -0,0 +1,79 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef measure_store_hpp
+#define measure_store_hpp
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "../measures/measure.hpp"
+
+namespace octopus { namespace csr {
+
+// Stores one row of measures per call. Rows are buffered in memory and spilled to disk in fixed
+// size chunks, with each column stored contiguously within a chunk. Once all rows have been added
+// the spill file is memory mapped for reading, so memory use does not grow with the number of calls.
+// Values are stored as doubles with NaN for missing values. Opaque (boost::any) values are not
+// stored and are read back as missing. Stores without any measures only count rows.
+class MeasureStore
+{
+public:
+    using MeasureVector = std::vector<Measure::ResultType>;
+    using Path = boost::filesystem::path;
+    
+    // The Measure::ResultType alternative a measure was recorded as, so it can be read back as one
+    enum class ValueType : std::int8_t { unknown = -1, real, optional_real, count, optional_count, boolean };
+    
+    MeasureStore() = delete;
+    
+    // The spill file is created in the system temporary directory unless another is given
+    MeasureStore(std::size_t num_measures, std::size_t chunk_size = 65'536);
+    MeasureStore(std::size_t num_measures, const Path& spill_directory, std::size_t chunk_size = 65'536);
+    
+    MeasureStore(const MeasureStore&)            = delete;
+    MeasureStore& operator=(const MeasureStore&) = delete;
+    MeasureStore(MeasureStore&&)                 = delete;
+    MeasureStore& operator=(MeasureStore&&)      = delete;
+    
+    ~MeasureStore();
+    
+    std::size_t num_measures() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    
+    void push_back(const MeasureVector& measures);
+    
+    // Must be called after the last row is added and before any reads
+    void finalise();
+    
+    double value(std::size_t row, std::size_t measure) const;
+    bool is_missing(std::size_t row, std::size_t measure) const;
+    Measure::ResultType get(std::size_t row, std::size_t measure) const;
+    MeasureVector get(std::size_t row) const;
+    
+    void clear();
+
+private:
+    std::size_t num_measures_, chunk_size_, size_;
+    Path spill_file_;
+    std::ofstream spill_;
+    std::vector<double> buffer_;
+    std::vector<ValueType> types_;
+    boost::iostreams::mapped_file_source mapped_;
+    const double* data_;
+    bool finalised_;
+    
+    void spill();
+    void remove_spill_file() noexcept;
+};
+
+} // namespace csr
+} // namespace octopus
+
+#endif
@@ -150,7 +150,8 @@ std::unique_ptr<VariantCallFilterFactory> ThresholdFilterFactory::do_clone() con
 std::unique_ptr<VariantCallFilter> ThresholdFilterFactory::do_make(FacetFactory facet_factory,
                                                                    VariantCallFilter::OutputOptions output_config,
                                                                    boost::optional<ProgressMeter&> progress,
-                                                                   VariantCallFilter::ConcurrencyPolicy threading) const
+                                                                   VariantCallFilter::ConcurrencyPolicy threading,
+                                                                   boost::optional<boost::filesystem::path> temp_directory) const
 {
     return std::make_unique<ThresholdVariantCallFilter>(std::move(facet_factory), hard_conditions_, soft_conditions_,
                                                         output_config, threading, progress);
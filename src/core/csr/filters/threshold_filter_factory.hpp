@@ -43,7 +43,8 @@ private:
     std::unique_ptr<VariantCallFilter> do_make(FacetFactory facet_factory,
                                                VariantCallFilter::OutputOptions output_config,
                                                boost::optional<ProgressMeter&> progress,
-                                               VariantCallFilter::ConcurrencyPolicy threading) const override;
+                                               VariantCallFilter::ConcurrencyPolicy threading,
+                                               boost::optional<boost::filesystem::path> temp_directory) const override;
 };
 
 } // namespace csr
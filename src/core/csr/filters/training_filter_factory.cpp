@@ -35,7 +35,8 @@ std::unique_ptr<VariantCallFilterFactory> TrainingFilterFactory::do_clone() cons
 std::unique_ptr<VariantCallFilter> TrainingFilterFactory::do_make(FacetFactory facet_factory,
                                                                   VariantCallFilter::OutputOptions output_config,
                                                                   boost::optional<ProgressMeter&> progress,
-                                                                  VariantCallFilter::ConcurrencyPolicy threading) const
+                                                                  VariantCallFilter::ConcurrencyPolicy threading,
+                                                                  boost::optional<boost::filesystem::path> temp_directory) const
 {
     output_config.annotate_measures = true;
     output_config.clear_info = true;
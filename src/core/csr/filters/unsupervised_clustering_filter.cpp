@@ -6,7 +6,6 @@
 #include <utility>
 #include <iterator>
 #include <algorithm>
-#include <numeric>
 
 namespace octopus { namespace csr {
 
@@ -14,8 +13,10 @@ UnsupervisedClusteringFilter::UnsupervisedClusteringFilter(FacetFactory facet_fa
                                                            std::vector<MeasureWrapper> measures,
                                                            OutputOptions output_config,
                                                            ConcurrencyPolicy threading,
+                                                           boost::optional<Path> temp_directory,
                                                            boost::optional<ProgressMeter&> progress)
-: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading, progress}
+: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading,
+                               std::move(temp_directory), progress}
 {}
 
 void UnsupervisedClusteringFilter::annotate(VcfHeader::Builder& header) const
@@ -23,28 +24,15 @@ void UnsupervisedClusteringFilter::annotate(VcfHeader::Builder& header) const
     // TODO
 }
 
-void UnsupervisedClusteringFilter::record(const std::size_t call_idx, MeasureVector measures) const
-{
-    if (data_.size() == call_idx) {
-        data_.push_back(std::move(measures));
-    } else if (call_idx > data_.size()) {
-        data_.resize(call_idx + 1);
-        data_.back() = std::move(measures);
-    } else {
-        data_[call_idx] = std::move(measures);
-    }
-}
-
-void UnsupervisedClusteringFilter::prepare_for_classification(boost::optional<Log>& log) const
+void UnsupervisedClusteringFilter::prepare_for_classification(const MeasureStore& measures, boost::optional<Log>& log) const
 {
+    const auto features = get_nonmissing_features(measures);
     if (log) {
-        stream(*log) << "CSR: clustering " << data_.size() << " records";
+        stream(*log) << "CSR: clustering " << measures.size() << " records on " << features.size()
+                     << " of " << measures.num_measures() << " measures";
     }
-    remove_missing_features();
-    const auto num_calls = data_.size();
+    const auto num_calls = measures.size();
     // TODO
-    data_.clear();
-    data_.shrink_to_fit();
     classifications_.resize(num_calls);
 }
 
@@ -53,43 +41,20 @@ VariantCallFilter::Classification UnsupervisedClusteringFilter::classify(std::si
     return classifications_[call_idx];
 }
 
-bool UnsupervisedClusteringFilter::all_missing(const MeasureVector& measures) const noexcept
+std::vector<std::size_t> UnsupervisedClusteringFilter::get_nonmissing_features(const MeasureStore& measures) const
 {
-    return std::all_of(std::cbegin(measures), std::cend(measures),
-                       [] (const auto& measure) noexcept { return is_missing(measure); });
-}
-
-void UnsupervisedClusteringFilter::remove_missing_features() const
-{
-    if (!data_.empty()) {
-        const auto num_dimensions = data_.front().size();
-        std::vector<std::size_t> missing_columns(num_dimensions);
-        std::iota(std::begin(missing_columns), std::end(missing_columns), 0);
-        for (const auto& point : data_) {
-            for (auto itr = std::cbegin(missing_columns); itr != std::cend(missing_columns);) {
-                assert(*itr < point.size());
-                if (is_missing(point[*itr])) {
-                    ++itr;
-                } else {
-                    itr = missing_columns.erase(itr);
-                }
-            }
-            if (missing_columns.empty()) break;
-        }
-        if (!missing_columns.empty()) {
-            if (missing_columns.size() != num_dimensions) {
-                assert(std::is_sorted(std::cbegin(missing_columns), std::cend(missing_columns)));
-                for (auto& point : data_) {
-                    std::for_each(std::crbegin(missing_columns), std::crend(missing_columns),
-                                  [&point] (auto idx) { point.erase(std::next(std::cbegin(point), idx)); });
-        
-                }
-            } else {
-                data_.clear();
-                data_.shrink_to_fit();
+    // Measures are stored column-wise so scanning one feature at a time is cache friendly
+    std::vector<std::size_t> result {};
+    result.reserve(measures.num_measures());
+    for (std::size_t feature {0}; feature < measures.num_measures(); ++feature) {
+        for (std::size_t call_idx {0}; call_idx < measures.size(); ++call_idx) {
+            if (!measures.is_missing(call_idx, feature)) {
+                result.push_back(feature);
+                break;
             }
         }
     }
+    return result;
 }
 
 } // namespace csr
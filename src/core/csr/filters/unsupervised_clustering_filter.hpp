@@ -5,7 +5,6 @@
 #define unsupervised_clustering_filter_hpp
 
 #include <vector>
-#include <deque>
 #include <cstddef>
 
 #include <boost/optional.hpp>
@@ -23,6 +22,7 @@ public:
                                  std::vector<MeasureWrapper> measures,
                                  OutputOptions output_config,
                                  ConcurrencyPolicy threading,
+                                 boost::optional<Path> temp_directory = boost::none,
                                  boost::optional<ProgressMeter&> progress = boost::none);
     
     UnsupervisedClusteringFilter(const UnsupervisedClusteringFilter&)            = delete;
@@ -33,16 +33,13 @@ public:
     virtual ~UnsupervisedClusteringFilter() override = default;
     
 private:
-    mutable std::deque<MeasureVector> data_;
     mutable std::vector<Classification> classifications_;
     
     void annotate(VcfHeader::Builder& header) const override;
-    void record(std::size_t call_idx, MeasureVector measures) const override;
-    void prepare_for_classification(boost::optional<Log>& log) const override;
+    void prepare_for_classification(const MeasureStore& measures, boost::optional<Log>& log) const override;
     Classification classify(std::size_t call_idx) const override;
     
-    bool all_missing(const MeasureVector& measures) const noexcept;
-    void remove_missing_features() const;
+    std::vector<std::size_t> get_nonmissing_features(const MeasureStore& measures) const;
 };
 
 } // namespace csr
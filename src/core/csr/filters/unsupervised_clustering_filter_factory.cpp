@@ -30,9 +30,11 @@ std::unique_ptr<VariantCallFilterFactory> UnsupervisedClusteringFilterFactory::d
 std::unique_ptr<VariantCallFilter> UnsupervisedClusteringFilterFactory::do_make(FacetFactory facet_factory,
                                                                                 VariantCallFilter::OutputOptions output_config,
                                                                                 boost::optional<ProgressMeter&> progress,
-                                                                                VariantCallFilter::ConcurrencyPolicy threading) const
+                                                                                VariantCallFilter::ConcurrencyPolicy threading,
+                                                                                boost::optional<boost::filesystem::path> temp_directory) const
 {
-    return std::make_unique<UnsupervisedClusteringFilter>(std::move(facet_factory), measures_, output_config, threading, progress);
+    return std::make_unique<UnsupervisedClusteringFilter>(std::move(facet_factory), measures_, output_config, threading,
+                                                          std::move(temp_directory), progress);
 }
 
 } // namespace csr
@@ -24,8 +24,8 @@
 #include "utils/string_utils.hpp"
 #include "utils/genotype_reader.hpp"
 #include "utils/append.hpp"
-#include "utils/parallel_transform.hpp"
 #include "io/variant/vcf_writer.hpp"
+#include "logging/profiler.hpp"
 
 namespace octopus { namespace csr {
 
@@ -179,14 +179,24 @@ std::vector<VariantCallFilter::MeasureBlock> VariantCallFilter::measure(const st
     std::vector<MeasureBlock> result {};
     result.reserve(blocks.size());
     if (is_multithreaded()) {
-        const auto facets = compute_facets(blocks);
         if (debug_log_) {
             stream(*debug_log_) << "Measuring " << blocks.size() << " blocks with " << workers_.size() << " threads";
         }
-        transform(std::cbegin(blocks), std::cend(blocks), std::cbegin(facets), std::back_inserter(result),
-                  [this] (const auto& block, const auto& block_facets) {
-                      return this->measure(block, block_facets);
-                  }, workers_);
+        // Block data is fetched serially as reads are fastest to fetch from left to right, but each block
+        // is handed to the workers as soon as it is fetched, so fetching the next block overlaps with
+        // computing the facets and measures of previous blocks.
+        std::vector<std::future<MeasureBlock>> futures {};
+        futures.reserve(blocks.size());
+        for (const auto& block : blocks) {
+            auto data = facet_factory_.fetch(facet_names_, block);
+            futures.push_back(workers_.push([this, &block, data {std::move(data)}] () mutable {
+                const auto facets = this->compute_facets(block, std::move(data));
+                return this->measure(block, facets);
+            }));
+        }
+        for (auto& fut : futures) {
+            result.push_back(fut.get());
+        }
     } else {
         for (const CallBlock& block : blocks) {
             result.push_back(measure(block));
@@ -275,18 +285,14 @@ auto make_map(const std::vector<std::string>& names, std::vector<FacetWrapper>&&
 
 Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block) const
 {
+    profiling::ScopedTimer timer {profiling::Stage::csr_facets};
     return make_map(facet_names_, facet_factory_.make(facet_names_, block));
 }
 
-std::vector<Measure::FacetMap> VariantCallFilter::compute_facets(const std::vector<CallBlock>& blocks) const
+Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block, FacetFactory::BlockData data) const
 {
-    auto facets = facet_factory_.make(facet_names_, blocks, workers_);
-    std::vector<Measure::FacetMap> result {};
-    result.reserve(blocks.size());
-    for (auto& block : facets) {
-        result.push_back(make_map(facet_names_, std::move(block)));
-    }
-    return result;
+    profiling::ScopedTimer timer {profiling::Stage::csr_facets};
+    return make_map(facet_names_, facet_factory_.make(facet_names_, block, std::move(data)));
 }
 
 VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& block, const Measure::FacetMap& facets) const
@@ -294,6 +300,7 @@ VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& bloc
     if (debug_log_ && !block.empty()) {
         stream(*debug_log_) << "Measuring block " << encompassing_region(block) << " containing " << block.size() << " calls";
     }
+    profiling::ScopedTimer timer {profiling::Stage::csr_measures};
     MeasureBlock result(block.size());
     std::transform(std::cbegin(block), std::cend(block), std::begin(result),
                    [&] (const auto& call) { return measure(call, facets); });
@@ -106,7 +106,7 @@ private:
     
     VcfHeader make_header(const VcfReader& source) const;
     Measure::FacetMap compute_facets(const CallBlock& block) const;
-    std::vector<Measure::FacetMap> compute_facets(const std::vector<CallBlock>& blocks) const;
+    Measure::FacetMap compute_facets(const CallBlock& block, FacetFactory::BlockData data) const;
     MeasureBlock measure(const CallBlock& block, const Measure::FacetMap& facets) const;
     MeasureVector measure(const VcfRecord& call, const Measure::FacetMap& facets) const;
     VcfRecord::Builder construct_template(const VcfRecord& call) const;
@@ -18,10 +18,12 @@ std::unique_ptr<VariantCallFilter> VariantCallFilterFactory::make(const Referenc
                                                                   BufferedReadPipe read_pipe,
                                                                   VariantCallFilter::OutputOptions output_config,
                                                                   boost::optional<ProgressMeter&> progress,
-                                                                  boost::optional<unsigned> max_threads) const
+                                                                  boost::optional<unsigned> max_threads,
+                                                                  std::shared_ptr<const ReadSupportSidecarReader> calling_read_support,
+                                                                  boost::optional<boost::filesystem::path> temp_directory) const
 {
-    FacetFactory facet_factory {reference, std::move(read_pipe)};
-    return do_make(std::move(facet_factory), output_config, progress, {max_threads});
+    FacetFactory facet_factory {reference, std::move(read_pipe), std::move(calling_read_support)};
+    return do_make(std::move(facet_factory), output_config, progress, {max_threads}, std::move(temp_directory));
 }
 
 } // namespace csr
@@ -8,6 +8,7 @@
 #include <utility>
 
 #include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
 
 #include "logging/progress_meter.hpp"
 #include "variant_call_filter.hpp"
@@ -16,6 +17,7 @@ namespace octopus {
 
 class ReferenceGenome;
 class BufferedReadPipe;
+class ReadSupportSidecarReader;
 
 namespace csr {
 
@@ -32,14 +34,17 @@ public:
                                             BufferedReadPipe read_pipe,
                                             VariantCallFilter::OutputOptions output_config,
                                             boost::optional<ProgressMeter&> progress = boost::none,
-                                            boost::optional<unsigned> max_threads = 1) const;
+                                            boost::optional<unsigned> max_threads = 1,
+                                            std::shared_ptr<const ReadSupportSidecarReader> calling_read_support = nullptr,
+                                            boost::optional<boost::filesystem::path> temp_directory = boost::none) const;
     
 private:
     virtual std::unique_ptr<VariantCallFilterFactory> do_clone() const = 0;
     virtual std::unique_ptr<VariantCallFilter> do_make(FacetFactory facet_factory,
                                                        VariantCallFilter::OutputOptions output_config,
                                                        boost::optional<ProgressMeter&> progress,
-                                                       VariantCallFilter::ConcurrencyPolicy threading) const = 0;
+                                                       VariantCallFilter::ConcurrencyPolicy threading,
+                                                       boost::optional<boost::filesystem::path> temp_directory) const = 0;
 };
 
 } // namespace csr
@@ -3,6 +3,8 @@
 
 #include "error_model_factory.hpp"
 
+#include <utility>
+
 #include "hiseq_snv_error_model.hpp"
 #include "x10_snv_error_model.hpp"
 #include "hiseq_indel_error_model.hpp"
@@ -26,19 +28,31 @@ bool is_xten(const std::string& sequencer) noexcept
 }
 
 std::unique_ptr<SnvErrorModel> make_snv_error_model(const std::string& sequencer)
+{
+    return make_snv_error_model(sequencer, nullptr);
+}
+
+std::unique_ptr<IndelErrorModel> make_indel_error_model(const std::string& sequencer)
+{
+    return make_indel_error_model(sequencer, nullptr);
+}
+
+std::unique_ptr<SnvErrorModel> make_snv_error_model(const std::string& sequencer,
+                                                    std::shared_ptr<const RepeatIndex> repeat_index)
 {
     if (is_xten(sequencer)) {
-        return std::make_unique<X10SnvErrorModel>();
+        return std::make_unique<X10SnvErrorModel>(std::move(repeat_index));
     }
-    return std::make_unique<HiSeqSnvErrorModel>();
+    return std::make_unique<HiSeqSnvErrorModel>(std::move(repeat_index));
 }
 
-std::unique_ptr<IndelErrorModel> make_indel_error_model(const std::string& sequencer)
+std::unique_ptr<IndelErrorModel> make_indel_error_model(const std::string& sequencer,
+                                                        std::shared_ptr<const RepeatIndex> repeat_index)
 {
     if (is_xten(sequencer)) {
-        return std::make_unique<X10IndelErrorModel>();
+        return std::make_unique<X10IndelErrorModel>(std::move(repeat_index));
     }
-    return std::make_unique<HiSeqIndelErrorModel>();
+    return std::make_unique<HiSeqIndelErrorModel>(std::move(repeat_index));
 }
     
 } // namespace octopus
@@ -12,10 +12,16 @@
 
 namespace octopus {
 
+class RepeatIndex;
+
 std::unique_ptr<SnvErrorModel> make_snv_error_model();
 std::unique_ptr<IndelErrorModel> make_indel_error_model();
 std::unique_ptr<SnvErrorModel> make_snv_error_model(const std::string& sequencer);
 std::unique_ptr<IndelErrorModel> make_indel_error_model(const std::string& sequencer);
+std::unique_ptr<SnvErrorModel> make_snv_error_model(const std::string& sequencer,
+                                                    std::shared_ptr<const RepeatIndex> repeat_index);
+std::unique_ptr<IndelErrorModel> make_indel_error_model(const std::string& sequencer,
+                                                        std::shared_ptr<const RepeatIndex> repeat_index);
 
 } // namespace octopus
 
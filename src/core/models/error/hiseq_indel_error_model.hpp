@@ -4,11 +4,14 @@
 #ifndef hiseq_indel_error_model_hpp
 #define hiseq_indel_error_model_hpp
 
+#include <memory>
+
 #include "indel_error_model.hpp"
 
 namespace octopus {
 
 class Haplotype;
+class RepeatIndex;
 
 class HiSeqIndelErrorModel : public IndelErrorModel
 {
@@ -18,12 +21,16 @@ public:
     
     HiSeqIndelErrorModel() = default;
     
+    HiSeqIndelErrorModel(std::shared_ptr<const RepeatIndex> repeat_index);
+    
     HiSeqIndelErrorModel(const HiSeqIndelErrorModel&)            = default;
     HiSeqIndelErrorModel& operator=(const HiSeqIndelErrorModel&) = default;
     HiSeqIndelErrorModel(HiSeqIndelErrorModel&&)                 = default;
     HiSeqIndelErrorModel& operator=(HiSeqIndelErrorModel&&)      = default;
     
 private:
+    std::shared_ptr<const RepeatIndex> repeat_index_;
+    
     static constexpr std::array<PenaltyType, 50> homopolymerErrors_ =
     {{
      60,60,50,45,41,36,30,25,22,20,19,17,16,15,14,13,12,11,11,10,
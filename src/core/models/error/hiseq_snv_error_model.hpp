@@ -7,12 +7,14 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <memory>
 
 #include "snv_error_model.hpp"
 
 namespace octopus {
 
 class Haplotype;
+class RepeatIndex;
 
 class HiSeqSnvErrorModel : public SnvErrorModel
 {
@@ -23,6 +25,8 @@ public:
     
     HiSeqSnvErrorModel() = default;
     
+    HiSeqSnvErrorModel(std::shared_ptr<const RepeatIndex> repeat_index);
+    
     HiSeqSnvErrorModel(const HiSeqSnvErrorModel&)            = default;
     HiSeqSnvErrorModel& operator=(const HiSeqSnvErrorModel&) = default;
     HiSeqSnvErrorModel(HiSeqSnvErrorModel&&)                 = default;
@@ -31,6 +35,8 @@ public:
     virtual ~HiSeqSnvErrorModel() = default;
 
 private:
+    std::shared_ptr<const RepeatIndex> repeat_index_;
+    
     static constexpr std::array<std::array<PenaltyType, 51>, 3> maxQualities_ =
     {{
      {
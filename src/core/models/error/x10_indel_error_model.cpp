@@ -5,10 +5,12 @@
 
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 #include "tandem/tandem.hpp"
 
 #include "core/types/haplotype.hpp"
+#include "utils/repeat_index.hpp"
 
 namespace octopus {
 
@@ -18,6 +20,10 @@ constexpr decltype(X10IndelErrorModel::homopolymerErrors_) X10IndelErrorModel::t
 constexpr decltype(X10IndelErrorModel::homopolymerErrors_) X10IndelErrorModel::polyNucleotideTandemRepeatErrors_;
 constexpr decltype(X10IndelErrorModel::defaultGapExtension_) X10IndelErrorModel::defaultGapExtension_;
 
+X10IndelErrorModel::X10IndelErrorModel(std::shared_ptr<const RepeatIndex> repeat_index)
+: repeat_index_ {std::move(repeat_index)}
+{}
+
 std::unique_ptr<IndelErrorModel> X10IndelErrorModel::do_clone() const
 {
     return std::make_unique<X10IndelErrorModel>(*this);
@@ -25,8 +31,11 @@ std::unique_ptr<IndelErrorModel> X10IndelErrorModel::do_clone() const
 
 namespace {
 
-auto extract_repeats(const Haplotype& haplotype)
+auto extract_repeats(const Haplotype& haplotype, const RepeatIndex* repeat_index)
 {
+    if (repeat_index) {
+        return find_tandem_repeats(haplotype, *repeat_index, 1, 3);
+    }
     return tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, 3);
 }
 
@@ -54,7 +63,7 @@ X10IndelErrorModel::PenaltyType
 X10IndelErrorModel::do_evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalities) const
 {
     using std::begin; using std::end; using std::cbegin; using std::cend; using std::next;
-    const auto repeats = extract_repeats(haplotype);
+    const auto repeats = extract_repeats(haplotype, repeat_index_.get());
     gap_open_penalities.assign(sequence_size(haplotype), homopolymerErrors_.front());
     tandem::Repeat max_repeat {};
     for (const auto& repeat : repeats) {
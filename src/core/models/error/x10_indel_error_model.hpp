@@ -4,11 +4,14 @@
 #ifndef x10_indel_error_model_hpp
 #define x10_indel_error_model_hpp
 
+#include <memory>
+
 #include "core/models/error/indel_error_model.hpp"
 
 namespace octopus {
 
 class Haplotype;
+class RepeatIndex;
 
 class X10IndelErrorModel : public IndelErrorModel
 {
@@ -18,12 +21,16 @@ public:
     
     X10IndelErrorModel() = default;
     
+    X10IndelErrorModel(std::shared_ptr<const RepeatIndex> repeat_index);
+    
     X10IndelErrorModel(const X10IndelErrorModel&)            = default;
     X10IndelErrorModel& operator=(const X10IndelErrorModel&) = default;
     X10IndelErrorModel(X10IndelErrorModel&&)                 = default;
     X10IndelErrorModel& operator=(X10IndelErrorModel&&)      = default;
 
 private:
+    std::shared_ptr<const RepeatIndex> repeat_index_;
+    
     static constexpr std::array<PenaltyType, 50> homopolymerErrors_ =
     {{
      60,59,48,43,38,32,28,23,20,18,16,15,14,13,12,11,10,10,9,
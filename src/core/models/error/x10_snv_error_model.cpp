@@ -6,15 +6,21 @@
 #include <iterator>
 #include <algorithm>
 #include <numeric>
+#include <utility>
 
 #include <tandem/tandem.hpp>
 
 #include <core/types/haplotype.hpp>
+#include <utils/repeat_index.hpp>
 
 namespace octopus {
 
 constexpr decltype(X10SnvErrorModel::maxQualities_) X10SnvErrorModel::maxQualities_;
 
+X10SnvErrorModel::X10SnvErrorModel(std::shared_ptr<const RepeatIndex> repeat_index)
+: repeat_index_ {std::move(repeat_index)}
+{}
+
 std::unique_ptr<SnvErrorModel> X10SnvErrorModel::do_clone() const
 {
     return std::make_unique<X10SnvErrorModel>(*this);
@@ -22,8 +28,11 @@ std::unique_ptr<SnvErrorModel> X10SnvErrorModel::do_clone() const
 
 namespace {
 
-auto extract_repeats(const Haplotype& haplotype, const unsigned max_period)
+auto extract_repeats(const Haplotype& haplotype, const unsigned max_period, const RepeatIndex* repeat_index)
 {
+    if (repeat_index) {
+        return find_tandem_repeats(haplotype, *repeat_index, 1, max_period);
+    }
     return tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, max_period);
 }
 
@@ -130,7 +139,7 @@ void X10SnvErrorModel::do_evaluate(const Haplotype& haplotype,
     using std::cbegin; using std::cend; using std::crbegin; using std::crend;
     using std::begin; using std::end; using std::rbegin; using std::next;
     constexpr auto Max_period = maxQualities_.size();
-    const auto repeats = extract_repeats(haplotype, Max_period);
+    const auto repeats = extract_repeats(haplotype, Max_period, repeat_index_.get());
     const auto num_bases = sequence_size(haplotype);
     std::array<std::vector<std::int8_t>, Max_period> repeat_masks {};
     repeat_masks.fill(std::vector<std::int8_t>(num_bases, 0));
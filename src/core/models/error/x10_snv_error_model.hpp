@@ -7,12 +7,14 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <memory>
 
 #include "core/models/error/snv_error_model.hpp"
 
 namespace octopus {
 
 class Haplotype;
+class RepeatIndex;
 
 class X10SnvErrorModel : public SnvErrorModel
 {
@@ -23,9 +25,13 @@ public:
     
     X10SnvErrorModel() = default;
     
+    X10SnvErrorModel(std::shared_ptr<const RepeatIndex> repeat_index);
+    
     virtual ~X10SnvErrorModel() = default;
 
 private:
+    std::shared_ptr<const RepeatIndex> repeat_index_;
+    
     static constexpr std::array<std::array<PenaltyType, 51>, 3> maxQualities_ =
     {{
      {
@@ -14,8 +14,6 @@
 #include "population_prior_model.hpp"
 #include "../mutation/coalescent_model.hpp"
 
-#include "timers.hpp"
-
 namespace octopus {
 
 class CoalescentPopulationPriorModel : public PopulationPriorModel
@@ -13,18 +13,25 @@
 #include <cassert>
 
 #include "utils/maths.hpp"
+#include "utils/cpu_dispatch.hpp"
 
 namespace octopus { namespace model {
 
 GermlineLikelihoodModel::GermlineLikelihoodModel(const HaplotypeLikelihoodCache& likelihoods)
 : likelihoods_ {likelihoods}
+, sample_index_ {}
+{}
+
+GermlineLikelihoodModel::GermlineLikelihoodModel(const HaplotypeLikelihoodCache& likelihoods, const SampleName& sample)
+: likelihoods_ {likelihoods}
+, sample_index_ {likelihoods.sample_index(sample)}
 {}
 
 // ln p(read | genotype)  = ln sum {haplotype in genotype} p(read | haplotype) - ln ploidy
 // ln p(reads | genotype) = sum {read in reads} ln p(read | genotype)
 double GermlineLikelihoodModel::evaluate(const Genotype<Haplotype>& genotype) const
 {
-    assert(likelihoods_.is_primed());
+    assert(sample_index_ || likelihoods_.is_primed());
     // These cases are just for optimisation
     switch (genotype.ploidy()) {
         case 0:
@@ -45,6 +52,12 @@ double GermlineLikelihoodModel::evaluate(const Genotype<Haplotype>& genotype) co
 
 // private methods
 
+const HaplotypeLikelihoodCache::LikelihoodVector&
+GermlineLikelihoodModel::get_likelihoods(const Haplotype& haplotype) const
+{
+    return sample_index_ ? likelihoods_(*sample_index_, haplotype) : likelihoods_[haplotype];
+}
+
 namespace {
 
 template <typename T = double>
@@ -65,74 +78,84 @@ static constexpr auto ln(const unsigned n)
     };
     return lnLookup[n];
 }
+
+// sum {i} ln(exp(a_shift + a[i]) + exp(b_shift + b[i])) - norm
+OCTOPUS_DISPATCH_VECTOR
+double sum_log_sum_exp(const double* a, const double* b, const std::size_t n,
+                       const double a_shift, const double b_shift, const double norm) noexcept
+{
+    double result {0};
+    for (std::size_t i {0}; i < n; ++i) {
+        result += maths::log_sum_exp(a_shift + a[i], b_shift + b[i]) - norm;
+    }
+    return result;
+}
+
+// sum {i} ln(exp(a[i]) + exp(b[i]) + exp(c[i])) - norm
+OCTOPUS_DISPATCH_VECTOR
+double sum_log_sum_exp(const double* a, const double* b, const double* c, const std::size_t n,
+                       const double norm) noexcept
+{
+    double result {0};
+    for (std::size_t i {0}; i < n; ++i) {
+        result += maths::log_sum_exp(a[i], b[i], c[i]) - norm;
+    }
+    return result;
+}
     
 } // namespace
 
 double GermlineLikelihoodModel::evaluate_haploid(const Genotype<Haplotype>& genotype) const
 {
-    const auto& log_likelihoods = likelihoods_[genotype[0]];
+    const auto& log_likelihoods = get_likelihoods(genotype[0]);
     return std::accumulate(std::cbegin(log_likelihoods), std::cend(log_likelihoods), 0.0);
 }
 
 double GermlineLikelihoodModel::evaluate_diploid(const Genotype<Haplotype>& genotype) const
 {
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
+    const auto& log_likelihoods1 = get_likelihoods(genotype[0]);
     if (genotype.is_homozygous()) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), 0.0);
     }
-    const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-    return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                              std::cbegin(log_likelihoods2), 0.0, std::plus<> {},
-                              [] (const auto a, const auto b) -> double {
-                                  return maths::log_sum_exp(a, b) - ln<>(2);
-                              });
+    const auto& log_likelihoods2 = get_likelihoods(genotype[1]);
+    return sum_log_sum_exp(log_likelihoods1.data(), log_likelihoods2.data(), log_likelihoods1.size(), 0.0, 0.0, ln<>(2));
 }
 
 double GermlineLikelihoodModel::evaluate_triploid(const Genotype<Haplotype>& genotype) const
 {
     using std::cbegin; using std::cend;
     
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
+    const auto& log_likelihoods1 = get_likelihoods(genotype[0]);
     if (genotype.is_homozygous()) {
         return std::accumulate(cbegin(log_likelihoods1), cend(log_likelihoods1), 0.0);
     }
     if (genotype.zygosity() == 3) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-        return maths::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                    cbegin(log_likelihoods2), cbegin(log_likelihoods3),
-                                    0.0, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c) -> double {
-                                        return maths::log_sum_exp(a, b, c) - ln<>(3);
-                                    });
+        const auto& log_likelihoods2 = get_likelihoods(genotype[1]);
+        const auto& log_likelihoods3 = get_likelihoods(genotype[2]);
+        return sum_log_sum_exp(log_likelihoods1.data(), log_likelihoods2.data(), log_likelihoods3.data(),
+                               log_likelihoods1.size(), ln<>(3));
     }
     if (genotype[0] != genotype[1]) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                  cbegin(log_likelihoods2), 0.0, std::plus<> {},
-                                  [] (const auto a, const auto b) -> double {
-                                      return maths::log_sum_exp(a, ln<>(2) + b) - ln<>(3);
-                                  });
+        const auto& log_likelihoods2 = get_likelihoods(genotype[1]);
+        return sum_log_sum_exp(log_likelihoods1.data(), log_likelihoods2.data(), log_likelihoods1.size(),
+                               0.0, ln<>(2), ln<>(3));
     }
-    const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-    return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                              cbegin(log_likelihoods3), 0.0, std::plus<> {},
-                              [] (const auto a, const auto b) -> double {
-                                  return maths::log_sum_exp(ln<>(2) + a, b) - ln<>(3);
-                              });
+    const auto& log_likelihoods3 = get_likelihoods(genotype[2]);
+    return sum_log_sum_exp(log_likelihoods1.data(), log_likelihoods3.data(), log_likelihoods1.size(),
+                           ln<>(2), 0.0, ln<>(3));
 }
 
 double GermlineLikelihoodModel::evaluate_tetraploid(const Genotype<Haplotype>& genotype) const
 {
     const auto z = genotype.zygosity();
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
+    const auto& log_likelihoods1 = get_likelihoods(genotype[0]);
     if (z == 1) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), 0.0);
     }
     if (z == 4) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-        const auto& log_likelihoods4 = likelihoods_[genotype[3]];
+        const auto& log_likelihoods2 = get_likelihoods(genotype[1]);
+        const auto& log_likelihoods3 = get_likelihoods(genotype[2]);
+        const auto& log_likelihoods4 = get_likelihoods(genotype[3]);
         return maths::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
                                     std::cbegin(log_likelihoods2), std::cbegin(log_likelihoods3),
                                     std::cbegin(log_likelihoods4), 0.0, std::plus<> {},
@@ -150,7 +173,7 @@ double GermlineLikelihoodModel::evaluate_polyploid(const Genotype<Haplotype>& ge
 {
     const auto ploidy = genotype.ploidy();
     const auto z = genotype.zygosity();
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
+    const auto& log_likelihoods1 = get_likelihoods(genotype[0]);
     
     if (z == 1) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), 0.0);
@@ -158,7 +181,7 @@ double GermlineLikelihoodModel::evaluate_polyploid(const Genotype<Haplotype>& ge
     if (z == 2) {
         const double lnpm1 {std::log(ploidy - 1)};
         const auto unique_haplotypes = genotype.copy_unique_ref();
-        const auto& log_likelihoods2 = likelihoods_[unique_haplotypes.back()];
+        const auto& log_likelihoods2 = get_likelihoods(unique_haplotypes.back());
         
         if (genotype.count(unique_haplotypes.front()) == 1) {
             return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
@@ -180,7 +203,7 @@ double GermlineLikelihoodModel::evaluate_polyploid(const Genotype<Haplotype>& ge
     std::transform(std::cbegin(genotype), std::cend(genotype), std::back_inserter(ln_likelihoods),
                    [this] (const auto& haplotype)
                         -> const HaplotypeLikelihoodCache::LikelihoodVector& {
-                       return likelihoods_[haplotype];
+                       return get_likelihoods(haplotype);
                    });
     
     std::vector<double> tmp(ploidy);
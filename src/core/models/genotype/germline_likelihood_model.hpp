@@ -4,6 +4,11 @@
 #ifndef germline_likelihood_model_hpp
 #define germline_likelihood_model_hpp
 
+#include <cstddef>
+
+#include <boost/optional.hpp>
+
+#include "config/common.hpp"
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
 #include "core/models/haplotype_likelihood_cache.hpp"
@@ -16,6 +21,8 @@ public:
     GermlineLikelihoodModel() = delete;
     
     GermlineLikelihoodModel(const HaplotypeLikelihoodCache& likelihoods);
+    // Uses the sample's likelihoods without priming the cache
+    GermlineLikelihoodModel(const HaplotypeLikelihoodCache& likelihoods, const SampleName& sample);
     
     GermlineLikelihoodModel(const GermlineLikelihoodModel&)            = default;
     GermlineLikelihoodModel& operator=(const GermlineLikelihoodModel&) = default;
@@ -28,6 +35,9 @@ public:
     
 private:
     const HaplotypeLikelihoodCache& likelihoods_;
+    boost::optional<std::size_t> sample_index_;
+    
+    const HaplotypeLikelihoodCache::LikelihoodVector& get_likelihoods(const Haplotype& haplotype) const;
     
     // These are just for optimisation
     double evaluate_haploid(const Genotype<Haplotype>& genotype) const;
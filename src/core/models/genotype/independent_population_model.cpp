@@ -3,27 +3,131 @@
 
 #include "independent_population_model.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <cassert>
+
+#include "utils/maths.hpp"
+#include "utils/thread_pool.hpp"
+#include "germline_likelihood_model.hpp"
+
 namespace octopus { namespace model {
 
 IndependentPopulationModel::IndependentPopulationModel(const GenotypePriorModel& genotype_prior_model,
                                                        boost::optional<logging::DebugLogger> debug_log,
                                                        boost::optional<logging::TraceLogger> trace_log)
+: IndependentPopulationModel {genotype_prior_model, ExecutionPolicy::seq, debug_log, trace_log}
+{}
+
+IndependentPopulationModel::IndependentPopulationModel(const GenotypePriorModel& genotype_prior_model,
+                                                       ExecutionPolicy execution_policy,
+                                                       boost::optional<logging::DebugLogger> debug_log,
+                                                       boost::optional<logging::TraceLogger> trace_log)
 : individual_model_ {genotype_prior_model, debug_log, trace_log}
+, execution_policy_ {debug_log || trace_log ? ExecutionPolicy::seq : execution_policy}
+, log_samples_ {debug_log || trace_log}
 {}
 
+namespace {
+
+// num_sample_genotypes is the total number of genotypes to evaluate over all samples
+unsigned get_num_threads(const ExecutionPolicy execution_policy, const std::size_t num_samples,
+                         const std::size_t num_sample_genotypes)
+{
+    static constexpr std::size_t min_samples_per_thread {4};
+    // Below this many sample genotypes, handing blocks to other threads costs more than it saves
+    static constexpr std::size_t min_parallel_sample_genotypes {10'000};
+    if (execution_policy == ExecutionPolicy::seq || num_sample_genotypes < min_parallel_sample_genotypes) return 1;
+    return num_parallel_blocks(num_samples, min_samples_per_thread);
+}
+
+template <typename Container>
+std::size_t count_sample_genotypes(const Container& genotypes)
+{
+    std::size_t result {0};
+    for (const auto& sample_genotypes : genotypes) result += sample_genotypes.get().size();
+    return result;
+}
+
+// The genotype prior model is not thread safe, so priors are evaluated before the samples are split
+template <typename Container>
+auto evaluate_priors(const Container& genotypes, const GenotypePriorModel& genotype_prior_model)
+{
+    std::vector<double> result(genotypes.size());
+    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(result),
+                   [&] (const auto& genotype) { return genotype_prior_model.evaluate(genotype); });
+    return result;
+}
+
+// Writes the sample's genotype posteriors straight into the result, returning the sample log evidence
+double evaluate_sample(const SampleName& sample, const std::vector<Genotype<Haplotype>>& genotypes,
+                       const std::vector<double>& genotype_log_priors, const HaplotypeLikelihoodCache& haplotype_likelihoods,
+                       std::vector<double>& genotype_posteriors)
+{
+    const GermlineLikelihoodModel likelihood_model {haplotype_likelihoods, sample};
+    genotype_posteriors.resize(genotypes.size());
+    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::cbegin(genotype_log_priors), std::begin(genotype_posteriors),
+                   [&likelihood_model] (const auto& genotype, const auto log_prior) {
+                       return log_prior + likelihood_model.evaluate(genotype);
+                   });
+    return maths::normalise_exp(genotype_posteriors);
+}
+
+// Samples are accumulated into the preallocated result one at a time, so only the final posteriors
+// are ever held. Evidence is summed in sample order so the result does not depend on the thread count.
+template <typename GenotypesGetter, typename PriorsGetter>
+void evaluate_samples(const IndependentPopulationModel::SampleVector& samples,
+                      GenotypesGetter&& sample_genotypes, PriorsGetter&& sample_genotype_log_priors,
+                      const HaplotypeLikelihoodCache& haplotype_likelihoods, const unsigned num_threads,
+                      IndependentPopulationModel::InferredLatents& result)
+{
+    auto& posteriors = result.posteriors.genotype_probabilities;
+    posteriors.resize(samples.size());
+    const auto evaluate = [&] (const std::size_t s) {
+        return evaluate_sample(samples[s], sample_genotypes(s), sample_genotype_log_priors(s),
+                               haplotype_likelihoods, posteriors[s]);
+    };
+    if (num_threads > 1) {
+        std::vector<double> sample_log_evidences(samples.size());
+        parallel_for_ranges(samples.size(), num_threads, [&] (const std::size_t first_sample, const std::size_t last_sample) {
+            for (auto s = first_sample; s < last_sample; ++s) {
+                sample_log_evidences[s] = evaluate(s);
+            }
+        });
+        for (const auto log_evidence : sample_log_evidences) result.log_evidence += log_evidence;
+    } else {
+        for (std::size_t s {0}; s < samples.size(); ++s) {
+            result.log_evidence += evaluate(s);
+        }
+    }
+}
+
+} // namespace
+
 IndependentPopulationModel::InferredLatents
 IndependentPopulationModel::evaluate(const SampleVector& samples,
                                      const GenotypeVector& genotypes,
                                      const HaplotypeLikelihoodCache& haplotype_likelihoods) const
 {
     InferredLatents result {};
-    result.posteriors.genotype_probabilities.reserve(samples.size());
-    for (const auto& sample : samples) {
-        haplotype_likelihoods.prime(sample);
-        auto sample_results = individual_model_.evaluate(genotypes, haplotype_likelihoods);
-        result.posteriors.genotype_probabilities.push_back(std::move(sample_results.posteriors.genotype_probabilities));
-        result.log_evidence += sample_results.log_evidence;
+    if (log_samples_) {
+        result.posteriors.genotype_probabilities.reserve(samples.size());
+        for (const auto& sample : samples) {
+            haplotype_likelihoods.prime(sample);
+            auto sample_results = individual_model_.evaluate(genotypes, haplotype_likelihoods);
+            result.posteriors.genotype_probabilities.push_back(std::move(sample_results.posteriors.genotype_probabilities));
+            result.log_evidence += sample_results.log_evidence;
+        }
+        return result;
     }
+    // Every sample has the same genotypes, so the priors only need evaluating once
+    const auto genotype_log_priors = evaluate_priors(genotypes, individual_model_.prior_model());
+    const auto num_threads = get_num_threads(execution_policy_, samples.size(), samples.size() * genotypes.size());
+    evaluate_samples(samples,
+                     [&] (std::size_t) -> const GenotypeVector& { return genotypes; },
+                     [&] (std::size_t) -> const std::vector<double>& { return genotype_log_priors; },
+                     haplotype_likelihoods, num_threads, result);
     return result;
 }
 
@@ -34,14 +138,36 @@ IndependentPopulationModel::evaluate(const SampleVector& samples,
 {
     assert(samples.size() == genotypes.size());
     InferredLatents result {};
+    if (log_samples_) {
+        result.posteriors.genotype_probabilities.reserve(samples.size());
+        for (std::size_t s {0}; s < samples.size(); ++s) {
+            haplotype_likelihoods.prime(samples[s]);
+            auto sample_results = individual_model_.evaluate(genotypes[s], haplotype_likelihoods);
+            result.posteriors.genotype_probabilities.push_back(std::move(sample_results.posteriors.genotype_probabilities));
+            result.log_evidence += sample_results.log_evidence;
+        }
+        return result;
+    }
+    // Samples with the same ploidy share a genotype vector, so priors are evaluated once per distinct vector
+    std::vector<const GenotypeVector*> distinct_genotypes {};
+    std::vector<std::vector<double>> distinct_genotype_log_priors {};
+    std::vector<std::size_t> sample_prior_indices(samples.size());
     for (std::size_t s {0}; s < samples.size(); ++s) {
-        haplotype_likelihoods.prime(samples[s]);
-        auto sample_results = individual_model_.evaluate(genotypes[s], haplotype_likelihoods);
-        result.posteriors.genotype_probabilities.push_back(std::move(sample_results.posteriors.genotype_probabilities));
-        result.log_evidence += sample_results.log_evidence;
+        const auto* sample_genotypes = std::addressof(genotypes[s].get());
+        const auto itr = std::find(std::cbegin(distinct_genotypes), std::cend(distinct_genotypes), sample_genotypes);
+        sample_prior_indices[s] = std::distance(std::cbegin(distinct_genotypes), itr);
+        if (itr == std::cend(distinct_genotypes)) {
+            distinct_genotypes.push_back(sample_genotypes);
+            distinct_genotype_log_priors.push_back(evaluate_priors(*sample_genotypes, individual_model_.prior_model()));
+        }
     }
+    const auto num_threads = get_num_threads(execution_policy_, samples.size(), count_sample_genotypes(genotypes));
+    evaluate_samples(samples,
+                     [&] (std::size_t s) -> const GenotypeVector& { return genotypes[s].get(); },
+                     [&] (std::size_t s) -> const std::vector<double>& { return distinct_genotype_log_priors[sample_prior_indices[s]]; },
+                     haplotype_likelihoods, num_threads, result);
     return result;
 }
-    
+
 } // namesapce model
 } // namespace octopus
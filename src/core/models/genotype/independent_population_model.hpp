@@ -44,6 +44,11 @@ public:
     IndependentPopulationModel(const GenotypePriorModel& genotype_prior_model,
                                boost::optional<logging::DebugLogger> debug_log = boost::none,
                                boost::optional<logging::TraceLogger> trace_log = boost::none);
+    // Samples are evaluated concurrently if the execution policy is par and no logs are given
+    IndependentPopulationModel(const GenotypePriorModel& genotype_prior_model,
+                               ExecutionPolicy execution_policy,
+                               boost::optional<logging::DebugLogger> debug_log = boost::none,
+                               boost::optional<logging::TraceLogger> trace_log = boost::none);
     
     IndependentPopulationModel(const IndependentPopulationModel&)            = delete;
     IndependentPopulationModel& operator=(const IndependentPopulationModel&) = delete;
@@ -64,6 +69,8 @@ public:
 
 private:
     IndividualModel individual_model_;
+    ExecutionPolicy execution_policy_;
+    bool log_samples_;
 };
 
 } // namesapce model
@@ -12,8 +12,6 @@
 #include "utils/maths.hpp"
 #include "germline_likelihood_model.hpp"
 
-#include "timers.hpp"
-
 namespace octopus { namespace model {
 
 IndividualModel::IndividualModel(const GenotypePriorModel& genotype_prior_model,
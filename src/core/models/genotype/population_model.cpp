@@ -7,10 +7,12 @@
 #include <utility>
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <cassert>
 #include <iostream>
 
 #include "utils/maths.hpp"
+#include "utils/thread_pool.hpp"
 #include "germline_likelihood_model.hpp"
 
 namespace octopus { namespace model {
@@ -39,18 +41,56 @@ namespace {
 using GenotypeLogLikelihoodVector  = std::vector<double>;
 using GenotypeLogLikelihoodMatrix  = std::vector<GenotypeLogLikelihoodVector>;
 
-struct GenotypeLogProbability
-{
-    const Genotype<Haplotype>& genotype;
-    double log_probability;
-};
-using GenotypeLogMarginalVector = std::vector<GenotypeLogProbability>;
+using GenotypeLogMarginalVector    = std::vector<double>;
 
 using GenotypeMarginalPosteriorVector  = std::vector<double>;
 using GenotypeMarginalPosteriorMatrix  = std::vector<GenotypeMarginalPosteriorVector>; // for each sample
 
 using InverseGenotypeTable = std::vector<std::vector<std::size_t>>;
 
+// Samples are split into contiguous blocks, one per thread, and f(first, last) is called for each
+// block on the shared thread pool. Blocks write to disjoint sample rows so no synchronisation is needed.
+template <typename F>
+void for_each_sample_block(const std::size_t num_samples, const unsigned num_threads, F f)
+{
+    if (num_threads < 2 || num_samples < 2) {
+        f(std::size_t {0}, num_samples);
+        return;
+    }
+    parallel_for_ranges(num_samples, num_threads, f);
+}
+
+unsigned get_num_threads(const ExecutionPolicy execution_policy, const std::size_t num_samples, const std::size_t num_genotypes)
+{
+    static constexpr std::size_t min_samples_per_thread {8};
+    // Below this many sample genotypes, handing blocks to other threads costs more than it saves
+    static constexpr std::size_t min_parallel_sample_genotypes {100'000};
+    if (execution_policy == ExecutionPolicy::seq || num_samples * num_genotypes < min_parallel_sample_genotypes) return 1;
+    return num_parallel_blocks(num_samples, min_samples_per_thread);
+}
+
+// Sets result to the normalised exponential of log_priors + log_likelihoods and returns the log
+// normalisation constant. Equivalent to maths::normalise_exp on the sum, but with a single exp per
+// element and simple loops the compiler can vectorise.
+double fused_normalise_exp(const double* log_priors, const double* log_likelihoods, double* result, const std::size_t n)
+{
+    double max {std::numeric_limits<double>::lowest()};
+    for (std::size_t i {0}; i < n; ++i) {
+        result[i] = log_priors[i] + log_likelihoods[i];
+        max = std::max(max, result[i]);
+    }
+    double sum {0};
+    for (std::size_t i {0}; i < n; ++i) {
+        result[i] = std::exp(result[i] - max);
+        sum += result[i];
+    }
+    const auto scale = 1.0 / sum;
+    for (std::size_t i {0}; i < n; ++i) {
+        result[i] *= scale;
+    }
+    return max + std::log(sum);
+}
+
 auto make_inverse_genotype_table(const std::vector<Haplotype>& haplotypes,
                                  const std::vector<Genotype<Haplotype>>& genotypes)
 {
@@ -100,16 +140,19 @@ struct ModelConstants
     const unsigned ploidy;
     const double frequency_update_norm;
     const InverseGenotypeTable genotypes_containing_haplotypes;
+    const unsigned num_threads;
     
     ModelConstants(const std::vector<Haplotype>& haplotypes,
                    const std::vector<Genotype<Haplotype>>& genotypes,
-                   const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
+                   const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods,
+                   const unsigned num_threads)
     : haplotypes {haplotypes}
     , genotypes {genotypes}
     , genotype_log_likilhoods {genotype_log_likilhoods}
     , ploidy {genotypes.front().ploidy()}
     , frequency_update_norm {calculate_frequency_update_norm(genotype_log_likilhoods.size(), ploidy)}
     , genotypes_containing_haplotypes {make_inverse_genotype_table(haplotypes, genotypes)}
+    , num_threads {num_threads}
     {}
 };
 
@@ -189,22 +232,21 @@ double log_hardy_weinberg(const Genotype& genotype, const Map& haplotype_frequen
 GenotypeLogLikelihoodMatrix
 compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
                                  const std::vector<Genotype<Haplotype>>& genotypes,
-                                 const HaplotypeLikelihoodCache& haplotype_likelihoods)
+                                 const HaplotypeLikelihoodCache& haplotype_likelihoods,
+                                 const unsigned num_threads)
 {
     assert(!genotypes.empty());
-    GermlineLikelihoodModel likelihood_model {haplotype_likelihoods};
-    GenotypeLogLikelihoodMatrix result {};
-    result.reserve(samples.size());
-    std::transform(std::cbegin(samples), std::cend(samples), std::back_inserter(result),
-                   [&genotypes, &haplotype_likelihoods, &likelihood_model] (const auto& sample) {
-                       GenotypeLogLikelihoodVector likelihoods(genotypes.size());
-                       haplotype_likelihoods.prime(sample);
-                       std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(likelihoods),
-                                      [&likelihood_model] (const auto& genotype) {
-                                          return likelihood_model.evaluate(genotype);
-                                      });
-                       return likelihoods;
-                   });
+    GenotypeLogLikelihoodMatrix result(samples.size(), GenotypeLogLikelihoodVector(genotypes.size()));
+    // The sample likelihood models do not prime the cache, so can be evaluated concurrently
+    for_each_sample_block(samples.size(), num_threads, [&] (const std::size_t first_sample, const std::size_t last_sample) {
+        for (auto s = first_sample; s < last_sample; ++s) {
+            const GermlineLikelihoodModel likelihood_model {haplotype_likelihoods, samples[s]};
+            std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(result[s]),
+                           [&likelihood_model] (const auto& genotype) {
+                               return likelihood_model.evaluate(genotype);
+                           });
+        }
+    });
     return result;
 }
 
@@ -212,67 +254,72 @@ GenotypeLogMarginalVector
 init_genotype_log_marginals(const std::vector<Genotype<Haplotype>>& genotypes,
                             const HaplotypeFrequencyMap& haplotype_frequencies)
 {
-    GenotypeLogMarginalVector result {};
-    result.reserve(genotypes.size());
-    for (const auto& genotype : genotypes) {
-        result.push_back({genotype, log_hardy_weinberg(genotype, haplotype_frequencies)});
-    }
+    GenotypeLogMarginalVector result(genotypes.size());
+    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(result),
+                   [&haplotype_frequencies] (const auto& genotype) {
+                       return log_hardy_weinberg(genotype, haplotype_frequencies);
+                   });
     return result;
 }
 
 void update_genotype_log_marginals(GenotypeLogMarginalVector& current_log_marginals,
+                                   const std::vector<Genotype<Haplotype>>& genotypes,
                                    const HaplotypeFrequencyMap& haplotype_frequencies)
 {
-    std::for_each(std::begin(current_log_marginals), std::end(current_log_marginals),
-                  [&haplotype_frequencies] (auto& p) {
-                      p.log_probability = log_hardy_weinberg(p.genotype, haplotype_frequencies);
-                  });
+    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(current_log_marginals),
+                   [&haplotype_frequencies] (const auto& genotype) {
+                       return log_hardy_weinberg(genotype, haplotype_frequencies);
+                   });
+}
+
+void update_genotype_posteriors(GenotypeMarginalPosteriorMatrix& current_genotype_posteriors,
+                                const GenotypeLogMarginalVector& genotype_log_marginals,
+                                const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods,
+                                const unsigned num_threads)
+{
+    const auto num_genotypes = genotype_log_marginals.size();
+    for_each_sample_block(current_genotype_posteriors.size(), num_threads,
+                          [&] (const std::size_t first_sample, const std::size_t last_sample) {
+        for (auto s = first_sample; s < last_sample; ++s) {
+            fused_normalise_exp(genotype_log_marginals.data(), genotype_log_likilhoods[s].data(),
+                                current_genotype_posteriors[s].data(), num_genotypes);
+        }
+    });
 }
 
 GenotypeMarginalPosteriorMatrix
 init_genotype_posteriors(const GenotypeLogMarginalVector& genotype_log_marginals,
-                         const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
-{
-    GenotypeMarginalPosteriorMatrix result {};
-    result.reserve(genotype_log_likilhoods.size());
-    for (const auto& sample_genotype_log_likilhoods : genotype_log_likilhoods) {
-        GenotypeMarginalPosteriorVector posteriors(genotype_log_marginals.size());
-        std::transform(std::cbegin(genotype_log_marginals), std::cend(genotype_log_marginals),
-                       std::cbegin(sample_genotype_log_likilhoods),
-                       std::begin(posteriors),
-                       [] (const auto& genotype_log_marginal, const auto genotype_log_likilhood) {
-                           return genotype_log_marginal.log_probability + genotype_log_likilhood;
-                       });
-        maths::normalise_exp(posteriors);
-        result.emplace_back(std::move(posteriors));
-    }
+                         const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods,
+                         const unsigned num_threads)
+{
+    GenotypeMarginalPosteriorMatrix result(genotype_log_likilhoods.size(),
+                                           GenotypeMarginalPosteriorVector(genotype_log_marginals.size()));
+    update_genotype_posteriors(result, genotype_log_marginals, genotype_log_likilhoods, num_threads);
     return result;
 }
 
-void update_genotype_posteriors(GenotypeMarginalPosteriorMatrix& current_genotype_posteriors,
-                                const GenotypeLogMarginalVector& genotype_log_marginals,
-                                const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
-{
-    auto it = std::cbegin(genotype_log_likilhoods);
-    for (auto& sample_genotype_posteriors : current_genotype_posteriors) {
-        std::transform(std::cbegin(genotype_log_marginals), std::cend(genotype_log_marginals),
-                       std::cbegin(*it++),
-                       std::begin(sample_genotype_posteriors),
-                       [] (const auto& log_marginal, const auto& log_likilhood) {
-                           return log_marginal.log_probability + log_likilhood;
-                       });
-        maths::normalise_exp(sample_genotype_posteriors);
-    }
-}
-
-auto collapse_genotype_posteriors(const GenotypeMarginalPosteriorMatrix& genotype_posteriors)
+auto collapse_genotype_posteriors(const GenotypeMarginalPosteriorMatrix& genotype_posteriors, const unsigned num_threads)
 {
     assert(!genotype_posteriors.empty());
-    std::vector<double> result(genotype_posteriors.front().size());
-    for (const auto& sample_posteriors : genotype_posteriors) {
-        std::transform(std::cbegin(result), std::cend(result), std::cbegin(sample_posteriors), std::begin(result),
+    const auto num_genotypes = genotype_posteriors.front().size();
+    const auto num_blocks = std::max(std::min<std::size_t>(num_threads, genotype_posteriors.size()), std::size_t {1});
+    std::vector<std::vector<double>> block_sums(num_blocks, std::vector<double>(num_genotypes));
+    for_each_sample_block(genotype_posteriors.size(), static_cast<unsigned>(num_blocks),
+                          [&] (const std::size_t first_sample, const std::size_t last_sample) {
+        const auto num_samples = genotype_posteriors.size();
+        auto& result = block_sums[(first_sample * num_blocks + num_samples - 1) / num_samples]; // inverts the block split
+        for (auto s = first_sample; s < last_sample; ++s) {
+            const auto& sample_posteriors = genotype_posteriors[s];
+            for (std::size_t g {0}; g < num_genotypes; ++g) {
+                result[g] += sample_posteriors[g];
+            }
+        }
+    });
+    auto result = std::move(block_sums.front());
+    std::for_each(std::next(std::cbegin(block_sums)), std::cend(block_sums), [&] (const auto& block_sum) {
+        std::transform(std::cbegin(result), std::cend(result), std::cbegin(block_sum), std::begin(result),
                        [] (const auto curr, const auto p) { return curr + p; });
-    }
+    });
     return result;
 }
 
@@ -280,9 +327,10 @@ double update_haplotype_frequencies(const std::vector<Haplotype>& haplotypes,
                                     HaplotypeFrequencyMap& current_haplotype_frequencies,
                                     const GenotypeMarginalPosteriorMatrix& genotype_posteriors,
                                     const InverseGenotypeTable& genotypes_containing_haplotypes,
-                                    const double frequency_update_norm)
+                                    const double frequency_update_norm,
+                                    const unsigned num_threads)
 {
-    const auto collaped_posteriors = collapse_genotype_posteriors(genotype_posteriors);
+    const auto collaped_posteriors = collapse_genotype_posteriors(genotype_posteriors, num_threads);
     double max_frequency_change {0};
     for (std::size_t i {0}; i < haplotypes.size(); ++i) {
         auto& current_frequency = current_haplotype_frequencies.at(haplotypes[i]);
@@ -309,10 +357,11 @@ double do_em_iteration(GenotypeMarginalPosteriorMatrix& genotype_posteriors,
                                                          haplotype_frequencies,
                                                          genotype_posteriors,
                                                          constants.genotypes_containing_haplotypes,
-                                                         constants.frequency_update_norm);
-    update_genotype_log_marginals(genotype_log_marginals, haplotype_frequencies);
+                                                         constants.frequency_update_norm,
+                                                         constants.num_threads);
+    update_genotype_log_marginals(genotype_log_marginals, constants.genotypes, haplotype_frequencies);
     update_genotype_posteriors(genotype_posteriors, genotype_log_marginals,
-                               constants.genotype_log_likilhoods);
+                               constants.genotype_log_likilhoods, constants.num_threads);
     return max_change;
 }
 
@@ -331,13 +380,14 @@ void run_em(GenotypeMarginalPosteriorMatrix& genotype_posteriors,
 
 auto compute_approx_genotype_marginal_posteriors(const std::vector<Genotype<Haplotype>>& genotypes,
                                                  const GenotypeLogLikelihoodMatrix& genotype_likelihoods,
-                                                 const EmOptions options)
+                                                 const EmOptions options,
+                                                 const unsigned num_threads)
 {
     const auto haplotypes = extract_unique_elements(genotypes);
-    const ModelConstants constants {haplotypes, genotypes, genotype_likelihoods};
+    const ModelConstants constants {haplotypes, genotypes, genotype_likelihoods, num_threads};
     auto haplotype_frequencies = init_haplotype_frequencies(constants);
     auto genotype_log_marginals = init_genotype_log_marginals(genotypes, haplotype_frequencies);
-    auto result = init_genotype_posteriors(genotype_log_marginals, genotype_likelihoods);
+    auto result = init_genotype_posteriors(genotype_log_marginals, genotype_likelihoods, num_threads);
     run_em(result, haplotype_frequencies, genotype_log_marginals, constants, options);
     return result;
 }
@@ -552,9 +602,11 @@ PopulationModel::evaluate(const SampleVector& samples, const GenotypeVector& gen
                           const HaplotypeLikelihoodCache& haplotype_likelihoods) const
 {
     assert(!genotypes.empty());
-    const auto genotype_log_likelihoods = compute_genotype_log_likelihoods(samples, genotypes, haplotype_likelihoods);
+    const auto num_threads = get_num_threads(options_.execution_policy, samples.size(), genotypes.size());
+    const auto genotype_log_likelihoods = compute_genotype_log_likelihoods(samples, genotypes, haplotype_likelihoods, num_threads);
     const auto approx_genotype_posteriors = compute_approx_genotype_marginal_posteriors(genotypes, genotype_log_likelihoods,
-                                                                                        {options_.max_em_iterations, 0.0001});
+                                                                                        {options_.max_em_iterations, 0.0001},
+                                                                                        num_threads);
     const auto max_combinations = options_.max_combinations_per_sample * samples.size();
     auto genotype_combinations = get_genotype_combinations(genotypes, approx_genotype_posteriors, max_combinations);
     auto p = calculate_posteriors(genotypes, genotype_combinations, genotype_log_likelihoods, prior_model_);
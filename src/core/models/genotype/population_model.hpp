@@ -39,6 +39,7 @@ public:
     {
         std::size_t max_combinations_per_sample = 200;
         unsigned max_em_iterations = 100;
+        ExecutionPolicy execution_policy = ExecutionPolicy::seq; // samples are evaluated concurrently if par
     };
     
     using SampleVector            = std::vector<SampleName>;
@@ -15,8 +15,6 @@
 #include "utils/maths.hpp"
 #include "germline_likelihood_model.hpp"
 
-#include "timers.hpp"
-
 namespace octopus { namespace model {
 
 TrioModel::TrioModel(const Trio& trio,
@@ -4,6 +4,7 @@
 #include "haplotype_likelihood_cache.hpp"
 
 #include <utility>
+#include <new>
 #include <cassert>
 
 #include <iostream> // DEBUG
@@ -43,48 +44,58 @@ void HaplotypeLikelihoodCache::populate(const ReadMap& reads,
 {
     // This code is not very pretty because it is a bottleneck for the entire application.
     // We want to try a minimise memory allocations for the mapping.
-    cache_.clear();
+    recycle_all();
     if (cache_.bucket_count() < haplotypes.size()) {
         cache_.rehash(haplotypes.size());
     }
     set_read_iterators_and_sample_indices(reads);
     assert(reads.size() == read_iterators_.size());
     const auto num_samples = reads.size();
-    // Precompute all read hashes so we don't have to recompute for each haplotype
-    std::vector<std::vector<KmerPerfectHashes>> read_hashes {};
-    read_hashes.reserve(num_samples);
-    for (const auto& t : read_iterators_) {
-        std::vector<KmerPerfectHashes> sample_read_hashes {};
-        sample_read_hashes.reserve(t.num_reads);
-        std::transform(t.first, t.last, std::back_inserter(sample_read_hashes),
-                       [] (const AlignedRead& read) { return compute_kmer_hashes<mapperKmerSize>(read.sequence()); });
-        read_hashes.emplace_back(std::move(sample_read_hashes));
+    for (const auto& haplotype : haplotypes) {
+        cache_.emplace(std::piecewise_construct, std::forward_as_tuple(haplotype), std::forward_as_tuple(num_samples));
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
     const auto first_mapping_position = std::begin(mapping_positions_);
-    for (const auto& haplotype : haplotypes) {
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
-        auto itr = std::begin(cache_.emplace(std::piecewise_construct,
-                                             std::forward_as_tuple(haplotype),
-                                             std::forward_as_tuple(num_samples)).first->second);
-        likelihood_model_.reset(haplotype, flank_state);
-        auto read_hash_itr = std::cbegin(read_hashes);
-        for (const auto& t : read_iterators_) { // for each sample
-            *itr = std::vector<double>(t.num_reads);
-            std::transform(t.first, t.last, std::cbegin(*read_hash_itr), std::begin(*itr),
-                           [&] (const AlignedRead& read, const auto& read_hashes) {
-                               const auto last_mapping_position = map_query_to_target(read_hashes, haplotype_hashes,
-                                                                                      haplotype_mapping_counts,
-                                                                                      first_mapping_position,
-                                                                                      maxMappingPositions);
-                               reset_mapping_counts(haplotype_mapping_counts);
-                               return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
-                           });
-            ++read_hash_itr;
-            ++itr;
+    // Samples are evaluated in batches so only the read hashes of one batch are held at once,
+    // which bounds memory for large cohorts. Each batch needs the haplotype hashes again.
+    // Hash buffers are overwritten in place so their capacity carries over between batches and windows.
+    for (std::size_t first_sample {0}; first_sample < num_samples;) {
+        std::size_t last_sample {first_sample}, num_batch_reads {0};
+        for (; last_sample < num_samples && (last_sample == first_sample || num_batch_reads < maxReadsPerBatch); ++last_sample) {
+            const auto& t = read_iterators_[last_sample];
+            // Precompute all read hashes so we don't have to recompute for each haplotype
+            const auto batch_index = last_sample - first_sample;
+            if (read_hashes_.size() <= batch_index) read_hashes_.resize(batch_index + 1);
+            auto& sample_read_hashes = read_hashes_[batch_index];
+            if (sample_read_hashes.size() < t.num_reads) sample_read_hashes.resize(t.num_reads);
+            auto hashes_itr = std::begin(sample_read_hashes);
+            std::for_each(t.first, t.last, [&] (const AlignedRead& read) {
+                compute_kmer_hashes<mapperKmerSize>(read.sequence(), *hashes_itr++);
+            });
+            num_batch_reads += t.num_reads;
+        }
+        for (const auto& haplotype : haplotypes) {
+            populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes_);
+            mapping_counts_.assign(haplotype_hashes_.size(), 0);
+            auto itr = std::next(std::begin(cache_.at(haplotype)), first_sample);
+            likelihood_model_.reset(haplotype, flank_state);
+            auto read_hash_itr = std::cbegin(read_hashes_);
+            for (auto s = first_sample; s < last_sample; ++s) {
+                const auto& t = read_iterators_[s];
+                *itr = make_likelihood_vector(t.num_reads);
+                std::transform(t.first, t.last, std::cbegin(*read_hash_itr), std::begin(*itr),
+                               [&] (const AlignedRead& read, const auto& read_hashes) {
+                                   const auto last_mapping_position = map_query_to_target(read_hashes, haplotype_hashes_,
+                                                                                          mapping_counts_,
+                                                                                          first_mapping_position,
+                                                                                          maxMappingPositions);
+                                   reset_mapping_counts(mapping_counts_);
+                                   return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
+                               });
+                ++read_hash_itr;
+                ++itr;
+            }
         }
-        clear_kmer_hash_table(haplotype_hashes);
+        first_sample = last_sample;
     }
     likelihood_model_.clear();
     read_iterators_.clear();
@@ -107,6 +118,17 @@ HaplotypeLikelihoodCache::operator[](const Haplotype& haplotype) const
     return cache_.at(haplotype)[*primed_sample_];
 }
 
+std::size_t HaplotypeLikelihoodCache::sample_index(const SampleName& sample) const
+{
+    return sample_indices_.at(sample);
+}
+
+const HaplotypeLikelihoodCache::LikelihoodVector&
+HaplotypeLikelihoodCache::operator()(const std::size_t sample_index, const Haplotype& haplotype) const
+{
+    return cache_.at(haplotype)[sample_index];
+}
+
 HaplotypeLikelihoodCache::SampleLikelihoodMap
 HaplotypeLikelihoodCache::extract_sample(const SampleName& sample) const
 {
@@ -130,7 +152,7 @@ bool HaplotypeLikelihoodCache::is_empty() const noexcept
 
 void HaplotypeLikelihoodCache::clear() noexcept
 {
-    cache_.clear();
+    recycle_all();
     sample_indices_.clear();
     unprime();
 }
@@ -170,6 +192,34 @@ void HaplotypeLikelihoodCache::set_read_iterators_and_sample_indices(const ReadM
     }
 }
 
+HaplotypeLikelihoodCache::LikelihoodVector HaplotypeLikelihoodCache::make_likelihood_vector(const std::size_t num_reads)
+{
+    if (likelihood_pool_.empty()) return LikelihoodVector(num_reads);
+    auto result = std::move(likelihood_pool_.back());
+    likelihood_pool_.pop_back();
+    result.resize(num_reads);
+    return result;
+}
+
+void HaplotypeLikelihoodCache::recycle(std::vector<LikelihoodVector>& likelihoods) noexcept
+{
+    try {
+        for (auto& sample_likelihoods : likelihoods) {
+            if (sample_likelihoods.capacity() > 0) {
+                likelihood_pool_.push_back(std::move(sample_likelihoods));
+            }
+        }
+    } catch (const std::bad_alloc&) {
+        // The remaining vectors are just freed
+    }
+}
+
+void HaplotypeLikelihoodCache::recycle_all() noexcept
+{
+    for (auto& p : cache_) recycle(p.second);
+    cache_.clear();
+}
+
 // non-member methods
 
 HaplotypeLikelihoodCache merge_samples(const std::vector<SampleName>& samples,
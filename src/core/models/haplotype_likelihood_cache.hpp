@@ -25,6 +25,12 @@ namespace octopus {
  
     The matrix can be efficiently populated as the read mapping and alignment are
     done internally which allows minimal memory allocation.
+ 
+    One cache is made for each calling task and cleared after each active window. Its
+    likelihood vectors and mapping buffers are kept and reused by later windows, so they are
+    only allocated when a window needs more than any window before it. This is the only
+    task-scoped storage: haplotypes, genotypes and variants are still allocated with the
+    global allocator.
  */
 class HaplotypeLikelihoodCache
 {
@@ -59,6 +65,10 @@ public:
     const LikelihoodVector& operator()(const SampleName& sample, const Haplotype& haplotype) const;
     const LikelihoodVector& operator[](const Haplotype& haplotype) const; // when primed with a sample
     
+    // Index based lookup does not need priming, so can be used concurrently for different samples
+    std::size_t sample_index(const SampleName& sample) const;
+    const LikelihoodVector& operator()(std::size_t sample_index, const Haplotype& haplotype) const;
+    
     SampleLikelihoodMap extract_sample(const SampleName& sample) const;
     
     bool contains(const Haplotype& haplotype) const noexcept;
@@ -79,6 +89,7 @@ public:
 private:
     static constexpr unsigned char mapperKmerSize {6};
     static constexpr std::size_t maxMappingPositions {10};
+    static constexpr std::size_t maxReadsPerBatch {100'000};
     
     HaplotypeLikelihoodModel likelihood_model_;
     
@@ -99,7 +110,16 @@ private:
     std::vector<ReadPacket> read_iterators_;
     std::vector<std::size_t> mapping_positions_;
     
+    // Working storage reused by each population (see above)
+    std::vector<LikelihoodVector> likelihood_pool_;
+    std::vector<std::vector<KmerPerfectHashes>> read_hashes_;
+    KmerHashTable haplotype_hashes_;
+    MappedIndexCounts mapping_counts_;
+    
     void set_read_iterators_and_sample_indices(const ReadMap& reads);
+    LikelihoodVector make_likelihood_vector(std::size_t num_reads);
+    void recycle(std::vector<LikelihoodVector>& likelihoods) noexcept;
+    void recycle_all() noexcept;
 };
 
 template <typename S, typename Container>
@@ -114,7 +134,11 @@ template <typename Container>
 void HaplotypeLikelihoodCache::erase(const Container& haplotypes)
 {
     for (const auto& haplotype : haplotypes) {
-        cache_.erase(haplotype);
+        const auto itr = cache_.find(haplotype);
+        if (itr != std::end(cache_)) {
+            recycle(itr->second);
+            cache_.erase(itr);
+        }
     }
 }
 
@@ -23,8 +23,6 @@
 #include "core/models/error/indel_error_model.hpp"
 #include "pairhmm/pair_hmm.hpp"
 
-#include "timers.hpp"
-
 namespace octopus {
 
 class AlignedRead;
@@ -9,12 +9,14 @@
 #include <numeric>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <cassert>
 
 #include "tandem/tandem.hpp"
 #include "basics/phred.hpp"
 #include "utils/maths.hpp"
+#include "utils/thread_pool.hpp"
 #include "core/types/variant.hpp"
 
 namespace octopus {
@@ -65,7 +67,8 @@ auto make_gap_extend_model(double indel_mutation_rate, std::size_t max_repeat_nu
 
 } // namespace
 
-DeNovoModel::DeNovoModel(Parameters parameters, std::size_t num_haplotypes_hint, CachingStrategy caching)
+DeNovoModel::DeNovoModel(Parameters parameters, std::size_t num_haplotypes_hint, CachingStrategy caching,
+                         ExecutionPolicy execution_policy)
 : flat_mutation_model_ {make_flat_hmm_model(parameters.snv_mutation_rate, parameters.indel_mutation_rate)}
 , repeat_length_gap_open_model_ {make_gap_open_model(parameters.indel_mutation_rate, 10)}
 , repeat_length_gap_extend_model_ {make_gap_extend_model(parameters.indel_mutation_rate, 10)}
@@ -73,43 +76,61 @@ DeNovoModel::DeNovoModel(Parameters parameters, std::size_t num_haplotypes_hint,
 , num_haplotypes_hint_ {num_haplotypes_hint}
 , haplotypes_ {}
 , caching_ {caching}
-, gap_open_penalties_ {}
+, execution_policy_ {execution_policy}
+, gap_open_result_ {}
 , gap_open_index_cache_ {}
 , value_cache_ {}
 , address_cache_ {}
-, guarded_index_cache_ {}
-, unguarded_index_cache_ {}
-, padded_given_ {}
-, use_unguarded_ {false}
+, index_cache_ {}
+, buffers_ {}
 {
-    gap_open_penalties_.reserve(1000);
+    gap_open_result_.first.reserve(1000);
     min_ln_probability_ = std::log(parameters.snv_mutation_rate) + std::log(parameters.indel_mutation_rate);
     if (caching_ == CachingStrategy::address) {
         address_cache_.reserve(num_haplotypes_hint_ * num_haplotypes_hint_);
     } else if (caching == CachingStrategy::value) {
         value_cache_.reserve(num_haplotypes_hint_);
     }
-    padded_given_.reserve(1000);
+    buffers_.target.reserve(1000);
+    buffers_.given.reserve(1000);
+    buffers_.gap_open_penalties.reserve(1000);
 }
 
+namespace {
+
+constexpr double unevaluated {std::numeric_limits<double>::quiet_NaN()};
+
+} // namespace
+
 void DeNovoModel::prime(std::vector<Haplotype> haplotypes)
 {
     if (is_primed()) throw std::runtime_error {"DeNovoModel: already primed"};
-    constexpr std::size_t max_unguardered {50};
+    constexpr unsigned max_precomputed {50}, min_targets_per_thread {4};
+    // Smaller tables are quicker to fill than to hand out to other threads
+    constexpr std::size_t min_parallel_table_size {256};
     haplotypes_ = std::move(haplotypes);
-    gap_open_index_cache_.resize(haplotypes_.size());
-    if (haplotypes_.size() <= max_unguardered) {
-        unguarded_index_cache_.assign(haplotypes_.size(), std::vector<double>(haplotypes_.size(), 0));
-        for (unsigned target {0}; target < haplotypes_.size(); ++target) {
-            for (unsigned given {0}; given < haplotypes_.size(); ++given) {
-                if (target != given) {
-                    unguarded_index_cache_[target][given] = evaluate_uncached(target, given);
-                }
-            }
-        }
-        use_unguarded_ = true;
+    const auto num_haplotypes = static_cast<unsigned>(haplotypes_.size());
+    gap_open_index_cache_.assign(num_haplotypes, boost::none);
+    index_cache_.assign(static_cast<std::size_t>(num_haplotypes) * num_haplotypes, unevaluated);
+    for (unsigned i {0}; i < num_haplotypes; ++i) {
+        index_cache_[static_cast<std::size_t>(i) * num_haplotypes + i] = 0;
+    }
+    if (num_haplotypes > max_precomputed) return;
+    unsigned num_threads {1};
+    if (execution_policy_ != ExecutionPolicy::seq && index_cache_.size() >= min_parallel_table_size) {
+        num_threads = num_parallel_blocks(num_haplotypes, min_targets_per_thread);
+    }
+    if (num_threads < 2) {
+        fill_index_cache(0, num_haplotypes, buffers_);
     } else {
-        guarded_index_cache_.assign(haplotypes_.size(), std::vector<boost::optional<double>>(haplotypes_.size()));
+        // Gap open penalties are shared between threads, so must all be set beforehand
+        for (unsigned given {0}; given < num_haplotypes; ++given) {
+            get_gap_open_penalties(given);
+        }
+        parallel_for_ranges(num_haplotypes, num_threads, [this] (const std::size_t first_target, const std::size_t last_target) {
+            AlignmentBuffers buffers {};
+            fill_index_cache(static_cast<unsigned>(first_target), static_cast<unsigned>(last_target), buffers);
+        });
     }
 }
 
@@ -119,16 +140,13 @@ void DeNovoModel::unprime() noexcept
     haplotypes_.shrink_to_fit();
     gap_open_index_cache_.clear();
     gap_open_index_cache_.shrink_to_fit();
-    guarded_index_cache_.clear();
-    guarded_index_cache_.shrink_to_fit();
-    unguarded_index_cache_.clear();
-    unguarded_index_cache_.shrink_to_fit();
-    use_unguarded_ = false;
+    index_cache_.clear();
+    index_cache_.shrink_to_fit();
 }
 
 bool DeNovoModel::is_primed() const noexcept
 {
-    return !guarded_index_cache_.empty() || !unguarded_index_cache_.empty();
+    return !index_cache_.empty();
 }
 
 double DeNovoModel::evaluate(const Haplotype& target, const Haplotype& given) const
@@ -143,19 +161,11 @@ double DeNovoModel::evaluate(const Haplotype& target, const Haplotype& given) co
 
 double DeNovoModel::evaluate(const unsigned target, const unsigned given) const noexcept
 {
-    if (use_unguarded_) {
-        return unguarded_index_cache_[target][given];
-    } else {
-        auto& result = guarded_index_cache_[target][given];
-        if (!result) {
-            if (target != given) {
-                result = evaluate_uncached(target, given);
-            } else {
-                result = 0;
-            }
-        }
-        return *result;
+    auto& result = index_cache_[static_cast<std::size_t>(target) * haplotypes_.size() + given];
+    if (std::isnan(result)) {
+        result = evaluate_uncached(target, given, buffers_);
     }
+    return result;
 }
 
 // private methods
@@ -168,19 +178,48 @@ auto get_short_tandem_repeats(const Haplotype::NucleotideSequence& given)
     return tandem::extract_exact_tandem_repeats(given, 1, max_repeat_period);
 }
 
-void pad_given(const Haplotype::NucleotideSequence& target, const Haplotype::NucleotideSequence& given,
-               std::string& result)
+template <typename Iterator>
+void pad_given(const std::size_t target_size, Iterator first_given, Iterator last_given, std::string& result)
 {
-    const auto required_size = std::max(target.size(), given.size()) + 2 * hmm::min_flank_pad();
-    result.resize(required_size);
+    const auto given_size = static_cast<std::size_t>(std::distance(first_given, last_given));
+    result.resize(std::max(target_size, given_size) + 2 * hmm::min_flank_pad());
     auto itr = std::fill_n(std::begin(result), hmm::min_flank_pad(), 'N');
-    itr = std::copy(std::cbegin(given), std::cend(given), itr);
+    itr = std::copy(first_given, last_given, itr);
     std::fill(itr, std::end(result), 'N');
 }
 
-void pad_given(const Haplotype& target, const Haplotype& given, std::string& result)
+struct FlankSizes
+{
+    std::size_t lhs, rhs;
+};
+
+// Only the sequence around the differences is aligned, with bases common to the start or end of both
+// sequences trimmed. Some context is kept so gaps are placed as in the full alignment, and repeats that
+// cross the context boundary are kept whole as gaps may slide anywhere within them. With flat gap
+// penalties this gives the same likelihood as the full length alignment. With repeat dependent
+// penalties the result can differ slightly where the banded full length alignment drifts off the
+// best path.
+FlankSizes get_trimmable_flank_sizes(const Haplotype::NucleotideSequence& target,
+                                     const Haplotype::NucleotideSequence& given,
+                                     const hmm::VariableGapOpenMutationModel::PenaltyVector* gap_open_penalties,
+                                     const short default_gap_open)
 {
-    pad_given(target.sequence(), given.sequence(), result);
+    constexpr std::size_t min_context_size {64};
+    const auto min_size = std::min(target.size(), given.size());
+    const auto prefix_end = std::mismatch(std::cbegin(target), std::next(std::cbegin(target), min_size), std::cbegin(given));
+    const auto prefix_size = static_cast<std::size_t>(std::distance(std::cbegin(target), prefix_end.first));
+    const auto suffix_end = std::mismatch(std::crbegin(target), std::next(std::crbegin(target), min_size - prefix_size),
+                                          std::crbegin(given));
+    const auto suffix_size = static_cast<std::size_t>(std::distance(std::crbegin(target), suffix_end.first));
+    FlankSizes result {prefix_size > min_context_size ? prefix_size - min_context_size : 0,
+                       suffix_size > min_context_size ? suffix_size - min_context_size : 0};
+    if (gap_open_penalties) {
+        assert(gap_open_penalties->size() == given.size());
+        const auto in_repeat = [&] (const std::size_t idx) { return (*gap_open_penalties)[idx] != default_gap_open; };
+        while (result.lhs > 0 && in_repeat(result.lhs - 1) && in_repeat(result.lhs)) --result.lhs;
+        while (result.rhs > 0 && in_repeat(given.size() - result.rhs) && in_repeat(given.size() - result.rhs - 1)) --result.rhs;
+    }
+    return result;
 }
 
 auto sequence_length_distance(const Haplotype& lhs, const Haplotype& rhs) noexcept
@@ -238,107 +277,108 @@ double approx_align(const Haplotype& target, const Haplotype& given, const hmm::
 
 } // namespace
 
-boost::optional<unsigned> DeNovoModel::set_gap_open_penalties(const Haplotype& given) const
+void DeNovoModel::set_gap_open_penalties(const Haplotype& given, GapOpenResult& result) const
 {
+    auto& gap_open_penalties = result.first;
     const auto repeats = get_short_tandem_repeats(given.sequence());
     if (!repeats.empty()) {
-        gap_open_penalties_.assign(sequence_size(given), flat_mutation_model_.gap_open);
+        gap_open_penalties.assign(sequence_size(given), flat_mutation_model_.gap_open);
         const auto max_num_repeats = static_cast<unsigned>(repeat_length_gap_open_model_.size());
         unsigned max_repeat_number {0};
         for (const auto& repeat : repeats) {
             const auto num_repeats = repeat.length / repeat.period;
             assert(num_repeats > 0);
             const auto penalty = repeat_length_gap_open_model_[std::min(num_repeats - 1, max_num_repeats - 1)];
-            assert(repeat.pos + repeat.length <= gap_open_penalties_.size());
-            std::fill_n(std::next(std::begin(gap_open_penalties_), repeat.pos), repeat.length, penalty);
+            assert(repeat.pos + repeat.length <= gap_open_penalties.size());
+            std::fill_n(std::next(std::begin(gap_open_penalties), repeat.pos), repeat.length, penalty);
             max_repeat_number = std::max(num_repeats, max_repeat_number);
         }
-        return max_repeat_number;
+        result.second = max_repeat_number;
     } else {
-        gap_open_penalties_.clear();
-        return boost::none;
+        gap_open_penalties.clear();
+        result.second = boost::none;
     }
 }
 
-boost::optional<unsigned> DeNovoModel::set_gap_open_penalties(const unsigned given) const
+const DeNovoModel::GapOpenResult& DeNovoModel::get_gap_open_penalties(const unsigned given) const
 {
     assert(given < gap_open_index_cache_.size());
     auto& cached_result = gap_open_index_cache_[given];
-    if (cached_result) {
-        if (cached_result->second) {
-            gap_open_penalties_ = cached_result->first;
-        }
-        return cached_result->second;
-    } else {
-        auto result = set_gap_open_penalties(haplotypes_[given]);
-        cached_result = std::make_pair(gap_open_penalties_, result);
-        return result;
+    if (!cached_result) {
+        cached_result = GapOpenResult {};
+        set_gap_open_penalties(haplotypes_[given], *cached_result);
     }
+    return *cached_result;
 }
 
-hmm::VariableGapOpenMutationModel DeNovoModel::make_variable_hmm_model(const unsigned max_repeat_number) const
+hmm::VariableGapOpenMutationModel
+DeNovoModel::make_variable_hmm_model(const PenaltyVector& gap_open_penalties, const unsigned max_repeat_number) const
 {
     assert(max_repeat_number > 0);
     auto extension_idx = std::min(repeat_length_gap_extend_model_.size() - 1, static_cast<std::size_t>(max_repeat_number) - 1);
     auto extension_penalty = repeat_length_gap_extend_model_[extension_idx];
-    return {flat_mutation_model_.mutation, gap_open_penalties_, extension_penalty};
+    return {flat_mutation_model_.mutation, gap_open_penalties, extension_penalty};
+}
+
+void DeNovoModel::fill_index_cache(const unsigned first_target, const unsigned last_target, AlignmentBuffers& buffers) const
+{
+    const auto num_haplotypes = static_cast<unsigned>(haplotypes_.size());
+    for (auto target = first_target; target < last_target; ++target) {
+        for (unsigned given {0}; given < num_haplotypes; ++given) {
+            if (target != given) {
+                index_cache_[static_cast<std::size_t>(target) * num_haplotypes + given] = evaluate_uncached(target, given, buffers);
+            }
+        }
+    }
 }
 
 double DeNovoModel::evaluate_uncached(const Haplotype& target, const Haplotype& given) const
 {
     if (sequence_size(target) == sequence_size(given)) {
-        pad_given(target, given, padded_given_);
-        return hmm_align(target.sequence(), padded_given_, flat_mutation_model_, min_ln_probability_);
+        return evaluate_uncached(target, given, nullptr, buffers_);
     } else {
-        const auto max_repeat_number = set_gap_open_penalties(given);
-        if (max_repeat_number) {
-            if (can_align_with_hmm(target, given)) {
-                pad_given(target, given, padded_given_);
-                gap_open_penalties_.resize(padded_given_.size(), flat_mutation_model_.gap_open);
-                rotate_right(gap_open_penalties_, hmm::min_flank_pad());
-                const auto model = make_variable_hmm_model(*max_repeat_number);
-                return hmm_align(target.sequence(), padded_given_, model, min_ln_probability_);
-            } else {
-                return approx_align(target, given, flat_mutation_model_, min_ln_probability_);
-            }
-        } else {
-            if (can_align_with_hmm(target, given)) {
-                pad_given(target, given, padded_given_);
-                return hmm_align(target.sequence(), padded_given_, flat_mutation_model_, min_ln_probability_);
-            } else {
-                return approx_align(target, given, flat_mutation_model_, min_ln_probability_);
-            }
-        }
+        set_gap_open_penalties(given, gap_open_result_);
+        return evaluate_uncached(target, given, std::addressof(gap_open_result_), buffers_);
     }
 }
 
-double DeNovoModel::evaluate_uncached(const unsigned target_idx, const unsigned given_idx) const
+double DeNovoModel::evaluate_uncached(const unsigned target_idx, const unsigned given_idx, AlignmentBuffers& buffers) const
 {
     const auto& target = haplotypes_[target_idx];
     const auto& given  = haplotypes_[given_idx];
     if (sequence_size(target) == sequence_size(given)) {
-        pad_given(target, given, padded_given_);
-        return hmm_align(target.sequence(), padded_given_, flat_mutation_model_, min_ln_probability_);
+        return evaluate_uncached(target, given, nullptr, buffers);
     } else {
-        const auto max_repeat_length = set_gap_open_penalties(given_idx);
-        if (max_repeat_length) {
-            if (can_align_with_hmm(target, given)) {
-                pad_given(target, given, padded_given_);
-                gap_open_penalties_.resize(padded_given_.size(), flat_mutation_model_.gap_open);
-                rotate_right(gap_open_penalties_, hmm::min_flank_pad());
-                const auto model = make_variable_hmm_model(*max_repeat_length);
-                return hmm_align(target.sequence(), padded_given_, model, min_ln_probability_);
-            } else {
-                return approx_align(target, given, flat_mutation_model_, min_ln_probability_);
-            }
-        } else {
-            if (can_align_with_hmm(target, given)) {
-                pad_given(target, given, padded_given_);
-                return hmm_align(target.sequence(), padded_given_, flat_mutation_model_, min_ln_probability_);
-            } else {
-                return approx_align(target, given, flat_mutation_model_, min_ln_probability_);
-            }
-        }
+        return evaluate_uncached(target, given, std::addressof(get_gap_open_penalties(given_idx)), buffers);
+    }
+}
+
+double DeNovoModel::evaluate_uncached(const Haplotype& target, const Haplotype& given,
+                                      const GapOpenResult* given_gap_open_penalties, AlignmentBuffers& buffers) const
+{
+    if (!can_align_with_hmm(target, given)) {
+        return approx_align(target, given, flat_mutation_model_, min_ln_probability_);
+    }
+    const auto& target_sequence = target.sequence();
+    const auto& given_sequence = given.sequence();
+    const PenaltyVector* repeat_gap_open_penalties {nullptr};
+    if (given_gap_open_penalties && given_gap_open_penalties->second) {
+        repeat_gap_open_penalties = std::addressof(given_gap_open_penalties->first);
+    }
+    const auto flanks = get_trimmable_flank_sizes(target_sequence, given_sequence, repeat_gap_open_penalties,
+                                                  flat_mutation_model_.gap_open);
+    buffers.target.assign(std::next(std::cbegin(target_sequence), flanks.lhs), std::prev(std::cend(target_sequence), flanks.rhs));
+    pad_given(buffers.target.size(), std::next(std::cbegin(given_sequence), flanks.lhs),
+              std::prev(std::cend(given_sequence), flanks.rhs), buffers.given);
+    if (repeat_gap_open_penalties) {
+        buffers.gap_open_penalties.assign(std::next(std::cbegin(*repeat_gap_open_penalties), flanks.lhs),
+                                          std::prev(std::cend(*repeat_gap_open_penalties), flanks.rhs));
+        buffers.gap_open_penalties.resize(buffers.given.size(), flat_mutation_model_.gap_open);
+        rotate_right(buffers.gap_open_penalties, hmm::min_flank_pad());
+        const auto model = make_variable_hmm_model(buffers.gap_open_penalties, *given_gap_open_penalties->second);
+        return hmm_align(buffers.target, buffers.given, model, min_ln_probability_);
+    } else {
+        return hmm_align(buffers.target, buffers.given, flat_mutation_model_, min_ln_probability_);
     }
 }
 
@@ -5,6 +5,7 @@
 #define denovo_model_hpp
 
 #include <cstddef>
+#include <vector>
 #include <unordered_map>
 #include <string>
 #include <utility>
@@ -12,6 +13,7 @@
 #include <boost/optional.hpp>
 #include <boost/functional/hash.hpp>
 
+#include "config/common.hpp"
 #include "core/types/haplotype.hpp"
 #include "../pairhmm/pair_hmm.hpp"
 
@@ -31,7 +33,8 @@ public:
     
     DeNovoModel(Parameters parameters,
                 std::size_t num_haplotypes_hint = 1000,
-                CachingStrategy caching = CachingStrategy::value);
+                CachingStrategy caching = CachingStrategy::value,
+                ExecutionPolicy execution_policy = ExecutionPolicy::seq);
     
     DeNovoModel(const DeNovoModel&)            = default;
     DeNovoModel& operator=(const DeNovoModel&) = default;
@@ -47,6 +50,8 @@ public:
     // ln p(target | given)
     double evaluate(const Haplotype& target, const Haplotype& given) const;
     
+    // Indices are into the haplotypes given to prime. If there were not too many haplotypes all pairs
+    // are evaluated by prime, otherwise pairs are evaluated on first use.
     double evaluate(unsigned target, unsigned given) const noexcept;
     
 private:
@@ -63,26 +68,36 @@ private:
     using PenaltyVector = hmm::VariableGapOpenMutationModel::PenaltyVector;
     using GapOpenResult = std::pair<PenaltyVector, boost::optional<unsigned>>;
     
+    // Scratch space for a single alignment, so alignments can run concurrently with separate buffers
+    struct AlignmentBuffers
+    {
+        std::string target, given;
+        PenaltyVector gap_open_penalties;
+    };
+    
     hmm::FlatGapMutationModel flat_mutation_model_;
     std::vector<hmm::VariableGapOpenMutationModel::Penalty> repeat_length_gap_open_model_, repeat_length_gap_extend_model_;
     boost::optional<double> min_ln_probability_;
     std::size_t num_haplotypes_hint_;
     std::vector<Haplotype> haplotypes_;
     CachingStrategy caching_;
-    mutable PenaltyVector gap_open_penalties_;
+    ExecutionPolicy execution_policy_;
+    mutable GapOpenResult gap_open_result_;
     mutable std::vector<boost::optional<GapOpenResult>> gap_open_index_cache_;
     mutable std::unordered_map<Haplotype, std::unordered_map<Haplotype, double>> value_cache_;
     mutable std::unordered_map<std::pair<const Haplotype*, const Haplotype*>, double, AddressPairHash> address_cache_;
-    mutable std::vector<std::vector<boost::optional<double>>> guarded_index_cache_;
-    mutable std::vector<std::vector<double>> unguarded_index_cache_;
-    mutable std::string padded_given_;
-    mutable bool use_unguarded_;
+    mutable std::vector<double> index_cache_; // row major target by given, NaN if not yet evaluated
+    mutable AlignmentBuffers buffers_;
     
-    boost::optional<unsigned> set_gap_open_penalties(const Haplotype& given) const;
-    boost::optional<unsigned> set_gap_open_penalties(unsigned given) const;
-    hmm::VariableGapOpenMutationModel make_variable_hmm_model(unsigned max_repeat_length) const;
+    void set_gap_open_penalties(const Haplotype& given, GapOpenResult& result) const;
+    const GapOpenResult& get_gap_open_penalties(unsigned given) const;
+    hmm::VariableGapOpenMutationModel make_variable_hmm_model(const PenaltyVector& gap_open_penalties,
+                                                              unsigned max_repeat_number) const;
+    void fill_index_cache(unsigned first_target, unsigned last_target, AlignmentBuffers& buffers) const;
     double evaluate_uncached(const Haplotype& target, const Haplotype& given) const;
-    double evaluate_uncached(unsigned target, unsigned given) const;
+    double evaluate_uncached(unsigned target, unsigned given, AlignmentBuffers& buffers) const;
+    double evaluate_uncached(const Haplotype& target, const Haplotype& given,
+                             const GapOpenResult* given_gap_open_penalties, AlignmentBuffers& buffers) const;
     double evaluate_basic_cache(const Haplotype& target, const Haplotype& given) const;
     double evaluate_address_cache(const Haplotype& target, const Haplotype& given) const;
 };
@@ -16,6 +16,7 @@
 #include <iostream>
 
 #include "utils/maths.hpp"
+#include "logging/profiler.hpp"
 #include "simd_pair_hmm.hpp"
 
 namespace octopus { namespace hmm {
@@ -124,6 +125,9 @@ auto simd_align(const std::string& truth, const std::string& target,
     if (alignment_offset + truth_alignment_size > truth_size) {
         return std::numeric_limits<double>::lowest();
     }
+    // The alignment is banded, so each target base is only aligned to 2 * pad truth bases
+    profiling::count(profiling::Counter::hmm_evaluations);
+    profiling::count(profiling::Counter::hmm_cells, static_cast<std::uint64_t>(target_size) * (truth_alignment_size - target_size + 1));
     const auto qualities = reinterpret_cast<const std::int8_t*>(target_qualities.data());
     if (!use_adjusted_alignment_score(truth, target, target_offset, model)) {
         const auto score = simd::align(truth.data() + alignment_offset,
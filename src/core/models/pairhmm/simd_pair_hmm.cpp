@@ -14,6 +14,8 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include "utils/cpu_dispatch.hpp"
+
 //#include <iostream> // DEBUG
 //#include <iterator> // DEBUG
 //
@@ -69,6 +71,7 @@ auto extract_epi16(const __m128i a, const int imm) noexcept
     }
 }
 
+OCTOPUS_DISPATCH_SSE
 int align(const char* truth, const char* target, const std::int8_t* qualities,
           int truth_len, int target_len,
           short gap_open, short gap_extend, short nuc_prior) noexcept
@@ -186,6 +189,7 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
     return (minscore + 0x8000) >> 2;
 }
 
+OCTOPUS_DISPATCH_SSE
 int align(const char* truth, const char* target, const std::int8_t* qualities,
           const int truth_len, const int target_len,
           const std::int8_t* gap_open, short gap_extend, short nuc_prior) noexcept
@@ -307,6 +311,7 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
     return (minscore + 0x8000) >> 2;
 }
 
+OCTOPUS_DISPATCH_SSE
 int align(const char* truth, const char* target, const std::int8_t* qualities,
           const int truth_len, const int target_len,
           const char* snv_mask, const std::int8_t* snv_prior,
@@ -440,6 +445,7 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
     return (minscore + 0x8000) >> 2;
 }
 
+OCTOPUS_DISPATCH_SSE
 int align(const char* truth, const char* target, const std::int8_t* qualities,
           const int truth_len, const int target_len,
           const std::int8_t* gap_open, short gap_extend, short nuc_prior,
@@ -637,6 +643,7 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
     return (minscore + 0x8000) >> 2;
 }
 
+OCTOPUS_DISPATCH_SSE
 int align(const char* truth, const char* target, const std::int8_t* qualities,
           int truth_len, int target_len,
           const char* snv_mask, const std::int8_t* snv_prior,
@@ -853,6 +860,7 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
     return (minscore + 0x8000) >> 2;
 }
 
+OCTOPUS_DISPATCH_SSE
 int calculate_flank_score(const int truth_len, const int lhs_flank_len, const int rhs_flank_len,
                           const std::int8_t* quals, const std::int8_t* gap_open,
                           const short gap_extend, const short nuc_prior,
@@ -927,6 +935,7 @@ int calculate_flank_score(const int truth_len, const int lhs_flank_len, const in
     return result;
 }
 
+OCTOPUS_DISPATCH_SSE
 int calculate_flank_score(const int truth_len, const int lhs_flank_len, const int rhs_flank_len,
                           const char* target, const std::int8_t* quals,
                           const char* snv_mask, const std::int8_t* snv_prior,
@@ -41,6 +41,7 @@
 #include "config/octopus_vcf.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/callers/caller.hpp"
+#include "core/tools/calling_checkpoint.hpp"
 #include "utils/maths.hpp"
 #include "logging/progress_meter.hpp"
 #include "logging/logging.hpp"
@@ -48,12 +49,15 @@
 #include "core/tools/vcf_header_factory.hpp"
 #include "io/variant/vcf.hpp"
 #include "utils/timing.hpp"
+#include "utils/cpu_dispatch.hpp"
+#include "utils/task_memory.hpp"
+#include "utils/thread_pool.hpp"
 #include "exceptions/program_error.hpp"
+#include "exceptions/user_error.hpp"
 #include "csr/filters/variant_call_filter.hpp"
 #include "csr/filters/variant_call_filter_factory.hpp"
 #include "readpipe/buffered_read_pipe.hpp"
-
-#include "timers.hpp" // BENCHMARK
+#include "logging/profiler.hpp"
 
 namespace octopus {
 
@@ -93,11 +97,14 @@ std::string get_octopus_version()
     return ss.str();
 }
 
+const VcfHeader::BasicKey shardKey {"octopus_shard"};
+
 VcfHeader make_vcf_header(const std::vector<SampleName>& samples,
                           const std::vector<GenomicRegion::ContigName>& contigs,
                           const ReferenceGenome& reference,
                           const CallTypeSet& call_types,
-                          const std::string& command)
+                          const std::string& command,
+                          const boost::optional<GenomeShard>& shard = boost::none)
 {
     auto builder = vcf::make_header_template().set_samples(samples);
     for (const auto& contig : contigs) {
@@ -106,6 +113,11 @@ VcfHeader make_vcf_header(const std::vector<SampleName>& samples,
     builder.add_basic_field("reference", reference.name());
     builder.add_basic_field("octopus_version", get_octopus_version());
     builder.add_structured_field("octopus", {{"command", '"' + command + '"'}});
+    if (shard) {
+        std::ostringstream ss {};
+        ss << *shard;
+        builder.add_basic_field(shardKey.value, ss.str());
+    }
     VcfHeaderFactory factory {};
     for (const auto& type : call_types) {
         factory.register_call_type(type);
@@ -147,10 +159,10 @@ void write_caller_output_header(GenomeCallingComponents& components, const std::
     const auto call_types = get_call_types(components, components.contigs());
     if (components.sites_only() && !apply_csr(components)) {
         components.output() << make_vcf_header({}, components.contigs(), components.reference(),
-                                               call_types, command);
+                                               call_types, command, components.shard());
     } else {
         components.output() << make_vcf_header(components.samples(), components.contigs(),
-                                               components.reference(), call_types, command);
+                                               components.reference(), call_types, command, components.shard());
     }
 }
 
@@ -164,6 +176,11 @@ std::string get_caller_name(const GenomeCallingComponents& components)
 
 void log_startup_info(const GenomeCallingComponents& components)
 {
+    static auto debug_log = get_debug_log();
+    if (debug_log) {
+        stream(*debug_log) << "Auto-vectorised kernels are using " << dispatched_vector_instruction_set()
+                           << " clones and pair HMM kernels are using " << dispatched_sse_instruction_set() << " clones";
+    }
     logging::InfoLogger log {};
     std::ostringstream ss {};
     if (!components.samples().empty()) {
@@ -216,47 +233,32 @@ void write_calls(std::deque<VcfRecord>&& calls, VcfWriter& out)
 {
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Writing " << calls.size() << " calls to output";
+    profiling::ScopedTimer timer {profiling::Stage::vcf_write};
+    profiling::count(profiling::Counter::records_written, calls.size());
     write(calls, out);
     calls.clear();
     calls.shrink_to_fit();
 }
 
-auto find_max_window(const ContigCallingComponents& components,
-                     const GenomicRegion& remaining_call_region)
+// Calls region, unless its inputs are unchanged since a previous run and its previous calls can be reused
+std::deque<VcfRecord> call(const GenomicRegion& region, const ContigCallingComponents& components)
 {
-    const auto& rm = components.read_manager.get();
-    if (!rm.has_reads(components.samples.get(), remaining_call_region)) {
-        return remaining_call_region;
-    }
-    auto result = rm.find_covered_subregion(components.samples, remaining_call_region,
-                                            components.read_buffer_size);
-    if (ends_before(result, remaining_call_region)) {
-        auto rest = right_overhang_region(remaining_call_region, result);
-        if (!rm.has_reads(components.samples.get(), rest)) {
-            result = remaining_call_region;
-        }
+    static auto debug_log = get_debug_log();
+    if (components.reusable_calls && components.reusable_calls->is_reusable(region)) {
+        if (debug_log) stream(*debug_log) << "Reusing previous calls in " << region;
+        auto result = components.reusable_calls->fetch(region);
+        components.progress_meter.get().log_completed(region);
+        return result;
     }
-    return result;
+    return components.caller->call(region, components.progress_meter);
 }
 
 auto propose_call_subregion(const ContigCallingComponents& components,
                             const GenomicRegion& remaining_call_region,
                             boost::optional<GenomicRegion::Size> min_size = boost::none)
 {
-    if (is_empty(remaining_call_region)) {
-        return remaining_call_region;
-    }
-    const auto max_window = find_max_window(components, remaining_call_region);
-    if (ends_before(remaining_call_region, max_window)) {
-        return remaining_call_region;
-    }
-    if (min_size && size(max_window) < *min_size) {
-        if (size(remaining_call_region) < *min_size) {
-            return remaining_call_region;
-        }
-        return expand_rhs(head_region(max_window), *min_size);
-    }
-    return max_window;
+    return octopus::propose_call_subregion(components.read_manager, components.samples, components.read_buffer_size,
+                                           remaining_call_region, min_size);
 }
 
 auto propose_call_subregion(const ContigCallingComponents& components,
@@ -356,7 +358,7 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
         if (debug_log) stream(*debug_log) << "Processing subregion " << subregion;
         
         try {
-            calls = components.caller->call(subregion, components.progress_meter);
+            calls = call(subregion, components);
         } catch(...) {
             // TODO: which exceptions can we recover from?
             throw;
@@ -387,17 +389,20 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
 
 void run_octopus_single_threaded(GenomeCallingComponents& components)
 {
-    #ifdef BENCHMARK
-    init_timers();
-    #endif
     components.progress_meter().start();
     for (const auto& contig : components.contigs()) {
         run_octopus_on_contig(ContigCallingComponents {contig, components});
     }
     components.progress_meter().stop();
-    #ifdef BENCHMARK
-        print_all_timers();
-    #endif
+}
+
+VcfWriter create_temp_output_file(boost::filesystem::path path, const GenomeCallingComponents& components)
+{
+    // All temp files share the final output header dictionaries so they can be block concatenated
+    const auto call_types = get_call_types(components, components.contigs());
+    auto header = make_vcf_header(components.samples(), components.contigs(), components.reference(), call_types,
+                                  "octopus-internal");
+    return VcfWriter {std::move(path), std::move(header)};
 }
 
 VcfWriter create_unique_temp_output_file(const GenomicRegion& region,
@@ -409,10 +414,7 @@ VcfWriter create_unique_temp_output_file(const GenomicRegion& region,
     const auto end     = std::to_string(region.end());
     boost::filesystem::path file_name {contig + "_" + begin + "-" + end + "_temp.bcf"};
     path /= file_name;
-    const auto call_types = get_call_types(components, {region.contig_name()});
-    auto header = make_vcf_header(components.samples(), contig, components.reference(), call_types,
-                                  "octopus-internal");
-    return VcfWriter {std::move(path), std::move(header)};
+    return create_temp_output_file(std::move(path), components);
 }
 
 VcfWriter create_unique_temp_output_file(const GenomicRegion::ContigName& contig,
@@ -431,8 +433,52 @@ TempVcfWriterMap make_temp_vcf_writers(const GenomeCallingComponents& components
     }
     TempVcfWriterMap result {};
     result.reserve(components.contigs().size());
+    const auto checkpoint = components.checkpoint();
     for (const auto& contig : components.contigs()) {
-        result.emplace(contig, create_unique_temp_output_file(contig, components));
+        if (checkpoint) {
+            // Checkpointed calls must survive the temp directory, so are written straight to segments
+            result.emplace(contig, create_temp_output_file(checkpoint->make_segment_path(contig), components));
+        } else {
+            result.emplace(contig, create_unique_temp_output_file(contig, components));
+        }
+    }
+    return result;
+}
+
+using ResumePointMap = std::unordered_map<ContigName, CallingCheckpoint::ResumePoint>;
+
+ResumePointMap get_resume_points(const GenomeCallingComponents& components)
+{
+    ResumePointMap result {};
+    const auto checkpoint = components.checkpoint();
+    if (checkpoint) {
+        for (const auto& contig : components.contigs()) {
+            const auto resume_point = checkpoint->resume_point(contig);
+            if (resume_point) result.emplace(contig, *resume_point);
+        }
+    }
+    return result;
+}
+
+// The search regions of contig that come after the last call written by a checkpointed run
+std::vector<GenomicRegion> get_remaining_regions(const ContigName& contig, const GenomeCallingComponents& components,
+                                                 const ResumePointMap& resume_points)
+{
+    const auto& regions = components.search_regions().at(contig);
+    const auto resume_itr = resume_points.find(contig);
+    if (resume_itr == std::cend(resume_points)) {
+        return {std::cbegin(regions), std::cend(regions)};
+    }
+    const auto resume_position = resume_itr->second.end;
+    std::vector<GenomicRegion> result {};
+    for (const auto& region : regions) {
+        if (region.end() > resume_position) {
+            if (region.begin() < resume_position) {
+                result.emplace_back(contig, resume_position, region.end());
+            } else {
+                result.push_back(region);
+            }
+        }
     }
     return result;
 }
@@ -504,7 +550,6 @@ struct TaskMakerSyncPacket
 void make_region_tasks(const GenomicRegion& region, const ContigCallingComponents& components, const ExecutionPolicy policy,
                        TaskQueue& result, TaskMakerSyncPacket& sync, const bool last_region_in_contig, const bool last_contig)
 {
-    static constexpr GenomicRegion::Size minTaskSize {5'000};
     std::unique_lock<std::mutex> lock {sync.mutex, std::defer_lock};
     auto subregion = propose_call_subregion(components, region, minTaskSize);
     if (ends_equal(subregion, region)) {
@@ -557,14 +602,14 @@ void make_region_tasks(const GenomicRegion& region, const ContigCallingComponent
     }
 }
 
-void make_contig_tasks(const ContigCallingComponents& components, const ExecutionPolicy policy,
-                       TaskQueue& result, TaskMakerSyncPacket& sync, const bool last_contig)
+void make_contig_tasks(const ContigCallingComponents& components, const std::vector<GenomicRegion>& regions,
+                       const ExecutionPolicy policy, TaskQueue& result, TaskMakerSyncPacket& sync, const bool last_contig)
 {
-    if (components.regions.empty()) return;
-    std::for_each(std::cbegin(components.regions), std::prev(std::cend(components.regions)), [&] (const auto& region) {
+    if (regions.empty()) return;
+    std::for_each(std::cbegin(regions), std::prev(std::cend(regions)), [&] (const auto& region) {
         make_region_tasks(region, components, policy, result, sync, false, last_contig);
     });
-    make_region_tasks(components.regions.back(), components, policy, result, sync, true, last_contig);
+    make_region_tasks(regions.back(), components, policy, result, sync, true, last_contig);
 }
 
 ExecutionPolicy make_execution_policy(const GenomeCallingComponents& components)
@@ -583,7 +628,8 @@ auto make_contig_components(const ContigName& contig, GenomeCallingComponents& c
 }
 
 void make_tasks_helper(TaskMap& tasks, std::vector<ContigName> contigs, GenomeCallingComponents& components,
-                       const unsigned num_threads, ExecutionPolicy execution_policy, TaskMakerSyncPacket& sync)
+                       const ResumePointMap& resume_points, const unsigned num_threads, ExecutionPolicy execution_policy,
+                       TaskMakerSyncPacket& sync)
 {
     try {
         static auto debug_log = get_debug_log();
@@ -592,7 +638,8 @@ void make_tasks_helper(TaskMap& tasks, std::vector<ContigName> contigs, GenomeCa
             const auto& contig = contigs[i];
             if (debug_log) stream(*debug_log) << "Making tasks for contig " << contig;
             auto contig_components = make_contig_components(contig, components, num_threads);
-            make_contig_tasks(contig_components, execution_policy, tasks[contig], sync, i == contigs.size() - 1);
+            make_contig_tasks(contig_components, get_remaining_regions(contig, components, resume_points),
+                              execution_policy, tasks[contig], sync, i == contigs.size() - 1);
             if (debug_log) stream(*debug_log) << "Finished making tasks for contig " << contig;
         }
         if (debug_log) *debug_log << "Finished making tasks";
@@ -613,10 +660,13 @@ void make_tasks_helper(TaskMap& tasks, std::vector<ContigName> contigs, GenomeCa
     }
 }
 
-std::thread make_task_maker_thread(TaskMap& tasks, GenomeCallingComponents& components, const unsigned num_threads,
-                                   TaskMakerSyncPacket& sync)
+std::thread make_task_maker_thread(TaskMap& tasks, GenomeCallingComponents& components, const ResumePointMap& resume_points,
+                                   const unsigned num_threads, TaskMakerSyncPacket& sync)
 {
-    auto contigs = components.contigs();
+    std::vector<ContigName> contigs {};
+    contigs.reserve(components.contigs().size());
+    std::copy_if(std::cbegin(components.contigs()), std::cend(components.contigs()), std::back_inserter(contigs),
+                 [&] (const auto& contig) { return !get_remaining_regions(contig, components, resume_points).empty(); });
     if (contigs.empty()) {
         sync.all_done = true;
         return std::thread {};
@@ -626,7 +676,7 @@ std::thread make_task_maker_thread(TaskMap& tasks, GenomeCallingComponents& comp
         sync.finished.emplace(contig, false);
     }
     return std::thread {make_tasks_helper, std::ref(tasks), std::move(contigs), std::ref(components),
-                        num_threads, make_execution_policy(components), std::ref(sync)};
+                        std::cref(resume_points), num_threads, make_execution_policy(components), std::ref(sync)};
 }
 
 void log_num_cores(const unsigned num_cores)
@@ -682,9 +732,10 @@ Task pop(TaskMap& tasks, TaskMakerSyncPacket& sync)
 
 struct CompletedTask : public Task
 {
-    CompletedTask(Task task) : Task {std::move(task)}, calls {}, runtime {} {}
+    CompletedTask(Task task) : Task {std::move(task)}, calls {}, runtime {}, footprint {} {}
     std::deque<VcfRecord> calls;
     utils::TimeInterval runtime;
+    std::size_t footprint; // peak working memory
 };
 
 std::string duration(const CompletedTask& task)
@@ -720,9 +771,13 @@ auto run(Task task, ContigCallingComponents components, CallerSyncPacket& sync)
     if (debug_log) stream(*debug_log) << "Spawning task " << task;
     return std::async(std::launch::async, [task = std::move(task), components = std::move(components), &sync] () {
         try {
+            // Counts this task against the thread budget, so it only splits work over threads no other task is using
+            const ParallelTaskScope parallel_task {};
             CompletedTask result {task};
             result.runtime.start = std::chrono::system_clock::now();
-            result.calls = components.caller->call(task.region, components.progress_meter);
+            reset_task_footprint();
+            result.calls = call(task.region, components);
+            result.footprint = peak_task_footprint();
             result.runtime.end = std::chrono::system_clock::now();
             std::unique_lock<std::mutex> lock {sync.mutex};
             ++sync.num_finished;
@@ -870,35 +925,102 @@ struct TaskWriterSyncPacket
     std::condition_variable cv;
     std::mutex mutex;
     std::deque<CompletedTask> tasks = {};
+    bool writing = false;
     bool done = false;
 };
 
-void write(std::deque<CompletedTask>& tasks, TempVcfWriterMap& writers)
+// Periodically closes the temp VCFs written since the last commit and records them in the checkpoint,
+// then continues each in a new segment. Only used by the task writer thread.
+class TempVcfCheckpointer
+{
+public:
+    TempVcfCheckpointer() = delete;
+    
+    TempVcfCheckpointer(CallingCheckpoint& checkpoint, const GenomeCallingComponents& components)
+    : checkpoint_ {checkpoint}
+    , components_ {components}
+    , unrecorded_ {}
+    , last_commit_ {Clock::now()}
+    {}
+    
+    void note_written(const CompletedTask& task)
+    {
+        if (!task.calls.empty()) {
+            const auto& last_call = task.calls.back();
+            unrecorded_[contig_name(task)] = CallingCheckpoint::ResumePoint {mapped_begin(last_call), mapped_end(last_call)};
+        }
+    }
+    
+    void commit_if_due(TempVcfWriterMap& writers)
+    {
+        if (!unrecorded_.empty() && Clock::now() - last_commit_ >= commitInterval) {
+            commit(writers);
+        }
+    }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr std::chrono::minutes commitInterval {5};
+    
+    std::reference_wrapper<CallingCheckpoint> checkpoint_;
+    std::reference_wrapper<const GenomeCallingComponents> components_;
+    std::unordered_map<ContigName, CallingCheckpoint::ResumePoint> unrecorded_;
+    Clock::time_point last_commit_;
+    
+    void commit(TempVcfWriterMap& writers)
+    {
+        static auto debug_log = get_debug_log();
+        for (const auto& p : unrecorded_) {
+            auto& writer = writers.at(p.first);
+            const auto segment = *writer.path();
+            writer.close();
+            checkpoint_.get().record(p.first, segment, p.second);
+            writer = create_temp_output_file(checkpoint_.get().make_segment_path(p.first), components_);
+        }
+        if (debug_log) stream(*debug_log) << "Checkpointed calls of " << unrecorded_.size() << " contigs";
+        unrecorded_.clear();
+        last_commit_ = Clock::now();
+    }
+};
+
+constexpr std::chrono::minutes TempVcfCheckpointer::commitInterval;
+
+void write(std::deque<CompletedTask>& tasks, TempVcfWriterMap& writers, boost::optional<TempVcfCheckpointer>& checkpointer)
 {
     static auto debug_log = get_debug_log();
     for (auto&& task : tasks) {
         if (debug_log) {
             stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
         }
+        if (checkpointer) checkpointer->note_written(task);
         auto& writer = writers.at(contig_name(task));
         write_calls(std::move(task.calls), writer);
     }
     tasks.clear();
+    if (checkpointer) checkpointer->commit_if_due(writers);
 }
 
-void write_temp_vcf_helper(TempVcfWriterMap& writers, TaskWriterSyncPacket& sync)
+void write_temp_vcf_helper(TempVcfWriterMap& writers, TaskWriterSyncPacket& sync,
+                           boost::optional<TempVcfCheckpointer>& checkpointer)
 {
     try {
         std::unique_lock<std::mutex> lock {sync.mutex, std::defer_lock};
         std::deque<CompletedTask> buffer {};
-        while (!sync.done) {
+        while (true) {
             lock.lock();
             sync.cv.wait(lock, [&] () { return !sync.tasks.empty() || sync.done; });
+            if (sync.tasks.empty()) break; // done
             assert(buffer.empty());
             std::swap(sync.tasks, buffer);
+            sync.writing = true;
+            lock.unlock();
+            sync.cv.notify_one();
+            write(buffer, writers, checkpointer);
+            lock.lock();
+            sync.writing = false;
             lock.unlock();
             sync.cv.notify_one();
-            write(buffer, writers);
         }
         logging::DebugLogger debug_log {};
         debug_log << "Task writer finished";
@@ -919,9 +1041,10 @@ void write_temp_vcf_helper(TempVcfWriterMap& writers, TaskWriterSyncPacket& sync
     }
 }
 
-std::thread make_task_writer_thread(TempVcfWriterMap& temp_writers, TaskWriterSyncPacket& writer_sync)
+std::thread make_task_writer_thread(TempVcfWriterMap& temp_writers, TaskWriterSyncPacket& writer_sync,
+                                    boost::optional<TempVcfCheckpointer>& checkpointer)
 {
-    return std::thread {write_temp_vcf_helper, std::ref(temp_writers), std::ref(writer_sync)};
+    return std::thread {write_temp_vcf_helper, std::ref(temp_writers), std::ref(writer_sync), std::ref(checkpointer)};
 }
 
 void write(std::deque<CompletedTask>&& tasks, VcfWriter& temp_vcf)
@@ -968,12 +1091,25 @@ void write_or_buffer(CompletedTask&& task, CompletedTaskMap::mapped_type& buffer
 void wait_until_finished(TaskWriterSyncPacket& sync)
 {
     std::unique_lock<std::mutex> lock {sync.mutex};
-    sync.cv.wait(lock, [&] () { return sync.tasks.empty(); });
+    sync.cv.wait(lock, [&] () { return sync.tasks.empty() && !sync.writing; });
     sync.done = true;
     lock.unlock();
     sync.cv.notify_one();
 }
 
+// Resumed calls up to and including the last call written by the checkpointed run are duplicates
+void erase_checkpointed_calls(CompletedTask& task, const ResumePointMap& resume_points)
+{
+    const auto itr = resume_points.find(contig_name(task));
+    if (itr != std::cend(resume_points)) {
+        const auto resume_point = itr->second;
+        const auto first_unwritten = std::find_if(std::cbegin(task.calls), std::cend(task.calls), [=] (const auto& call) {
+            return is_after(resume_point, mapped_begin(call), mapped_end(call));
+        });
+        task.calls.erase(std::cbegin(task.calls), first_unwritten);
+    }
+}
+
 using FutureCompletedTasks = std::vector<std::future<CompletedTask>>;
 using RemainingTaskMap = std::map<ContigName, std::deque<CompletedTask>>;
 
@@ -1035,37 +1171,120 @@ void write(RemainingTaskMap&& remaining_tasks, TempVcfWriterMap& temp_vcfs)
 }
 
 void write_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
-                           const ContigCallingComponentFactoryMap& calling_components)
+                           const ContigCallingComponentFactoryMap& calling_components, const ResumePointMap& resume_points)
 {
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Waiting for " << futures.size() << " running tasks to finish";
     auto remaining_tasks = extract_remaining_tasks(futures, buffered_tasks);
+    if (!resume_points.empty()) {
+        for (auto& p : remaining_tasks) {
+            for (auto& task : p.second) erase_checkpointed_calls(task, resume_points);
+        }
+    }
     resolve_connecting_calls(remaining_tasks, calling_components);
     write(std::move(remaining_tasks), temp_vcfs);
 }
 
-auto extract_writers(TempVcfWriterMap&& vcfs)
+auto extract_writers(TempVcfWriterMap&& vcfs, const std::vector<ContigName>& contigs)
 {
     std::vector<VcfWriter> result {};
     result.reserve(vcfs.size());
-    for (auto&& p : vcfs) {
-        result.push_back(std::move(p.second));
+    for (const auto& contig : contigs) {
+        const auto itr = vcfs.find(contig);
+        if (itr != std::end(vcfs)) {
+            result.push_back(std::move(itr->second));
+        }
     }
     vcfs.clear();
     return result;
 }
 
-auto extract_as_readers(TempVcfWriterMap&& vcfs)
+auto extract_as_readers(TempVcfWriterMap&& vcfs, const std::vector<ContigName>& contigs)
+{
+    return writers_to_readers(extract_writers(std::move(vcfs), contigs));
+}
+
+// Each contig's checkpointed segments come before the calls written since the last checkpoint
+auto extract_as_readers(TempVcfWriterMap&& vcfs, const CallingCheckpoint& checkpoint, const std::vector<ContigName>& contigs)
 {
-    return writers_to_readers(extract_writers(std::move(vcfs)));
+    std::vector<VcfReader> result {};
+    for (const auto& contig : contigs) {
+        for (const auto& segment : checkpoint.segments(contig)) {
+            result.emplace_back(segment);
+        }
+        const auto itr = vcfs.find(contig);
+        if (itr != std::end(vcfs)) {
+            auto& writer = itr->second;
+            const auto path = *writer.path();
+            writer.close();
+            result.emplace_back(path);
+        }
+    }
+    vcfs.clear();
+    return result;
 }
 
 void merge(TempVcfWriterMap&& temp_vcf_writers, GenomeCallingComponents& components)
 {
     static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Merging " << temp_vcf_writers.size() << " temporary VCF files";
-    auto temp_readers = extract_as_readers(std::move(temp_vcf_writers));
-    merge(temp_readers, components.output(), components.contigs());
+    // Temp files are written one per contig in contig order, so can be concatenated
+    const auto checkpoint = components.checkpoint();
+    auto temp_readers = checkpoint ? extract_as_readers(std::move(temp_vcf_writers), *checkpoint, components.contigs())
+                                   : extract_as_readers(std::move(temp_vcf_writers), components.contigs());
+    if (is_block_concatenable(temp_readers, components.output())) {
+        if (debug_log) stream(*debug_log) << "Concatenating " << temp_readers.size() << " temporary VCF files";
+        concatenate(temp_readers, components.output());
+    } else {
+        if (debug_log) stream(*debug_log) << "Merging " << temp_readers.size() << " temporary VCF files";
+        merge(temp_readers, components.output(), components.contigs());
+    }
+}
+
+boost::optional<TaskMemoryBudget> make_memory_budget(const GenomeCallingComponents& components, const unsigned num_task_threads)
+{
+    const auto budget = components.working_memory_budget();
+    if (budget) {
+        return TaskMemoryBudget {budget->num_bytes(), num_task_threads};
+    } else {
+        return boost::none;
+    }
+}
+
+// Splits the task where about half of its reads are behind, rather than at the midpoint, as task
+// footprints follow the reads. Both halves are kept at least minTaskSize.
+auto split(const Task& task, const GenomeCallingComponents& components)
+{
+    const auto& region = task.region;
+    assert(size(region) >= 2 * minTaskSize);
+    auto mid = region.begin() + size(region) / 2;
+    const auto& samples = components.samples();
+    const auto num_reads = components.read_manager().count_reads(samples, region);
+    if (num_reads > 1) {
+        const auto head = components.read_manager().find_covered_subregion(samples, region, num_reads / 2);
+        mid = std::max(std::min(head.end(), region.end() - minTaskSize), region.begin() + minTaskSize);
+    }
+    return std::make_pair(Task {GenomicRegion {region.contig_name(), region.begin(), mid}, task.policy},
+                          Task {GenomicRegion {region.contig_name(), mid, region.end()}, task.policy});
+}
+
+// Halves the task until its projected footprint fits in the budget, putting the right halves at the
+// front of held_tasks so they run next and each contig's tasks still run in order. Returns the projected
+// footprint if the task can be admitted now.
+boost::optional<std::size_t> try_admit(Task& task, std::deque<Task>& held_tasks, const TaskMemoryBudget& budget,
+                                       const GenomeCallingComponents& components)
+{
+    auto projected_footprint = budget.project(size(task.region));
+    while (!budget.can_admit(projected_footprint) && size(task.region) >= 2 * minTaskSize) {
+        auto halves = split(task, components);
+        held_tasks.push_front(std::move(halves.second));
+        task = std::move(halves.first);
+        projected_footprint = budget.project(size(task.region));
+    }
+    if (budget.can_admit(projected_footprint)) {
+        return projected_footprint;
+    } else {
+        return boost::none;
+    }
 }
 
 void run_octopus_multi_threaded(GenomeCallingComponents& components)
@@ -1075,17 +1294,27 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     
     const auto num_task_threads = calculate_num_task_threads(components);
     
+    const auto checkpoint = components.checkpoint();
+    // Taken before any threads start, as the task writer thread updates the checkpoint
+    const auto resume_points = get_resume_points(components);
+    if (!resume_points.empty()) {
+        logging::InfoLogger info_log {};
+        stream(info_log) << "Resuming from checkpoint in " << checkpoint->directory() << " with calls written for "
+                         << resume_points.size() << " of " << components.contigs().size() << " contigs";
+    }
+    
     TaskMap pending_tasks {components.contigs()};
     TaskMakerSyncPacket task_maker_sync {};
     task_maker_sync.batch_size_hint = 2 * num_task_threads;
     std::unique_lock<std::mutex> pending_task_lock {task_maker_sync.mutex, std::defer_lock};
-    auto task_maker_thread = make_task_maker_thread(pending_tasks, components, num_task_threads, task_maker_sync);
-    if (!task_maker_thread.joinable()) {
+    auto task_maker_thread = make_task_maker_thread(pending_tasks, components, resume_points, num_task_threads, task_maker_sync);
+    if (task_maker_thread.joinable()) {
+        task_maker_thread.detach();
+    } else if (!task_maker_sync.all_done) {
         logging::FatalLogger fatal_log {};
         fatal_log << "Unable to make task maker thread";
         return;
     }
-    task_maker_thread.detach();
     
     FutureCompletedTasks futures(num_task_threads);
     TaskMap running_tasks {ContigOrder {components.contigs()}};
@@ -1102,9 +1331,18 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     const auto calling_components = make_contig_calling_component_factory_map(components);
     unsigned num_idle_futures {0};
     
+    auto memory_budget = make_memory_budget(components, num_task_threads);
+    std::vector<std::size_t> task_footprints(num_task_threads, 0); // reserved by the task running in each future
+    // Tasks that have been taken from pending_tasks but not yet run, either deferred or split off.
+    // They must run before any more pending tasks.
+    std::deque<Task> held_tasks {};
+    bool deferred {false};
+    
     auto temp_writers = make_temp_vcf_writers(components);
+    boost::optional<TempVcfCheckpointer> checkpointer {};
+    if (checkpoint) checkpointer = TempVcfCheckpointer {*checkpoint, components};
     TaskWriterSyncPacket task_writer_sync {};
-    auto task_writer_thread = make_task_writer_thread(temp_writers, task_writer_sync);
+    auto task_writer_thread = make_task_writer_thread(temp_writers, task_writer_sync, checkpointer);
     if (!task_writer_thread.joinable()) {
         logging::FatalLogger fatal_log {};
         fatal_log << "Unable to make task writer thread";
@@ -1114,19 +1352,19 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     
     // Wait for the first task to be made
     const auto tasks_available = [&] () noexcept { return task_maker_sync.num_tasks > 0; };
-    while(task_maker_sync.num_tasks == 0) {
+    while(task_maker_sync.num_tasks == 0 && !task_maker_sync.all_done) {
         pending_task_lock.lock();
-        task_maker_sync.cv.wait(pending_task_lock, tasks_available);
+        task_maker_sync.cv.wait(pending_task_lock, [&] () noexcept { return tasks_available() || task_maker_sync.all_done; });
         pending_task_lock.unlock();
     }
     task_maker_sync.batch_size_hint = num_task_threads / 2;
     
     components.progress_meter().start();
     
-    while (!task_maker_sync.all_done || task_maker_sync.num_tasks > 0) {
+    while (!task_maker_sync.all_done || task_maker_sync.num_tasks > 0 || !held_tasks.empty()) {
         pending_task_lock.lock();
         assert(count_tasks(pending_tasks) == task_maker_sync.num_tasks);
-        if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0) {
+        if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0 && held_tasks.empty()) {
             task_maker_sync.batch_size_hint = std::max(num_idle_futures, num_task_threads / 2);
             if (num_idle_futures < futures.size()) {
                 // If there are running futures then it's good periodically check to see if
@@ -1141,9 +1379,16 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
         }
         pending_task_lock.unlock();
         num_idle_futures = 0;
-        for (auto& future : futures) {
+        deferred = false;
+        for (std::size_t i {0}; i < futures.size(); ++i) {
+            auto& future = futures[i];
             if (is_ready(future)) {
                 auto completed_task = future.get();
+                if (!resume_points.empty()) erase_checkpointed_calls(completed_task, resume_points);
+                if (memory_budget) {
+                    memory_budget->release(task_footprints[i], size(completed_task.region), completed_task.footprint);
+                    task_footprints[i] = 0;
+                }
                 const auto& contig = contig_name(completed_task.region);
                 write_or_buffer(std::move(completed_task), buffered_tasks.at(contig),
                                 running_tasks.at(contig), holdbacks.at(contig),
@@ -1151,21 +1396,47 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
                 --caller_sync.num_finished;
             }
             if (!future.valid()) {
-                pending_task_lock.lock();
-                if (task_maker_sync.num_tasks > 0) {
-                    pending_task_lock.unlock(); // As pop will need to lock the mutex too == deadlock
-                    auto task = pop(pending_tasks, task_maker_sync);
-                    future = run(task, calling_components.at(contig_name(task))(), caller_sync);
-                    running_tasks.at(contig_name(task)).push(std::move(task));
+                boost::optional<Task> task {};
+                if (!held_tasks.empty()) {
+                    if (!deferred) {
+                        task = std::move(held_tasks.front());
+                        held_tasks.pop_front();
+                    }
+                } else {
+                    pending_task_lock.lock();
+                    if (task_maker_sync.num_tasks > 0) {
+                        pending_task_lock.unlock(); // As pop will need to lock the mutex too == deadlock
+                        task = pop(pending_tasks, task_maker_sync);
+                    } else {
+                        pending_task_lock.unlock();
+                    }
+                }
+                if (task && memory_budget) {
+                    const auto footprint = try_admit(*task, held_tasks, *memory_budget, components);
+                    if (footprint) {
+                        memory_budget->reserve(*footprint);
+                        task_footprints[i] = *footprint;
+                    } else {
+                        if (debug_log) stream(*debug_log) << "Deferring task " << *task << " as its projected footprint "
+                                                          << MemoryFootprint {memory_budget->project(size(task->region))}
+                                                          << " exceeds the remaining working memory budget";
+                        held_tasks.push_front(std::move(*task));
+                        task = boost::none;
+                        deferred = true;
+                    }
+                }
+                if (task) {
+                    future = run(*task, calling_components.at(contig_name(*task))(), caller_sync);
+                    running_tasks.at(contig_name(*task)).push(std::move(*task));
                 } else {
-                    pending_task_lock.unlock();
                     ++num_idle_futures;
                 }
             }
         }
         // If there are no idle futures then all threads are busy and we must wait for one to finish,
-        // otherwise we must have run out of tasks, so we should wait for new ones.
-        if (num_idle_futures == 0 && caller_sync.num_finished == 0) {
+        // otherwise we must have run out of tasks, so we should wait for new ones. Deferred tasks
+        // can only run once a running task finishes and releases its memory.
+        if ((num_idle_futures == 0 || deferred) && caller_sync.num_finished == 0) {
             task_maker_sync.waiting = false;
             std::unique_lock<std::mutex> lock {caller_sync.mutex};
             caller_sync.cv.wait(lock, [&] () { return caller_sync.num_finished > 0; });
@@ -1180,9 +1451,10 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     holdbacks.clear(); // holdbacks are just references to buffered tasks
     if (debug_log) *debug_log << "Finished making new tasks. Waiting for task writer to complete existing jobs";
     wait_until_finished(task_writer_sync);
-    write_remaining_tasks(futures, buffered_tasks, temp_writers, calling_components);
+    write_remaining_tasks(futures, buffered_tasks, temp_writers, calling_components, resume_points);
     components.progress_meter().stop();
     merge(std::move(temp_writers), components);
+    if (checkpoint) checkpoint->remove();
 }
 
 } // namespace
@@ -1283,8 +1555,14 @@ void run_filtering(GenomeCallingComponents& components)
         if (components.sites_only()) {
             output_config.emit_sites_only = true;
         }
+        std::shared_ptr<const ReadSupportSidecarReader> calling_read_support {};
+        if (components.read_support_writer()) {
+            components.read_support_writer()->close();
+            calling_read_support = std::make_shared<ReadSupportSidecarReader>(components.read_support_writer()->path());
+        }
         const auto filter = filter_factory.make(components.reference(), std::move(buffered_rp),
-                                                output_config, progress, components.num_threads());
+                                                output_config, progress, components.num_threads(),
+                                                std::move(calling_read_support), components.temp_directory());
         assert(filter);
         const VcfReader in {std::move(*input_path)};
         VcfWriter& out {*components.filtered_output()};
@@ -1327,6 +1605,17 @@ void log_run_start(const GenomeCallingComponents& components)
     if (debug_log) print_input_regions(stream(*debug_log), components.search_regions());
 }
 
+void write_input_digest(const GenomeCallingComponents& components)
+{
+    const auto path = components.input_digest_path();
+    if (path) {
+        assert(components.input_digest());
+        components.input_digest()->write(*path);
+        logging::InfoLogger info_log {};
+        stream(info_log) << "Wrote input digest to " << *path;
+    }
+}
+
 class CallingBug : public ProgramError
 {
     std::string do_where() const override { return "run_octopus"; }
@@ -1395,6 +1684,7 @@ void run_octopus(GenomeCallingComponents& components, std::string command)
         logging::WarningLogger warn_log {};
         warn_log << "Failed to make legacy vcf";
     }
+    write_input_digest(components);
     const auto end = std::chrono::system_clock::now();
     const auto search_size = sum_region_sizes(components.search_regions());
     stream(info_log) << "Finished calling "
@@ -1403,4 +1693,145 @@ void run_octopus(GenomeCallingComponents& components, std::string command)
     cleanup(components);
 }
 
+namespace {
+
+class BadShardOutputs : public UserError
+{
+    std::string do_where() const override
+    {
+        return "merge_shards";
+    }
+    
+    std::string do_why() const override
+    {
+        return why_;
+    }
+    
+    std::string do_help() const override
+    {
+        return "Give the outputs of every --shard run, each made with the same number of shards";
+    }
+    
+    std::string why_;
+public:
+    BadShardOutputs(std::string why) : why_ {std::move(why)} {}
+};
+
+// Returns the shard outputs in shard order
+std::vector<VcfReader> open_shard_outputs(const std::vector<boost::filesystem::path>& paths)
+{
+    std::vector<boost::optional<VcfReader>> shards(paths.size());
+    for (const auto& path : paths) {
+        VcfReader reader {path};
+        const auto header = reader.fetch_header();
+        if (!header.has(shardKey)) {
+            throw BadShardOutputs {path.string() + " was not made with --shard"};
+        }
+        const auto shard = parse_shard(header.at(shardKey));
+        if (!shard) {
+            throw BadShardOutputs {path.string() + " has a malformed shard header line"};
+        }
+        if (shard->count() != paths.size()) {
+            std::ostringstream ss {};
+            ss << path << " is shard " << *shard << " but " << paths.size() << " shard outputs were given";
+            throw BadShardOutputs {ss.str()};
+        }
+        if (shards[shard->index()]) {
+            std::ostringstream ss {};
+            ss << path << " and " << shards[shard->index()]->path() << " are both shard " << *shard;
+            throw BadShardOutputs {ss.str()};
+        }
+        shards[shard->index()] = std::move(reader);
+    }
+    std::vector<VcfReader> result {};
+    result.reserve(shards.size());
+    for (auto& shard : shards) {
+        result.push_back(std::move(*shard));
+    }
+    return result;
+}
+
+// The calls of consecutive shards are joined exactly like consecutive thread tasks
+void merge_shard_calls(const std::vector<VcfReader>& shards, GenomeCallingComponents& components)
+{
+    static auto debug_log = get_debug_log();
+    std::vector<VcfHeader> headers {};
+    headers.reserve(shards.size());
+    for (const auto& shard : shards) {
+        headers.push_back(shard.fetch_header());
+    }
+    const auto calling_components = make_contig_calling_component_factory_map(components);
+    for (const auto& contig : components.contigs()) {
+        boost::optional<CompletedTask> holdback {};
+        for (std::size_t i {0}; i < shards.size(); ++i) {
+            if (!contig_line_exists(headers[i], contig)) continue;
+            auto calls = shards[i].fetch_records(contig);
+            if (calls.empty()) continue;
+            CompletedTask shard_task {encompassing_region(calls)};
+            shard_task.calls.assign(std::make_move_iterator(std::begin(calls)), std::make_move_iterator(std::end(calls)));
+            calls.clear();
+            calls.shrink_to_fit();
+            if (holdback) {
+                resolve_connecting_calls(*holdback, shard_task, calling_components.at(contig));
+                if (debug_log) stream(*debug_log) << "Writing shard calls in " << *holdback;
+                write_calls(std::move(holdback->calls), components.output());
+            }
+            holdback = std::move(shard_task);
+        }
+        if (holdback) {
+            if (debug_log) stream(*debug_log) << "Writing shard calls in " << *holdback;
+            write_calls(std::move(holdback->calls), components.output());
+        }
+    }
+}
+
+} // namespace
+
+void merge_shards(GenomeCallingComponents& components, const std::vector<boost::filesystem::path>& shard_outputs,
+                  std::string command)
+{
+    static auto debug_log = get_debug_log();
+    logging::InfoLogger info_log {};
+    using utils::TimeInterval;
+    
+    const auto shards = open_shard_outputs(shard_outputs);
+    stream(info_log) << "Merging " << shards.size() << " shard outputs";
+    write_caller_output_header(components, command);
+    const auto start = std::chrono::system_clock::now();
+    try {
+        merge_shard_calls(shards, components);
+    } catch (const Error& e) {
+        try {
+            if (debug_log) *debug_log << "Encountered an error whilst merging shards, attempting to cleanup";
+            cleanup(components);
+        } catch (...) {}
+        throw;
+    } catch (const std::exception& e) {
+        try {
+            if (debug_log) *debug_log << "Encountered an error whilst merging shards, attempting to cleanup";
+            cleanup(components);
+        } catch (...) {}
+        throw CallingBug {e};
+    }
+    components.output().close();
+    try {
+        run_filtering(components);
+    } catch (...) {
+        try {
+            if (debug_log) *debug_log << "Encountered an error whilst filtering, attempting to cleanup";
+            cleanup(components);
+        } catch (...) {}
+        throw CallingBug {};
+    }
+    try {
+        run_legacy_generation(components);
+    } catch (...) {
+        logging::WarningLogger warn_log {};
+        warn_log << "Failed to make legacy vcf";
+    }
+    const auto end = std::chrono::system_clock::now();
+    stream(info_log) << "Finished merging shards, total runtime " << TimeInterval {start, end};
+    cleanup(components);
+}
+
 } // namespace octopus
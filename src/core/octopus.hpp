@@ -5,6 +5,9 @@
 #define octopus_hpp
 
 #include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
 
 #include "calling_components.hpp"
 
@@ -12,6 +15,10 @@ namespace octopus {
 
 void run_octopus(GenomeCallingComponents& components, std::string command);
 
+// Merges the outputs of --shard runs into the final output, as if the shards had been called in one run
+void merge_shards(GenomeCallingComponents& components, const std::vector<boost::filesystem::path>& shard_outputs,
+                  std::string command);
+
 }
 
 #endif
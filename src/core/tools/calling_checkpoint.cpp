@@ -0,0 +1,337 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "calling_checkpoint.hpp"
+
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <iomanip>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "utils/string_utils.hpp"
+#include "exceptions/user_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+#include "exceptions/system_error.hpp"
+
+namespace octopus {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::string manifestName {"checkpoint.txt"};
+const std::string manifestFormat {"##octopus-checkpoint=2"};
+const std::string inputsLinePrefix {"##inputs="};
+const std::string sampleLinePrefix {"##sample="};
+const std::string contigLinePrefix {"##contig="};
+
+class ExistingCheckpoint : public UserError
+{
+    std::string do_where() const override
+    {
+        return "CallingCheckpoint";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "The checkpoint directory " << directory_ << " already contains a checkpoint";
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Add --resume to continue the checkpointed run, or use a different checkpoint directory";
+    }
+    
+    fs::path directory_;
+public:
+    ExistingCheckpoint(fs::path directory) : directory_ {std::move(directory)} {};
+};
+
+class MismatchedCheckpoint : public UserError
+{
+    std::string do_where() const override
+    {
+        return "CallingCheckpoint";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "The checkpoint in " << directory_ << " was made for different " << what_;
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Resume with the same inputs and options as the checkpointed run, or use a different checkpoint directory";
+    }
+    
+    fs::path directory_;
+    std::string what_;
+public:
+    MismatchedCheckpoint(fs::path directory, std::string what) : directory_ {std::move(directory)}, what_ {std::move(what)} {};
+};
+
+class MalformedCheckpoint : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "CallingCheckpoint";
+    }
+public:
+    MalformedCheckpoint(fs::path file) : MalformedFileError {std::move(file)} {}
+};
+
+class CheckpointWriteError : public SystemError
+{
+    std::string do_where() const override
+    {
+        return "CallingCheckpoint";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "Could not write checkpoint file " << file_;
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Check there is space on the device and that the checkpoint directory is writable";
+    }
+    
+    fs::path file_;
+public:
+    CheckpointWriteError(fs::path file) : file_ {std::move(file)} {}
+};
+
+bool starts_with(const std::string& line, const std::string& prefix)
+{
+    return line.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Closing a file does not put its data on disk, so without a sync a power loss after the manifest is
+// replaced could leave recorded segments, or the manifest itself, truncated
+void sync(const fs::path& file)
+{
+    const auto fd = ::open(file.c_str(), O_RDONLY);
+    if (fd == -1) throw CheckpointWriteError {file};
+    const auto status = ::fsync(fd);
+    ::close(fd);
+    if (status != 0) throw CheckpointWriteError {file};
+}
+
+// Makes a rename in directory durable. Not all file systems support syncing directories, so this
+// is best effort.
+void sync_directory(const fs::path& directory) noexcept
+{
+    const auto fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd != -1) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+std::string to_hex(const CallingCheckpoint::Digest digest)
+{
+    std::ostringstream ss {};
+    ss << std::hex << std::setw(16) << std::setfill('0') << digest;
+    return ss.str();
+}
+
+} // namespace
+
+CallingCheckpoint::CallingCheckpoint(Path directory, std::vector<SampleName> samples, std::vector<ContigName> contigs,
+                                     const Digest inputs, const bool resume)
+: directory_ {std::move(directory)}
+, samples_ {std::move(samples)}
+, contigs_ {std::move(contigs)}
+, inputs_ {inputs}
+, progress_ {}
+{
+    progress_.reserve(contigs_.size());
+    for (const auto& contig : contigs_) {
+        progress_.emplace(contig, ContigProgress {});
+    }
+    if (fs::exists(directory_ / manifestName)) {
+        if (!resume) throw ExistingCheckpoint {directory_};
+        load();
+    } else {
+        fs::create_directories(directory_);
+    }
+    remove_unrecorded_segments();
+    save();
+}
+
+const CallingCheckpoint::Path& CallingCheckpoint::directory() const
+{
+    return directory_;
+}
+
+boost::optional<CallingCheckpoint::ResumePoint> CallingCheckpoint::resume_point(const ContigName& contig) const
+{
+    const auto itr = progress_.find(contig);
+    if (itr != std::cend(progress_) && !itr->second.segments.empty()) {
+        return itr->second.segments.back().resume_point;
+    } else {
+        return boost::none;
+    }
+}
+
+std::vector<CallingCheckpoint::Path> CallingCheckpoint::segments(const ContigName& contig) const
+{
+    std::vector<Path> result {};
+    const auto itr = progress_.find(contig);
+    if (itr != std::cend(progress_)) {
+        result.reserve(itr->second.segments.size());
+        for (const auto& segment : itr->second.segments) {
+            result.push_back(directory_ / segment.file);
+        }
+    }
+    return result;
+}
+
+CallingCheckpoint::Path CallingCheckpoint::make_segment_path(const ContigName& contig)
+{
+    auto& progress = progress_.at(contig);
+    return directory_ / (contig + "." + std::to_string(progress.num_segments_made++) + ".bcf");
+}
+
+void CallingCheckpoint::record(const ContigName& contig, const Path& segment, const ResumePoint resume_point)
+{
+    sync(segment);
+    Path index {segment.string() + ".csi"};
+    if (fs::exists(index)) sync(index);
+    progress_.at(contig).segments.push_back({segment.filename(), resume_point});
+    save();
+}
+
+void CallingCheckpoint::remove()
+{
+    fs::remove_all(directory_);
+}
+
+bool is_after(const CallingCheckpoint::ResumePoint& resume_point,
+              const CallingCheckpoint::Position begin, const CallingCheckpoint::Position end) noexcept
+{
+    return begin > resume_point.begin || (begin == resume_point.begin && end > resume_point.end);
+}
+
+// private methods
+
+void CallingCheckpoint::load()
+{
+    const auto manifest_path = directory_ / manifestName;
+    fs::ifstream manifest {manifest_path};
+    std::string line;
+    if (!std::getline(manifest, line) || line != manifestFormat) {
+        throw MalformedCheckpoint {manifest_path};
+    }
+    boost::optional<std::string> inputs {};
+    std::vector<SampleName> samples {};
+    std::vector<ContigName> contigs {};
+    while (std::getline(manifest, line)) {
+        if (starts_with(line, inputsLinePrefix)) {
+            inputs = line.substr(inputsLinePrefix.size());
+        } else if (starts_with(line, sampleLinePrefix)) {
+            samples.push_back(line.substr(sampleLinePrefix.size()));
+        } else if (starts_with(line, contigLinePrefix)) {
+            contigs.push_back(line.substr(contigLinePrefix.size()));
+        } else if (!line.empty()) {
+            // contig, segment, last call begin, last call end
+            const auto fields = utils::split(line, '\t');
+            if (fields.size() != 4 || progress_.count(fields[0]) == 0) {
+                throw MalformedCheckpoint {manifest_path};
+            }
+            auto& progress = progress_.at(fields[0]);
+            try {
+                const ResumePoint resume_point {boost::lexical_cast<Position>(fields[2]), boost::lexical_cast<Position>(fields[3])};
+                progress.segments.push_back({fields[1], resume_point});
+            } catch (const boost::bad_lexical_cast&) {
+                throw MalformedCheckpoint {manifest_path};
+            }
+            ++progress.num_segments_made;
+        }
+    }
+    if (samples != samples_) {
+        throw MismatchedCheckpoint {directory_, "samples"};
+    }
+    if (contigs != contigs_) {
+        throw MismatchedCheckpoint {directory_, "contigs"};
+    }
+    if (!inputs) {
+        throw MalformedCheckpoint {manifest_path};
+    }
+    if (*inputs != to_hex(inputs_)) {
+        throw MismatchedCheckpoint {directory_, "inputs or options"};
+    }
+}
+
+void CallingCheckpoint::save() const
+{
+    // Written and synced to a temporary file, then renamed over the manifest, so an interruption
+    // leaves either the old or the new manifest, never a partial one
+    const auto manifest_path = directory_ / manifestName;
+    auto tmp_path = manifest_path;
+    tmp_path += ".tmp";
+    {
+        fs::ofstream tmp {tmp_path};
+        tmp << manifestFormat << '\n';
+        tmp << inputsLinePrefix << to_hex(inputs_) << '\n';
+        for (const auto& sample : samples_) {
+            tmp << sampleLinePrefix << sample << '\n';
+        }
+        for (const auto& contig : contigs_) {
+            tmp << contigLinePrefix << contig << '\n';
+        }
+        for (const auto& contig : contigs_) {
+            for (const auto& segment : progress_.at(contig).segments) {
+                tmp << contig << '\t' << segment.file.string() << '\t'
+                    << segment.resume_point.begin << '\t' << segment.resume_point.end << '\n';
+            }
+        }
+        tmp.close();
+        if (!tmp) throw CheckpointWriteError {tmp_path};
+    }
+    sync(tmp_path);
+    fs::rename(tmp_path, manifest_path);
+    sync_directory(directory_);
+}
+
+void CallingCheckpoint::remove_unrecorded_segments() const
+{
+    std::vector<Path> recorded {};
+    for (const auto& p : progress_) {
+        std::transform(std::cbegin(p.second.segments), std::cend(p.second.segments), std::back_inserter(recorded),
+                       [] (const auto& segment) { return segment.file; });
+    }
+    std::sort(std::begin(recorded), std::end(recorded));
+    std::vector<Path> unrecorded {};
+    for (fs::directory_iterator itr {directory_}, last {}; itr != last; ++itr) {
+        const auto file_name = itr->path().filename();
+        const auto extension = file_name.extension().string();
+        // Segment indices are named <segment>.csi, and are kept with their segment
+        const auto segment_name = extension == ".csi" ? file_name.stem() : file_name;
+        if ((extension == ".bcf" || extension == ".csi")
+            && !std::binary_search(std::cbegin(recorded), std::cend(recorded), segment_name)) {
+            unrecorded.push_back(itr->path());
+        }
+    }
+    for (const auto& path : unrecorded) {
+        fs::remove(path);
+    }
+}
+
+} // namespace octopus
@@ -0,0 +1,104 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef calling_checkpoint_hpp
+#define calling_checkpoint_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+
+namespace octopus {
+
+// Records the calls that a multi-threaded run has durably written, so an interrupted run can be
+// resumed without calling those regions again.
+//
+// The calls of each contig are written to a sequence of segment files in the checkpoint directory.
+// A segment is only recorded once it has been closed and synced to disk, and the manifest is synced
+// and then replaced atomically, so every recorded segment is complete even after a power loss.
+// Unrecorded segment files are partial, and are removed on resume.
+//
+// Not thread safe.
+class CallingCheckpoint
+{
+public:
+    using Path       = boost::filesystem::path;
+    using ContigName = GenomicRegion::ContigName;
+    using Position   = GenomicRegion::Position;
+    using Digest     = std::uint64_t;
+    
+    // The region of the last call written for a contig. Calling resumes from the end of the call, and
+    // resumed calls that begin before it would be out of order with the calls already written.
+    struct ResumePoint
+    {
+        Position begin, end;
+    };
+    
+    CallingCheckpoint() = delete;
+    
+    // Starts a new checkpoint in directory, or continues the one there if resume is true. Throws if
+    // directory already holds a checkpoint and resume is false, or if it holds a checkpoint made
+    // for different samples, contigs, or calling inputs (a digest of the configuration and input files).
+    CallingCheckpoint(Path directory, std::vector<SampleName> samples, std::vector<ContigName> contigs,
+                      Digest inputs, bool resume);
+    
+    CallingCheckpoint(const CallingCheckpoint&)            = delete;
+    CallingCheckpoint& operator=(const CallingCheckpoint&) = delete;
+    CallingCheckpoint(CallingCheckpoint&&)                 = default;
+    CallingCheckpoint& operator=(CallingCheckpoint&&)      = default;
+    
+    ~CallingCheckpoint() = default;
+    
+    const Path& directory() const;
+    
+    boost::optional<ResumePoint> resume_point(const ContigName& contig) const;
+    
+    // The recorded segments of contig, in the order they were written
+    std::vector<Path> segments(const ContigName& contig) const;
+    
+    Path make_segment_path(const ContigName& contig);
+    
+    // Syncs segment, and its index if there is one, to disk before recording it
+    void record(const ContigName& contig, const Path& segment, ResumePoint resume_point);
+    
+    // Removes the checkpoint directory, once the segments are no longer needed
+    void remove();
+    
+private:
+    struct Segment
+    {
+        Path file; // relative to directory_
+        ResumePoint resume_point;
+    };
+    
+    struct ContigProgress
+    {
+        std::vector<Segment> segments;
+        unsigned num_segments_made = 0;
+    };
+    
+    Path directory_;
+    std::vector<SampleName> samples_;
+    std::vector<ContigName> contigs_;
+    Digest inputs_;
+    std::unordered_map<ContigName, ContigProgress> progress_;
+    
+    void load();
+    void save() const;
+    void remove_unrecorded_segments() const;
+};
+
+// True if a call mapped to [begin, end) is ordered after the last call written before resume_point
+// was recorded, and so has not already been written
+bool is_after(const CallingCheckpoint::ResumePoint& resume_point,
+              CallingCheckpoint::Position begin, CallingCheckpoint::Position end) noexcept;
+
+} // namespace octopus
+
+#endif
@@ -17,9 +17,9 @@
 #include "concepts/mappable.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/append.hpp"
+#include "logging/profiler.hpp"
 
 #include <iostream> // DEBUG
-#include "timers.hpp"
 
 #define _unused(x) ((void)(x))
 
@@ -281,6 +281,7 @@ bool has_rhs_sandwich_insertion(const MappableFlatSet<Allele>& alleles, const Ge
 
 HaplotypeGenerator::HaplotypePacket HaplotypeGenerator::generate()
 {
+    profiling::ScopedTimer timer {profiling::Stage::haplotype_generation};
     if (alleles_.empty()) {
         return std::make_tuple(std::vector<Haplotype> {}, boost::none, boost::none);
     }
@@ -288,6 +289,7 @@ HaplotypeGenerator::HaplotypePacket HaplotypeGenerator::generate()
     const auto haplotype_region = calculate_haplotype_region();
     assert(contains(haplotype_region, active_region_));
     auto haplotypes = tree_.extract_haplotypes(haplotype_region);
+    profiling::count(profiling::Counter::haplotypes, haplotypes.size());
     if (!(is_lagging_enabled() || in_holdout_mode())) tree_.clear();
     return std::make_tuple(std::move(haplotypes), active_region_, holdout_region_);
 }
@@ -0,0 +1,270 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "input_digest.hpp"
+
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <functional>
+#include <iomanip>
+#include <cstdint>
+#include <cctype>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "basics/aligned_read.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/stable_hash.hpp"
+#include "exceptions/missing_file_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+#include "exceptions/system_error.hpp"
+
+namespace octopus {
+
+namespace fs = boost::filesystem;
+
+constexpr GenomicRegion::Size InputDigest::blockSize;
+constexpr unsigned InputDigest::formatVersion;
+
+namespace {
+
+const std::string formatLinePrefix {"##octopus-input-digest="};
+const std::string configurationLinePrefix {"##configuration="};
+
+class MissingInputDigest : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "InputDigest";
+    }
+public:
+    MissingInputDigest(fs::path file) : MissingFileError {std::move(file), "input digest"} {};
+};
+
+class MalformedInputDigest : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "InputDigest";
+    }
+public:
+    MalformedInputDigest(fs::path file) : MalformedFileError {std::move(file)} {}
+};
+
+class InputDigestWriteError : public SystemError
+{
+    std::string do_where() const override
+    {
+        return "InputDigest::write";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "Could not write input digest " << file_;
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Check there is space on the device and that the file is writable";
+    }
+    
+    fs::path file_;
+public:
+    InputDigestWriteError(fs::path file) : file_ {std::move(file)} {}
+};
+
+bool starts_with(const std::string& line, const std::string& prefix)
+{
+    return line.compare(0, prefix.size(), prefix) == 0;
+}
+
+auto make_blocks(const GenomicRegion& region)
+{
+    std::vector<GenomicRegion> result {};
+    auto block_begin = region.begin();
+    while (block_begin < region.end()) {
+        const auto block_end = std::min((block_begin / InputDigest::blockSize + 1) * InputDigest::blockSize, region.end());
+        result.emplace_back(region.contig_name(), block_begin, block_end);
+        block_begin = block_end;
+    }
+    return result;
+}
+
+void hash_flags(const AlignedRead& read, utils::StableHasher& hasher)
+{
+    const auto flags = read.flags();
+    std::uint64_t bits {0};
+    for (const bool flag : {flags.multiple_segment_template, flags.all_segments_in_read_aligned, flags.unmapped,
+                            flags.reverse_mapped, flags.secondary_alignment, flags.qc_fail, flags.duplicate,
+                            flags.supplementary_alignment, flags.first_template_segment, flags.last_template_segment}) {
+        bits = (bits << 1) | flag;
+    }
+    hasher.update(bits);
+}
+
+// Everything read filters and the caller look at: the alignment, the flags, and the template
+void hash_read(const AlignedRead& read, utils::StableHasher& hasher)
+{
+    hasher.update(read.name());
+    hasher.update(read.mapped_region().begin());
+    hasher.update(read.mapped_region().end());
+    hasher.update(read.cigar().size());
+    for (const auto& op : read.cigar()) {
+        hasher.update(op.size());
+        hasher.update(static_cast<std::uint64_t>(op.flag()));
+    }
+    hasher.update(read.mapping_quality());
+    hasher.update(read.sequence());
+    hasher.update(read.base_qualities().data(), read.base_qualities().size() * sizeof(AlignedRead::BaseQuality));
+    hash_flags(read, hasher);
+    hasher.update(read.has_other_segment());
+    if (read.has_other_segment()) {
+        const auto& mate = read.next_segment();
+        hasher.update(mate.contig_name());
+        hasher.update(mate.begin());
+        hasher.update(mate.inferred_template_length());
+        hasher.update(mate.is_marked_unmapped());
+        hasher.update(mate.is_marked_reverse_mapped());
+    }
+}
+
+InputDigest::Digest digest(const GenomicRegion& block, const ReferenceGenome& reference,
+                           const ReadManager& read_manager, const std::vector<SampleName>& samples)
+{
+    utils::StableHasher hasher {};
+    hasher.update(reference.fetch_sequence(block));
+    const auto reads = read_manager.fetch_reads(samples, block);
+    for (const auto& sample : samples) {
+        hasher.update(sample);
+        const auto sample_reads = reads.find(sample);
+        if (sample_reads != std::cend(reads)) {
+            hasher.update(sample_reads->second.size());
+            for (const auto& read : sample_reads->second) {
+                hash_read(read, hasher);
+            }
+        } else {
+            hasher.update(std::uint64_t {0});
+        }
+    }
+    return hasher.digest();
+}
+
+std::string to_hex(const InputDigest::Digest digest)
+{
+    std::ostringstream ss {};
+    ss << std::hex << std::setw(16) << std::setfill('0') << digest;
+    return ss.str();
+}
+
+InputDigest::Digest from_hex(const std::string& str)
+{
+    if (str.size() != 16 || !std::all_of(std::cbegin(str), std::cend(str), [] (char c) { return std::isxdigit(c); })) {
+        throw boost::bad_lexical_cast {};
+    }
+    return std::stoull(str, nullptr, 16);
+}
+
+} // namespace
+
+InputDigest::InputDigest(const std::string& configuration, const ReferenceGenome& reference, const ReadManager& read_manager,
+                         const std::vector<SampleName>& samples, const InputRegionMap& regions)
+: version_ {formatVersion}
+, configuration_ {}
+, blocks_ {}
+{
+    utils::StableHasher hasher {};
+    hasher.update(configuration);
+    hasher.update(reference.name());
+    for (const auto& sample : samples) hasher.update(sample);
+    configuration_ = hasher.digest();
+    for (const auto& p : regions) {
+        for (const auto& region : p.second) {
+            for (auto& block : make_blocks(region)) {
+                const auto block_digest = digest(block, reference, read_manager, samples);
+                blocks_.push_back({std::move(block), block_digest});
+            }
+        }
+    }
+    // Region maps are unordered, but the written digest should only depend on the inputs
+    std::sort(std::begin(blocks_), std::end(blocks_), [] (const Block& lhs, const Block& rhs) {
+        if (lhs.region.contig_name() != rhs.region.contig_name()) return lhs.region.contig_name() < rhs.region.contig_name();
+        return lhs.region.begin() < rhs.region.begin();
+    });
+}
+
+InputDigest::InputDigest(const Path& file)
+: version_ {}
+, configuration_ {}
+, blocks_ {}
+{
+    if (!fs::exists(file)) throw MissingInputDigest {file};
+    fs::ifstream in {file};
+    std::string line;
+    if (!std::getline(in, line) || !starts_with(line, formatLinePrefix)) {
+        throw MalformedInputDigest {file};
+    }
+    try {
+        version_ = boost::lexical_cast<unsigned>(line.substr(formatLinePrefix.size()));
+        // Digests written by other versions hash differently, so none of their blocks can match
+        if (version_ != formatVersion) return;
+        if (!std::getline(in, line) || !starts_with(line, configurationLinePrefix)) {
+            throw MalformedInputDigest {file};
+        }
+        configuration_ = from_hex(line.substr(configurationLinePrefix.size()));
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            // contig, begin, end, digest
+            const auto fields = utils::split(line, '\t');
+            if (fields.size() != 4) throw MalformedInputDigest {file};
+            GenomicRegion region {fields[0], boost::lexical_cast<GenomicRegion::Position>(fields[1]),
+                                  boost::lexical_cast<GenomicRegion::Position>(fields[2])};
+            blocks_.push_back({std::move(region), from_hex(fields[3])});
+        }
+    } catch (const boost::bad_lexical_cast&) {
+        throw MalformedInputDigest {file};
+    }
+}
+
+std::size_t InputDigest::num_blocks() const noexcept
+{
+    return blocks_.size();
+}
+
+InputRegionMap InputDigest::unchanged_blocks(const InputDigest& previous) const
+{
+    InputRegionMap result {};
+    if (version_ != previous.version_ || configuration_ != previous.configuration_) return result;
+    std::unordered_map<GenomicRegion, Digest> previous_digests {};
+    previous_digests.reserve(previous.blocks_.size());
+    for (const auto& block : previous.blocks_) {
+        previous_digests.emplace(block.region, block.digest);
+    }
+    for (const auto& block : blocks_) {
+        const auto itr = previous_digests.find(block.region);
+        if (itr != std::cend(previous_digests) && itr->second == block.digest) {
+            result[block.region.contig_name()].insert(block.region);
+        }
+    }
+    return result;
+}
+
+void InputDigest::write(const Path& file) const
+{
+    fs::ofstream out {file};
+    out << formatLinePrefix << version_ << '\n';
+    out << configurationLinePrefix << to_hex(configuration_) << '\n';
+    for (const auto& block : blocks_) {
+        out << block.region.contig_name() << '\t' << block.region.begin() << '\t' << block.region.end()
+            << '\t' << to_hex(block.digest) << '\n';
+    }
+    out.close();
+    if (!out) throw InputDigestWriteError {file};
+}
+
+} // namespace octopus
@@ -0,0 +1,72 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef input_digest_hpp
+#define input_digest_hpp
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/filesystem/path.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "io/read/read_manager.hpp"
+
+namespace octopus {
+
+// Digests of the calling inputs of fixed size blocks of the search regions, so a later run can tell
+// which blocks would be called the same. A block digest covers the reference sequence and the reads
+// of each sample overlapping the block; the configuration digest covers the samples and the options
+// that affect calling. Digests are stable content hashes, so they can be compared between runs on
+// different machines and builds.
+class InputDigest
+{
+public:
+    using Path   = boost::filesystem::path;
+    using Digest = std::uint64_t;
+    
+    static constexpr GenomicRegion::Size blockSize {100'000};
+    // Bumped whenever the way digests are computed changes
+    static constexpr unsigned formatVersion {2};
+    
+    InputDigest() = delete;
+    
+    InputDigest(const std::string& configuration, const ReferenceGenome& reference, const ReadManager& read_manager,
+                const std::vector<SampleName>& samples, const InputRegionMap& regions);
+    
+    // Reads a digest written by write
+    InputDigest(const Path& file);
+    
+    InputDigest(const InputDigest&)            = default;
+    InputDigest& operator=(const InputDigest&) = default;
+    InputDigest(InputDigest&&)                 = default;
+    InputDigest& operator=(InputDigest&&)      = default;
+    
+    ~InputDigest() = default;
+    
+    std::size_t num_blocks() const noexcept;
+    
+    // The blocks of this digest with the same inputs in previous
+    InputRegionMap unchanged_blocks(const InputDigest& previous) const;
+    
+    void write(const Path& file) const;
+    
+private:
+    struct Block
+    {
+        GenomicRegion region;
+        Digest digest;
+    };
+    
+    unsigned version_;
+    Digest configuration_;
+    std::vector<Block> blocks_;
+};
+
+} // namespace octopus
+
+#endif
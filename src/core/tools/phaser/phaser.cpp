@@ -16,8 +16,6 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/maths.hpp"
 
-#include "timers.hpp"
-
 namespace octopus {
 
 Phaser::Phaser(Phred<double> min_phase_score) : min_phase_score_ {min_phase_score} {}
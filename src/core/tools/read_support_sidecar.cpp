@@ -0,0 +1,266 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "read_support_sidecar.hpp"
+
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include <boost/functional/hash.hpp>
+
+#include "core/types/variant.hpp"
+
+namespace octopus {
+
+constexpr std::uint32_t ReadSupportRecord::unassigned;
+
+ReadSupportRecord::ReadId make_read_support_id(const AlignedRead& read)
+{
+    // Reads may be fetched through a different read pipe for filtering, so only use fields that
+    // read transforms do not modify.
+    std::size_t result {};
+    using boost::hash_combine;
+    hash_combine(result, read.name());
+    hash_combine(result, mapped_begin(read));
+    hash_combine(result, read.is_marked_reverse_mapped());
+    return result;
+}
+
+std::vector<ContigAllele> extract_nonreference_alleles(const Haplotype& haplotype, const ReferenceGenome& reference)
+{
+    const Haplotype ref {mapped_region(haplotype), reference};
+    const auto variants = haplotype.difference(ref);
+    std::vector<ContigAllele> result {};
+    result.reserve(variants.size());
+    for (const auto& variant : variants) {
+        result.push_back(demote(variant.alt_allele()));
+    }
+    return result;
+}
+
+std::vector<Haplotype> make_haplotypes(const GenomicRegion& region, const ReadSupportRecord::Sample& sample,
+                                       const ReferenceGenome& reference)
+{
+    std::vector<Haplotype> result {};
+    result.reserve(sample.haplotypes.size());
+    for (const auto& alleles : sample.haplotypes) {
+        Haplotype::Builder builder {region, reference};
+        for (const auto& allele : alleles) {
+            builder.push_back(allele);
+        }
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+const ReadSupportRecord::Read* find_read(const ReadSupportRecord::Sample& sample, const ReadSupportRecord::ReadId id) noexcept
+{
+    const auto itr = std::lower_bound(std::cbegin(sample.reads), std::cend(sample.reads), id,
+                                      [] (const auto& read, const auto id) { return read.id < id; });
+    if (itr != std::cend(sample.reads) && itr->id == id) {
+        return &(*itr);
+    } else {
+        return nullptr;
+    }
+}
+
+namespace {
+
+// Records are stored as a length prefixed payload so the index can be built without decoding them.
+// Values use the native byte order as sidecars never outlive the run that created them.
+
+template <typename T>
+void put(std::string& buffer, const T value)
+{
+    const auto data = reinterpret_cast<const char*>(&value);
+    buffer.append(data, sizeof(T));
+}
+
+void put(std::string& buffer, const std::string& value)
+{
+    put(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+template <typename T>
+T get(std::istream& in)
+{
+    T result;
+    if (!in.read(reinterpret_cast<char*>(&result), sizeof(T))) {
+        throw std::runtime_error {"ReadSupportSidecarReader: unexpected end of file"};
+    }
+    return result;
+}
+
+template <>
+std::string get<std::string>(std::istream& in)
+{
+    std::string result(get<std::uint32_t>(in), '\0');
+    if (!result.empty() && !in.read(&result[0], result.size())) {
+        throw std::runtime_error {"ReadSupportSidecarReader: unexpected end of file"};
+    }
+    return result;
+}
+
+using PayloadSize = std::uint64_t;
+
+std::string serialise(const ReadSupportRecord& record)
+{
+    std::string result {};
+    put(result, PayloadSize {0});
+    put(result, record.region.contig_name());
+    put(result, static_cast<std::uint32_t>(record.region.begin()));
+    put(result, static_cast<std::uint32_t>(record.region.end()));
+    put(result, static_cast<std::uint32_t>(record.samples.size()));
+    for (const auto& p : record.samples) {
+        put(result, p.first);
+        put(result, static_cast<std::uint32_t>(p.second.haplotypes.size()));
+        for (const auto& alleles : p.second.haplotypes) {
+            put(result, static_cast<std::uint32_t>(alleles.size()));
+            for (const auto& allele : alleles) {
+                put(result, static_cast<std::uint32_t>(mapped_begin(allele)));
+                put(result, static_cast<std::uint32_t>(mapped_end(allele)));
+                put(result, allele.sequence());
+            }
+        }
+        put(result, static_cast<std::uint32_t>(p.second.reads.size()));
+        for (const auto& read : p.second.reads) {
+            put(result, read.id);
+            put(result, read.haplotype);
+            put(result, read.margin);
+        }
+    }
+    const PayloadSize payload_size {result.size() - sizeof(PayloadSize)};
+    std::memcpy(&result[0], &payload_size, sizeof(PayloadSize));
+    return result;
+}
+
+GenomicRegion read_region(std::istream& in)
+{
+    auto contig = get<std::string>(in);
+    const auto begin = get<std::uint32_t>(in);
+    const auto end = get<std::uint32_t>(in);
+    return GenomicRegion {std::move(contig), begin, end};
+}
+
+ReadSupportRecord deserialise(std::istream& in)
+{
+    get<PayloadSize>(in);
+    ReadSupportRecord result {read_region(in), {}};
+    const auto num_samples = get<std::uint32_t>(in);
+    result.samples.reserve(num_samples);
+    for (std::uint32_t s {0}; s < num_samples; ++s) {
+        auto& sample = result.samples[get<std::string>(in)];
+        sample.haplotypes.resize(get<std::uint32_t>(in));
+        for (auto& alleles : sample.haplotypes) {
+            const auto num_alleles = get<std::uint32_t>(in);
+            alleles.reserve(num_alleles);
+            for (std::uint32_t i {0}; i < num_alleles; ++i) {
+                const auto begin = get<std::uint32_t>(in);
+                const auto end = get<std::uint32_t>(in);
+                alleles.emplace_back(ContigRegion {begin, end}, get<std::string>(in));
+            }
+        }
+        sample.reads.resize(get<std::uint32_t>(in));
+        for (auto& read : sample.reads) {
+            read.id = get<ReadSupportRecord::ReadId>(in);
+            read.haplotype = get<std::uint32_t>(in);
+            read.margin = get<float>(in);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+// ReadSupportSidecarWriter
+
+ReadSupportSidecarWriter::ReadSupportSidecarWriter(Path path)
+: path_ {std::move(path)}
+, file_ {path_.string(), std::ios::binary | std::ios::trunc}
+, mutex_ {}
+{
+    if (!file_) {
+        throw std::runtime_error {"ReadSupportSidecarWriter: could not open " + path_.string()};
+    }
+}
+
+const ReadSupportSidecarWriter::Path& ReadSupportSidecarWriter::path() const noexcept
+{
+    return path_;
+}
+
+void ReadSupportSidecarWriter::write(const ReadSupportRecord& record)
+{
+    const auto data = serialise(record);
+    std::lock_guard<std::mutex> lock {mutex_};
+    file_.write(data.data(), data.size());
+}
+
+void ReadSupportSidecarWriter::close()
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (file_.is_open()) file_.close();
+}
+
+// ReadSupportSidecarReader
+
+ReadSupportSidecarReader::ReadSupportSidecarReader(Path path)
+: path_ {std::move(path)}
+, file_ {path_.string(), std::ios::binary}
+, index_ {}
+, mutex_ {}
+{
+    if (!file_) {
+        throw std::runtime_error {"ReadSupportSidecarReader: could not open " + path_.string()};
+    }
+    build_index();
+}
+
+std::vector<ReadSupportRecord> ReadSupportSidecarReader::fetch(const GenomicRegion& region) const
+{
+    std::vector<ReadSupportRecord> result {};
+    const auto itr = index_.find(region.contig_name());
+    if (itr == std::cend(index_)) return result;
+    const auto& contig_index = itr->second;
+    const auto& entries = contig_index.entries;
+    // No entry beginning before this can overlap the region
+    const auto min_begin = region.begin() > contig_index.max_region_size ? region.begin() - contig_index.max_region_size : 0;
+    auto first = std::lower_bound(std::cbegin(entries), std::cend(entries), min_begin,
+                                  [] (const auto& entry, const auto pos) { return entry.region.begin() < pos; });
+    std::lock_guard<std::mutex> lock {mutex_};
+    for (; first != std::cend(entries) && first->region.begin() <= region.end(); ++first) {
+        if (overlaps(first->region, region.contig_region())) {
+            file_.clear();
+            file_.seekg(first->offset);
+            result.push_back(deserialise(file_));
+        }
+    }
+    return result;
+}
+
+// private methods
+
+void ReadSupportSidecarReader::build_index()
+{
+    while (file_.peek() != std::char_traits<char>::eof()) {
+        const auto offset = static_cast<std::streamoff>(file_.tellg());
+        const auto payload_size = get<PayloadSize>(file_);
+        const auto region = read_region(file_);
+        auto& contig_index = index_[region.contig_name()];
+        contig_index.entries.push_back({region.contig_region(), offset});
+        contig_index.max_region_size = std::max(contig_index.max_region_size, region_size(region));
+        file_.seekg(offset + static_cast<std::streamoff>(sizeof(PayloadSize) + payload_size));
+    }
+    file_.clear();
+    for (auto& p : index_) {
+        std::sort(std::begin(p.second.entries), std::end(p.second.entries),
+                  [] (const auto& lhs, const auto& rhs) { return lhs.region < rhs.region; });
+    }
+}
+
+} // namespace octopus
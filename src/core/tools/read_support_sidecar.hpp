@@ -0,0 +1,130 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef read_support_sidecar_hpp
+#define read_support_sidecar_hpp
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <mutex>
+#include <limits>
+
+#include <boost/filesystem/path.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "io/reference/reference_genome.hpp"
+
+namespace octopus {
+
+// A compact summary of how reads were assigned to the called haplotypes of one active region
+// during calling. Reads are identified by a hash rather than stored, so the summary can be
+// matched against reads fetched again later.
+struct ReadSupportRecord
+{
+    using ReadId = std::uint64_t;
+    
+    static constexpr std::uint32_t unassigned = std::numeric_limits<std::uint32_t>::max();
+    
+    struct Read
+    {
+        ReadId id;
+        std::uint32_t haplotype; // index into Sample::haplotypes, or unassigned
+        float margin; // log likelihood difference between the best and second best haplotype
+    };
+    
+    struct Sample
+    {
+        std::vector<std::vector<ContigAllele>> haplotypes; // non-reference alleles only
+        std::vector<Read> reads; // sorted by id
+    };
+    
+    GenomicRegion region;
+    std::unordered_map<SampleName, Sample> samples;
+};
+
+ReadSupportRecord::ReadId make_read_support_id(const AlignedRead& read);
+
+std::vector<ContigAllele> extract_nonreference_alleles(const Haplotype& haplotype, const ReferenceGenome& reference);
+
+std::vector<Haplotype> make_haplotypes(const GenomicRegion& region, const ReadSupportRecord::Sample& sample,
+                                       const ReferenceGenome& reference);
+
+const ReadSupportRecord::Read* find_read(const ReadSupportRecord::Sample& sample, ReadSupportRecord::ReadId id) noexcept;
+
+// Records are appended from multiple calling threads, so writes are serialised.
+class ReadSupportSidecarWriter
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    ReadSupportSidecarWriter() = delete;
+    
+    ReadSupportSidecarWriter(Path path);
+    
+    ReadSupportSidecarWriter(const ReadSupportSidecarWriter&)            = delete;
+    ReadSupportSidecarWriter& operator=(const ReadSupportSidecarWriter&) = delete;
+    ReadSupportSidecarWriter(ReadSupportSidecarWriter&&)                 = delete;
+    ReadSupportSidecarWriter& operator=(ReadSupportSidecarWriter&&)      = delete;
+    
+    ~ReadSupportSidecarWriter() = default;
+    
+    const Path& path() const noexcept;
+    
+    void write(const ReadSupportRecord& record);
+    void close();
+
+private:
+    Path path_;
+    std::ofstream file_;
+    std::mutex mutex_;
+};
+
+// Only the record regions are loaded on construction, records are read from disk on demand.
+class ReadSupportSidecarReader
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    ReadSupportSidecarReader() = delete;
+    
+    ReadSupportSidecarReader(Path path);
+    
+    ReadSupportSidecarReader(const ReadSupportSidecarReader&)            = delete;
+    ReadSupportSidecarReader& operator=(const ReadSupportSidecarReader&) = delete;
+    ReadSupportSidecarReader(ReadSupportSidecarReader&&)                 = delete;
+    ReadSupportSidecarReader& operator=(ReadSupportSidecarReader&&)      = delete;
+    
+    ~ReadSupportSidecarReader() = default;
+    
+    std::vector<ReadSupportRecord> fetch(const GenomicRegion& region) const;
+
+private:
+    struct IndexEntry
+    {
+        ContigRegion region;
+        std::streamoff offset;
+    };
+    
+    struct ContigIndex
+    {
+        std::vector<IndexEntry> entries; // sorted by region
+        ContigRegion::Size max_region_size = 0;
+    };
+    
+    Path path_;
+    mutable std::ifstream file_;
+    std::unordered_map<GenomicRegion::ContigName, ContigIndex> index_;
+    mutable std::mutex mutex_;
+    
+    void build_index();
+};
+
+} // namespace octopus
+
+#endif
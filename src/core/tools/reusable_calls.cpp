@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "reusable_calls.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace octopus {
+
+constexpr GenomicRegion::Size ReusableCalls::boundaryMargin;
+
+ReusableCalls::ReusableCalls(Path previous_calls, InputRegionMap regions)
+: previous_calls_ {std::move(previous_calls)}
+, regions_ {std::move(regions)}
+{}
+
+const InputRegionMap& ReusableCalls::regions() const noexcept
+{
+    return regions_;
+}
+
+bool ReusableCalls::is_reusable(const GenomicRegion& region) const
+{
+    const auto itr = regions_.find(region.contig_name());
+    if (itr == std::cend(regions_)) return false;
+    const auto overlapped = itr->second.overlap_range(region);
+    return std::any_of(std::cbegin(overlapped), std::cend(overlapped),
+                       [&] (const auto& reusable) { return contains(reusable, region); });
+}
+
+std::deque<VcfRecord> ReusableCalls::fetch(const GenomicRegion& region) const
+{
+    // Calls overlapping the start of region belong to the region before
+    auto calls = previous_calls_.fetch_records(region);
+    std::deque<VcfRecord> result {};
+    std::copy_if(std::make_move_iterator(std::begin(calls)), std::make_move_iterator(std::end(calls)),
+                 std::back_inserter(result), [&] (const auto& call) { return mapped_begin(call) >= region.begin(); });
+    return result;
+}
+
+namespace {
+
+auto join_adjacent(const InputRegionMap::mapped_type& blocks, const GenomicRegion& region)
+{
+    std::vector<GenomicRegion> result {};
+    for (const auto& block : blocks.contained_range(region)) {
+        if (!result.empty() && result.back().end() == block.begin()) {
+            result.back() = encompassing_region(result.back(), block);
+        } else {
+            result.push_back(block);
+        }
+    }
+    return result;
+}
+
+boost::optional<GenomicRegion> shrink_interior_edges(const GenomicRegion& reusable, const GenomicRegion& region)
+{
+    auto begin = reusable.begin();
+    auto end = reusable.end();
+    if (begin > region.begin()) begin += ReusableCalls::boundaryMargin;
+    if (end < region.end()) end = end > ReusableCalls::boundaryMargin ? end - ReusableCalls::boundaryMargin : 0;
+    if (begin >= end) return boost::none;
+    return GenomicRegion {reusable.contig_name(), begin, end};
+}
+
+} // namespace
+
+std::pair<InputRegionMap, InputRegionMap>
+split_reusable(const InputRegionMap& regions, const InputRegionMap& reusable_blocks)
+{
+    std::pair<InputRegionMap, InputRegionMap> result {};
+    for (const auto& p : regions) {
+        const auto& contig = p.first;
+        auto& split_regions = result.first[contig];
+        const auto blocks_itr = reusable_blocks.find(contig);
+        for (const auto& region : p.second) {
+            auto unsplit_begin = region.begin();
+            if (blocks_itr != std::cend(reusable_blocks)) {
+                for (const auto& joined : join_adjacent(blocks_itr->second, region)) {
+                    const auto reusable = shrink_interior_edges(joined, region);
+                    if (!reusable) continue;
+                    if (unsplit_begin < reusable->begin()) split_regions.emplace(contig, unsplit_begin, reusable->begin());
+                    split_regions.insert(*reusable);
+                    result.second[contig].insert(*reusable);
+                    unsplit_begin = reusable->end();
+                }
+            }
+            if (unsplit_begin < region.end()) split_regions.emplace(contig, unsplit_begin, region.end());
+        }
+    }
+    return result;
+}
+
+} // namespace octopus
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef reusable_calls_hpp
+#define reusable_calls_hpp
+
+#include <deque>
+#include <utility>
+
+#include <boost/filesystem/path.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "io/variant/vcf_reader.hpp"
+#include "io/variant/vcf_record.hpp"
+
+namespace octopus {
+
+// The calls of a previous run in regions whose calling inputs have not changed since, so they
+// don't need calling again. Thread safe.
+class ReusableCalls
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    // Calls near the edge of a reusable region can depend on reads in the neighbouring block, so
+    // this much of a reusable region is called again where it borders a region that is called again
+    static constexpr GenomicRegion::Size boundaryMargin {1'000};
+    
+    ReusableCalls() = delete;
+    
+    ReusableCalls(Path previous_calls, InputRegionMap regions);
+    
+    ReusableCalls(const ReusableCalls&)            = delete;
+    ReusableCalls& operator=(const ReusableCalls&) = delete;
+    ReusableCalls(ReusableCalls&&)                 = default;
+    ReusableCalls& operator=(ReusableCalls&&)      = default;
+    
+    ~ReusableCalls() = default;
+    
+    const InputRegionMap& regions() const noexcept;
+    
+    // True if region is entirely within a reusable region
+    bool is_reusable(const GenomicRegion& region) const;
+    
+    // The previous calls that begin in region
+    std::deque<VcfRecord> fetch(const GenomicRegion& region) const;
+    
+private:
+    VcfReader previous_calls_;
+    InputRegionMap regions_;
+};
+
+// Splits regions where they enter or leave the reusable blocks, so no region is partly reusable.
+// Adjacent reusable blocks are joined, and each joined region is shrunk by boundaryMargin where it
+// borders part of regions that is called again. Returns the split regions and the reusable regions.
+std::pair<InputRegionMap, InputRegionMap>
+split_reusable(const InputRegionMap& regions, const InputRegionMap& reusable_blocks);
+
+} // namespace octopus
+
+#endif
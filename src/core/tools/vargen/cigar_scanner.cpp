@@ -6,9 +6,8 @@
 #include <iterator>
 #include <algorithm>
 #include <numeric>
-
-#include <boost/iterator/zip_iterator.hpp>
-#include <boost/tuple/tuple.hpp>
+#include <tuple>
+#include <emmintrin.h>
 
 #include "config/common.hpp"
 #include "basics/aligned_read.hpp"
@@ -18,6 +17,7 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/append.hpp"
 #include "logging/logging.hpp"
+#include "logging/profiler.hpp"
 
 #include "utils/maths.hpp"
 
@@ -31,6 +31,13 @@ std::unique_ptr<VariantGenerator> CigarScanner::do_clone() const
 CigarScanner::CigarScanner(const ReferenceGenome& reference, Options options)
 : reference_ {reference}
 , options_ {options}
+, samples_ {}
+, reference_window_region_ {}
+, reference_window_ {}
+, snv_buffer_ {}
+, snv_pileup_ {}
+, likely_misaligned_snv_pileup_ {}
+, snv_observations_ {}
 , buffer_ {}
 , candidates_ {}
 , likely_misaligned_candidates_ {}
@@ -74,10 +81,10 @@ double ln_probability_read_correctly_aligned(const double misalign_penalty, cons
 
 void CigarScanner::do_add_read(const SampleName& sample, const AlignedRead& read)
 {
-    add_read(sample, read, sample_read_coverage_tracker_[sample]);
+    add_read(sample, sample_index(sample), read, sample_read_coverage_tracker_[sample]);
 }
 
-void CigarScanner::add_read(const SampleName& sample, const AlignedRead& read,
+void CigarScanner::add_read(const SampleName& sample, const unsigned sample_index, const AlignedRead& read,
                             CoverageTracker<GenomicRegion>& sample_coverage_tracker)
 {
     using std::cbegin; using std::next; using std::move;
@@ -98,7 +105,7 @@ void CigarScanner::add_read(const SampleName& sample, const AlignedRead& read,
                 misalignment_penalty += add_snvs_in_match_range(GenomicRegion {read_contig, ref_index, ref_index + op_size},
                                                                 next(sequence_iter, read_index),
                                                                 next(sequence_iter, read_index + op_size),
-                                                                sample,
+                                                                sample_index,
                                                                 next(base_quality_iter, read_index),
                                                                 read.direction());
                 read_index += op_size;
@@ -112,7 +119,7 @@ void CigarScanner::add_read(const SampleName& sample, const AlignedRead& read,
             {
                 region = GenomicRegion {read_contig, ref_index, ref_index + op_size};
                 add_candidate(region,
-                              reference_.get().fetch_sequence(region),
+                              fetch_reference_sequence(region),
                               copy(read_sequence, read_index, op_size),
                               sample,
                               next(base_quality_iter, read_index),
@@ -137,8 +144,9 @@ void CigarScanner::add_read(const SampleName& sample, const AlignedRead& read,
             case Flag::deletion:
             {
                 region = GenomicRegion {read_contig, ref_index, ref_index + op_size};
+                auto deleted_sequence = fetch_reference_sequence(region);
                 add_candidate(move(region),
-                              reference_.get().fetch_sequence(region),
+                              move(deleted_sequence),
                               "",
                               sample,
                               next(base_quality_iter, read_index),
@@ -181,22 +189,27 @@ void CigarScanner::add_read(const SampleName& sample, const AlignedRead& read,
     }
     if (!is_likely_misaligned(read, misalignment_penalty)) {
         utils::append(std::move(buffer_), candidates_);
+        utils::append(snv_buffer_, snv_pileup_);
     } else {
         utils::append(std::move(buffer_), likely_misaligned_candidates_);
+        utils::append(snv_buffer_, likely_misaligned_snv_pileup_);
         misaligned_tracker_.add(clipped_mapped_region(read));
     }
+    snv_buffer_.clear();
 }
 
 void CigarScanner::do_add_reads(const SampleName& sample, VectorIterator first, VectorIterator last)
 {
+    const auto index = sample_index(sample);
     auto& sample_coverage_tracker = sample_read_coverage_tracker_[sample];
-    std::for_each(first, last, [&] (const AlignedRead& read) { add_read(sample, read, sample_coverage_tracker); });
+    std::for_each(first, last, [&] (const AlignedRead& read) { add_read(sample, index, read, sample_coverage_tracker); });
 }
 
 void CigarScanner::do_add_reads(const SampleName& sample, FlatSetIterator first, FlatSetIterator last)
 {
+    const auto index = sample_index(sample);
     auto& sample_coverage_tracker = sample_read_coverage_tracker_[sample];
-    std::for_each(first, last, [&] (const AlignedRead& read) { add_read(sample, read, sample_coverage_tracker); });
+    std::for_each(first, last, [&] (const AlignedRead& read) { add_read(sample, index, read, sample_coverage_tracker); });
 }
 
 unsigned get_min_depth(const Variant& v, const CoverageTracker<GenomicRegion>& tracker)
@@ -256,8 +269,13 @@ void choose_push_back(Variant candidate, std::vector<Variant>& final_candidates,
 
 std::vector<Variant> CigarScanner::do_generate_variants(const GenomicRegion& region)
 {
+    profiling::ScopedTimer timer {profiling::Stage::cigar_scanner};
     using std::begin; using std::end; using std::cbegin; using std::cend; using std::next;
     
+    flush_snv_pileup(snv_pileup_, candidates_, true);
+    flush_snv_pileup(likely_misaligned_snv_pileup_, likely_misaligned_candidates_, false);
+    read_coverage_tracker_.flush();
+    for (auto& p : sample_read_coverage_tracker_) p.second.flush();
     std::sort(begin(candidates_), end(candidates_));
     auto viable_candidates = overlap_range(candidates_, region, max_seen_candidate_size_);
     std::vector<Variant> result {};
@@ -322,6 +340,17 @@ std::vector<Variant> CigarScanner::do_generate_variants(const GenomicRegion& reg
 
 void CigarScanner::do_clear() noexcept
 {
+    reference_window_region_ = boost::none;
+    reference_window_.clear();
+    reference_window_.shrink_to_fit();
+    snv_buffer_.clear();
+    snv_buffer_.shrink_to_fit();
+    snv_pileup_.clear();
+    snv_pileup_.shrink_to_fit();
+    likely_misaligned_snv_pileup_.clear();
+    likely_misaligned_snv_pileup_.shrink_to_fit();
+    snv_observations_.clear();
+    snv_observations_.shrink_to_fit();
     buffer_.clear();
     buffer_.shrink_to_fit();
     candidates_.clear();
@@ -340,36 +369,120 @@ std::string CigarScanner::name() const
 
 // private methods
 
+unsigned CigarScanner::sample_index(const SampleName& sample)
+{
+    const auto itr = std::find(std::cbegin(samples_), std::cend(samples_), sample);
+    if (itr != std::cend(samples_)) return static_cast<unsigned>(std::distance(std::cbegin(samples_), itr));
+    samples_.push_back(sample);
+    return static_cast<unsigned>(samples_.size() - 1);
+}
+
+CigarScanner::ReferenceBases CigarScanner::fetch_reference(const GenomicRegion& region)
+{
+    // Reads are mostly added in position order, so a window is fetched ahead of the region to
+    // avoid fetching the reference for every alignment block
+    if (reference_window_region_ && contains(*reference_window_region_, region)) {
+        return {reference_window_.data() + (region.begin() - reference_window_region_->begin()), region_size(region)};
+    }
+    // Reads may overhang the end of the contig, so the region is clamped to the contig
+    const auto contig_size = reference_.get().contig_size(region.contig_name());
+    const auto end = std::min(region.end(), contig_size);
+    const auto begin = std::min(region.begin(), end);
+    if (!reference_window_region_ || !contains(*reference_window_region_, GenomicRegion {region.contig_name(), begin, end})) {
+        const auto window_end = std::min(std::max(end, begin + minReferenceWindowSize), contig_size);
+        reference_window_region_ = GenomicRegion {region.contig_name(), begin, window_end};
+        reference_window_ = reference_.get().fetch_sequence(*reference_window_region_);
+    }
+    const auto offset = static_cast<std::size_t>(begin - reference_window_region_->begin());
+    const auto size = std::min(static_cast<std::size_t>(end - begin), reference_window_.size() - std::min(offset, reference_window_.size()));
+    return {reference_window_.data() + offset, size};
+}
+
+CigarScanner::NucleotideSequence CigarScanner::fetch_reference_sequence(const GenomicRegion& region)
+{
+    const auto bases = fetch_reference(region);
+    return NucleotideSequence {bases.data, bases.size};
+}
+
+namespace {
+
+// Calls f with the index of every base that differs between the two sequences, ignoring 'N's.
+// Sixteen bases are compared at a time.
+template <typename F>
+void for_each_mismatch(const char* ref, const char* read, const std::size_t n, F f)
+{
+    std::size_t i {0};
+    const auto ns = _mm_set1_epi8('N');
+    for (; i + 16 <= n; i += 16) {
+        const auto ref_bases  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ref + i));
+        const auto read_bases = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read + i));
+        const auto ignored = _mm_or_si128(_mm_cmpeq_epi8(ref_bases, read_bases),
+                                          _mm_or_si128(_mm_cmpeq_epi8(ref_bases, ns), _mm_cmpeq_epi8(read_bases, ns)));
+        auto mismatches = ~static_cast<unsigned>(_mm_movemask_epi8(ignored)) & 0xffffu;
+        while (mismatches != 0) {
+            f(i + __builtin_ctz(mismatches));
+            mismatches &= mismatches - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (ref[i] != read[i] && ref[i] != 'N' && read[i] != 'N') f(i);
+    }
+}
+
+} // namespace
+
 double CigarScanner::add_snvs_in_match_range(const GenomicRegion& region,
                                              const SequenceIterator first_base, const SequenceIterator last_base,
-                                             const SampleName& origin,
-                                             AlignedRead::BaseQualityVector::const_iterator first_base_quality,
-                                             AlignedRead::Direction support_direction)
-{
-    using boost::make_zip_iterator; using std::for_each; using std::cbegin; using std::cend;
-    using Tuple = boost::tuple<char, char>;
-    const NucleotideSequence ref_segment {reference_.get().fetch_sequence(region)};
-    const auto& contig = region.contig_name();
-    auto ref_index = mapped_begin(region);
+                                             const unsigned sample_index,
+                                             const AlignedRead::BaseQualityVector::const_iterator first_base_quality,
+                                             const AlignedRead::Direction support_direction)
+{
+    const auto ref = fetch_reference(region);
+    const auto ref_bases = ref.data;
+    const auto read_bases = &*first_base;
+    const auto ref_begin = mapped_begin(region);
+    const auto num_bases = std::min(static_cast<std::size_t>(std::distance(first_base, last_base)), ref.size);
     double misalignment_penalty {0};
-    for_each(make_zip_iterator(boost::make_tuple(cbegin(ref_segment), first_base)),
-             make_zip_iterator(boost::make_tuple(cend(ref_segment), last_base)),
-             [this, &contig, &ref_index, &origin, &first_base_quality,
-              &misalignment_penalty, support_direction] (const Tuple& t) {
-                 const char ref_base  {t.get<0>()}, read_base {t.get<1>()};
-                 if (ref_base != read_base && ref_base != 'N' && read_base != 'N') {
-                     add_candidate(GenomicRegion {contig, ref_index, ref_index + 1},
-                                   ref_base, read_base, origin, first_base_quality, support_direction);
-                     if (*first_base_quality >= options_.misalignment_parameters.snv_threshold) {
-                         misalignment_penalty += options_.misalignment_parameters.snv_penalty;
-                     }
-                 }
-                 ++ref_index;
-                 ++first_base_quality;
-             });
+    for_each_mismatch(ref_bases, read_bases, num_bases, [&] (const std::size_t i) {
+        const auto base_quality = first_base_quality[i];
+        snv_buffer_.push_back({static_cast<ContigRegion::Position>(ref_begin + i), sample_index, base_quality,
+                               ref_bases[i], read_bases[i], support_direction});
+        if (base_quality >= options_.misalignment_parameters.snv_threshold) {
+            misalignment_penalty += options_.misalignment_parameters.snv_penalty;
+        }
+    });
     return misalignment_penalty;
 }
 
+void CigarScanner::flush_snv_pileup(std::vector<SnvObservation>& pileup, std::deque<Candidate>& candidates,
+                                    const bool keep_observations)
+{
+    if (pileup.empty() || !reference_window_region_ || options_.max_variant_size < 1) {
+        pileup.clear();
+        return;
+    }
+    const auto snv_less = [] (const SnvObservation& lhs, const SnvObservation& rhs) noexcept {
+        return std::tie(lhs.position, lhs.alt_base) < std::tie(rhs.position, rhs.alt_base);
+    };
+    std::sort(std::begin(pileup), std::end(pileup), snv_less);
+    const auto& contig = reference_window_region_->contig_name();
+    const auto offset = snv_observations_.size();
+    for (auto first = std::cbegin(pileup); first != std::cend(pileup);) {
+        const auto last = std::upper_bound(first, std::cend(pileup), *first, snv_less);
+        candidates.emplace_back(GenomicRegion {contig, first->position, first->position + 1},
+                                first->ref_base, first->alt_base, SampleName {},
+                                AlignedRead::BaseQualityVector::const_iterator {}, first->support_direction);
+        if (keep_observations) {
+            candidates.back().first_snv_observation = offset + std::distance(std::cbegin(pileup), first);
+            candidates.back().num_snv_observations = std::distance(first, last);
+        }
+        first = last;
+    }
+    if (keep_observations) utils::append(pileup, snv_observations_);
+    pileup.clear();
+    max_seen_candidate_size_ = std::max(max_seen_candidate_size_, Variant::MappingDomain::Size {1});
+}
+
 unsigned CigarScanner::sum_base_qualities(const Candidate& candidate) const noexcept
 {
     return std::accumulate(candidate.first_base_quality_iter,
@@ -402,25 +515,39 @@ CigarScanner::make_observation(const CandidateIterator first_match, const Candid
     result.variant = candidate.variant;
     result.total_depth = get_min_depth(candidate.variant, read_coverage_tracker_);
     result.num_samples = sample_read_coverage_tracker_.size();
-    std::vector<Candidate> observations {first_match, last_match};
-    std::sort(begin(observations), end(observations), [] (const Candidate& lhs, const Candidate& rhs) { return lhs.origin < rhs.origin; });
-    for (auto observation_itr = begin(observations); observation_itr != end(observations);) {
-        const auto& origin = observation_itr->origin;
-        auto next_itr = std::find_if_not(next(observation_itr), end(observations),
-                                         [&] (const Candidate& c) { return c.origin == origin; });
-        std::vector<unsigned> observed_qualities(std::distance(observation_itr, next_itr));
-        std::transform(observation_itr, next_itr, begin(observed_qualities),
-                       [this] (const Candidate& c) noexcept { return sum_base_qualities(c); });
-        const auto num_fwd_support = std::accumulate(observation_itr, next_itr, 0u,
-                                                     [] (unsigned curr, const Candidate& c) noexcept {
-                                                         if (c.support_direction == AlignedRead::Direction::forward) {
-                                                             ++curr;
-                                                         }
-                                                         return curr;
-                                                     });
+    struct Support
+    {
+        const SampleName* sample;
+        unsigned quality;
+        AlignedRead::Direction direction;
+    };
+    std::vector<Support> supports {};
+    std::for_each(first_match, last_match, [&] (const Candidate& c) {
+        if (c.num_snv_observations > 0) {
+            const auto first_observation = std::next(std::cbegin(snv_observations_), c.first_snv_observation);
+            std::for_each(first_observation, std::next(first_observation, c.num_snv_observations),
+                          [&] (const SnvObservation& o) {
+                              supports.push_back({&samples_[o.sample], o.quality, o.support_direction});
+                          });
+        } else {
+            supports.push_back({&c.origin, sum_base_qualities(c), c.support_direction});
+        }
+    });
+    std::sort(begin(supports), end(supports), [] (const Support& lhs, const Support& rhs) { return *lhs.sample < *rhs.sample; });
+    for (auto support_itr = begin(supports); support_itr != end(supports);) {
+        const auto& origin = *support_itr->sample;
+        auto next_itr = std::find_if_not(next(support_itr), end(supports),
+                                         [&] (const Support& s) { return *s.sample == origin; });
+        std::vector<unsigned> observed_qualities(std::distance(support_itr, next_itr));
+        std::transform(support_itr, next_itr, begin(observed_qualities),
+                       [] (const Support& s) noexcept { return s.quality; });
+        const auto num_fwd_support = std::count_if(support_itr, next_itr,
+                                                   [] (const Support& s) noexcept {
+                                                       return s.direction == AlignedRead::Direction::forward;
+                                                   });
         const auto depth = get_min_depth(candidate.variant, sample_read_coverage_tracker_.at(origin));
-        result.sample_observations.push_back({depth, std::move(observed_qualities), num_fwd_support});
-        observation_itr = next_itr;
+        result.sample_observations.push_back({depth, std::move(observed_qualities), static_cast<unsigned>(num_fwd_support)});
+        support_itr = next_itr;
     }
     return result;
 }
@@ -11,8 +11,12 @@
 #include <functional>
 #include <memory>
 
+#include <boost/optional.hpp>
+
 #include "concepts/mappable.hpp"
 #include "concepts/comparable.hpp"
+#include "basics/contig_region.hpp"
+#include "basics/genomic_region.hpp"
 #include "basics/aligned_read.hpp"
 #include "core/types/variant.hpp"
 #include "utils/coverage_tracker.hpp"
@@ -21,7 +25,6 @@
 namespace octopus {
 
 class ReferenceGenome;
-class GenomicRegion;
 
 namespace coretools {
 
@@ -83,7 +86,7 @@ private:
     std::unique_ptr<VariantGenerator> do_clone() const override;
     bool do_requires_reads() const noexcept override;
     void do_add_read(const SampleName& sample, const AlignedRead& read) override;
-    void add_read(const SampleName& sample, const AlignedRead& read,
+    void add_read(const SampleName& sample, unsigned sample_index, const AlignedRead& read,
                   CoverageTracker<GenomicRegion>& sample_coverage_tracker);
     void do_add_reads(const SampleName& sample, VectorIterator first, VectorIterator last) override;
     void do_add_reads(const SampleName& sample, FlatSetIterator first, FlatSetIterator last) override;
@@ -97,6 +100,8 @@ private:
         SampleName origin;
         AlignedRead::BaseQualityVector::const_iterator first_base_quality_iter;
         AlignedRead::Direction support_direction;
+        // SNV candidates are made from the pileup and stand for all of their observations
+        std::size_t first_snv_observation = 0, num_snv_observations = 0;
         
         template <typename T1, typename T2, typename T3, typename T4>
         Candidate(T1&& region, T2&& sequence_removed, T3&& sequence_added, T4&& origin,
@@ -109,11 +114,28 @@ private:
         friend bool operator<(const Candidate& lhs, const Candidate& rhs) noexcept { return lhs.variant < rhs.variant; }
     };
     
+    // A read base that mismatches the reference in an alignment match block
+    struct SnvObservation
+    {
+        ContigRegion::Position position;
+        unsigned sample;
+        AlignedRead::BaseQuality quality;
+        char ref_base, alt_base;
+        AlignedRead::Direction support_direction;
+    };
+    
     using NucleotideSequence = AlignedRead::NucleotideSequence;
     using SequenceIterator   = NucleotideSequence::const_iterator;
     
+    static constexpr ContigRegion::Size minReferenceWindowSize {10'000};
+    
     std::reference_wrapper<const ReferenceGenome> reference_;
     Options options_;
+    std::vector<SampleName> samples_;
+    boost::optional<GenomicRegion> reference_window_region_;
+    NucleotideSequence reference_window_;
+    std::vector<SnvObservation> snv_buffer_, snv_pileup_, likely_misaligned_snv_pileup_;
+    std::vector<SnvObservation> snv_observations_; // sorted pileup referenced by SNV candidates
     std::vector<Candidate> buffer_;
     std::deque<Candidate> candidates_, likely_misaligned_candidates_;
     Variant::MappingDomain::Size max_seen_candidate_size_;
@@ -126,10 +148,22 @@ private:
     void add_candidate(T1&& region, T2&& sequence_removed, T3&& sequence_added, T4&& origin,
                        AlignedRead::BaseQualityVector::const_iterator first_base_quality,
                        AlignedRead::Direction support_direction);
+    unsigned sample_index(const SampleName& sample);
+    // The reference bases of region. There are fewer than region_size(region) bases if the region
+    // overhangs the end of the contig.
+    struct ReferenceBases
+    {
+        const char* data;
+        std::size_t size;
+    };
+    
+    ReferenceBases fetch_reference(const GenomicRegion& region);
+    NucleotideSequence fetch_reference_sequence(const GenomicRegion& region);
     double add_snvs_in_match_range(const GenomicRegion& region, SequenceIterator first_base, SequenceIterator last_base,
-                                   const SampleName& origin,
+                                   unsigned sample_index,
                                    AlignedRead::BaseQualityVector::const_iterator first_quality,
                                    AlignedRead::Direction support_direction);
+    void flush_snv_pileup(std::vector<SnvObservation>& pileup, std::deque<Candidate>& candidates, bool keep_observations);
     unsigned sum_base_qualities(const Candidate& candidate) const noexcept;
     std::vector<GenomicRegion> get_repeat_regions(const GenomicRegion& region) const;
     bool is_likely_misaligned(const AlignedRead& read, double penalty) const;
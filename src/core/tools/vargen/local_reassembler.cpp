@@ -22,6 +22,7 @@
 #include "utils/append.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "logging/logging.hpp"
+#include "logging/profiler.hpp"
 #include "utils/global_aligner.hpp"
 
 namespace octopus { namespace coretools {
@@ -351,6 +352,7 @@ void log_active_regions(const Range& regions, boost::optional<logging::DebugLogg
 
 std::vector<Variant> LocalReassembler::do_generate_variants(const GenomicRegion& region)
 {
+    profiling::ScopedTimer timer {profiling::Stage::local_reassembler};
     const auto active_regions = active_region_generator_.generate(region);
     debug::log_active_regions(active_regions, debug_log_);
     for (const auto& active_region : active_regions) {
@@ -30,8 +30,6 @@
 #include "utils/sequence_utils.hpp"
 #include "utils/append.hpp"
 
-#include "timers.hpp"
-
 #define _unused(x) ((void)(x))
 
 namespace octopus { namespace coretools {
@@ -282,8 +282,11 @@ get_interesting_hotspots(const GenomicRegion& region,
     }
 }
 
-std::vector<GenomicRegion> AssemblerActiveRegionGenerator::generate(const GenomicRegion& region) const
+std::vector<GenomicRegion> AssemblerActiveRegionGenerator::generate(const GenomicRegion& region)
 {
+    for (auto* trackers : {&coverage_tracker_, &interesting_read_coverages_, &clipped_coverage_tracker_}) {
+        for (auto& p : *trackers) p.second.flush();
+    }
     auto interesting_regions = get_interesting_hotspots(region, interesting_read_coverages_, coverage_tracker_);
     if (structual_interesting_) {
         for (const auto& p : clipped_coverage_tracker_) {
@@ -47,7 +47,7 @@ public:
     template <typename ForwardIterator>
     void add(const SampleName& sample, ForwardIterator first_read, ForwardIterator last_read);
     
-    std::vector<GenomicRegion> generate(const GenomicRegion& region) const;
+    std::vector<GenomicRegion> generate(const GenomicRegion& region);
 
     void clear() noexcept;
     
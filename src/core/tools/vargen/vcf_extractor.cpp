@@ -11,6 +11,7 @@
 #include "io/variant/vcf_spec.hpp"
 #include "io/variant/vcf_record.hpp"
 #include "utils/sequence_utils.hpp"
+#include "logging/profiler.hpp"
 
 namespace octopus { namespace coretools {
 
@@ -30,7 +31,8 @@ std::unique_ptr<VariantGenerator> VcfExtractor::do_clone() const
 
 namespace {
 
-static bool is_canonical(const VcfRecord::NucleotideSequence& allele)
+template <typename Sequence>
+bool is_canonical(const Sequence& allele)
 {
     return allele != vcfspec::missingValue
            && std::none_of(std::cbegin(allele), std::cend(allele),
@@ -45,41 +47,58 @@ auto make_allele(const Iterator first_base, const Iterator last_base)
     return result;
 }
 
+template <typename Sequence, typename Container>
+void extract_variants(const GenomicRegion::ContigName& contig, const GenomicRegion::Position pos,
+                      const Sequence& ref_allele, const Sequence& alt_allele, Container& result)
+{
+    if (ref_allele.size() != alt_allele.size()) {
+        auto begin = pos;
+        const auto p = std::mismatch(std::cbegin(ref_allele), std::cend(ref_allele),
+                                     std::cbegin(alt_allele), std::cend(alt_allele));
+        if (p.first != std::cend(ref_allele) && alt_allele.size() > ref_allele.size()) {
+            // Split non-reference padded insertions into snv (or mnv) and insertion with empty
+            // reference (e.g. A -> TT makes two variants A -> T and -> T).
+            const auto ref_pad_size = std::distance(std::cbegin(ref_allele), p.first);
+            begin += ref_pad_size;
+            const auto remaining_ref_size = ref_allele.size() - ref_pad_size;
+            const auto first_alt_end = std::next(p.second, remaining_ref_size);
+            result.emplace_back(contig, begin - 1,
+                                make_allele(p.first, std::cend(ref_allele)),
+                                make_allele(p.second, first_alt_end));
+            begin += remaining_ref_size;
+            result.emplace_back(contig, begin - 1, "",
+                                make_allele(first_alt_end, std::cend(alt_allele)));
+        } else {
+            begin += std::distance(std::cbegin(ref_allele), p.first);
+            result.emplace_back(contig, begin - 1,
+                                make_allele(p.first, std::cend(ref_allele)),
+                                make_allele(p.second, std::cend(alt_allele)));
+        }
+    } else {
+        result.emplace_back(contig, pos - 1,
+                            make_allele(std::cbegin(ref_allele), std::cend(ref_allele)),
+                            make_allele(std::cbegin(alt_allele), std::cend(alt_allele)));
+    }
+}
+
 template <typename Container>
 void extract_variants(const VcfRecord& record, Container& result)
 {
     for (const auto& alt_allele : record.alt()) {
         if (is_canonical(alt_allele)) {
-            const auto& ref_allele = record.ref();
-            if (ref_allele.size() != alt_allele.size()) {
-                auto begin = record.pos();
-                const auto p = std::mismatch(std::cbegin(ref_allele), std::cend(ref_allele),
-                                             std::cbegin(alt_allele), std::cend(alt_allele));
-                if (p.first != std::cend(ref_allele) && alt_allele.size() > ref_allele.size()) {
-                    // Split non-reference padded insertions into snv (or mnv) and insertion with empty
-                    // reference (e.g. A -> TT makes two variants A -> T and -> T).
-                    const auto ref_pad_size = std::distance(std::cbegin(ref_allele), p.first);
-                    begin += ref_pad_size;
-                    const auto remaining_ref_size = ref_allele.size() - ref_pad_size;
-                    const auto first_alt_end = std::next(p.second, remaining_ref_size);
-                    result.emplace_back(record.chrom(), begin - 1,
-                                        make_allele(p.first, std::cend(ref_allele)),
-                                        make_allele(p.second, first_alt_end));
-                    begin += remaining_ref_size;
-                    result.emplace_back(record.chrom(), begin - 1, "",
-                                        make_allele(first_alt_end, std::cend(alt_allele)));
-                } else {
-                    begin += std::distance(std::cbegin(ref_allele), p.first);
-                    result.emplace_back(record.chrom(), begin - 1,
-                                        make_allele(p.first, std::cend(ref_allele)),
-                                        make_allele(p.second, std::cend(alt_allele)));
-                }
-            } else {
-                using utils::capitalise_copy;
-                result.emplace_back(record.chrom(), record.pos() - 1,
-                                    capitalise_copy(record.ref()),
-                                    capitalise_copy(alt_allele));
-            }
+            extract_variants(record.chrom(), record.pos(), record.ref(), alt_allele, result);
+        }
+    }
+}
+
+template <typename Container>
+void extract_variants(const BcfRecord& record, const GenomicRegion::ContigName& contig, Container& result)
+{
+    const auto ref_allele = record.ref();
+    for (unsigned i {0}; i < record.num_alt(); ++i) {
+        const auto alt_allele = record.alt(i);
+        if (is_canonical(alt_allele)) {
+            extract_variants(contig, record.pos(), ref_allele, alt_allele, result);
         }
     }
 }
@@ -88,10 +107,20 @@ void extract_variants(const VcfRecord& record, Container& result)
 
 std::vector<Variant> VcfExtractor::do_generate_variants(const GenomicRegion& region)
 {
+    profiling::ScopedTimer timer {profiling::Stage::vcf_extractor};
     std::deque<Variant> variants {};
-    for (auto p = reader_->iterate(region, VcfReader::UnpackPolicy::sites); p.first != p.second; ++p.first) {
-        if (is_good(*p.first)) {
-            extract_variants(*p.first, variants);
+    if (reader_->is_raw_iterable()) {
+        // Only the site fields are needed, so avoid decoding INFO into VcfRecord strings
+        for (auto p = reader_->iterate_raw(region); p.first != p.second; ++p.first) {
+            if (is_good(*p.first)) {
+                extract_variants(*p.first, region.contig_name(), variants);
+            }
+        }
+    } else {
+        for (auto p = reader_->iterate(region, VcfReader::UnpackPolicy::sites); p.first != p.second; ++p.first) {
+            if (is_good(*p.first)) {
+                extract_variants(*p.first, variants);
+            }
         }
     }
     std::vector<Variant> result {std::make_move_iterator(std::begin(variants)),
@@ -106,11 +135,17 @@ std::string VcfExtractor::name() const
     return "VCF extraction";
 }
 
-bool VcfExtractor::is_good(const VcfRecord& record)
+bool VcfExtractor::is_good(const VcfRecord& record) const
 {
     if (!options_.extract_filtered && is_filtered(record)) return false;
     return !options_.min_quality || (record.qual() && *record.qual() >= *options_.min_quality);
 }
 
+bool VcfExtractor::is_good(const BcfRecord& record) const
+{
+    if (!options_.extract_filtered && record.is_filtered()) return false;
+    return !options_.min_quality || (record.qual() && *record.qual() >= *options_.min_quality);
+}
+
 } // namespace coretools
 } // namespace octopus
@@ -50,7 +50,8 @@ private:
     std::shared_ptr<const VcfReader> reader_;
     Options options_;
     
-    bool is_good(const VcfRecord& record);
+    bool is_good(const VcfRecord& record) const;
+    bool is_good(const BcfRecord& record) const;
 };
 
 } // namespace coretools
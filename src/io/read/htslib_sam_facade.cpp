@@ -19,6 +19,7 @@
 #include "exceptions/missing_file_error.hpp"
 #include "exceptions/missing_index_error.hpp"
 #include "exceptions/malformed_file_error.hpp"
+#include "readpipe/downsampling/streaming_downsampler.hpp"
 
 namespace octopus { namespace io {
 
@@ -523,6 +524,38 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const std::vector<Sa
     return result;
 }
 
+HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const std::vector<SampleName>& samples,
+                                                            const GenomicRegion& region,
+                                                            const DownsamplingParameters downsampling) const
+{
+    HtslibIterator it {*this, region};
+    SampleReadMap result {samples.size()};
+    std::unordered_map<SampleName, readpipe::StreamingDownsampler> downsamplers {};
+    downsamplers.reserve(samples.size());
+    for (const auto& sample : samples) {
+        if (contains(samples_, sample)) {
+            result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
+            downsamplers.emplace(sample, downsampling.max_coverage);
+        }
+    }
+    if (result.empty()) return result; // no matching samples
+    while (++it) {
+        try {
+            const auto& sample = samples_.size() == 1 ? samples_.front() : sample_names_.at(it.read_group());
+            const auto downsampler_itr = downsamplers.find(sample);
+            if (downsampler_itr != std::end(downsamplers)) {
+                const auto record = it.record();
+                if (downsampler_itr->second.keep(record->core.pos, bam_endpos(record), bam_get_qname(record))) {
+                    result.at(sample).push_back(extract_read(record));
+                }
+            }
+        } catch (InvalidBamRecord& e) {
+            // TODO
+        }
+    }
+    return result;
+}
+
 std::vector<GenomicRegion::ContigName> HtslibSamFacade::reference_contigs() const
 {
     std::vector<GenomicRegion::ContigName> result {};
@@ -786,19 +819,24 @@ auto extract_next_segment_flags(const bam1_core_t& c) noexcept
 }
 
 AlignedRead HtslibSamFacade::HtslibIterator::operator*() const
+{
+    return hts_facade_.extract_read(hts_bam1_.get());
+}
+
+AlignedRead HtslibSamFacade::extract_read(const bam1_t* record) const
 {
     using std::begin; using std::end; using std::next; using std::move;
     
-    auto qualities = extract_qualities(hts_bam1_.get());
+    auto qualities = extract_qualities(record);
     
     if (qualities.empty() || qualities[0] == 0xff) {
-        throw InvalidBamRecord {hts_facade_.file_path_, extract_read_name(hts_bam1_.get()), "corrupt sequence data"};
+        throw InvalidBamRecord {file_path_, extract_read_name(record), "corrupt sequence data"};
     }
     
-    auto cigar = extract_cigar_string(hts_bam1_.get());
-    const auto& info = hts_bam1_->core;
+    auto cigar = extract_cigar_string(record);
+    const auto& info = record->core;
     auto read_begin_tmp = clipped_begin(cigar, info.pos);
-    auto sequence = extract_sequence(hts_bam1_.get());
+    auto sequence = extract_sequence(record);
     
     if (read_begin_tmp < 0) {
         // Then the read hangs off the left of the contig, and we must remove bases, base_qualities, and
@@ -817,11 +855,11 @@ AlignedRead HtslibSamFacade::HtslibIterator::operator*() const
     }
     
     const auto read_begin = static_cast<AlignedRead::MappingDomain::Position>(read_begin_tmp);
-    const auto& contig_name = hts_facade_.get_contig_name(info.tid);
+    const auto& contig_name = get_contig_name(info.tid);
     
     if (has_multiple_segments(info)) {
         return AlignedRead {
-            extract_read_name(hts_bam1_.get()),
+            extract_read_name(record),
             GenomicRegion {
                 contig_name,
                 read_begin,
@@ -832,14 +870,14 @@ AlignedRead HtslibSamFacade::HtslibIterator::operator*() const
             move(cigar),
             mapping_quality(info),
             extract_flags(info),
-            hts_facade_.get_contig_name(info.mtid),
+            get_contig_name(info.mtid),
             next_segment_position(info),
             template_length(info),
             extract_next_segment_flags(info)
         };
     } else {
         return AlignedRead {
-            extract_read_name(hts_bam1_.get()),
+            extract_read_name(record),
             GenomicRegion {
                 contig_name,
                 read_begin,
@@ -885,5 +923,10 @@ std::size_t HtslibSamFacade::HtslibIterator::begin() const noexcept
     return hts_bam1_->core.pos;
 }
 
+const bam1_t* HtslibSamFacade::HtslibIterator::record() const noexcept
+{
+    return hts_bam1_.get();
+}
+
 } // namespace io
 } // namespace octopus
@@ -37,6 +37,7 @@ public:
     using IReadReaderImpl::ReadContainer;
     using IReadReaderImpl::SampleReadMap;
     using IReadReaderImpl::PositionList;
+    using IReadReaderImpl::DownsamplingParameters;
     
     using NucleotideSequence = AlignedRead::NucleotideSequence;
     
@@ -85,6 +86,9 @@ public:
                               const GenomicRegion& region) const override;
     SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
                               const GenomicRegion& region) const override;
+    SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
+                              const GenomicRegion& region,
+                              DownsamplingParameters downsampling) const override;
     
     GenomicRegion::Size reference_size(const GenomicRegion::ContigName& contig) const override;
     std::vector<GenomicRegion::ContigName> reference_contigs() const override;
@@ -115,6 +119,7 @@ private:
         
         bool is_good() const noexcept;
         std::size_t begin() const noexcept;
+        const bam1_t* record() const noexcept;
         
     private:
         struct HtsIteratorDeleter
@@ -162,6 +167,7 @@ private:
     const GenomicRegion::ContigName& get_contig_name(HtsTid target) const;
     std::uint64_t get_num_mapped_reads(const GenomicRegion::ContigName& contig) const;
     ReadContainer fetch_all_reads(const GenomicRegion& region) const;
+    AlignedRead extract_read(const bam1_t* record) const;
 };
 
 } // namespace io
@@ -314,6 +314,7 @@ GenomicRegion ReadManager::find_covered_subregion(const std::vector<SampleName>&
             reader_itr = open_readers(begin(reader_paths), end(reader_paths));
         }
     }
+    position_tracker.flush();
     return max_head_region(position_tracker, region, max_reads);
 }
 
@@ -357,6 +358,26 @@ ReadManager::ReadContainer ReadManager::fetch_reads(const SampleName& sample, co
 }
 
 ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region) const
+{
+    return fetch_sample_reads(samples, region, [&] (const ReadReader& reader) { return reader.fetch_reads(samples, region); });
+}
+
+ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                                    const DownsamplingParameters downsampling) const
+{
+    return fetch_sample_reads(samples, region, [&] (const ReadReader& reader) { return reader.fetch_reads(samples, region, downsampling); });
+}
+
+ReadManager::SampleReadMap ReadManager::fetch_reads(const GenomicRegion& region) const
+{
+    return fetch_reads(samples(), region);
+}
+
+// Private methods
+
+template <typename Fetcher>
+ReadManager::SampleReadMap ReadManager::fetch_sample_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                                           Fetcher fetcher) const
 {
     SampleReadMap result {samples.size()};
     // Populate here so we can do unchcked access
@@ -365,7 +386,7 @@ ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName
     }
     if (all_readers_are_open()) {
         for (const auto& p : open_readers_) {
-            auto reads = p.second.fetch_reads(samples, region);
+            auto reads = fetcher(p.second);
             for (auto&& r : reads) {
                 merge_insert(std::move(r.second), result.at(r.first));
                 r.second.clear();
@@ -379,7 +400,7 @@ ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName
         while (!reader_paths.empty()) {
             using std::begin; using std::end; using std::make_move_iterator; using std::for_each;
             for_each(reader_itr, end(reader_paths), [&] (const auto& reader_path) {
-                auto reads = open_readers_.at(reader_path).fetch_reads(samples, region);
+                auto reads = fetcher(open_readers_.at(reader_path));
                 for (auto&& r : reads) {
                     merge_insert(std::move(r.second), result.at(r.first));
                     r.second.clear();
@@ -393,13 +414,6 @@ ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName
     return result;
 }
 
-ReadManager::SampleReadMap ReadManager::fetch_reads(const GenomicRegion& region) const
-{
-    return fetch_reads(samples(), region);
-}
-
-// Private methods
-
 bool ReadManager::FileSizeCompare::operator()(const Path& lhs, const Path& rhs) const
 {
     return boost::filesystem::file_size(lhs) < boost::filesystem::file_size(rhs);
@@ -35,6 +35,7 @@ public:
     using SampleName    = IReadReaderImpl::SampleName;
     using ReadContainer = IReadReaderImpl::ReadContainer;
     using SampleReadMap = IReadReaderImpl::SampleReadMap;
+    using DownsamplingParameters = IReadReaderImpl::DownsamplingParameters;
     
     ReadManager() = default;
     
@@ -75,6 +76,10 @@ public:
     SampleReadMap fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region) const;
     SampleReadMap fetch_reads(const GenomicRegion& region) const;
     
+    // Reads are downsampled independently in each file
+    SampleReadMap fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                              DownsamplingParameters downsampling) const;
+    
 private:
     using PathHash = octopus::utils::FilepathHash;
     
@@ -128,6 +133,9 @@ private:
     std::vector<Path> get_possible_reader_paths(const GenomicRegion& region) const;
     std::vector<Path> get_possible_reader_paths(const std::vector<SampleName>& samples,
                                                 const GenomicRegion& region) const;
+    template <typename Fetcher>
+    SampleReadMap fetch_sample_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                     Fetcher fetcher) const;
 };
 
 } // namespace io
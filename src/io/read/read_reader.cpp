@@ -237,6 +237,14 @@ ReadReader::SampleReadMap ReadReader::fetch_reads(const std::vector<SampleName>&
     return impl_->fetch_reads(samples, region);
 }
 
+ReadReader::SampleReadMap ReadReader::fetch_reads(const std::vector<SampleName>& samples,
+                                                  const GenomicRegion& region,
+                                                  const DownsamplingParameters downsampling) const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return impl_->fetch_reads(samples, region, downsampling);
+}
+
 bool operator==(const ReadReader& lhs, const ReadReader& rhs)
 {
     return lhs.path() == rhs.path();
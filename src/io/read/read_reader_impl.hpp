@@ -25,6 +25,13 @@ public:
     using SampleReadMap   = std::unordered_map<SampleName, ReadContainer>;
     using PositionList    = std::vector<GenomicRegion::Position>;
     
+    // Reads may be removed as they are fetched from positions where more than max_coverage
+    // reads have been fetched. Reads from the same template are removed together.
+    struct DownsamplingParameters
+    {
+        unsigned max_coverage;
+    };
+    
     virtual ~IReadReaderImpl() noexcept = default;
     
     virtual bool is_open() const noexcept = 0;
@@ -60,6 +67,9 @@ public:
                                       const GenomicRegion& region) const = 0;
     virtual SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
                                       const GenomicRegion& region) const = 0;
+    virtual SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
+                                      const GenomicRegion& region,
+                                      DownsamplingParameters downsampling) const { return fetch_reads(samples, region); }
     
     virtual std::vector<GenomicRegion::ContigName> reference_contigs() const = 0;
     virtual GenomicRegion::Size reference_size(const GenomicRegion::ContigName& contig) const = 0;
@@ -0,0 +1,316 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "bcf_record.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "vcf_spec.hpp"
+
+namespace octopus {
+
+namespace {
+
+template <typename T>
+T read(const std::uint8_t* data, const unsigned n) noexcept
+{
+    T result;
+    std::memcpy(&result, data + n * sizeof(T), sizeof(T));
+    return result;
+}
+
+// Widens the value to int32, keeping the missing and vector end sentinels
+std::int32_t read_int(const std::uint8_t* data, const int type, const unsigned n) noexcept
+{
+    switch (type) {
+        case BCF_BT_INT8:
+        {
+            const auto value = read<std::int8_t>(data, n);
+            if (value == bcf_int8_missing) return bcf_int32_missing;
+            if (value == bcf_int8_vector_end) return bcf_int32_vector_end;
+            return value;
+        }
+        case BCF_BT_INT16:
+        {
+            const auto value = read<std::int16_t>(data, n);
+            if (value == bcf_int16_missing) return bcf_int32_missing;
+            if (value == bcf_int16_vector_end) return bcf_int32_vector_end;
+            return value;
+        }
+        case BCF_BT_INT32:
+            return read<std::int32_t>(data, n);
+        default:
+            return bcf_int32_missing;
+    }
+}
+
+boost::optional<std::int32_t> decode_int(const std::uint8_t* data, const int type, const unsigned n) noexcept
+{
+    const auto value = read_int(data, type, n);
+    if (value == bcf_int32_missing || value == bcf_int32_vector_end) return boost::none;
+    return value;
+}
+
+boost::optional<float> decode_float(const std::uint8_t* data, const int type, const unsigned n) noexcept
+{
+    if (type != BCF_BT_FLOAT) return boost::none;
+    const auto value = read<float>(data, n);
+    if (bcf_float_is_missing(value) || bcf_float_is_vector_end(value)) return boost::none;
+    return value;
+}
+
+} // namespace
+
+BcfRecord::BcfRecord(HeaderPtr header, RecordPtr record)
+: header_ {std::move(header)}
+, record_ {std::move(record)}
+{}
+
+boost::optional<BcfRecord::KeyId> BcfRecord::find_key(const char* key) const noexcept
+{
+    const auto result = bcf_hdr_id2int(header_.get(), BCF_DT_ID, key);
+    if (result < 0) return boost::none;
+    return result;
+}
+
+const char* BcfRecord::chrom() const noexcept
+{
+    return bcf_hdr_id2name(header_.get(), record_->rid);
+}
+
+GenomicRegion::Position BcfRecord::pos() const noexcept
+{
+    return static_cast<GenomicRegion::Position>(record_->pos + 1);
+}
+
+GenomicRegion BcfRecord::mapped_region() const
+{
+    const auto begin = static_cast<GenomicRegion::Position>(record_->pos);
+    return GenomicRegion {chrom(), begin, begin + static_cast<GenomicRegion::Position>(record_->rlen)};
+}
+
+BcfRecord::StringRef BcfRecord::id() const noexcept
+{
+    unpack(BCF_UN_STR);
+    return record_->d.id;
+}
+
+BcfRecord::StringRef BcfRecord::ref() const noexcept
+{
+    unpack(BCF_UN_STR);
+    return record_->d.allele[0];
+}
+
+unsigned BcfRecord::num_alt() const noexcept
+{
+    return record_->n_allele > 0 ? record_->n_allele - 1 : 0;
+}
+
+BcfRecord::StringRef BcfRecord::alt(const unsigned n) const noexcept
+{
+    unpack(BCF_UN_STR);
+    return record_->d.allele[n + 1];
+}
+
+boost::optional<float> BcfRecord::qual() const noexcept
+{
+    if (bcf_float_is_missing(record_->qual)) return boost::none;
+    return record_->qual;
+}
+
+bool BcfRecord::is_filtered() const noexcept
+{
+    unpack(BCF_UN_FLT);
+    if (record_->d.n_flt == 0) return false;
+    return std::strcmp(bcf_hdr_int2id(header_.get(), BCF_DT_ID, record_->d.flt[0]), vcfspec::filter::pass) != 0;
+}
+
+bool BcfRecord::has_filter(const KeyId key) const noexcept
+{
+    unpack(BCF_UN_FLT);
+    return std::find(record_->d.flt, record_->d.flt + record_->d.n_flt, key) != record_->d.flt + record_->d.n_flt;
+}
+
+bool BcfRecord::has_info(const KeyId key) const noexcept
+{
+    return get_info(key) != nullptr;
+}
+
+unsigned BcfRecord::info_cardinality(const KeyId key) const noexcept
+{
+    const auto info = get_info(key);
+    return info != nullptr ? static_cast<unsigned>(info->len) : 0;
+}
+
+boost::optional<std::int32_t> BcfRecord::info_int(const KeyId key, const unsigned n) const noexcept
+{
+    const auto info = get_info(key);
+    if (info == nullptr || static_cast<int>(n) >= info->len) return boost::none;
+    return decode_int(info->vptr, info->type, n);
+}
+
+boost::optional<float> BcfRecord::info_float(const KeyId key, const unsigned n) const noexcept
+{
+    const auto info = get_info(key);
+    if (info == nullptr || static_cast<int>(n) >= info->len) return boost::none;
+    return decode_float(info->vptr, info->type, n);
+}
+
+BcfRecord::StringRef BcfRecord::info_string(const KeyId key) const noexcept
+{
+    const auto info = get_info(key);
+    if (info == nullptr || info->type != BCF_BT_CHAR) return {};
+    const auto data = reinterpret_cast<const char*>(info->vptr);
+    // Strings may be padded with NULs
+    return StringRef {data, static_cast<std::size_t>(std::find(data, data + info->len, '\0') - data)};
+}
+
+unsigned BcfRecord::num_samples() const noexcept
+{
+    return record_->n_sample;
+}
+
+bool BcfRecord::has_format(const KeyId key) const noexcept
+{
+    return get_format(key) != nullptr;
+}
+
+unsigned BcfRecord::format_cardinality(const KeyId key) const noexcept
+{
+    const auto format = get_format(key);
+    return format != nullptr ? static_cast<unsigned>(format->n) : 0;
+}
+
+boost::optional<std::int32_t> BcfRecord::format_int(const KeyId key, const SampleIndex sample, const unsigned n) const noexcept
+{
+    const auto format = get_format(key);
+    if (format == nullptr || sample >= num_samples() || static_cast<int>(n) >= format->n) return boost::none;
+    return decode_int(format->p + sample * format->size, format->type, n);
+}
+
+boost::optional<float> BcfRecord::format_float(const KeyId key, const SampleIndex sample, const unsigned n) const noexcept
+{
+    const auto format = get_format(key);
+    if (format == nullptr || sample >= num_samples() || static_cast<int>(n) >= format->n) return boost::none;
+    return decode_float(format->p + sample * format->size, format->type, n);
+}
+
+unsigned BcfRecord::ploidy(const SampleIndex sample) const noexcept
+{
+    const auto genotypes = get_genotypes();
+    if (genotypes == nullptr || sample >= num_samples()) return 0;
+    const auto data = genotypes->p + sample * genotypes->size;
+    unsigned result {0};
+    while (static_cast<int>(result) < genotypes->n
+           && read_int(data, genotypes->type, result) != bcf_int32_vector_end) {
+        ++result;
+    }
+    return result;
+}
+
+boost::optional<unsigned> BcfRecord::genotype_allele(const SampleIndex sample, const unsigned n) const noexcept
+{
+    if (n >= ploidy(sample)) return boost::none;
+    const auto genotypes = get_genotypes();
+    const auto value = read_int(genotypes->p + sample * genotypes->size, genotypes->type, n);
+    if (value == bcf_int32_missing || bcf_gt_is_missing(value)) return boost::none;
+    return static_cast<unsigned>(bcf_gt_allele(value));
+}
+
+bool BcfRecord::is_sample_phased(const SampleIndex sample) const noexcept
+{
+    // The phase of an allele is stored with the allele, and the first allele is always unphased
+    const auto sample_ploidy = ploidy(sample);
+    if (sample_ploidy < 2) return false;
+    const auto genotypes = get_genotypes();
+    const auto data = genotypes->p + sample * genotypes->size;
+    for (unsigned i {1}; i < sample_ploidy; ++i) {
+        if (!bcf_gt_is_phased(read_int(data, genotypes->type, i))) return false;
+    }
+    return true;
+}
+
+// private methods
+
+void BcfRecord::unpack(const int level) const noexcept
+{
+    if ((record_->unpacked & level) != level) {
+        bcf_unpack(record_.get(), level);
+    }
+}
+
+bcf_info_t* BcfRecord::get_info(const KeyId key) const noexcept
+{
+    unpack(BCF_UN_INFO);
+    const auto first = record_->d.info, last = record_->d.info + record_->n_info;
+    const auto itr = std::find_if(first, last, [key] (const bcf_info_t& info) { return info.key == key; });
+    // Removed fields are kept but have no data
+    return (itr != last && itr->vptr != nullptr) ? itr : nullptr;
+}
+
+bcf_fmt_t* BcfRecord::get_format(const KeyId key) const noexcept
+{
+    unpack(BCF_UN_FMT);
+    const auto first = record_->d.fmt, last = record_->d.fmt + record_->n_fmt;
+    const auto itr = std::find_if(first, last, [key] (const bcf_fmt_t& format) { return format.id == key; });
+    return (itr != last && itr->p != nullptr) ? itr : nullptr;
+}
+
+bcf_fmt_t* BcfRecord::get_genotypes() const noexcept
+{
+    const auto key = find_key(vcfspec::format::genotype);
+    return key ? get_format(*key) : nullptr;
+}
+
+// BcfRecordIterator
+
+BcfRecordIterator::BcfRecordIterator(ReaderPtr reader, BcfRecord::HeaderPtr header)
+: reader_ {std::move(reader)}
+, record_ {std::move(header), nullptr}
+{
+    next();
+}
+
+BcfRecordIterator::reference BcfRecordIterator::operator*() const noexcept
+{
+    return record_;
+}
+
+BcfRecordIterator::pointer BcfRecordIterator::operator->() const noexcept
+{
+    return &record_;
+}
+
+BcfRecordIterator& BcfRecordIterator::operator++()
+{
+    next();
+    return *this;
+}
+
+void BcfRecordIterator::next()
+{
+    if (bcf_sr_next_line(reader_.get())) {
+        const auto line = bcf_sr_get_line(reader_.get(), 0);
+        if (record_.record_ && record_.record_.use_count() == 1) {
+            bcf_copy(record_.record_.get(), line);
+        } else {
+            record_.record_.reset(bcf_dup(line), bcf_destroy);
+        }
+    } else {
+        reader_ = nullptr;
+        record_ = BcfRecord {};
+    }
+}
+
+bool operator==(const BcfRecordIterator& lhs, const BcfRecordIterator& rhs) noexcept
+{
+    return lhs.reader_ == rhs.reader_;
+}
+
+bool operator!=(const BcfRecordIterator& lhs, const BcfRecordIterator& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+} // namespace octopus
@@ -0,0 +1,129 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef bcf_record_hpp
+#define bcf_record_hpp
+
+#include <cstdint>
+#include <memory>
+#include <iterator>
+#include <cstddef>
+#include <utility>
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include "htslib/vcf.h"
+#include "htslib/synced_bcf_reader.h"
+
+#include "basics/genomic_region.hpp"
+
+namespace octopus {
+
+// A read-only record backed directly by the htslib record buffer. Fields are only unpacked when first
+// accessed and INFO/FORMAT values are returned typed, so reading a record allocates no strings.
+// Keys are referred to by header dictionary ids, which should be resolved once with find_key.
+// Copies share the same buffer. Accessors may unpack the buffer, so a record must not be read
+// concurrently from multiple threads.
+class BcfRecord
+{
+public:
+    using KeyId       = int;
+    using SampleIndex = unsigned;
+    using StringRef   = boost::string_ref;
+    using HeaderPtr   = std::shared_ptr<const bcf_hdr_t>;
+    using RecordPtr   = std::shared_ptr<bcf1_t>;
+    
+    BcfRecord() = default;
+    
+    BcfRecord(HeaderPtr header, RecordPtr record);
+    
+    BcfRecord(const BcfRecord&)            = default;
+    BcfRecord& operator=(const BcfRecord&) = default;
+    BcfRecord(BcfRecord&&)                 = default;
+    BcfRecord& operator=(BcfRecord&&)      = default;
+    
+    ~BcfRecord() = default;
+    
+    boost::optional<KeyId> find_key(const char* key) const noexcept;
+    
+    const char* chrom() const noexcept;
+    GenomicRegion::Position pos() const noexcept; // One based!
+    GenomicRegion mapped_region() const;
+    StringRef id() const noexcept;
+    StringRef ref() const noexcept;
+    unsigned num_alt() const noexcept;
+    StringRef alt(unsigned n) const noexcept;
+    boost::optional<float> qual() const noexcept;
+    bool is_filtered() const noexcept;
+    bool has_filter(KeyId key) const noexcept;
+    bool has_info(KeyId key) const noexcept;
+    unsigned info_cardinality(KeyId key) const noexcept;
+    boost::optional<std::int32_t> info_int(KeyId key, unsigned n = 0) const noexcept;
+    boost::optional<float> info_float(KeyId key, unsigned n = 0) const noexcept;
+    StringRef info_string(KeyId key) const noexcept;
+    
+    unsigned num_samples() const noexcept;
+    bool has_format(KeyId key) const noexcept;
+    unsigned format_cardinality(KeyId key) const noexcept;
+    boost::optional<std::int32_t> format_int(KeyId key, SampleIndex sample, unsigned n = 0) const noexcept;
+    boost::optional<float> format_float(KeyId key, SampleIndex sample, unsigned n = 0) const noexcept;
+    unsigned ploidy(SampleIndex sample) const noexcept;
+    boost::optional<unsigned> genotype_allele(SampleIndex sample, unsigned n) const noexcept;
+    bool is_sample_phased(SampleIndex sample) const noexcept;
+    
+    friend class BcfRecordIterator;
+
+private:
+    HeaderPtr header_;
+    RecordPtr record_;
+    
+    void unpack(int level) const noexcept;
+    bcf_info_t* get_info(KeyId key) const noexcept;
+    bcf_fmt_t* get_format(KeyId key) const noexcept;
+    bcf_fmt_t* get_genotypes() const noexcept;
+};
+
+// Reuses the current record buffer on increment if no copies of the current record are alive,
+// so a scan that does not retain records performs no per-record allocation.
+class BcfRecordIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = BcfRecord;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const BcfRecord*;
+    using reference         = const BcfRecord&;
+    
+    using ReaderPtr = std::shared_ptr<bcf_srs_t>;
+    
+    BcfRecordIterator() = default; // end
+    
+    BcfRecordIterator(ReaderPtr reader, BcfRecord::HeaderPtr header);
+    
+    BcfRecordIterator(const BcfRecordIterator&)            = default;
+    BcfRecordIterator& operator=(const BcfRecordIterator&) = default;
+    BcfRecordIterator(BcfRecordIterator&&)                 = default;
+    BcfRecordIterator& operator=(BcfRecordIterator&&)      = default;
+    
+    reference operator*() const noexcept;
+    pointer operator->() const noexcept;
+    
+    BcfRecordIterator& operator++();
+    
+    friend bool operator==(const BcfRecordIterator& lhs, const BcfRecordIterator& rhs) noexcept;
+
+private:
+    ReaderPtr reader_;
+    BcfRecord record_;
+    
+    void next();
+};
+
+bool operator!=(const BcfRecordIterator& lhs, const BcfRecordIterator& rhs) noexcept;
+
+using BcfRecordIteratorPair = std::pair<BcfRecordIterator, BcfRecordIterator>;
+
+} // namespace octopus
+
+#endif
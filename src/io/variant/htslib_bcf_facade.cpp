@@ -12,13 +12,18 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
+#include <cerrno>
+#include <cmath>
+#include <limits>
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/optional.hpp>
-#include <boost/container/small_vector.hpp>
+
+#include "htslib/hfile.h"
 
 #include "basics/genomic_region.hpp"
 #include "utils/string_utils.hpp"
+#include "exceptions/program_error.hpp"
 #include "vcf_spec.hpp"
 #include "vcf_header.hpp"
 #include "vcf_record.hpp"
@@ -31,8 +36,6 @@ namespace {
 
 static const std::string vcfMissingValue {vcfspec::missingValue};
 
-namespace bc = boost::container;
-
 } // namespace
 
 char* convert(const std::string& source)
@@ -79,6 +82,8 @@ HtslibBcfFacade::HtslibBcfFacade()
 , file_ {bcf_open("-", "[w]"), HtsFileDeleter {}}
 , header_ {bcf_hdr_init("w"), HtsHeaderDeleter {}}
 , samples_ {}
+, write_record_ {nullptr, HtsBcf1Deleter {}}
+, encode_buffers_ {}
 {
     if (file_ == nullptr) {
         throw std::runtime_error {"HtslibBcfFacade: could not open stdout writer"};
@@ -93,6 +98,8 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
 , file_ {nullptr, HtsFileDeleter {}}
 , header_ {nullptr, HtsHeaderDeleter {}}
 , samples_ {}
+, write_record_ {nullptr, HtsBcf1Deleter {}}
+, encode_buffers_ {}
 {
     const auto hts_mode = get_hts_mode(file_path_, mode);
     if (mode == Mode::read) {
@@ -280,6 +287,22 @@ HtslibBcfFacade::fetch_records(const GenomicRegion& region, const UnpackPolicy l
     return fetch_records(sr.get(), level, n_records);
 }
 
+BcfRecordIteratorPair HtslibBcfFacade::iterate_raw(const GenomicRegion& region) const
+{
+    HtsBcfSrPtr sr {bcf_sr_init(), HtsSrsDeleter {}};
+    const auto region_str = to_string(region);
+    
+    if (bcf_sr_set_regions(sr.get(), region_str.c_str(), 0) != 0) {
+        throw std::runtime_error {"failed load region " + region_str};
+    }
+    if (bcf_sr_add_reader(sr.get(), file_path_.c_str()) != 1) {
+        sr.release();
+        throw std::runtime_error {"failed to open file " + file_path_.string()};
+    }
+    BcfRecord::HeaderPtr header {bcf_hdr_dup(header_.get()), HtsHeaderDeleter {}};
+    return std::make_pair(BcfRecordIterator {std::move(sr), std::move(header)}, BcfRecordIterator {});
+}
+
 auto hts_tag_type(const std::string& tag)
 {
     using namespace vcfspec::header::meta::tag;
@@ -356,14 +379,11 @@ void HtslibBcfFacade::write(const VcfHeader& header)
 
 void set_chrom(const bcf_hdr_t* header, bcf1_t* record, const std::string& chrom);
 void set_pos(bcf1_t* record, GenomicRegion::Position pos);
-void set_id(bcf1_t* record, const std::string& id);
+void set_id(const bcf_hdr_t* header, bcf1_t* record, const std::string& id);
 void set_alleles(const bcf_hdr_t* header, bcf1_t* record, const VcfRecord::NucleotideSequence& ref,
                  const std::vector<VcfRecord::NucleotideSequence>& alts);
 void set_qual(bcf1_t* record, VcfRecord::QualityType qual);
 void set_filter(const bcf_hdr_t* header, bcf1_t* record, const std::vector<std::string>& filters);
-void set_info(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source);
-void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
-                 const std::vector<std::string>& samples);
 
 void HtslibBcfFacade::write(const VcfRecord& record)
 {
@@ -380,21 +400,194 @@ void HtslibBcfFacade::write(const VcfRecord& record)
         throw std::runtime_error {"HtslibBcfFacade: required contig header line missing for contig \"" + contig + "\""};
     }
     
-    auto hts_record = bcf_init();
+    if (write_record_) {
+        bcf_clear(write_record_.get()); // keeps the record's buffers for reuse
+    } else {
+        write_record_.reset(bcf_init());
+    }
+    const auto hts_record = write_record_.get();
     set_chrom(header_.get(), hts_record, contig);
     set_pos(hts_record, record.pos() - 1);
-    set_id(hts_record, record.id());
+    set_id(header_.get(), hts_record, record.id());
     set_alleles(header_.get(), hts_record, record.ref(), record.alt());
     if (record.qual()) {
         set_qual(hts_record, *record.qual());
     }
     set_filter(header_.get(), hts_record, record.filter());
-    set_info(header_.get(), hts_record, record);
+    encode_info(record);
     if (record.num_samples() > 0) {
-        set_samples(header_.get(), hts_record, record, samples_);
+        encode_samples(record);
     }
     bcf_write(file_.get(), header_.get(), hts_record);
-    bcf_destroy(hts_record);
+}
+
+namespace {
+
+bool is_bgzf_bcf(const htsFile* file) noexcept
+{
+    return (file->format.format == bcf || file->format.format == binary_format)
+            && file->format.compression == bgzf;
+}
+
+bool is_header_block_aligned(const htsFile* file) noexcept
+{
+    // htslib flushes the BGZF stream after writing a BCF header, so records normally start on a new block
+    return file->fp.bgzf->block_offset == file->fp.bgzf->block_length;
+}
+
+bool is_prefix_dictionary(const bcf_hdr_t* lhs, const bcf_hdr_t* rhs, const int type) noexcept
+{
+    if (lhs->n[type] > rhs->n[type]) return false;
+    for (int i {0}; i < lhs->n[type]; ++i) {
+        const auto lhs_key = lhs->id[type][i].key, rhs_key = rhs->id[type][i].key;
+        if (lhs_key == nullptr || rhs_key == nullptr) {
+            if (lhs_key != rhs_key) return false;
+        } else if (std::strcmp(lhs_key, rhs_key) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Raw BCF records refer to header lines by dictionary index, so they can only be copied into a
+// file whose header assigns the same index to every key the source header knows about.
+bool is_compatible(const bcf_hdr_t* source, const bcf_hdr_t* dest) noexcept
+{
+    return is_prefix_dictionary(source, dest, BCF_DT_ID)
+           && is_prefix_dictionary(source, dest, BCF_DT_CTG)
+           && bcf_hdr_nsamples(source) == bcf_hdr_nsamples(dest)
+           && is_prefix_dictionary(source, dest, BCF_DT_SAMPLE);
+}
+
+hts_idx_t* make_csi_index(const bcf_hdr_t* header, const std::uint64_t first_record_offset)
+{
+    // Same parameters as bcf_index_build
+    static constexpr int minShift {14};
+    std::int64_t max_contig_length {0};
+    for (int i {0}; i < header->n[BCF_DT_CTG]; ++i) {
+        const auto contig_info = header->id[BCF_DT_CTG][i].val;
+        if (contig_info != nullptr) {
+            max_contig_length = std::max(max_contig_length, static_cast<std::int64_t>(contig_info->info[0]));
+        }
+    }
+    max_contig_length += 256;
+    int num_levels {0};
+    for (std::int64_t s {1 << minShift}; max_contig_length > s; s <<= 3) ++num_levels;
+    return hts_idx_init(header->n[BCF_DT_CTG], HTS_FMT_CSI, first_record_offset, minShift, num_levels);
+}
+
+struct HtsIdxDeleter
+{
+    void operator()(hts_idx_t* index) const { hts_idx_destroy(index); }
+};
+
+using HtsIdxPtr = std::unique_ptr<hts_idx_t, HtsIdxDeleter>;
+
+std::uint64_t shift_virtual_offset(const std::uint64_t offset, const std::int64_t block_shift) noexcept
+{
+    // Blocks are copied byte-for-byte, so only the compressed part of a virtual offset changes
+    const auto block_address = static_cast<std::int64_t>(offset >> 16) + block_shift;
+    return (static_cast<std::uint64_t>(block_address) << 16) | (offset & 0xFFFF);
+}
+
+void index_records(htsFile* source, bcf_hdr_t* header, const std::int64_t block_shift, hts_idx_t* index)
+{
+    std::unique_ptr<bcf1_t, decltype(&bcf_destroy)> record {bcf_init(), &bcf_destroy};
+    int status;
+    // bcf_read only loads the raw record buffers; nothing is unpacked
+    while ((status = bcf_read(source, header, record.get())) == 0) {
+        const auto end_offset = shift_virtual_offset(bgzf_tell(source->fp.bgzf), block_shift);
+        if (hts_idx_push(index, record->rid, record->pos, record->pos + record->rlen, end_offset, 1) < 0) {
+            throw std::runtime_error {"HtslibBcfFacade: failed to index concatenated record"};
+        }
+    }
+    if (status < -1) {
+        throw std::runtime_error {"HtslibBcfFacade: failed to read record during concatenation"};
+    }
+}
+
+bool ends_with_eof_marker(hFILE* file, const off_t file_size)
+{
+    static constexpr std::array<char, 28> eofMarker {{
+        '\037', '\213', '\010', '\4', '\0', '\0', '\0', '\0', '\0', '\377', '\6', '\0', '\102', '\103',
+        '\2', '\0', '\033', '\0', '\3', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0'
+    }};
+    if (file_size < static_cast<off_t>(eofMarker.size())) return false;
+    std::array<char, 28> tail;
+    if (hseek(file, file_size - static_cast<off_t>(tail.size()), SEEK_SET) < 0) return false;
+    if (hread(file, tail.data(), tail.size()) != static_cast<ssize_t>(tail.size())) return false;
+    return tail == eofMarker;
+}
+
+off_t copy_compressed_blocks(hFILE* source, const off_t begin, const off_t source_size,
+                             hFILE* dest, std::vector<char>& buffer)
+{
+    // The trailing EOF marker is an empty block; dropping it keeps the output free of spurious EOF blocks
+    const auto end = ends_with_eof_marker(source, source_size) ? source_size - 28 : source_size;
+    if (hseek(source, begin, SEEK_SET) < 0) {
+        throw std::runtime_error {"HtslibBcfFacade: failed to seek during concatenation"};
+    }
+    auto num_remaining = end - begin;
+    while (num_remaining > 0) {
+        const auto num_to_read = std::min(static_cast<std::size_t>(num_remaining), buffer.size());
+        const auto num_read = hread(source, buffer.data(), num_to_read);
+        if (num_read <= 0 || hwrite(dest, buffer.data(), num_read) != num_read) {
+            throw std::runtime_error {"HtslibBcfFacade: failed to copy blocks during concatenation"};
+        }
+        num_remaining -= num_read;
+    }
+    return end - begin;
+}
+
+} // namespace
+
+bool HtslibBcfFacade::is_block_concatenable(const std::vector<Path>& sources) const
+{
+    if (file_ == nullptr || header_ == nullptr || !is_bgzf_bcf(file_.get())) return false;
+    return std::all_of(std::cbegin(sources), std::cend(sources), [this] (const Path& source) {
+        std::unique_ptr<htsFile, HtsFileDeleter> file {bcf_open(source.c_str(), "r"), HtsFileDeleter {}};
+        if (file == nullptr || !is_bgzf_bcf(file.get())) return false;
+        std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> header {bcf_hdr_read(file.get()), HtsHeaderDeleter {}};
+        return header != nullptr && is_header_block_aligned(file.get()) && is_compatible(header.get(), header_.get());
+    });
+}
+
+bool HtslibBcfFacade::block_concatenate(const std::vector<Path>& sources)
+{
+    if (!is_block_concatenable(sources)) {
+        throw std::runtime_error {"HtslibBcfFacade: cannot block concatenate given files"};
+    }
+    BGZF* dest = file_->fp.bgzf;
+    if (bgzf_flush(dest) != 0) {
+        throw std::runtime_error {"HtslibBcfFacade: failed to flush " + file_path_.string()};
+    }
+    HtsIdxPtr index {nullptr, HtsIdxDeleter {}};
+    if (!file_path_.empty()) {
+        index.reset(make_csi_index(header_.get(), static_cast<std::uint64_t>(htell(dest->fp)) << 16));
+    }
+    static constexpr std::size_t copyBufferSize {1 << 20};
+    std::vector<char> buffer(copyBufferSize);
+    for (const auto& source : sources) {
+        std::unique_ptr<htsFile, HtsFileDeleter> file {bcf_open(source.c_str(), "r"), HtsFileDeleter {}};
+        std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> header {bcf_hdr_read(file.get()), HtsHeaderDeleter {}};
+        const auto source_begin = static_cast<off_t>(bgzf_tell(file->fp.bgzf) >> 16);
+        const auto dest_begin = htell(dest->fp);
+        if (index) {
+            index_records(file.get(), header.get(), dest_begin - source_begin, index.get());
+        }
+        const auto source_size = static_cast<off_t>(boost::filesystem::file_size(source));
+        copy_compressed_blocks(file->fp.bgzf->fp, source_begin, source_size, dest->fp, buffer);
+        // Keep the BGZF stream in sync with the raw writes so later writes and bgzf_tell are correct
+        dest->block_address = htell(dest->fp);
+    }
+    if (index) {
+        if (hts_idx_finish(index.get(), static_cast<std::uint64_t>(htell(dest->fp)) << 16) != 0
+            || hts_idx_save(index.get(), file_path_.c_str(), HTS_FMT_CSI) != 0) {
+            throw std::runtime_error {"HtslibBcfFacade: failed to write index for " + file_path_.string()};
+        }
+        return true;
+    }
+    return false;
 }
 
 // HtslibBcfFacade::RecordIterator
@@ -494,9 +687,9 @@ void extract_id(const bcf1_t* record, VcfRecord::Builder& builder)
     builder.set_id(record->d.id);
 }
 
-void set_id(bcf1_t* record, const std::string& id)
+void set_id(const bcf_hdr_t* header, bcf1_t* record, const std::string& id)
 {
-    record->d.id = convert(id);
+    bcf_update_id(header, record, id.c_str());
 }
 
 void extract_ref(const bcf1_t* record, VcfRecord::Builder& builder)
@@ -621,40 +814,96 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
     if (flaginfo != nullptr) std::free(flaginfo);
 }
 
-void set_info(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source)
+namespace {
+
+class MalformedRecordValue : public ProgramError
 {
+public:
+    MalformedRecordValue(std::string key, std::string value, std::string type)
+    : key_ {std::move(key)}
+    , value_ {std::move(value)}
+    , type_ {std::move(type)}
+    {}
+    
+private:
+    std::string key_, value_, type_;
+    
+    std::string do_where() const override
+    {
+        return "HtslibBcfFacade::write";
+    }
+    
+    std::string do_why() const override
+    {
+        return "The value \"" + value_ + "\" of field " + key_ + " is not a valid " + type_;
+    }
+};
+
+// strtol/strtof rather than std::stoi/std::stof as values are almost always written by us, so
+// there is no need to construct strings or unwind exceptions for every value. Anything that
+// does not parse completely is still rejected, rather than silently written as 0.
+std::int32_t parse_int(const std::string& value, const VcfRecord::KeyType& key)
+{
+    if (value == vcfMissingValue) return bcf_int32_missing;
+    char* end {nullptr};
+    errno = 0;
+    const auto result = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || end != value.c_str() + value.size() || errno == ERANGE
+        || result < std::numeric_limits<std::int32_t>::min() || result > std::numeric_limits<std::int32_t>::max()) {
+        throw MalformedRecordValue {key, value, "Integer"};
+    }
+    return static_cast<std::int32_t>(result);
+}
+
+float parse_float(const std::string& value, const VcfRecord::KeyType& key)
+{
+    if (value == vcfMissingValue) return bcf_float_missing;
+    char* end {nullptr};
+    errno = 0;
+    const auto result = std::strtof(value.c_str(), &end);
+    // ERANGE is also set on underflow, which still gives a usable (zero or denormal) value
+    if (value.empty() || end != value.c_str() + value.size() || (errno == ERANGE && std::isinf(result))) {
+        throw MalformedRecordValue {key, value, "Float"};
+    }
+    return result;
+}
+
+} // namespace
+
+void HtslibBcfFacade::encode_info(const VcfRecord& source)
+{
+    const auto header = header_.get();
+    const auto dest = write_record_.get();
+    auto& buffers = encode_buffers_;
     for (const auto& key : source.info_keys()) {
         const auto& values    = source.info_value(key);
         const auto num_values = static_cast<int>(values.size());
         
-        static constexpr std::size_t defaultBufferCapacity {100};
-        
         switch (bcf_hdr_id2type(header, BCF_HL_INFO, bcf_hdr_id2int(header, BCF_DT_ID, key.c_str()))) {
             case BCF_HT_INT:
             {
-                bc::small_vector<int, defaultBufferCapacity> vals(num_values);
-                std::transform(std::cbegin(values), std::cend(values), std::begin(vals),
-                               [] (const auto& v) {
-                                   return v != vcfMissingValue ? std::stoi(v) : bcf_int32_missing;
-                               });
-                bcf_update_info_int32(header, dest, key.c_str(), vals.data(), num_values);
+                buffers.ints.resize(num_values);
+                std::transform(std::cbegin(values), std::cend(values), std::begin(buffers.ints),
+                               [&key] (const auto& value) { return parse_int(value, key); });
+                bcf_update_info_int32(header, dest, key.c_str(), buffers.ints.data(), num_values);
                 break;
             }
             case BCF_HT_REAL:
             {
-                bc::small_vector<float, defaultBufferCapacity> vals(num_values);
-                std::transform(std::cbegin(values), std::cend(values), std::begin(vals),
-                               [] (const auto& v) {
-                                   return v != vcfMissingValue ? std::stof(v) : bcf_float_missing;
-                               });
-                bcf_update_info_float(header, dest, key.c_str(), vals.data(), num_values);
+                buffers.floats.resize(num_values);
+                std::transform(std::cbegin(values), std::cend(values), std::begin(buffers.floats),
+                               [&key] (const auto& value) { return parse_float(value, key); });
+                bcf_update_info_float(header, dest, key.c_str(), buffers.floats.data(), num_values);
                 break;
             }
             case BCF_HT_STR:
             {
-                // Can we also use small_vector here?
-                const auto vals = utils::join(values, vcfspec::info::valueSeperator);
-                bcf_update_info_string(header, dest, key.c_str(), vals.c_str());
+                buffers.joined.clear();
+                for (const auto& value : values) {
+                    if (!buffers.joined.empty()) buffers.joined += vcfspec::info::valueSeperator;
+                    buffers.joined += value;
+                }
+                bcf_update_info_string(header, dest, key.c_str(), buffers.joined.c_str());
                 break;
             }
             case BCF_HT_FLAG:
@@ -796,21 +1045,27 @@ void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder
     }
 }
 
-template <typename T, typename Container>
-auto genotype_number(const T& allele, const Container& alleles, const bool is_phased)
+namespace {
+
+auto genotype_number(const std::string& allele, const std::vector<const std::string*>& alleles, const bool is_phased)
 {
     if (allele == vcfMissingValue) {
         return (is_phased) ? bcf_gt_missing + 1 : bcf_gt_missing;
     }
-    const auto it = std::find(std::cbegin(alleles), std::cend(alleles), allele);
+    const auto it = std::find_if(std::cbegin(alleles), std::cend(alleles),
+                                 [&allele] (const std::string* other) { return *other == allele; });
     const auto allele_num = 2 * static_cast<decltype(bcf_gt_missing)>(std::distance(std::cbegin(alleles), it)) + 2;
     return (is_phased) ? allele_num + 1 : allele_num;
 }
 
-void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
-                 const std::vector<std::string>& samples)
+} // namespace
+
+void HtslibBcfFacade::encode_samples(const VcfRecord& source)
 {
-    if (samples.empty()) return;
+    if (samples_.empty()) return;
+    const auto header = header_.get();
+    const auto dest = write_record_.get();
+    auto& buffers = encode_buffers_;
     const auto num_samples = static_cast<int>(source.num_samples());
     const auto& format = source.format();
     if (format.empty()) return;
@@ -818,81 +1073,74 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
     auto first_format = std::cbegin(format);
     if (*first_format == vcfspec::format::genotype) {
         const auto& alt_alleles = source.alt();
-        bc::small_vector<VcfRecord::NucleotideSequence, 5> alleles {};
-        alleles.reserve(alt_alleles.size() + 1);
-        alleles.push_back(source.ref());
-        alleles.insert(std::end(alleles), std::cbegin(alt_alleles), std::cend(alt_alleles));
+        buffers.alleles.clear();
+        buffers.alleles.push_back(&source.ref());
+        for (const auto& allele : alt_alleles) buffers.alleles.push_back(&allele);
         
         unsigned max_ploidy {};
-        for (const auto& sample : samples) {
+        for (const auto& sample : samples_) {
             const auto p = source.ploidy(sample);
             if (p > max_ploidy) max_ploidy = p;
         }
         
         const auto ngt = num_samples * static_cast<int>(max_ploidy);
-        bc::small_vector<int, 1000> genotype(ngt);
-        auto it = std::begin(genotype);
+        buffers.ints.resize(ngt);
+        auto it = std::begin(buffers.ints);
         
-        for (const auto& sample : samples) {
+        for (const auto& sample : samples_) {
             const bool is_phased {source.is_sample_phased(sample)};
             const auto& genotype = source.get_sample_value(sample, vcfspec::format::genotype);
             const auto ploidy = static_cast<unsigned>(genotype.size());
             
             it = std::transform(std::cbegin(genotype), std::cend(genotype), it,
-                                [is_phased, &alleles] (const auto& allele) {
-                                    return genotype_number(allele, alleles, is_phased);
+                                [is_phased, &buffers] (const auto& allele) {
+                                    return genotype_number(allele, buffers.alleles, is_phased);
                                 });
             it = std::fill_n(it, max_ploidy - ploidy, bcf_int32_vector_end);
         }
         
-        bcf_update_genotypes(header, dest, genotype.data(), ngt);
+        bcf_update_genotypes(header, dest, buffers.ints.data(), ngt);
         ++first_format;
     }
     
     std::for_each(first_format, std::cend(format), [&] (const auto& key) {
         const auto num_values = num_samples * static_cast<int>(source.format_cardinality(key));
-
-        static constexpr std::size_t defaultValueCapacity {100};
         
         switch (bcf_hdr_id2type(header, BCF_HL_FMT, bcf_hdr_id2int(header, BCF_DT_ID, key.c_str()))) {
           case BCF_HT_INT:
           {
-              bc::small_vector<int, defaultValueCapacity> typed_values(num_values);
-              auto it = std::begin(typed_values);
-              for (const auto& sample : samples) {
+              buffers.ints.resize(num_values);
+              auto it = std::begin(buffers.ints);
+              for (const auto& sample : samples_) {
                   const auto& values = source.get_sample_value(sample, key);
                   it = std::transform(std::cbegin(values), std::cend(values), it,
-                                      [] (const auto& v) {
-                                          return v != vcfMissingValue ? std::stoi(v) : bcf_int32_missing;
-                                      });
+                                     [&key] (const auto& value) { return parse_int(value, key); });
               }
-              bcf_update_format_int32(header, dest, key.c_str(), typed_values.data(), num_values);
+              bcf_update_format_int32(header, dest, key.c_str(), buffers.ints.data(), num_values);
               break;
           }
           case BCF_HT_REAL:
           {
-              bc::small_vector<float, defaultValueCapacity> typed_values(num_values);
-              auto it = std::begin(typed_values);
-              for (const auto& sample : samples) {
+              buffers.floats.resize(num_values);
+              auto it = std::begin(buffers.floats);
+              for (const auto& sample : samples_) {
                   const auto& values = source.get_sample_value(sample, key);
                   it = std::transform(std::cbegin(values), std::cend(values), it,
-                                      [] (const auto& v) {
-                                          return v != vcfMissingValue ? std::stof(v) : bcf_float_missing;
-                                      });
+                                     [&key] (const auto& value) { return parse_float(value, key); });
               }
-              bcf_update_format_float(header, dest, key.c_str(), typed_values.data(), num_values);
+              bcf_update_format_float(header, dest, key.c_str(), buffers.floats.data(), num_values);
               break;
           }
           case BCF_HT_STR:
           {
-              bc::small_vector<const char*, defaultValueCapacity> typed_values(num_values);
-              auto it = std::begin(typed_values);
-              for (const auto& sample : samples) {
+              buffers.strings.resize(num_values);
+              auto it = std::begin(buffers.strings);
+              for (const auto& sample : samples_) {
                   const auto& values = source.get_sample_value(sample, key);
                   it = std::transform(std::cbegin(values), std::cend(values), it,
                                       [] (const auto& value) { return value.c_str(); });
               }
-              bcf_update_format_string(header, dest, key.c_str(), typed_values.data(), num_values);
+              bcf_update_format_string(header, dest, key.c_str(), buffers.strings.data(), num_values);
               break;
           }
         }
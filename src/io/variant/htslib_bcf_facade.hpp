@@ -5,9 +5,11 @@
 #define htslib_bcf_facade_hpp
 
 #include <string>
+#include <vector>
 #include <set>
 #include <memory>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 
 #include <boost/filesystem/path.hpp>
@@ -18,6 +20,7 @@
 
 #include "vcf_reader_impl.hpp"
 #include "vcf_record.hpp"
+#include "bcf_record.hpp"
 
 namespace octopus {
 
@@ -61,9 +64,17 @@ public:
     RecordContainer fetch_records(const std::string& contig, UnpackPolicy level) const override;
     RecordContainer fetch_records(const GenomicRegion& region, UnpackPolicy level) const override;
     
+    BcfRecordIteratorPair iterate_raw(const GenomicRegion& region) const;
+    
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
     
+    bool is_block_concatenable(const std::vector<Path>& sources) const;
+    // Appends the records of each source by copying compressed blocks directly, without
+    // decoding records. If this is an indexable file then an index is built in the same pass.
+    // Returns true if an index was written.
+    bool block_concatenate(const std::vector<Path>& sources);
+    
 private:
     struct HtsFileDeleter
     {
@@ -85,11 +96,26 @@ private:
     using HtsBcfSrPtr = std::unique_ptr<bcf_srs_t, HtsSrsDeleter>;
     using HtsBcf1Ptr  = std::unique_ptr<bcf1_t, HtsBcf1Deleter>;
     
+    // Typed value buffers reused for every written record, so encoding does not allocate
+    // once they have grown to fit the largest record
+    struct EncodeBuffers
+    {
+        std::vector<std::int32_t> ints;
+        std::vector<float> floats;
+        std::vector<const char*> strings;
+        std::vector<const std::string*> alleles;
+        std::string joined;
+    };
+    
     Path file_path_;
     std::unique_ptr<htsFile, HtsFileDeleter> file_;
     std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> header_;
     std::vector<std::string> samples_;
+    HtsBcf1Ptr write_record_;
+    EncodeBuffers encode_buffers_;
     
+    void encode_info(const VcfRecord& source);
+    void encode_samples(const VcfRecord& source);
     std::size_t count_records(HtsBcfSrPtr& sr) const;
     VcfRecord fetch_record(const bcf_srs_t* sr, UnpackPolicy level) const;
     RecordContainer fetch_records(bcf_srs_t*, UnpackPolicy level, size_t num_records) const;
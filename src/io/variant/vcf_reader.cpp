@@ -226,6 +226,22 @@ VcfReader::RecordIteratorPair VcfReader::iterate(const GenomicRegion& region, co
     return std::make_pair(std::move(p.first), std::move(p.second));
 }
 
+bool VcfReader::is_raw_iterable() const noexcept
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return dynamic_cast<const HtslibBcfFacade*>(reader_.get()) != nullptr;
+}
+
+BcfRecordIteratorPair VcfReader::iterate_raw(const GenomicRegion& region) const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    const auto hts_reader = dynamic_cast<const HtslibBcfFacade*>(reader_.get());
+    if (hts_reader == nullptr) {
+        throw std::runtime_error {"VcfReader: raw iteration is not supported for " + file_path_.string()};
+    }
+    return hts_reader->iterate_raw(region);
+}
+
 // non member methods
 
 bool operator==(const VcfReader& lhs, const VcfReader& rhs)
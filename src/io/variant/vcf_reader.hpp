@@ -17,6 +17,7 @@
 #include <boost/filesystem.hpp>
 
 #include "vcf_reader_impl.hpp"
+#include "bcf_record.hpp"
 
 namespace octopus {
 
@@ -67,6 +68,10 @@ public:
     RecordIteratorPair iterate(const std::string& contig, UnpackPolicy level = UnpackPolicy::all) const;
     RecordIteratorPair iterate(const GenomicRegion& region, UnpackPolicy level = UnpackPolicy::all) const;
     
+    // Raw iteration skips VcfRecord construction entirely, but is only possible for BCF or bgzipped VCF
+    bool is_raw_iterable() const noexcept;
+    BcfRecordIteratorPair iterate_raw(const GenomicRegion& region) const;
+    
 private:
     Path file_path_;
     std::unique_ptr<IVcfReaderImpl> reader_;
@@ -431,6 +431,37 @@ void merge(const std::vector<VcfReader>& sources, VcfWriter& dst)
 
 namespace {
 
+auto get_paths(const std::vector<VcfReader>& readers)
+{
+    std::vector<VcfReader::Path> result {};
+    result.reserve(readers.size());
+    std::transform(std::cbegin(readers), std::cend(readers), std::back_inserter(result),
+                   [] (const auto& reader) { return reader.path(); });
+    return result;
+}
+
+} // namespace
+
+bool is_block_concatenable(const std::vector<VcfReader>& sources, const VcfWriter& dst)
+{
+    return dst.is_block_concatenable(get_paths(sources));
+}
+
+void concatenate(const std::vector<VcfReader>& sources, VcfWriter& dst)
+{
+    if (sources.empty()) return;
+    const auto paths = get_paths(sources);
+    if (dst.is_block_concatenable(paths)) {
+        dst.block_concatenate(paths);
+    } else {
+        for (const auto& source : sources) {
+            copy(source, dst);
+        }
+    }
+}
+
+namespace {
+
 bool has_deleted(const VcfRecord::NucleotideSequence& allele) noexcept
 {
     return std::find(std::cbegin(allele), std::cend(allele), vcfspec::deletedBase) != std::cend(allele);
@@ -47,6 +47,11 @@ void merge(const std::vector<VcfReader>& sources, VcfWriter& dst,
 
 void merge(const std::vector<VcfReader>& sources, VcfWriter& dst);
 
+bool is_block_concatenable(const std::vector<VcfReader>& sources, const VcfWriter& dst);
+
+// Sources must be sorted, non-overlapping, and given in output order.
+void concatenate(const std::vector<VcfReader>& sources, VcfWriter& dst);
+
 void convert_to_legacy(const VcfReader& src, VcfWriter& dst, bool remove_ref_pad_duplicates = true);
 
 } // namespace octopus    
@@ -32,12 +32,14 @@ VcfWriter::VcfWriter()
 : file_path_ {}
 , writer_ {make_vcf_writer()}
 , is_header_written_ {false}
+, is_index_written_ {false}
 {}
 
 VcfWriter::VcfWriter(Path file_path)
 : file_path_ {std::move(file_path)}
 , writer_ {nullptr}
 , is_header_written_ {false}
+, is_index_written_ {false}
 {
     using namespace boost::filesystem;
     
@@ -79,6 +81,7 @@ VcfWriter::VcfWriter(VcfWriter&& other)
     std::lock_guard<std::mutex> lock {other.mutex_};
     file_path_         = std::move(other.file_path_);
     is_header_written_ = other.is_header_written_;
+    is_index_written_  = other.is_index_written_;
     writer_            = std::move(other.writer_);
 }
 
@@ -89,6 +92,7 @@ VcfWriter& VcfWriter::operator=(VcfWriter&& other)
         std::lock(lock_lhs, lock_rhs);
         file_path_         = std::move(other.file_path_);
         is_header_written_ = other.is_header_written_;
+        is_index_written_  = other.is_index_written_;
         writer_            = std::move(other.writer_);
     }
     return *this;
@@ -114,6 +118,7 @@ void swap(VcfWriter& lhs, VcfWriter& rhs) noexcept
     using std::swap;
     swap(lhs.file_path_, rhs.file_path_);
     swap(lhs.is_header_written_, rhs.is_header_written_);
+    swap(lhs.is_index_written_, rhs.is_index_written_);
     swap(lhs.writer_, rhs.writer_);
 }
 
@@ -129,6 +134,7 @@ void VcfWriter::open(Path file_path)
     file_path_         = std::move(file_path);
     writer_            = make_vcf_writer(*file_path_);
     is_header_written_ = false;
+    is_index_written_  = false;
 }
 
 void VcfWriter::close() noexcept
@@ -161,14 +167,31 @@ void VcfWriter::write(const VcfRecord& record)
     std::lock_guard<std::mutex> lock {mutex_};
     if (is_header_written_) {
         writer_->write(record);
+        is_index_written_ = false;
     } else {
         throw std::runtime_error {"VcfWriter::write: cannot write record as header has not been written"};
     }
 }
 
+bool VcfWriter::is_block_concatenable(const std::vector<Path>& sources) const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return is_header_written_ && writer_ && writer_->is_block_concatenable(sources);
+}
+
+void VcfWriter::block_concatenate(const std::vector<Path>& sources)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (is_header_written_) {
+        is_index_written_ = writer_->block_concatenate(sources);
+    } else {
+        throw std::runtime_error {"VcfWriter::block_concatenate: cannot concatenate as header has not been written"};
+    }
+}
+
 bool VcfWriter::can_write_index() const noexcept
 {
-    return file_path_ && is_header_written_
+    return file_path_ && is_header_written_ && !is_index_written_
            && is_indexable(*file_path_) && boost::filesystem::exists(*file_path_);
 }
 
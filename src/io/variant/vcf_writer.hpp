@@ -9,6 +9,7 @@
 #include <type_traits>
 #include <functional>
 #include <iterator>
+#include <vector>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
@@ -51,10 +52,13 @@ public:
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
     
+    bool is_block_concatenable(const std::vector<Path>& sources) const;
+    void block_concatenate(const std::vector<Path>& sources);
+    
 private:
     boost::optional<Path> file_path_;
     std::unique_ptr<HtslibBcfFacade> writer_;
-    bool is_header_written_;
+    bool is_header_written_, is_index_written_;
     mutable std::mutex mutex_;
     
     bool can_write_index() const noexcept;
@@ -4,6 +4,16 @@
 #include "logging.hpp"
 
 #include <iostream>
+#include <vector>
+#include <functional>
+#include <cstdlib>
+#include <mutex>
+
+#include <boost/make_shared.hpp>
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
 
 namespace octopus { namespace logging {
 
@@ -24,61 +34,90 @@ std::ostream& operator<<(std::ostream& os, severity_level level)
     return os;
 }
 
-void init(boost::optional<boost::filesystem::path> debug_log,
-          boost::optional<boost::filesystem::path> trace_log)
+namespace {
+
+// Records are formatted and written on a dedicated thread per sink, so logging threads only pay
+// for queueing. The queue is bounded so a slow sink applies back pressure rather than growing
+// without limit.
+constexpr std::size_t maxQueuedRecords {10'000};
+
+template <typename Backend>
+using AsyncSink = sinks::asynchronous_sink<Backend, sinks::bounded_fifo_queue<maxQueuedRecords, sinks::block_on_overflow>>;
+
+std::mutex sinks_mutex {};
+std::vector<std::function<void()>> sink_stoppers {};
+std::vector<std::function<void()>> sink_flushers {};
+
+void stop_sinks()
 {
-    logging::add_console_log
-    (
-        std::clog,
-        keywords::filter =
-        (
-            severity != severity_level::debug && severity != severity_level::trace
-        ),
-        keywords::format =
-        (
-         expr::stream
+    std::lock_guard<std::mutex> lock {sinks_mutex};
+    for (auto& stop : sink_stoppers) stop();
+    sink_stoppers.clear();
+    sink_flushers.clear();
+}
+
+template <typename Sink>
+void add_sink(boost::shared_ptr<Sink> sink)
+{
+    logging::core::get()->add_sink(sink);
+    std::lock_guard<std::mutex> lock {sinks_mutex};
+    sink_stoppers.push_back([sink] () {
+        logging::core::get()->remove_sink(sink);
+        sink->stop();
+        sink->flush();
+    });
+    sink_flushers.push_back([sink] () { sink->flush(); });
+    static const bool stop_on_exit {std::atexit(stop_sinks) == 0};
+    (void) stop_on_exit;
+}
+
+auto make_formatter()
+{
+    return expr::stream
             << expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "[%Y-%m-%d %H:%M:%S]")
             << " <" << severity
-            << "> " << expr::smessage
-        )
-    );
-    
+            << "> " << expr::smessage;
+}
+
+void add_console_log()
+{
+    auto backend = boost::make_shared<sinks::text_ostream_backend>();
+    backend->add_stream(boost::shared_ptr<std::ostream> {&std::clog, boost::null_deleter {}});
+    backend->auto_flush(true);
+    auto sink = boost::make_shared<AsyncSink<sinks::text_ostream_backend>>(backend);
+    sink->set_filter(severity != severity_level::debug && severity != severity_level::trace);
+    sink->set_formatter(make_formatter());
+    add_sink(sink);
+}
+
+template <typename Filter>
+void add_file_log(const boost::filesystem::path& file, Filter filter)
+{
+    auto backend = boost::make_shared<sinks::text_file_backend>(keywords::file_name = file.c_str());
+    auto sink = boost::make_shared<AsyncSink<sinks::text_file_backend>>(backend);
+    sink->set_filter(filter);
+    sink->set_formatter(make_formatter());
+    add_sink(sink);
+}
+
+} // namespace
+
+void flush()
+{
+    std::lock_guard<std::mutex> lock {sinks_mutex};
+    for (auto& flush_sink : sink_flushers) flush_sink();
+}
+
+void init(boost::optional<boost::filesystem::path> debug_log,
+          boost::optional<boost::filesystem::path> trace_log)
+{
+    add_console_log();
     if (debug_log) {
-        logging::add_file_log
-        (
-         keywords::file_name = debug_log->c_str(),
-         keywords::filter =
-         (
-          severity != severity_level::trace
-          ),
-         keywords::format =
-         (
-            expr::stream
-                << expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "[%Y-%m-%d %H:%M:%S]")
-                << " <" << severity
-                << "> " << expr::smessage
-          )
-         );
+        add_file_log(*debug_log, severity != severity_level::trace);
     }
-    
     if (trace_log) {
-        logging::add_file_log
-        (
-         keywords::file_name = trace_log->c_str(),
-         keywords::filter =
-         (
-          severity != severity_level::debug
-          ),
-         keywords::format =
-         (
-          expr::stream
-                << expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "[%Y-%m-%d %H:%M:%S]")
-                << " <" << severity
-                << "> " << expr::smessage
-          )
-         );
+        add_file_log(*trace_log, severity != severity_level::debug);
     }
-    
     logging::add_common_attributes();
 }
 
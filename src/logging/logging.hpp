@@ -46,13 +46,21 @@ BOOST_LOG_ATTRIBUTE_KEYWORD(severity, "Severity", severity_level)
 void init(boost::optional<boost::filesystem::path> debug_log = boost::none,
           boost::optional<boost::filesystem::path> trace_log = boost::none);
 
+// Blocks until every record logged so far has been written
+void flush();
+
 template <severity_level L>
 class Logger
 {
 public:
     Logger() : lg_ {logger::get()} {}
     
-    template <typename T> void write(const T& msg) { BOOST_LOG_SEV(lg_, L) << msg; }
+    // Errors are written before returning, as they are often followed by termination
+    template <typename T> void write(const T& msg)
+    {
+        BOOST_LOG_SEV(lg_, L) << msg;
+        if (L >= severity_level::error) flush();
+    }
     
 private:
     src::severity_logger<severity_level> lg_;
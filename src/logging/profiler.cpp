@@ -0,0 +1,309 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "profiler.hpp"
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include <utility>
+
+#include <boost/filesystem/fstream.hpp>
+
+namespace octopus { namespace profiling {
+
+namespace {
+
+constexpr std::size_t numStages {static_cast<std::size_t>(Stage::count)};
+constexpr std::size_t numCounters {static_cast<std::size_t>(Counter::count)};
+
+using Values = std::array<std::uint64_t, 2 * numStages + numCounters>;
+
+auto index_of(const Stage stage) noexcept { return static_cast<std::size_t>(stage); }
+auto index_of(const Counter counter) noexcept { return static_cast<std::size_t>(counter); }
+
+// Written only by the owning thread, but read by the report writer, hence the relaxed atomics.
+// Layout is stage nanoseconds, then stage calls, then counters.
+struct ThreadProfile
+{
+    unsigned id;
+    std::array<std::atomic<std::uint64_t>, std::tuple_size<Values>::value> values;
+    
+    ThreadProfile(unsigned id) : id {id}
+    {
+        for (auto& value : values) value.store(0, std::memory_order_relaxed);
+    }
+    
+    void add(const std::size_t idx, const std::uint64_t n) noexcept
+    {
+        values[idx].store(values[idx].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    
+    Values snapshot() const noexcept
+    {
+        Values result;
+        std::transform(std::cbegin(values), std::cend(values), std::begin(result),
+                       [] (const auto& value) { return value.load(std::memory_order_relaxed); });
+        return result;
+    }
+};
+
+struct TaskProfile
+{
+    GenomicRegion region;
+    unsigned thread;
+    std::uint64_t nanoseconds;
+    Values values;
+};
+
+std::atomic<bool> enabled {false};
+
+// Thread profiles are shared with the registry so totals include threads that have since exited
+std::mutex registry_mutex {};
+std::vector<std::shared_ptr<ThreadProfile>> thread_profiles {};
+std::vector<TaskProfile> task_profiles {};
+
+ThreadProfile& local_profile()
+{
+    thread_local std::shared_ptr<ThreadProfile> result {};
+    if (!result) {
+        std::lock_guard<std::mutex> lock {registry_mutex};
+        result = std::make_shared<ThreadProfile>(static_cast<unsigned>(thread_profiles.size()));
+        thread_profiles.push_back(result);
+    }
+    return *result;
+}
+
+template <typename Clock>
+std::uint64_t nanoseconds_since(const typename Clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+} // namespace
+
+const char* name(const Stage stage) noexcept
+{
+    switch (stage) {
+        case Stage::read_fetch: return "read_fetch";
+        case Stage::read_transform: return "read_transform";
+        case Stage::read_filter: return "read_filter";
+        case Stage::read_downsample: return "read_downsample";
+        case Stage::candidate_generation: return "candidate_generation";
+        case Stage::cigar_scanner: return "cigar_scanner";
+        case Stage::local_reassembler: return "local_reassembler";
+        case Stage::vcf_extractor: return "vcf_extractor";
+        case Stage::haplotype_generation: return "haplotype_generation";
+        case Stage::haplotype_likelihoods: return "haplotype_likelihoods";
+        case Stage::genotype_inference: return "genotype_inference";
+        case Stage::variant_calling: return "variant_calling";
+        case Stage::phasing: return "phasing";
+        case Stage::vcf_write: return "vcf_write";
+        case Stage::csr_facets: return "csr_facets";
+        case Stage::csr_measures: return "csr_measures";
+        case Stage::count: break;
+    }
+    return "unknown";
+}
+
+const char* name(const Counter counter) noexcept
+{
+    switch (counter) {
+        case Counter::reads_fetched: return "reads_fetched";
+        case Counter::candidates: return "candidates";
+        case Counter::haplotypes: return "haplotypes";
+        case Counter::hmm_evaluations: return "hmm_evaluations";
+        case Counter::hmm_cells: return "hmm_cells";
+        case Counter::records_written: return "records_written";
+        case Counter::count: break;
+    }
+    return "unknown";
+}
+
+void enable() noexcept
+{
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool is_enabled() noexcept
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void count(const Counter counter, const std::uint64_t n) noexcept
+{
+    if (is_enabled()) {
+        local_profile().add(2 * numStages + index_of(counter), n);
+    }
+}
+
+ScopedTimer::ScopedTimer(const Stage stage) noexcept
+: stage_ {stage}
+, active_ {is_enabled()}
+, start_ {}
+{
+    if (active_) start_ = Clock::now();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (active_) {
+        auto& profile = local_profile();
+        profile.add(index_of(stage_), nanoseconds_since<Clock>(start_));
+        profile.add(numStages + index_of(stage_), 1);
+    }
+}
+
+namespace detail {
+
+struct Snapshot
+{
+    std::chrono::steady_clock::time_point time;
+    Values values;
+};
+
+// Values recorded for the task by job threads, added as each job finishes
+struct TaskRecord
+{
+    std::mutex mutex;
+    Values values {};
+};
+
+} // namespace detail
+
+namespace {
+
+thread_local TaskContext local_task {};
+
+auto make_snapshot()
+{
+    auto result = std::make_unique<detail::Snapshot>();
+    result->values = local_profile().snapshot();
+    result->time = std::chrono::steady_clock::now();
+    return result;
+}
+
+// The values recorded by the calling thread since start
+Values recorded_since(const detail::Snapshot& start)
+{
+    auto result = local_profile().snapshot();
+    std::transform(std::cbegin(result), std::cend(result), std::cbegin(start.values), std::begin(result), std::minus<> {});
+    return result;
+}
+
+} // namespace
+
+TaskContext current_task() noexcept
+{
+    return local_task;
+}
+
+TaskScope::TaskScope(const GenomicRegion& region)
+: region_ {region}
+, task_ {}
+, previous_ {}
+, start_ {}
+{
+    if (is_enabled()) {
+        task_ = std::make_shared<detail::TaskRecord>();
+        previous_ = std::exchange(local_task, task_);
+        start_ = make_snapshot();
+    }
+}
+
+TaskScope::~TaskScope()
+{
+    if (start_) {
+        TaskProfile task {region_, local_profile().id, nanoseconds_since<std::chrono::steady_clock>(start_->time),
+                          recorded_since(*start_)};
+        {
+            std::lock_guard<std::mutex> lock {task_->mutex};
+            std::transform(std::cbegin(task.values), std::cend(task.values), std::cbegin(task_->values),
+                           std::begin(task.values), std::plus<> {});
+        }
+        local_task = std::move(previous_);
+        std::lock_guard<std::mutex> lock {registry_mutex};
+        task_profiles.push_back(std::move(task));
+    }
+}
+
+JobScope::JobScope(TaskContext task)
+: task_ {}
+, previous_ {}
+, start_ {}
+{
+    if (task && task != local_task) {
+        task_ = std::move(task);
+        previous_ = std::exchange(local_task, task_);
+        start_ = make_snapshot();
+    }
+}
+
+JobScope::~JobScope()
+{
+    if (start_) {
+        const auto values = recorded_since(*start_);
+        {
+            std::lock_guard<std::mutex> lock {task_->mutex};
+            std::transform(std::cbegin(task_->values), std::cend(task_->values), std::cbegin(values),
+                           std::begin(task_->values), std::plus<> {});
+        }
+        local_task = std::move(previous_);
+    }
+}
+
+namespace {
+
+double to_seconds(const std::uint64_t nanoseconds) noexcept
+{
+    return static_cast<double>(nanoseconds) / 1e9;
+}
+
+void write_values(std::ostream& os, const Values& values)
+{
+    os << "\"stages\": {";
+    for (std::size_t s {0}; s < numStages; ++s) {
+        if (s > 0) os << ", ";
+        os << '"' << name(static_cast<Stage>(s)) << "\": {\"calls\": " << values[numStages + s]
+           << ", \"seconds\": " << to_seconds(values[s]) << '}';
+    }
+    os << "}, \"counters\": {";
+    for (std::size_t c {0}; c < numCounters; ++c) {
+        if (c > 0) os << ", ";
+        os << '"' << name(static_cast<Counter>(c)) << "\": " << values[2 * numStages + c];
+    }
+    os << '}';
+}
+
+} // namespace
+
+bool write_report(const boost::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock {registry_mutex};
+    Values totals {};
+    for (const auto& profile : thread_profiles) {
+        const auto values = profile->snapshot();
+        std::transform(std::cbegin(totals), std::cend(totals), std::cbegin(values), std::begin(totals), std::plus<> {});
+    }
+    boost::filesystem::ofstream file {path};
+    if (!file) return false;
+    file << "{\n\"threads\": " << thread_profiles.size() << ",\n\"totals\": {";
+    write_values(file, totals);
+    file << "},\n\"tasks\": [";
+    for (std::size_t t {0}; t < task_profiles.size(); ++t) {
+        const auto& task = task_profiles[t];
+        file << (t > 0 ? ",\n" : "\n") << "{\"region\": \"" << task.region << "\", \"thread\": " << task.thread
+             << ", \"seconds\": " << to_seconds(task.nanoseconds) << ", ";
+        write_values(file, task.values);
+        file << '}';
+    }
+    file << "\n]\n}\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace profiling
+} // namespace octopus
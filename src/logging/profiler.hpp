@@ -0,0 +1,155 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef profiler_hpp
+#define profiler_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+
+#include <boost/filesystem/path.hpp>
+
+#include "basics/genomic_region.hpp"
+
+namespace octopus { namespace profiling {
+
+// Stage timings are inclusive, so a stage includes the time of any stage that runs within it
+// (e.g. candidate_generation includes cigar_scanner).
+enum class Stage : std::size_t
+{
+    read_fetch,
+    read_transform,
+    read_filter,
+    read_downsample,
+    candidate_generation,
+    cigar_scanner,
+    local_reassembler,
+    vcf_extractor,
+    haplotype_generation,
+    haplotype_likelihoods,
+    genotype_inference,
+    variant_calling,
+    phasing,
+    vcf_write,
+    csr_facets,
+    csr_measures,
+    count // not a stage
+};
+
+enum class Counter : std::size_t
+{
+    reads_fetched,
+    candidates,
+    haplotypes,
+    hmm_evaluations,
+    hmm_cells,
+    records_written,
+    count // not a counter
+};
+
+const char* name(Stage stage) noexcept;
+const char* name(Counter counter) noexcept;
+
+// Profiling is off until enabled, and every recording function is then a single relaxed load.
+// Once enabled, each thread records into its own counters so recording never takes a lock.
+void enable() noexcept;
+bool is_enabled() noexcept;
+
+void count(Counter counter, std::uint64_t n = 1) noexcept;
+
+class ScopedTimer
+{
+public:
+    ScopedTimer() = delete;
+    
+    ScopedTimer(Stage stage) noexcept;
+    
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ScopedTimer(ScopedTimer&&)                 = delete;
+    ScopedTimer& operator=(ScopedTimer&&)      = delete;
+    
+    ~ScopedTimer();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Stage stage_;
+    bool active_;
+    Clock::time_point start_;
+};
+
+template <typename F>
+decltype(auto) timed(const Stage stage, F&& f)
+{
+    ScopedTimer timer {stage};
+    return f();
+}
+
+namespace detail {
+
+struct Snapshot;
+struct TaskRecord;
+
+} // namespace detail
+
+// Identifies the task the calling thread is recording for, so work handed to other threads can be
+// attributed to it. Null outside a task, or when profiling is disabled.
+using TaskContext = std::shared_ptr<detail::TaskRecord>;
+
+TaskContext current_task() noexcept;
+
+// Everything recorded by the calling thread while in scope, and by any JobScope for the task, is
+// attributed to the task region. Stage timings of a task are then summed over the threads that worked
+// on it, so may exceed the task time.
+class TaskScope
+{
+public:
+    TaskScope() = delete;
+    
+    TaskScope(const GenomicRegion& region);
+    
+    TaskScope(const TaskScope&)            = delete;
+    TaskScope& operator=(const TaskScope&) = delete;
+    TaskScope(TaskScope&&)                 = delete;
+    TaskScope& operator=(TaskScope&&)      = delete;
+    
+    ~TaskScope();
+
+private:
+    const GenomicRegion& region_;
+    TaskContext task_, previous_;
+    std::unique_ptr<detail::Snapshot> start_; // null when profiling is disabled
+};
+
+// Attributes everything the calling thread records while in scope to task, for jobs run on behalf
+// of a task by another thread (e.g. on the shared thread pool). Does nothing if task is null or is
+// already the calling thread's task.
+class JobScope
+{
+public:
+    JobScope() = delete;
+    
+    JobScope(TaskContext task);
+    
+    JobScope(const JobScope&)            = delete;
+    JobScope& operator=(const JobScope&) = delete;
+    JobScope(JobScope&&)                 = delete;
+    JobScope& operator=(JobScope&&)      = delete;
+    
+    ~JobScope();
+
+private:
+    TaskContext task_, previous_;
+    std::unique_ptr<detail::Snapshot> start_; // null if not recording for task
+};
+
+// Writes totals over all threads, and each task, as JSON. Returns false if the file can't be written.
+bool write_report(const boost::filesystem::path& path);
+
+} // namespace profiling
+} // namespace octopus
+
+#endif
@@ -21,6 +21,9 @@ namespace octopus {
 
 using utils::TimeInterval;
 
+constexpr std::size_t ProgressMeter::numPendingSlots;
+constexpr std::chrono::milliseconds ProgressMeter::reportInterval;
+
 namespace {
 
 template <typename T>
@@ -75,6 +78,13 @@ ProgressMeter::ProgressMeter(InputRegionMap regions)
 , position_tab_length_ {}
 , block_compute_times_ {}
 , log_ {}
+, pending_ {}
+, draining_ {}
+, mutex_ {}
+, reporter_wakeup_ {}
+, reporter_ {}
+, reporting_ {false}
+, stop_reporting_ {false}
 {
     for (auto& p : target_regions_) {
         auto covered_regions = extract_covered_regions(p.second);
@@ -87,6 +97,8 @@ ProgressMeter::ProgressMeter(InputRegionMap regions)
     if (!target_regions_.empty()) {
         position_tab_length_ = calculate_position_tab_length(target_regions_);
     }
+    pending_.reserve(numPendingSlots);
+    std::generate_n(std::back_inserter(pending_), numPendingSlots, [] () { return std::make_unique<PendingSlot>(); });
 }
 
 ProgressMeter::ProgressMeter(GenomicRegion region)
@@ -94,7 +106,11 @@ ProgressMeter::ProgressMeter(GenomicRegion region)
 {}
 
 ProgressMeter::ProgressMeter(ProgressMeter&& other)
+: reporting_ {false}
+, stop_reporting_ {false}
 {
+    const bool other_reporting {other.reporting_};
+    other.stop_reporter();
     std::lock_guard<std::mutex> lock {other.mutex_};
     using std::move;
     target_regions_       = move(other.target_regions_);
@@ -112,11 +128,17 @@ ProgressMeter::ProgressMeter(ProgressMeter&& other)
     position_tab_length_  = move(other.position_tab_length_);
     block_compute_times_  = move(other.block_compute_times_);
     log_                  = move(other.log_);
+    pending_              = move(other.pending_);
+    draining_             = move(other.draining_);
+    if (other_reporting) start_reporter();
 }
 
 ProgressMeter& ProgressMeter::operator=(ProgressMeter&& other)
 {
     if (this != &other) {
+        const bool other_reporting {other.reporting_};
+        stop_reporter();
+        other.stop_reporter();
         std::unique_lock<std::mutex> lock_lhs {mutex_, std::defer_lock}, lock_rhs {other.mutex_, std::defer_lock};
         std::lock(lock_lhs, lock_rhs);
         using std::move;
@@ -135,6 +157,10 @@ ProgressMeter& ProgressMeter::operator=(ProgressMeter&& other)
         position_tab_length_  = move(other.position_tab_length_);
         block_compute_times_  = move(other.block_compute_times_);
         log_                  = move(other.log_);
+        pending_              = move(other.pending_);
+        draining_             = move(other.draining_);
+        lock_lhs.unlock();
+        if (other_reporting) start_reporter();
     }
     return *this;
 }
@@ -224,22 +250,18 @@ auto estimate_ttc(const std::chrono::system_clock::time_point now,
 
 ProgressMeter::~ProgressMeter()
 {
+    stop_reporter();
+    if (pending_.empty()) return; // moved from
+    std::lock_guard<std::mutex> lock {mutex_};
+    report_pending();
     if (!done_ && !target_regions_.empty() && num_bp_completed_ > 0) {
-        const TimeInterval duration {start_, std::chrono::system_clock::now()};
-        const auto time_taken = to_string(duration);
-        stream(log_) << std::string(position_tab_length_ - 4, ' ')
-                     << "-"
-                     << completed_pad("100%")
-                     << "100%"
-                     << time_taken_pad(time_taken)
-                     << time_taken
-                     << ttc_pad("-")
-                     << "-";
+        write_completion();
     }
 }
 
 void ProgressMeter::set_max_tick_size(double percent)
 {
+    std::lock_guard<std::mutex> lock {mutex_};
     block_compute_times_.clear(); // TODO: can we use old block times to estimate new block times?
     max_tick_size_ = percent;
     percent_until_tick_  = std::min(percent, percent_until_tick_);
@@ -248,12 +270,16 @@ void ProgressMeter::set_max_tick_size(double percent)
 
 void ProgressMeter::start()
 {
-    if (!target_regions_.empty()) {
-        completed_regions_.reserve(target_regions_.size());
-        write_header();
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if (!target_regions_.empty()) {
+            completed_regions_.reserve(target_regions_.size());
+            write_header();
+        }
+        start_ = std::chrono::system_clock::now();
+        last_tick_ = start_;
     }
-    start_ = std::chrono::system_clock::now();
-    last_tick_ = start_;
+    if (!target_regions_.empty()) start_reporter();
 }
 
 void ProgressMeter::resume()
@@ -268,17 +294,11 @@ void ProgressMeter::pause()
 
 void ProgressMeter::stop()
 {
+    stop_reporter();
+    std::lock_guard<std::mutex> lock {mutex_};
+    report_pending();
     if (!done_ && !target_regions_.empty()) {
-        const TimeInterval duration {start_, std::chrono::system_clock::now()};
-        const auto time_taken = to_string(duration);
-        stream(log_) << std::string(position_tab_length_ - 4, ' ')
-        << "-"
-        << completed_pad("100%")
-        << "100%"
-        << time_taken_pad(time_taken)
-        << time_taken
-        << ttc_pad("-")
-        << "-";
+        write_completion();
     }
     done_ = true;
 }
@@ -286,6 +306,11 @@ void ProgressMeter::stop()
 void ProgressMeter::reset()
 {
     if (!done_) stop();
+    std::lock_guard<std::mutex> lock {mutex_};
+    for (auto& slot : pending_) {
+        std::lock_guard<std::mutex> slot_lock {slot->mutex};
+        slot->regions.clear();
+    }
     completed_regions_.clear();
     num_bp_to_search_ = sum_region_sizes(target_regions_);
     num_bp_completed_ = 0;
@@ -299,21 +324,26 @@ void ProgressMeter::reset()
     done_ = false;
     block_compute_times_.clear();
     block_compute_times_.shrink_to_fit();
-    
 }
 
 void ProgressMeter::log_completed(const GenomicRegion& region)
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    const auto new_bp_processed = merge(region);
-    const auto new_percent_done = percent_completed(new_bp_processed, num_bp_to_search_);
-    num_bp_completed_ += new_bp_processed;
-    percent_until_tick_ -= new_percent_done;
-    if (percent_until_tick_ <= 0) output_log(region);
+    if (pending_.empty()) return; // moved from
+    auto& slot = pending_slot();
+    {
+        std::lock_guard<std::mutex> lock {slot.mutex};
+        slot.regions.push_back(region);
+    }
+    if (!reporting_) {
+        // Nobody else will report this so do it now
+        std::lock_guard<std::mutex> lock {mutex_};
+        report_pending();
+    }
 }
 
 void ProgressMeter::log_completed(const GenomicRegion::ContigName& contig)
 {
+    if (pending_.empty()) return; // moved from
     const auto& contig_regions = target_regions_.at(contig);
     if (!contig_regions.empty()) {
         const auto contig_region = encompassing_region(contig_regions.front(), contig_regions.back());
@@ -323,6 +353,78 @@ void ProgressMeter::log_completed(const GenomicRegion::ContigName& contig)
 
 // private methods
 
+ProgressMeter::PendingSlot& ProgressMeter::pending_slot() noexcept
+{
+    assert(!pending_.empty());
+    return *pending_[std::hash<std::thread::id> {}(std::this_thread::get_id()) % pending_.size()];
+}
+
+void ProgressMeter::start_reporter()
+{
+    if (reporting_) return;
+    stop_reporting_ = false;
+    reporting_ = true;
+    reporter_ = std::thread {&ProgressMeter::report_until_stopped, this};
+}
+
+void ProgressMeter::stop_reporter()
+{
+    if (!reporter_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        stop_reporting_ = true;
+    }
+    reporter_wakeup_.notify_one();
+    reporter_.join();
+    reporting_ = false;
+}
+
+void ProgressMeter::report_until_stopped()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    while (!stop_reporting_) {
+        reporter_wakeup_.wait_for(lock, reportInterval, [this] () { return stop_reporting_; });
+        report_pending();
+    }
+}
+
+void ProgressMeter::report_pending()
+{
+    for (auto& slot : pending_) {
+        {
+            std::lock_guard<std::mutex> lock {slot->mutex};
+            if (slot->regions.empty()) continue;
+            // swapping keeps both buffers' capacity for reuse
+            std::swap(slot->regions, draining_);
+        }
+        for (const auto& region : draining_) record(region);
+        draining_.clear();
+    }
+}
+
+void ProgressMeter::record(const GenomicRegion& region)
+{
+    const auto new_bp_processed = merge(region);
+    const auto new_percent_done = percent_completed(new_bp_processed, num_bp_to_search_);
+    num_bp_completed_ += new_bp_processed;
+    percent_until_tick_ -= new_percent_done;
+    if (percent_until_tick_ <= 0) output_log(region);
+}
+
+void ProgressMeter::write_completion()
+{
+    const TimeInterval duration {start_, std::chrono::system_clock::now()};
+    const auto time_taken = to_string(duration);
+    stream(log_) << std::string(position_tab_length_ - 4, ' ')
+                 << "-"
+                 << completed_pad("100%")
+                 << "100%"
+                 << time_taken_pad(time_taken)
+                 << time_taken
+                 << ttc_pad("-")
+                 << "-";
+}
+
 ProgressMeter::RegionSizeType ProgressMeter::merge(const GenomicRegion& region)
 {
     RegionSizeType result {0};
@@ -8,7 +8,12 @@
 #include <cstddef>
 #include <chrono>
 #include <deque>
+#include <vector>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 
 #include "config/common.hpp"
 #include "basics/contig_region.hpp"
@@ -18,6 +23,8 @@
 
 namespace octopus {
 
+// Completed regions are only queued by the threads logging them; merging them and writing the
+// progress log happens on a reporter thread while the meter is started. Thread safe.
 class ProgressMeter
 {
 public:
@@ -49,6 +56,17 @@ private:
     using ContigRegionMap = MappableSetMap<ContigName, ContigRegion>;
     using DurationUnits = std::chrono::milliseconds;
     
+    static constexpr std::size_t numPendingSlots {64};
+    static constexpr std::chrono::milliseconds reportInterval {1000};
+    
+    // Each logging thread mostly has its own slot, so the slot mutex is rarely contended. Slots
+    // are allocated separately to keep them off each other's cache lines.
+    struct PendingSlot
+    {
+        std::mutex mutex;
+        std::vector<GenomicRegion> regions;
+    };
+    
     InputRegionMap target_regions_;
     ContigRegionMap completed_regions_;
     RegionSizeType num_bp_to_search_, num_bp_completed_;
@@ -60,9 +78,24 @@ private:
     bool done_;
     std::size_t position_tab_length_;
     mutable std::deque<DurationUnits> block_compute_times_;
-    mutable std::mutex mutex_;
     logging::InfoLogger log_;
     
+    std::vector<std::unique_ptr<PendingSlot>> pending_;
+    std::vector<GenomicRegion> draining_;
+    mutable std::mutex mutex_;
+    std::condition_variable reporter_wakeup_;
+    std::thread reporter_;
+    std::atomic<bool> reporting_;
+    bool stop_reporting_;
+    
+    PendingSlot& pending_slot() noexcept;
+    void start_reporter();
+    void stop_reporter();
+    void report_until_stopped();
+    void report_pending();
+    void record(const GenomicRegion& region);
+    void write_completion();
+    
     RegionSizeType merge(const GenomicRegion& region);
     
     void write_header();
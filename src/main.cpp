@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <chrono>
 #include <exception>
+#include <thread>
 
 #include "config/config.hpp"
 #include "config/common.hpp"
@@ -15,8 +16,11 @@
 #include "core/octopus.hpp"
 #include "utils/timing.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/repeat_index.hpp"
+#include "utils/thread_pool.hpp"
 #include "exceptions/error.hpp"
 #include "logging/error_handler.hpp"
+#include "logging/profiler.hpp"
 
 using namespace octopus;
 using namespace octopus::options;
@@ -44,6 +48,8 @@ void init_common(const OptionMap& options)
     logging::init(get_debug_log_file_name(options), get_trace_log_file_name(options));
     DEBUG_MODE = options::is_debug_mode(options);
     TRACE_MODE = options::is_trace_mode(options);
+    const auto num_threads = options::get_num_threads(options);
+    set_shared_thread_budget(num_threads ? *num_threads : std::thread::hardware_concurrency());
 }
 
 std::string to_string(const int argc, const char** argv)
@@ -52,6 +58,30 @@ std::string to_string(const int argc, const char** argv)
     return utils::join(arguements, ' ');
 }
 
+void build_repeat_index(const OptionMap& options)
+{
+    logging::InfoLogger info_log {};
+    const auto reference = make_reference(options);
+    const auto index_path = get_repeat_index_build_path(options);
+    stream(info_log) << "Building repeat index " << index_path;
+    const auto start = std::chrono::system_clock::now();
+    octopus::build_repeat_index(reference, index_path);
+    const auto end = std::chrono::system_clock::now();
+    using utils::TimeInterval;
+    stream(info_log) << "Done building repeat index in " << TimeInterval {start, end};
+}
+
+void write_profile(const boost::filesystem::path& path)
+{
+    if (profiling::write_report(path)) {
+        logging::InfoLogger info_log {};
+        stream(info_log) << "Wrote profile to " << path;
+    } else {
+        logging::WarningLogger warn_log {};
+        stream(warn_log) << "Could not write profile to " << path;
+    }
+}
+
 } // namespace
 
 int main(const int argc, const char** argv)
@@ -73,6 +103,8 @@ int main(const int argc, const char** argv)
         try {
             init_common(options);
             log_program_startup();
+            const auto profile_path = get_profile_file_name(options);
+            if (profile_path) profiling::enable();
             logging::InfoLogger info_log {};
             const auto start = std::chrono::system_clock::now();
             auto components = collate_genome_calling_components(options);
@@ -82,6 +114,7 @@ int main(const int argc, const char** argv)
             options.clear();
             if (validate(components)) {
                 run_octopus(components, to_string(argc, argv));
+                if (profile_path) write_profile(*profile_path);
             }
             log_program_end();
         } catch (const Error& e) {
@@ -93,6 +126,41 @@ int main(const int argc, const char** argv)
             log_program_end();
             return EXIT_FAILURE;
         }
+    } else if (is_merge_shards_command(options)) {
+        try {
+            init_common(options);
+            log_program_startup();
+            const auto shard_outputs = get_shard_outputs(options);
+            auto components = collate_genome_calling_components(options);
+            options.clear();
+            if (validate(components)) {
+                merge_shards(components, shard_outputs, to_string(argc, argv));
+            }
+            log_program_end();
+        } catch (const Error& e) {
+            return log_exception(e);
+        } catch (const std::exception& e) {
+            return log_exception(e);
+        } catch (...) {
+            log_unknown_error();
+            log_program_end();
+            return EXIT_FAILURE;
+        }
+    } else if (is_build_repeat_index_command(options)) {
+        try {
+            init_common(options);
+            log_program_startup();
+            build_repeat_index(options);
+            log_program_end();
+        } catch (const Error& e) {
+            return log_exception(e);
+        } catch (const std::exception& e) {
+            return log_exception(e);
+        } catch (...) {
+            log_unknown_error();
+            log_program_end();
+            return EXIT_FAILURE;
+        }
     }
     
     return EXIT_SUCCESS;
@@ -18,8 +18,6 @@
 #include "utils/read_algorithms.hpp"
 #include "utils/append.hpp"
 
-#include "timers.hpp"
-
 namespace octopus { namespace readpipe {
 
 namespace {
@@ -251,6 +249,16 @@ Downsampler::Downsampler(const unsigned trigger_coverage, const unsigned target_
     }
 }
 
+unsigned Downsampler::trigger_coverage() const noexcept
+{
+    return trigger_coverage_;
+}
+
+unsigned Downsampler::target_coverage() const noexcept
+{
+    return target_coverage_;
+}
+
 std::size_t Downsampler::downsample(ReadContainer& reads) const
 {
     return sample(reads, trigger_coverage_, target_coverage_);
@@ -31,6 +31,9 @@ public:
     
     ~Downsampler() = default;
     
+    unsigned trigger_coverage() const noexcept;
+    unsigned target_coverage() const noexcept;
+    
     // Returns the number of reads removed
     std::size_t downsample(ReadContainer& reads) const;
     
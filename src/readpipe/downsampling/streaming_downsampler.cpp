@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "streaming_downsampler.hpp"
+
+#include <algorithm>
+
+namespace octopus { namespace readpipe {
+
+StreamingDownsampler::StreamingDownsampler(unsigned max_coverage)
+: max_coverage_ {max_coverage}
+, seen_ends_ {}
+, begin_ {0}
+, coverage_before_begin_ {0}
+, num_seen_at_begin_ {0}
+{}
+
+bool StreamingDownsampler::keep(const Position begin, const Position end, const char* read_name)
+{
+    if (num_seen_at_begin_ == 0 || begin != begin_) {
+        while (!seen_ends_.empty() && seen_ends_.top() <= begin) seen_ends_.pop();
+        begin_ = begin;
+        coverage_before_begin_ = seen_ends_.size();
+        num_seen_at_begin_ = 0;
+    }
+    seen_ends_.push(end);
+    ++num_seen_at_begin_;
+    if (seen_ends_.size() <= max_coverage_) return true;
+    // Using the coverage before the position makes the decision independent of the order of
+    // reads beginning at the same position, so mates are treated alike
+    const auto coverage = std::max(coverage_before_begin_, num_seen_at_begin_);
+    return template_rank(read_name) < static_cast<double>(max_coverage_) / coverage;
+}
+
+double template_rank(const char* read_name) noexcept
+{
+    // FNV-1a with a final avalanche, so the result does not depend on the platform's std::hash
+    std::uint64_t hash {14695981039346656037ull};
+    for (; *read_name != '\0'; ++read_name) {
+        hash ^= static_cast<unsigned char>(*read_name);
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return static_cast<double>(hash >> 11) / static_cast<double>(std::uint64_t {1} << 53);
+}
+
+} // namespace readpipe
+} // namespace octopus
@@ -0,0 +1,58 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef streaming_downsampler_hpp
+#define streaming_downsampler_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <functional>
+
+namespace octopus { namespace readpipe {
+
+/**
+ StreamingDownsampler decides which reads to keep as they are streamed from file in position
+ order, before any filtering, so extreme pileups need not be loaded in full. It is not a
+ replacement for Downsampler, which should still be applied to the filtered reads.
+ 
+ Reads are only removed where more than max_coverage reads have been seen over the read's begin
+ position, and then with probability max_coverage / coverage, where the coverage is that of reads
+ beginning before the position (or the number beginning at it, if greater). The decision is made
+ on a hash of the read name rather than a random draw, so reads from the same template are kept
+ or removed together wherever their positions have similar coverage.
+ */
+class StreamingDownsampler
+{
+public:
+    using Position = std::int64_t;
+    
+    StreamingDownsampler() = delete;
+    
+    StreamingDownsampler(unsigned max_coverage);
+    
+    StreamingDownsampler(const StreamingDownsampler&)            = default;
+    StreamingDownsampler& operator=(const StreamingDownsampler&) = default;
+    StreamingDownsampler(StreamingDownsampler&&)                 = default;
+    StreamingDownsampler& operator=(StreamingDownsampler&&)      = default;
+    
+    ~StreamingDownsampler() = default;
+    
+    // Reads must be added in begin position order
+    bool keep(Position begin, Position end, const char* read_name);
+    
+private:
+    unsigned max_coverage_;
+    std::priority_queue<Position, std::vector<Position>, std::greater<>> seen_ends_;
+    Position begin_;
+    std::size_t coverage_before_begin_, num_seen_at_begin_;
+};
+
+// Maps a read name to [0, 1), the same for every read with the same name
+double template_rank(const char* read_name) noexcept;
+
+} // namespace readpipe
+} // namespace octopus
+
+#endif
@@ -11,9 +11,11 @@
 #include <iterator>
 #include <type_traits>
 #include <utility>
+#include <cstddef>
 
 #include <boost/optional.hpp>
 
+#include "utils/thread_pool.hpp"
 #include "read_filter.hpp"
 
 namespace octopus { namespace readpipe
@@ -55,6 +57,9 @@ public:
     // Like std::remove
     BidirIt remove(ReadIterator first, ReadIterator last) const;
     BidirIt remove(ReadIterator first, ReadIterator last, FilterCountMap& filter_counts) const;
+    // Basic filters are evaluated in num_threads blocks on the shared thread pool. ReadIterator
+    // must be random access.
+    BidirIt remove(ReadIterator first, ReadIterator last, unsigned num_threads) const;
     
     // Like std::stable_partition
     BidirIt partition(ReadIterator first, ReadIterator last) const;
@@ -113,6 +118,40 @@ BidirIt ReadFilterer<BidirIt>::remove(BidirIt first, BidirIt last) const
     return last;
 }
 
+template <typename BidirIt>
+BidirIt ReadFilterer<BidirIt>::remove(BidirIt first, BidirIt last, const unsigned num_threads) const
+{
+    if (num_threads < 2) return remove(first, last);
+    if (first == last || num_filters() == 0) return last;
+    
+    if (!basic_filters_.empty()) {
+        const auto num_reads = static_cast<std::size_t>(std::distance(first, last));
+        std::vector<char> passes(num_reads);
+        const auto filter_block = [this, first, &passes] (const std::size_t block_begin, const std::size_t block_end) {
+            for (auto i = block_begin; i < block_end; ++i) {
+                passes[i] = passes_all_basic_filters(*std::next(first, i));
+            }
+        };
+        parallel_for_ranges(num_reads, num_threads, filter_block);
+        auto passed_last = first;
+        for (std::size_t i {0}; i < num_reads; ++i) {
+            if (passes[i]) {
+                const auto read = std::next(first, i);
+                if (read != passed_last) *passed_last = std::move(*read);
+                ++passed_last;
+            }
+        }
+        last = passed_last;
+    }
+    
+    std::for_each(cbegin(context_filters_), cend(context_filters_),
+                  [first, &last] (const auto& filter) {
+                      last = filter->remove(first, last);
+                  });
+    
+    return last;
+}
+
 template <typename BidirIt>
 BidirIt ReadFilterer<BidirIt>::partition(BidirIt first, BidirIt last) const
 {
@@ -278,6 +317,12 @@ auto remove(Container& reads, const ReadFilterer& filter,
     return filter.remove(std::begin(reads), std::end(reads), filter_counts);
 }
 
+template <typename Container, typename ReadFilterer>
+auto remove(Container& reads, const ReadFilterer& filter, const unsigned num_threads)
+{
+    return filter.remove(std::begin(reads), std::end(reads), num_threads);
+}
+
 template <typename Map>
 using FilterPointMap = std::unordered_map<typename Map::key_type, typename Map::mapped_type::iterator>;
 
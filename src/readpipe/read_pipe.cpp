@@ -6,10 +6,15 @@
 #include <utility>
 #include <iterator>
 #include <algorithm>
+#include <future>
+#include <cstdint>
+#include <limits>
 #include <cassert>
 
 #include "utils/read_stats.hpp"
 #include "utils/mappable_algorithms.hpp"
+#include "utils/thread_pool.hpp"
+#include "logging/profiler.hpp"
 
 namespace octopus {
 
@@ -27,6 +32,7 @@ ReadPipe::ReadPipe(const ReadManager& source, ReadTransformer transformer, ReadF
 , postfilter_transformer_ {}
 , downsampler_ {std::move(downsampler)}
 , samples_ {std::move(samples)}
+, execution_policy_ {ExecutionPolicy::seq}
 , debug_log_ {}
 {
     if (DEBUG_MODE) debug_log_ = logging::DebugLogger {};
@@ -41,15 +47,22 @@ ReadPipe::ReadPipe(const ReadManager& source, ReadTransformer prefilter_transfor
 , postfilter_transformer_ {std::move(postfilter_transformer)}
 , downsampler_ {std::move(downsampler)}
 , samples_ {std::move(samples)}
+, execution_policy_ {ExecutionPolicy::seq}
 , debug_log_ {}
 {
     if (DEBUG_MODE) debug_log_ = logging::DebugLogger {};
 }
 
-std::vector<std::vector<SampleName>> batch_samples(std::vector<SampleName> samples)
+// Batches are processed one at a time, so only one batch of unfiltered reads is held in memory
+std::vector<std::vector<SampleName>> batch_samples(const std::vector<SampleName>& samples, const std::size_t max_batch_size)
 {
     std::vector<std::vector<SampleName>> result {};
-    result.emplace_back(std::move(samples)); // TODO: find a better strategy for this
+    result.reserve((samples.size() + max_batch_size - 1) / max_batch_size);
+    for (auto first = std::cbegin(samples); first != std::cend(samples);) {
+        const auto last = std::next(first, std::min(max_batch_size, static_cast<std::size_t>(std::distance(first, std::cend(samples)))));
+        result.emplace_back(first, last);
+        first = last;
+    }
     return result;
 }
 
@@ -63,6 +76,11 @@ void ReadPipe::set_read_manager(const ReadManager& source) noexcept
     source_ = source;
 }
 
+void ReadPipe::set_execution_policy(const ExecutionPolicy policy) noexcept
+{
+    execution_policy_ = policy;
+}
+
 unsigned ReadPipe::num_samples() const noexcept
 {
     return static_cast<unsigned>(samples_.size());
@@ -83,10 +101,25 @@ void sort_each(Map& reads)
     }
 }
 
-auto fetch_batch(const ReadManager& rm, const std::vector<SampleName>& samples, const GenomicRegion& region)
+// When downsampling, reads are also removed as they are fetched, but only where the raw coverage is
+// far above the trigger coverage. This bounds the number of reads decoded in extreme pileups, while
+// leaving the downsampler, which runs after filtering, enough reads to reach its target.
+constexpr unsigned fetchDownsamplingCoverageMultiplier {4};
+
+auto fetch_batch(const ReadManager& rm, const std::vector<SampleName>& samples, const GenomicRegion& region,
+                 const boost::optional<readpipe::Downsampler>& downsampler)
 {
-    auto result = rm.fetch_reads(samples, region);
+    profiling::ScopedTimer timer {profiling::Stage::read_fetch};
+    ReadManager::SampleReadMap result {};
+    if (downsampler) {
+        const auto max_coverage = std::min(std::uint64_t {fetchDownsamplingCoverageMultiplier} * downsampler->trigger_coverage(),
+                                           std::uint64_t {std::numeric_limits<unsigned>::max()});
+        result = rm.fetch_reads(samples, region, {static_cast<unsigned>(max_coverage)});
+    } else {
+        result = rm.fetch_reads(samples, region);
+    }
     sort_each(result);
+    profiling::count(profiling::Counter::reads_fetched, count_reads(result));
     return result;
 }
 
@@ -131,40 +164,47 @@ void shrink_to_fit(ReadMap& reads)
 ReadMap ReadPipe::fetch_reads(const GenomicRegion& region) const
 {
     using namespace readpipe;
+    // The debug log is not thread safe
+    if (execution_policy_ != ExecutionPolicy::seq && !debug_log_ && num_free_threads() > 0) {
+        return fetch_reads_parallel(region);
+    }
     ReadMap result {samples_.size()};
     for (const auto& sample : samples_) {
         result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
     }
-    for (const auto& batch : batch_samples(samples_)) {
-        auto batch_reads = fetch_batch(source_, batch, region);
+    for (const auto& batch : batch_samples(samples_, maxSamplesPerBatch)) {
+        auto batch_reads = fetch_batch(source_, batch, region, downsampler_);
         if (debug_log_) {
             stream(*debug_log_) << "Fetched " << count_reads(batch_reads) << " unfiltered reads from " << region;
         }
-        transform_reads(batch_reads, prefilter_transformer_);
-        if (debug_log_) {
-            SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
-            filter_counts.reserve(samples_.size());
-            for (const auto& sample : samples_) {
-                filter_counts[sample].reserve(filterer_.num_filters());
-            }
-            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
-            if (filterer_.num_filters() > 0) {
-                for (const auto& p : filter_counts) {
-                    stream(*debug_log_) << "In sample " << p.first;
-                    if (!p.second.empty()) {
-                        for (const auto& c : p.second) {
-                            stream(*debug_log_) << c.second << " failed the " << c.first << " filter";
+        profiling::timed(profiling::Stage::read_transform, [&] () { transform_reads(batch_reads, prefilter_transformer_); });
+        {
+            profiling::ScopedTimer timer {profiling::Stage::read_filter};
+            if (debug_log_) {
+                SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
+                filter_counts.reserve(batch.size());
+                for (const auto& sample : batch) {
+                    filter_counts[sample].reserve(filterer_.num_filters());
+                }
+                erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
+                if (filterer_.num_filters() > 0) {
+                    for (const auto& p : filter_counts) {
+                        stream(*debug_log_) << "In sample " << p.first;
+                        if (!p.second.empty()) {
+                            for (const auto& c : p.second) {
+                                stream(*debug_log_) << c.second << " failed the " << c.first << " filter";
+                            }
+                        } else {
+                            *debug_log_ << "No reads were filtered";
                         }
-                    } else {
-                        *debug_log_ << "No reads were filtered";
                     }
                 }
+            } else {
+                erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
             }
-        } else {
-            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
         }
         if (postfilter_transformer_) {
-            transform_reads(batch_reads, *postfilter_transformer_);
+            profiling::timed(profiling::Stage::read_transform, [&] () { transform_reads(batch_reads, *postfilter_transformer_); });
         }
         if (debug_log_) {
             stream(*debug_log_) << "There are " << count_reads(batch_reads) << " reads in " << region
@@ -172,7 +212,7 @@ ReadMap ReadPipe::fetch_reads(const GenomicRegion& region) const
         }
         if (downsampler_) {
             auto reads = make_mappable_map(std::move(batch_reads));
-            const auto n = downsample(reads, *downsampler_);
+            const auto n = profiling::timed(profiling::Stage::read_downsample, [&] () { return downsample(reads, *downsampler_); });
             if (debug_log_) stream(*debug_log_) << "Downsampling removed " << n << " reads from " << region;
             insert_each(std::move(reads), result);
         } else {
@@ -183,6 +223,56 @@ ReadMap ReadPipe::fetch_reads(const GenomicRegion& region) const
     return result;
 }
 
+ReadMap ReadPipe::fetch_reads_parallel(const GenomicRegion& region) const
+{
+    using namespace readpipe;
+    ReadMap result {samples_.size()};
+    for (const auto& sample : samples_) {
+        result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
+    }
+    const auto batches = batch_samples(samples_, maxSamplesPerBatch);
+    const auto fetch = [this, &region, &batches] (const std::size_t b) {
+        return async_shared([this, &region, &batch = batches[b]] () { return fetch_batch(source_, batch, region, downsampler_); });
+    };
+    std::future<ReadManager::SampleReadMap> next_batch_reads {};
+    if (!batches.empty()) next_batch_reads = fetch(0);
+    for (std::size_t b {0}; b < batches.size(); ++b) {
+        auto batch_reads = next_batch_reads.get();
+        if (b + 1 < batches.size()) {
+            next_batch_reads = fetch(b + 1);
+        }
+        for (auto& p : batch_reads) {
+            auto& reads = p.second;
+            const auto num_threads = get_num_threads(reads.size());
+            profiling::timed(profiling::Stage::read_transform, [&] () {
+                prefilter_transformer_.transform_reads(std::begin(reads), std::end(reads), num_threads);
+            });
+            profiling::timed(profiling::Stage::read_filter, [&] () {
+                reads.erase(remove(reads, filterer_, num_threads), std::end(reads));
+            });
+            if (postfilter_transformer_) {
+                profiling::timed(profiling::Stage::read_transform, [&] () {
+                    postfilter_transformer_->transform_reads(std::begin(reads), std::end(reads), num_threads);
+                });
+            }
+        }
+        if (downsampler_) {
+            auto reads = make_mappable_map(std::move(batch_reads));
+            profiling::timed(profiling::Stage::read_downsample, [&] () { downsample(reads, *downsampler_); });
+            insert_each(std::move(reads), result);
+        } else {
+            insert_each(std::move(batch_reads), result);
+        }
+    }
+    shrink_to_fit(result);
+    return result;
+}
+
+unsigned ReadPipe::get_num_threads(const std::size_t num_reads) const noexcept
+{
+    return num_parallel_blocks(num_reads, minReadsPerThread);
+}
+
 ReadMap ReadPipe::fetch_reads(const std::vector<GenomicRegion>& regions) const
 {
     assert(std::is_sorted(std::cbegin(regions), std::cend(regions)));
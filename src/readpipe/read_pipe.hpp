@@ -25,11 +25,15 @@ namespace octopus {
  actually fetching the reads from file, and applying any filters, transforms etc. The result is
  then a set of reads that can be used for calling.
  
- Rather than just fetching all reads for all samples in one go and processing, we can be a bit more
- clever and fetch reads in batches (e.g. each sample, or regions in samples). This could potentially
- decrease average memory consumption (and also increase runtime performance) by minimising the
- number of 'bad' reads in memory. If we are really short on memory we could even compress filtered
- read batches while we process other batches.
+ Rather than fetching all reads for all samples in one go and processing, reads are fetched and
+ processed in batches of samples. This decreases peak memory consumption for large cohorts by
+ minimising the number of 'bad' reads in memory. If we are really short on memory we could even
+ compress filtered read batches while we process other batches.
+ 
+ With a parallel execution policy, the next batch is fetched while the current batch is processed,
+ and the transforms and basic filters are applied to blocks of each sample's reads concurrently.
+ This uses the shared thread pool, so is bounded by the run's thread budget, and is only done when
+ some of the budget is not in use by other calling tasks.
  */
 class ReadPipe
 {
@@ -63,6 +67,8 @@ public:
     const ReadManager& read_manager() const noexcept;
     void set_read_manager(const ReadManager& source) noexcept;
     
+    void set_execution_policy(ExecutionPolicy policy) noexcept;
+    
     unsigned num_samples() const noexcept;
     const std::vector<SampleName>& samples() const noexcept;
     
@@ -72,13 +78,20 @@ public:
     //Report get_report() const;
     
 private:
+    static constexpr std::size_t maxSamplesPerBatch {16};
+    static constexpr std::size_t minReadsPerThread {5'000};
+    
     std::reference_wrapper<const ReadManager> source_;
     ReadTransformer prefilter_transformer_;
     ReadFilterer filterer_;
     boost::optional<ReadTransformer> postfilter_transformer_;
     boost::optional<Downsampler> downsampler_;
     std::vector<SampleName> samples_;
+    ExecutionPolicy execution_policy_;
     mutable boost::optional<logging::DebugLogger> debug_log_;
+    
+    ReadMap fetch_reads_parallel(const GenomicRegion& region) const;
+    unsigned get_num_threads(std::size_t num_reads) const noexcept;
 };
 
 } // namespace octopus
@@ -4,6 +4,7 @@
 #include "read_transformer.hpp"
 
 #include <iostream>
+#include <vector>
 
 namespace octopus { namespace readpipe {
 
@@ -94,5 +95,25 @@ void ReadTransformer::transform(ReadReferenceVector& reads) const
     transform_templates(reads);
 }
 
+void ReadTransformer::transform(ReadReferenceVector& reads, const unsigned num_threads) const
+{
+    group_templates(reads);
+    // Block boundaries are moved forward to the next template so no template is split
+    std::vector<ReadReferenceVector::iterator> block_boundaries {std::begin(reads)};
+    block_boundaries.reserve(num_threads + 1);
+    for (unsigned thread {1}; thread < num_threads; ++thread) {
+        auto boundary = std::next(std::begin(reads), thread * reads.size() / num_threads);
+        if (boundary < block_boundaries.back()) boundary = block_boundaries.back();
+        if (boundary != std::begin(reads) && boundary != std::end(reads)) {
+            boundary = std::find_if_not(boundary, std::end(reads), ReadTemplateEqual {*std::prev(boundary)});
+        }
+        block_boundaries.push_back(boundary);
+    }
+    block_boundaries.push_back(std::end(reads));
+    parallel_for_each_block(num_threads, [this, &block_boundaries] (const unsigned block) {
+        transform_templates(block_boundaries[block], block_boundaries[block + 1]);
+    });
+}
+
 } // namespace readpipe
 } // namespace octopus
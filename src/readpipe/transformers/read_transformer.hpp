@@ -9,9 +9,11 @@
 #include <algorithm>
 #include <iterator>
 #include <type_traits>
+#include <cstddef>
 
 #include "basics/aligned_read.hpp"
 #include "containers/mappable_flat_multi_set.hpp"
+#include "utils/thread_pool.hpp"
 
 namespace octopus { namespace readpipe {
 
@@ -42,7 +44,11 @@ public:
     
     template <typename ForwardIt>
     void transform_reads(ForwardIt first, ForwardIt last) const;
-        
+    
+    // Reads, and read templates, are transformed in num_threads blocks on the shared thread pool
+    template <typename RandomIt>
+    void transform_reads(RandomIt first, RandomIt last, unsigned num_threads) const;
+    
 private:
     std::vector<ReadTransform> read_transforms_;
     std::vector<TemplateTransform> template_transforms_;
@@ -51,6 +57,7 @@ private:
     template <typename ForwardIt>
     auto make_references(ForwardIt first, ForwardIt last) const;
     void transform(ReadReferenceVector& reads) const;
+    void transform(ReadReferenceVector& reads, unsigned num_threads) const;
     void transform_templates(ReadReferenceVector& reads) const;
     void transform_templates(ReadReferenceVector::iterator first, ReadReferenceVector::iterator last) const;
     void transform_template(ReadTemplate& read_template) const;
@@ -79,6 +86,27 @@ void ReadTransformer::transform_reads(ForwardIt first, ForwardIt last) const
     }
 }
 
+template <typename RandomIt>
+void ReadTransformer::transform_reads(RandomIt first, RandomIt last, const unsigned num_threads) const
+{
+    if (num_threads < 2) {
+        transform_reads(first, last);
+        return;
+    }
+    if (!read_transforms_.empty()) {
+        const auto num_reads = static_cast<std::size_t>(std::distance(first, last));
+        const auto transform_block = [this, first] (const std::size_t block_begin, const std::size_t block_end) {
+            std::for_each(std::next(first, block_begin), std::next(first, block_end),
+                          [this] (AlignedRead& read) { transform_read(read); });
+        };
+        parallel_for_ranges(num_reads, num_threads, transform_block);
+    }
+    if (!template_transforms_.empty()) {
+        auto read_references = make_references(first, last);
+        transform(read_references, num_threads);
+    }
+}
+
 // non-member methods
 
 namespace detail {
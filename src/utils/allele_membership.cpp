@@ -0,0 +1,136 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "allele_membership.hpp"
+
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <cassert>
+
+namespace octopus {
+
+std::size_t AlleleMembership::num_alleles() const noexcept
+{
+    return num_alleles_;
+}
+
+std::size_t AlleleMembership::num_haplotypes() const noexcept
+{
+    return num_haplotypes_;
+}
+
+std::size_t AlleleMembership::num_genotypes() const noexcept
+{
+    return genotype_offsets_.empty() ? 0 : genotype_offsets_.size() - 1;
+}
+
+namespace {
+
+template <typename Block>
+bool test_bit(const Block* blocks, const std::size_t idx) noexcept
+{
+    constexpr std::size_t block_size {8 * sizeof(Block)};
+    return (blocks[idx / block_size] >> (idx % block_size)) & 1;
+}
+
+template <typename Block>
+void set_bit(Block* blocks, const std::size_t idx) noexcept
+{
+    constexpr std::size_t block_size {8 * sizeof(Block)};
+    blocks[idx / block_size] |= Block {1} << (idx % block_size);
+}
+
+} // namespace
+
+bool AlleleMembership::haplotype_contains(const std::size_t haplotype, const std::size_t allele) const noexcept
+{
+    assert(haplotype < num_haplotypes() && allele < num_alleles());
+    return test_bit(haplotype_membership_.data() + allele * num_haplotype_blocks_, haplotype);
+}
+
+bool AlleleMembership::contains(const std::size_t genotype, const std::size_t allele) const noexcept
+{
+    assert(genotype < num_genotypes() && allele < num_alleles());
+    return test_bit(genotype_membership_.data() + allele * num_genotype_blocks_, genotype);
+}
+
+unsigned AlleleMembership::count(const std::size_t genotype, const std::size_t allele) const noexcept
+{
+    assert(genotype < num_genotypes() && allele < num_alleles());
+    if (!contains(genotype, allele)) return 0;
+    const auto first = std::next(std::cbegin(genotype_haplotypes_), genotype_offsets_[genotype]);
+    const auto last  = std::next(std::cbegin(genotype_haplotypes_), genotype_offsets_[genotype + 1]);
+    return std::count_if(first, last, [=] (const unsigned haplotype) { return haplotype_contains(haplotype, allele); });
+}
+
+std::size_t AlleleMembership::num_genotypes_containing(const std::size_t allele) const noexcept
+{
+    assert(allele < num_alleles());
+    const auto first = std::next(std::cbegin(genotype_membership_), allele * num_genotype_blocks_);
+    return std::accumulate(first, std::next(first, num_genotype_blocks_), std::size_t {0},
+                           [] (const auto curr, const Block block) noexcept {
+                               return curr + __builtin_popcountll(block);
+                           });
+}
+
+double AlleleMembership::sum_excluded(const std::size_t allele, const std::vector<double>& genotype_probabilities) const noexcept
+{
+    assert(allele < num_alleles() && genotype_probabilities.size() == num_genotypes());
+    const auto blocks = genotype_membership_.data() + allele * num_genotype_blocks_;
+    const auto num_genotypes = genotype_probabilities.size();
+    double result {0};
+    for (std::size_t b {0}; b < num_genotype_blocks_; ++b) {
+        auto excluded = ~blocks[b];
+        const auto first_genotype = b * block_size;
+        if (num_genotypes - first_genotype < block_size) {
+            excluded &= (Block {1} << (num_genotypes - first_genotype)) - 1;
+        }
+        while (excluded != 0) {
+            result += genotype_probabilities[first_genotype + __builtin_ctzll(excluded)];
+            excluded &= excluded - 1;
+        }
+    }
+    return result;
+}
+
+// private methods
+
+void AlleleMembership::add(const Genotype<Haplotype>& genotype, HaplotypeIndexMap& haplotype_indices,
+                           std::vector<const Haplotype*>& haplotypes)
+{
+    for (const auto& haplotype : genotype) {
+        const auto itr = haplotype_indices.emplace(std::addressof(haplotype), static_cast<unsigned>(haplotypes.size()));
+        if (itr.second) haplotypes.push_back(std::addressof(haplotype));
+        genotype_haplotypes_.push_back(itr.first->second);
+    }
+    genotype_offsets_.push_back(genotype_haplotypes_.size());
+}
+
+void AlleleMembership::build(const std::vector<Allele>& alleles, const std::vector<const Haplotype*>& haplotypes)
+{
+    num_haplotypes_ = haplotypes.size();
+    num_haplotype_blocks_ = (num_haplotypes() + block_size - 1) / block_size;
+    num_genotype_blocks_ = (num_genotypes() + block_size - 1) / block_size;
+    haplotype_membership_.assign(num_alleles_ * num_haplotype_blocks_, 0);
+    genotype_membership_.assign(num_alleles_ * num_genotype_blocks_, 0);
+    for (std::size_t allele {0}; allele < num_alleles_; ++allele) {
+        const auto haplotype_row = haplotype_membership_.data() + allele * num_haplotype_blocks_;
+        for (std::size_t haplotype {0}; haplotype < num_haplotypes(); ++haplotype) {
+            if (haplotypes[haplotype]->contains(alleles[allele])) {
+                set_bit(haplotype_row, haplotype);
+            }
+        }
+        const auto genotype_row = genotype_membership_.data() + allele * num_genotype_blocks_;
+        for (std::size_t genotype {0}; genotype < num_genotypes(); ++genotype) {
+            const auto first = std::next(std::cbegin(genotype_haplotypes_), genotype_offsets_[genotype]);
+            const auto last  = std::next(std::cbegin(genotype_haplotypes_), genotype_offsets_[genotype + 1]);
+            if (std::any_of(first, last, [=] (const unsigned haplotype) { return test_bit(haplotype_row, haplotype); })) {
+                set_bit(genotype_row, genotype);
+            }
+        }
+    }
+}
+
+} // namespace octopus
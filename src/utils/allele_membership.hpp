@@ -0,0 +1,103 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef allele_membership_hpp
+#define allele_membership_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+
+namespace octopus {
+
+// Which of a set of alleles are contained by each of a set of genotypes. Each allele is tested once
+// against each distinct haplotype and genotype membership is derived from the haplotype membership,
+// so marginalising an allele over the genotypes is a scan of a bitset rather than repeated
+// sequence comparison.
+class AlleleMembership
+{
+public:
+    AlleleMembership() = default;
+    
+    // Genotypes are taken from the key (first) of each genotype probability pair in the range
+    template <typename GenotypeProbabilityIterator>
+    AlleleMembership(const std::vector<Allele>& alleles,
+                     GenotypeProbabilityIterator first_genotype, GenotypeProbabilityIterator last_genotype);
+    
+    AlleleMembership(const AlleleMembership&)            = default;
+    AlleleMembership& operator=(const AlleleMembership&) = default;
+    AlleleMembership(AlleleMembership&&)                 = default;
+    AlleleMembership& operator=(AlleleMembership&&)      = default;
+    
+    ~AlleleMembership() = default;
+    
+    std::size_t num_alleles() const noexcept;
+    std::size_t num_haplotypes() const noexcept;
+    std::size_t num_genotypes() const noexcept;
+    
+    bool haplotype_contains(std::size_t haplotype, std::size_t allele) const noexcept;
+    bool contains(std::size_t genotype, std::size_t allele) const noexcept;
+    
+    // The number of haplotypes in the genotype containing the allele
+    unsigned count(std::size_t genotype, std::size_t allele) const noexcept;
+    
+    std::size_t num_genotypes_containing(std::size_t allele) const noexcept;
+    
+    // Sum of the probabilities of the genotypes not containing the allele. Probabilities must be in
+    // the same order as the genotypes given on construction.
+    double sum_excluded(std::size_t allele, const std::vector<double>& genotype_probabilities) const noexcept;
+
+private:
+    using Block = std::uint64_t;
+    
+    static constexpr std::size_t block_size {64};
+    
+    using HaplotypeIndexMap = std::unordered_map<const Haplotype*, unsigned>;
+    
+    std::size_t num_alleles_ = 0, num_haplotypes_ = 0;
+    std::vector<unsigned> genotype_haplotypes_; // haplotype indices of each genotype
+    std::vector<std::size_t> genotype_offsets_; // into genotype_haplotypes_, one past the end for the last genotype
+    std::size_t num_haplotype_blocks_ = 0, num_genotype_blocks_ = 0;
+    std::vector<Block> haplotype_membership_, genotype_membership_; // one row of blocks per allele
+    
+    void add(const Genotype<Haplotype>& genotype, HaplotypeIndexMap& haplotype_indices,
+             std::vector<const Haplotype*>& haplotypes);
+    void build(const std::vector<Allele>& alleles, const std::vector<const Haplotype*>& haplotypes);
+};
+
+template <typename GenotypeProbabilityIterator>
+AlleleMembership::AlleleMembership(const std::vector<Allele>& alleles,
+                                   GenotypeProbabilityIterator first_genotype, GenotypeProbabilityIterator last_genotype)
+: num_alleles_ {alleles.size()}
+, genotype_haplotypes_ {}
+, genotype_offsets_ {0}
+{
+    HaplotypeIndexMap haplotype_indices {};
+    std::vector<const Haplotype*> haplotypes {}; // distinct by address
+    for (; first_genotype != last_genotype; ++first_genotype) {
+        const Genotype<Haplotype>& genotype = first_genotype->first;
+        add(genotype, haplotype_indices, haplotypes);
+    }
+    build(alleles, haplotypes);
+}
+
+// Genotype probabilities in the order AlleleMembership expects
+template <typename GenotypeProbabilityIterator>
+std::vector<double>
+extract_probabilities(GenotypeProbabilityIterator first_genotype, GenotypeProbabilityIterator last_genotype)
+{
+    std::vector<double> result {};
+    for (; first_genotype != last_genotype; ++first_genotype) {
+        result.push_back(first_genotype->second);
+    }
+    return result;
+}
+
+} // namespace octopus
+
+#endif
@@ -5,8 +5,10 @@
 #define coverage_tracker_hpp
 
 #include <vector>
-#include <deque>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <cmath>
 #include <utility>
 #include <iterator>
 #include <algorithm>
@@ -17,13 +19,20 @@
 #include <boost/optional.hpp>
 
 #include "concepts/mappable.hpp"
-#include "maths.hpp"
 
 namespace octopus {
 
 /**
  CoverageTracker provides an efficient method for tracking coverage statistics over a range
  of Mappable objects without having to store the entire collection.
+ 
+ Added regions are buffered and applied in bulk with a difference array by flush, so adding is
+ amortised constant time. Buffered regions must be flushed before the tracker is queried. Coverage
+ is stored per position in fixed size blocks, and the block summaries (sum, sum of squares, min,
+ max) are kept in a segment tree, so range statistics take logarithmic time plus a scan of the
+ positions in partially covered blocks at either end of the range.
+ 
+ Queries do not modify the tracker, so a flushed tracker can be queried concurrently.
  */
 template <typename Region>
 class CoverageTracker
@@ -41,20 +50,24 @@ public:
     template <typename MappableType>
     void add(const MappableType& mappable);
     
-    std::size_t total_coverage() const noexcept;
-    std::size_t total_coverage(const Region& region) const noexcept;
+    // Applies all added regions. Must be called between adding and querying.
+    void flush();
+    bool is_flushed() const noexcept;
     
-    unsigned max_coverage() const noexcept;
-    unsigned max_coverage(const Region& region) const noexcept;
+    std::size_t total_coverage() const;
+    std::size_t total_coverage(const Region& region) const;
     
-    unsigned min_coverage() const noexcept;
-    unsigned min_coverage(const Region& region) const noexcept;
+    unsigned max_coverage() const;
+    unsigned max_coverage(const Region& region) const;
     
-    double mean_coverage() const noexcept;
-    double mean_coverage(const Region& region) const noexcept;
+    unsigned min_coverage() const;
+    unsigned min_coverage(const Region& region) const;
     
-    double stdev_coverage() const noexcept;
-    double stdev_coverage(const Region& region) const noexcept;
+    double mean_coverage() const;
+    double mean_coverage(const Region& region) const;
+    
+    double stdev_coverage() const;
+    double stdev_coverage(const Region& region) const;
     
     double median_coverage(const Region& region) const;
     
@@ -69,14 +82,39 @@ public:
     void clear() noexcept;
     
 private:
-    std::deque<unsigned> coverage_ = {};
+    using Position = typename RegionType<Region>::Position;
+    
+    struct BlockSummary
+    {
+        std::size_t sum = 0;
+        std::uint64_t sum_squares = 0;
+        unsigned min = std::numeric_limits<unsigned>::max(), max = 0;
+    };
+    
+    struct Summary
+    {
+        std::size_t num_positions = 0, sum = 0;
+        std::uint64_t sum_squares = 0;
+        unsigned min = std::numeric_limits<unsigned>::max(), max = 0;
+    };
+    
+    static constexpr std::size_t blockSize {256};
+    static constexpr std::size_t maxPendingRegions {1'000'000}; // bounds the buffer between flushes
+    
     Region encompassing_region_;
     std::size_t num_tracked_ = 0;
-    
-    using Iterator = typename decltype(coverage_)::const_iterator;
+    std::vector<std::pair<Position, Position>> pending_ = {};
+    Position origin_ = 0; // position of the first element of coverage_, always a block boundary
+    std::vector<unsigned> coverage_ = {};
+    std::size_t num_leaves_ = 0; // power of two, at least the number of blocks
+    std::vector<BlockSummary> block_tree_ = {}; // 1-based segment tree, leaves from num_leaves_
     
     void do_add(const Region& region);
-    std::pair<Iterator, Iterator> range(const Region& region) const;
+    void resize(Position first_position, std::size_t num_blocks);
+    void update_blocks(std::size_t first_block, std::size_t last_block);
+    void check_flushed() const;
+    std::pair<std::size_t, std::size_t> range(const Region& region) const;
+    Summary summarise(const Region& region) const;
 };
 
 // public methods
@@ -90,80 +128,112 @@ void CoverageTracker<Region>::add(const MappableType& mappable)
 }
 
 template <typename Region>
-std::size_t CoverageTracker<Region>::total_coverage() const noexcept
+void CoverageTracker<Region>::flush()
 {
-    return std::accumulate(std::cbegin(coverage_), std::cend(coverage_), std::size_t {0});
+    if (pending_.empty()) return;
+    // Grow the coverage blocks to span the encompassing region
+    const Position first_position {mapped_begin(encompassing_region_) / blockSize * blockSize};
+    const auto num_blocks = (mapped_end(encompassing_region_) - first_position + blockSize - 1) / blockSize;
+    if (coverage_.empty() || first_position < origin_ || num_blocks * blockSize > coverage_.size() + (origin_ - first_position)) {
+        resize(first_position, num_blocks);
+    }
+    // Apply all the buffered regions with a single difference array sweep
+    Position first {pending_.front().first}, last {pending_.front().second};
+    for (const auto& p : pending_) {
+        first = std::min(first, p.first);
+        last = std::max(last, p.second);
+    }
+    std::vector<int> deltas(last - first + 1, 0);
+    for (const auto& p : pending_) {
+        ++deltas[p.first - first];
+        --deltas[p.second - first];
+    }
+    pending_.clear();
+    int depth {0};
+    const auto offset = first - origin_;
+    for (std::size_t i {0}; i < deltas.size() - 1; ++i) {
+        depth += deltas[i];
+        coverage_[offset + i] += depth;
+    }
+    update_blocks(offset / blockSize, (offset + deltas.size() - 1 + blockSize - 1) / blockSize);
 }
 
 template <typename Region>
-std::size_t CoverageTracker<Region>::total_coverage(const Region& region) const noexcept
+bool CoverageTracker<Region>::is_flushed() const noexcept
 {
-    if (octopus::is_empty(region)) return 0;
-    const auto p = range(region);
-    if (p.first == p.second) return 0;
-    return std::accumulate(p.first, p.second, std::size_t {0});
+    return pending_.empty();
 }
 
 template <typename Region>
-unsigned CoverageTracker<Region>::max_coverage() const noexcept
+std::size_t CoverageTracker<Region>::total_coverage() const
 {
-    if (coverage_.empty()) return 0;
-    return *std::max_element(std::cbegin(coverage_), std::cend(coverage_));
+    if (is_empty()) return 0;
+    return total_coverage(encompassing_region_);
 }
 
 template <typename Region>
-unsigned CoverageTracker<Region>::max_coverage(const Region& region) const noexcept
+std::size_t CoverageTracker<Region>::total_coverage(const Region& region) const
 {
-    if (octopus::is_empty(region)) return 0;
-    const auto p = range(region);
-    if (p.first == p.second) return 0;
-    return *std::max_element(p.first, p.second);
+    return summarise(region).sum;
 }
 
 template <typename Region>
-unsigned CoverageTracker<Region>::min_coverage() const noexcept
+unsigned CoverageTracker<Region>::max_coverage() const
 {
-    if (coverage_.empty()) return 0;
-    return *std::min_element(std::cbegin(coverage_), std::cend(coverage_));
+    if (is_empty()) return 0;
+    return max_coverage(encompassing_region_);
 }
 
 template <typename Region>
-unsigned CoverageTracker<Region>::min_coverage(const Region& region) const noexcept
+unsigned CoverageTracker<Region>::max_coverage(const Region& region) const
 {
-    if (octopus::is_empty(region)) return 0;
-    const auto p = range(region);
-    if (p.first == p.second) return 0;
-    return *std::min_element(p.first, p.second);
+    return summarise(region).max;
 }
 
 template <typename Region>
-double CoverageTracker<Region>::mean_coverage() const noexcept
+unsigned CoverageTracker<Region>::min_coverage() const
 {
-    if (coverage_.empty()) return 0;
-    return maths::mean(coverage_);
+    if (is_empty()) return 0;
+    return min_coverage(encompassing_region_);
 }
 
 template <typename Region>
-double CoverageTracker<Region>::mean_coverage(const Region& region) const noexcept
+unsigned CoverageTracker<Region>::min_coverage(const Region& region) const
 {
-    if (octopus::is_empty(region)) return 0;
-    const auto p = range(region);
-    return maths::mean(p.first, p.second);
+    const auto summary = summarise(region);
+    return summary.num_positions > 0 ? summary.min : 0;
 }
 
 template <typename Region>
-double CoverageTracker<Region>::stdev_coverage() const noexcept
+double CoverageTracker<Region>::mean_coverage() const
 {
-    if (coverage_.empty()) return 0;
-    return maths::stdev(coverage_);
+    if (is_empty()) return 0;
+    return mean_coverage(encompassing_region_);
 }
 
 template <typename Region>
-double CoverageTracker<Region>::stdev_coverage(const Region& region) const noexcept
+double CoverageTracker<Region>::mean_coverage(const Region& region) const
 {
-    if (octopus::is_empty(region)) return 0;
-    const auto p = range(region);
-    return maths::stdev(p.first, p.second);
+    const auto summary = summarise(region);
+    if (summary.num_positions == 0) return 0;
+    return static_cast<double>(summary.sum) / summary.num_positions;
+}
+
+template <typename Region>
+double CoverageTracker<Region>::stdev_coverage() const
+{
+    if (is_empty()) return 0;
+    return stdev_coverage(encompassing_region_);
+}
+
+template <typename Region>
+double CoverageTracker<Region>::stdev_coverage(const Region& region) const
+{
+    const auto summary = summarise(region);
+    if (summary.num_positions == 0) return 0;
+    const auto mean = static_cast<double>(summary.sum) / summary.num_positions;
+    const auto variance = static_cast<double>(summary.sum_squares) / summary.num_positions - mean * mean;
+    return std::sqrt(std::max(variance, 0.0));
 }
 
 template <typename Region>
@@ -180,15 +250,16 @@ double CoverageTracker<Region>::median_coverage(const Region& region) const
 template <typename Region>
 std::vector<unsigned> CoverageTracker<Region>::coverage(const Region& region) const
 {
-    if (coverage_.empty()) return std::vector<unsigned>(size(region), 0);
+    std::vector<unsigned> result(size(region), 0);
+    if (is_empty() || octopus::is_empty(region)) return result;
+    check_flushed();
     const auto p = range(region);
-    if (!contains(encompassing_region_, region)) {
-        std::vector<unsigned> result(size(region), 0);
-        const auto d = std::max(begin_distance(region, encompassing_region_), GenomicRegion::Distance {0});
-        std::copy(p.first, p.second, std::next(std::begin(result), d));
-        return result;
+    if (p.first < p.second) {
+        const auto offset = origin_ + p.first - mapped_begin(region);
+        std::copy(std::next(std::cbegin(coverage_), p.first), std::next(std::cbegin(coverage_), p.second),
+                  std::next(std::begin(result), offset));
     }
-    return std::vector<unsigned> {p.first, p.second};
+    return result;
 }
 
 template <typename Region>
@@ -216,8 +287,13 @@ std::size_t CoverageTracker<Region>::num_tracked() const noexcept
 template <typename Region>
 void CoverageTracker<Region>::clear() noexcept
 {
+    pending_.clear();
+    pending_.shrink_to_fit();
     coverage_.clear();
     coverage_.shrink_to_fit();
+    block_tree_.clear();
+    block_tree_.shrink_to_fit();
+    num_leaves_ = 0;
     num_tracked_ = 0;
 }
 
@@ -235,6 +311,15 @@ inline bool is_same_contig_helper(const GenomicRegion& lhs, const GenomicRegion&
     return is_same_contig(lhs, rhs);
 }
 
+inline void combine(const std::size_t sum, const std::uint64_t sum_squares, const unsigned min, const unsigned max,
+                    std::size_t& result_sum, std::uint64_t& result_sum_squares, unsigned& result_min, unsigned& result_max) noexcept
+{
+    result_sum += sum;
+    result_sum_squares += sum_squares;
+    result_min = std::min(result_min, min);
+    result_max = std::max(result_max, max);
+}
+
 } // namespace detail
 
 template <typename Region>
@@ -242,44 +327,118 @@ void CoverageTracker<Region>::do_add(const Region& region)
 {
     if (octopus::is_empty(region)) return;
     if (num_tracked_ == 0) {
-        coverage_.assign(size(region), 1);
         encompassing_region_ = region;
+        pending_.clear();
+        coverage_.clear();
+        block_tree_.clear();
+        num_leaves_ = 0;
     } else {
         if (!detail::is_same_contig_helper(region, encompassing_region_)) {
             throw std::runtime_error {"CoverageTracker: contig mismatch"};
         }
-        bool region_change {false};
-        if (begins_before(region, encompassing_region_)) {
-            coverage_.insert(std::cbegin(coverage_), left_overhang_size(region, encompassing_region_), 0);
-            region_change = true;
-        }
-        if (ends_before(encompassing_region_, region)) {
-            coverage_.insert(std::cend(coverage_), right_overhang_size(region, encompassing_region_), 0);
-            region_change = true;
-        }
-        if (region_change) {
+        if (begins_before(region, encompassing_region_) || ends_before(encompassing_region_, region)) {
             encompassing_region_ = octopus::encompassing_region(encompassing_region_, region);
         }
-        const auto first = std::next(std::begin(coverage_), begin_distance(encompassing_region_, region));
-        assert(first < std::end(coverage_));
-        assert(std::next(first, size(region)) <= std::end(coverage_));
-        std::transform(first, std::next(first, size(region)), first, [] (auto count) { return count + 1; });
     }
+    pending_.emplace_back(mapped_begin(region), mapped_end(region));
     ++num_tracked_;
+    if (pending_.size() >= maxPendingRegions) flush();
 }
 
 template <typename Region>
-std::pair<typename CoverageTracker<Region>::Iterator, typename CoverageTracker<Region>::Iterator>
-CoverageTracker<Region>::range(const Region& region) const
+void CoverageTracker<Region>::resize(const Position first_position, const std::size_t num_blocks)
 {
-    if (coverage_.empty() || !overlaps(region, encompassing_region_)) {
-        return {std::end(coverage_), std::end(coverage_)};
+    std::vector<unsigned> new_coverage(num_blocks * blockSize, 0);
+    if (!coverage_.empty()) {
+        std::copy(std::cbegin(coverage_), std::cend(coverage_), std::next(std::begin(new_coverage), origin_ - first_position));
+    }
+    const auto had_coverage = !coverage_.empty();
+    coverage_ = std::move(new_coverage);
+    origin_ = first_position;
+    num_leaves_ = 1;
+    while (num_leaves_ < num_blocks) num_leaves_ *= 2;
+    block_tree_.assign(2 * num_leaves_, BlockSummary {});
+    if (had_coverage) update_blocks(0, num_blocks);
+}
+
+template <typename Region>
+void CoverageTracker<Region>::update_blocks(const std::size_t first_block, const std::size_t last_block)
+{
+    if (first_block >= last_block) return;
+    for (auto b = first_block; b < last_block; ++b) {
+        const auto first = std::next(std::cbegin(coverage_), b * blockSize);
+        const auto last = std::next(first, blockSize);
+        BlockSummary summary {};
+        const auto min_max = std::minmax_element(first, last);
+        summary.min = *min_max.first;
+        summary.max = *min_max.second;
+        std::for_each(first, last, [&summary] (const unsigned depth) {
+            summary.sum += depth;
+            summary.sum_squares += static_cast<std::uint64_t>(depth) * depth;
+        });
+        block_tree_[num_leaves_ + b] = summary;
+    }
+    // Update the ancestors of the changed leaves, a level at a time
+    auto first_node = (num_leaves_ + first_block) / 2, last_node = (num_leaves_ + last_block - 1) / 2;
+    for (; first_node > 0; first_node /= 2, last_node /= 2) {
+        for (auto node = first_node; node <= last_node; ++node) {
+            const auto& lhs = block_tree_[2 * node];
+            const auto& rhs = block_tree_[2 * node + 1];
+            auto& parent = block_tree_[node];
+            parent = lhs;
+            detail::combine(rhs.sum, rhs.sum_squares, rhs.min, rhs.max, parent.sum, parent.sum_squares, parent.min, parent.max);
+        }
+    }
+}
+
+template <typename Region>
+void CoverageTracker<Region>::check_flushed() const
+{
+    if (!is_flushed()) {
+        throw std::runtime_error {"CoverageTracker: queried before flushing added regions"};
+    }
+}
+
+template <typename Region>
+std::pair<std::size_t, std::size_t> CoverageTracker<Region>::range(const Region& region) const
+{
+    if (is_empty() || !overlaps(region, encompassing_region_)) return {0, 0};
+    const auto first = std::max(mapped_begin(region), mapped_begin(encompassing_region_));
+    const auto last = std::min(mapped_end(region), mapped_end(encompassing_region_));
+    if (last <= first) return {0, 0};
+    return {first - origin_, last - origin_};
+}
+
+template <typename Region>
+typename CoverageTracker<Region>::Summary CoverageTracker<Region>::summarise(const Region& region) const
+{
+    Summary result {};
+    if (octopus::is_empty(region)) return result;
+    check_flushed();
+    auto p = range(region);
+    result.num_positions = p.second - p.first;
+    const auto add_position = [&] (const unsigned depth) {
+        detail::combine(depth, static_cast<std::uint64_t>(depth) * depth, depth, depth,
+                        result.sum, result.sum_squares, result.min, result.max);
+    };
+    const auto add_node = [&] (const BlockSummary& node) {
+        detail::combine(node.sum, node.sum_squares, node.min, node.max, result.sum, result.sum_squares, result.min, result.max);
+    };
+    // Positions before the first whole block
+    for (; p.first < p.second && p.first % blockSize != 0; ++p.first) {
+        add_position(coverage_[p.first]);
+    }
+    // Positions after the last whole block
+    for (; p.second > p.first && p.second % blockSize != 0; --p.second) {
+        add_position(coverage_[p.second - 1]);
     }
-    auto first = std::begin(coverage_);
-    if (begins_before(encompassing_region_, region)) {
-        std::advance(first, begin_distance(encompassing_region_, region));
+    // Whole blocks, from the segment tree
+    auto first_node = num_leaves_ + p.first / blockSize, last_node = num_leaves_ + p.second / blockSize;
+    for (; first_node < last_node; first_node /= 2, last_node /= 2) {
+        if (first_node % 2 == 1) add_node(block_tree_[first_node++]);
+        if (last_node % 2 == 1) add_node(block_tree_[--last_node]);
     }
-    return {first, std::next(first, overlap_size(region, encompassing_region_))};
+    return result;
 }
 
 } // namespace octopus
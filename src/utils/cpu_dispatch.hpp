@@ -0,0 +1,55 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef cpu_dispatch_hpp
+#define cpu_dispatch_hpp
+
+// Portable builds (BUILD_PORTABLE) target baseline x86-64, so hot kernels are marked with one of
+// these to have the compiler emit a clone for each wider instruction set. The loader picks the best
+// clone for the CPU with CPUID, once, so calls cost the same as a normal indirect call. Native builds
+// are already compiled for the host CPU and don't need clones.
+//
+// OCTOPUS_DISPATCH_VECTOR is for loops the compiler can auto-vectorise, which benefit from AVX-512.
+// OCTOPUS_DISPATCH_SSE is for kernels written with 128-bit intrinsics, which only gain the
+// non-destructive VEX encodings and newer SSE instructions.
+
+#if defined(OCTOPUS_PORTABLE) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__ELF__)
+    #define OCTOPUS_DISPATCH_VECTOR __attribute__((target_clones("avx512f", "avx2", "sse4.1", "default")))
+    #define OCTOPUS_DISPATCH_SSE __attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+    #define OCTOPUS_DISPATCH_VECTOR
+    #define OCTOPUS_DISPATCH_SSE
+#endif
+
+namespace octopus {
+
+// The clones the loader picks on this CPU. These must follow the clone lists above: the "default"
+// clone is compiled for baseline x86-64, so it uses SSE2.
+inline const char* dispatched_vector_instruction_set() noexcept
+{
+    #if defined(OCTOPUS_PORTABLE) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__ELF__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return "AVX-512";
+    if (__builtin_cpu_supports("avx2")) return "AVX2";
+    if (__builtin_cpu_supports("sse4.1")) return "SSE4.1";
+    return "SSE2";
+    #else
+    return "native";
+    #endif
+}
+
+inline const char* dispatched_sse_instruction_set() noexcept
+{
+    #if defined(OCTOPUS_PORTABLE) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__ELF__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return "AVX2";
+    if (__builtin_cpu_supports("sse4.1")) return "SSE4.1";
+    return "SSE2";
+    #else
+    return "native";
+    #endif
+}
+
+} // namespace octopus
+
+#endif
@@ -0,0 +1,153 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "genome_shard.hpp"
+
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+namespace octopus {
+
+GenomeShard::GenomeShard(const unsigned index, const unsigned count)
+: index_ {index}
+, count_ {count}
+{
+    if (count_ == 0 || index_ >= count_) {
+        throw std::invalid_argument {"GenomeShard: index must be less than count"};
+    }
+}
+
+unsigned GenomeShard::index() const noexcept
+{
+    return index_;
+}
+
+unsigned GenomeShard::count() const noexcept
+{
+    return count_;
+}
+
+bool operator==(const GenomeShard& lhs, const GenomeShard& rhs) noexcept
+{
+    return lhs.index() == rhs.index() && lhs.count() == rhs.count();
+}
+
+std::ostream& operator<<(std::ostream& os, const GenomeShard& shard)
+{
+    os << (shard.index() + 1) << '/' << shard.count();
+    return os;
+}
+
+std::istream& operator>>(std::istream& is, GenomeShard& result)
+{
+    if (is.good()) {
+        std::string input;
+        std::getline(is, input, ' ');
+        auto shard = parse_shard(input);
+        if (shard) {
+            result = *shard;
+        } else {
+            is.setstate(std::ios_base::failbit);
+        }
+    }
+    return is;
+}
+
+boost::optional<GenomeShard> parse_shard(const std::string& shard_str)
+{
+    const auto slash_pos = shard_str.find('/');
+    if (slash_pos == std::string::npos) return boost::none;
+    unsigned number, count;
+    try {
+        number = boost::lexical_cast<unsigned>(shard_str.substr(0, slash_pos));
+        count  = boost::lexical_cast<unsigned>(shard_str.substr(slash_pos + 1));
+    } catch (const boost::bad_lexical_cast&) {
+        return boost::none;
+    }
+    if (number == 0 || number > count) return boost::none;
+    return GenomeShard {number - 1, count};
+}
+
+namespace {
+
+std::uint64_t sum_region_sizes(const InputRegionMap& regions, const std::vector<ContigName>& contigs)
+{
+    std::uint64_t result {0};
+    for (const auto& contig : contigs) {
+        for (const auto& region : regions.at(contig)) result += size(region);
+    }
+    return result;
+}
+
+// The regions covering bases [shard_begin, shard_end) of the regions laid end to end
+InputRegionMap select_bases(const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                            const std::uint64_t shard_begin, const std::uint64_t shard_end)
+{
+    InputRegionMap result {};
+    std::uint64_t offset {0};
+    for (const auto& contig : contigs) {
+        if (offset >= shard_end) break;
+        for (const auto& region : regions.at(contig)) {
+            const auto region_begin = offset, region_end = offset + size(region);
+            offset = region_end;
+            if (region_end <= shard_begin) continue;
+            if (region_begin >= shard_end) break;
+            const auto begin = region.begin() + static_cast<GenomicRegion::Position>(std::max(region_begin, shard_begin) - region_begin);
+            const auto end   = region.begin() + static_cast<GenomicRegion::Position>(std::min(region_end, shard_end) - region_begin);
+            result[contig].emplace(contig, begin, end);
+        }
+    }
+    return result;
+}
+
+std::uint64_t move_to_task_end(const std::uint64_t cut, const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                               const CallTaskProposer& propose_task)
+{
+    std::uint64_t offset {0};
+    for (const auto& contig : contigs) {
+        for (const auto& region : regions.at(contig)) {
+            const auto region_begin = offset, region_end = offset + size(region);
+            offset = region_end;
+            if (region_end <= cut) continue;
+            // Cuts between regions are already task boundaries
+            if (region_begin == cut) return cut;
+            const auto cut_position = region.begin() + static_cast<GenomicRegion::Position>(cut - region_begin);
+            auto task = propose_task(region);
+            while (task.end() < cut_position) {
+                const auto next_task = propose_task(right_overhang_region(region, task));
+                if (next_task.end() <= task.end()) break;
+                task = next_task;
+            }
+            return region_begin + std::max(task.end(), cut_position) - region.begin();
+        }
+    }
+    return cut;
+}
+
+} // namespace
+
+InputRegionMap select_shard(const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                            const GenomeShard& shard)
+{
+    const auto total_size = sum_region_sizes(regions, contigs);
+    const auto shard_begin = total_size * shard.index() / shard.count();
+    const auto shard_end   = total_size * (shard.index() + 1) / shard.count();
+    return select_bases(regions, contigs, shard_begin, shard_end);
+}
+
+InputRegionMap select_shard(const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                            const GenomeShard& shard, const CallTaskProposer& propose_task)
+{
+    const auto total_size = sum_region_sizes(regions, contigs);
+    // Both neighbours of a cut move it the same way, so the shards still partition the regions
+    const auto shard_begin = move_to_task_end(total_size * shard.index() / shard.count(), regions, contigs, propose_task);
+    const auto shard_end   = move_to_task_end(total_size * (shard.index() + 1) / shard.count(), regions, contigs, propose_task);
+    if (shard_begin >= shard_end) return {};
+    return select_bases(regions, contigs, shard_begin, shard_end);
+}
+
+} // namespace octopus
@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef genome_shard_hpp
+#define genome_shard_hpp
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <functional>
+
+#include <boost/optional.hpp>
+
+#include "config/common.hpp"
+
+namespace octopus {
+
+// One of count equal parts of the search regions, for spreading a run over several processes.
+// Shards are written one-based (i/N) but indexed from zero.
+class GenomeShard
+{
+public:
+    GenomeShard() = default;
+    
+    GenomeShard(unsigned index, unsigned count);
+    
+    GenomeShard(const GenomeShard&)            = default;
+    GenomeShard& operator=(const GenomeShard&) = default;
+    GenomeShard(GenomeShard&&)                 = default;
+    GenomeShard& operator=(GenomeShard&&)      = default;
+    
+    ~GenomeShard() = default;
+    
+    unsigned index() const noexcept;
+    unsigned count() const noexcept;
+    
+private:
+    unsigned index_ = 0, count_ = 1;
+};
+
+bool operator==(const GenomeShard& lhs, const GenomeShard& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const GenomeShard& shard);
+std::istream& operator>>(std::istream& is, GenomeShard& result);
+
+boost::optional<GenomeShard> parse_shard(const std::string& shard_str);
+
+// The part of regions covered by shard. The regions are cut into count pieces with near equal numbers
+// of bases, in the given contig order, so consecutive shards only meet at a single position.
+InputRegionMap select_shard(const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                            const GenomeShard& shard);
+
+// Proposes the next calling task at the start of the given remaining region
+using CallTaskProposer = std::function<GenomicRegion(const GenomicRegion&)>;
+
+// As above, but each cut is moved right to the end of the task that contains it, where tasks are proposed
+// one after another from the start of each region. Consecutive shards then meet on a task boundary of
+// an unsharded run.
+InputRegionMap select_shard(const InputRegionMap& regions, const std::vector<ContigName>& contigs,
+                            const GenomeShard& shard, const CallTaskProposer& propose_task);
+
+} // namespace octopus
+
+#endif
@@ -37,7 +37,7 @@ constexpr auto perfect_hash(const char base) noexcept
     return hashTable[base];
 }
 
-using KmerHashType = std::uint_fast32_t;
+using KmerHashType = std::uint32_t; // enough for k <= 16
 
 template <unsigned char K, typename InputIt>
 constexpr auto perfect_kmer_hash(InputIt first)
@@ -54,56 +54,76 @@ constexpr auto perfect_kmer_hash(InputIt first)
 
 using KmerPerfectHashes = std::vector<KmerHashType>;
 
+// Rolling version of perfect_kmer_hash: the first base of each kmer is the least significant,
+// so the next hash is found by dropping the lowest two bits and adding the new base at the top.
 template <unsigned char K>
-auto compute_kmer_hashes(const std::string& sequence)
+void compute_kmer_hashes(const std::string& sequence, KmerPerfectHashes& result)
 {
-    if (sequence.size() < K) {
-        return KmerPerfectHashes {};
-    }
-    
-    KmerPerfectHashes result(sequence.size() - K + 1);
-    
-    auto result_it = std::begin(result);
-    
-    for (auto it = std::cbegin(sequence); it != std::prev(std::cend(sequence), K - 1); ++it, ++result_it) {
-        *result_it = perfect_kmer_hash<K>(it);
+    static_assert(K > 0 && K <= 16, "kmer size must be in [1, 16]");
+    result.clear();
+    if (sequence.size() < K) return;
+    result.resize(sequence.size() - K + 1);
+    constexpr auto top_shift = 2 * (K - 1);
+    auto hash = perfect_kmer_hash<K>(std::cbegin(sequence));
+    result.front() = hash;
+    for (std::size_t i {1}; i < result.size(); ++i) {
+        hash = (hash >> 2) | (static_cast<KmerHashType>(perfect_hash(sequence[i + K - 1])) << top_shift);
+        result[i] = hash;
     }
-    
+}
+
+template <unsigned char K>
+auto compute_kmer_hashes(const std::string& sequence)
+{
+    KmerPerfectHashes result {};
+    compute_kmer_hashes<K>(sequence, result);
     return result;
 }
 
-using KmerHashTable = std::pair<std::vector<std::vector<std::size_t>>, std::size_t>;
+// A flat kmer index of one target sequence. The positions of kmer h are
+// positions[offsets[h]] ... positions[offsets[h + 1] - 1] in increasing order. The buffers are
+// kept between populations so reusing a table for many targets does not allocate.
+struct KmerHashTable
+{
+    using Position = std::uint32_t;
+    
+    std::vector<Position> offsets;
+    std::vector<Position> positions;
+    KmerPerfectHashes hashes; // scratch
+    
+    std::size_t size() const noexcept { return positions.size(); }
+};
 
 template <unsigned char K>
 KmerHashTable init_kmer_hash_table()
 {
-    return std::make_pair(std::vector<std::vector<std::size_t>> {num_kmers(K), std::vector<std::size_t> {}}, 0);
+    KmerHashTable result {};
+    result.offsets.assign(num_kmers(K) + 1, 0);
+    return result;
 }
 
 inline void clear_kmer_hash_table(KmerHashTable& table)
 {
-    for (auto& bin : table.first) bin.clear();
-    table.second = 0;
+    std::fill(std::begin(table.offsets), std::end(table.offsets), 0);
+    table.positions.clear();
 }
 
 template <unsigned char K>
 void populate_kmer_hash_table(const std::string& sequence, KmerHashTable& result)
 {
-    if (sequence.size() < K) {
-        return;
-    }
-    
-    const auto last_index = sequence.size() - K;
-    
-    auto it = std::cbegin(sequence);
-    
-    for (std::size_t index {0}; index <= last_index; ++index, ++it) {
-        result.first[perfect_kmer_hash<K>(it)].push_back(index);
+    compute_kmer_hashes<K>(sequence, result.hashes);
+    result.offsets.assign(num_kmers(K) + 1, 0);
+    result.positions.resize(result.hashes.size());
+    if (result.hashes.empty()) return;
+    // Counting sort: offsets[h + 1] counts h, then becomes the end of bin h after the prefix sum
+    for (const auto hash : result.hashes) ++result.offsets[hash + 1];
+    std::partial_sum(std::cbegin(result.offsets), std::cend(result.offsets), std::begin(result.offsets));
+    // Fill bins using offsets[h] as the insertion point, which leaves offsets[h] at the end of bin h
+    for (KmerHashTable::Position index {0}; index < result.hashes.size(); ++index) {
+        result.positions[result.offsets[result.hashes[index]]++] = index;
     }
-    
-    for (auto& bin : result.first) bin.shrink_to_fit();
-    
-    result.second = sequence.size() - K + 1;
+    std::copy_backward(std::cbegin(result.offsets), std::prev(std::cend(result.offsets)), std::end(result.offsets));
+    result.offsets.front() = 0;
 }
 
 template <unsigned char K>
@@ -118,7 +138,7 @@ using MappedIndexCounts = std::vector<unsigned>;
 
 inline MappedIndexCounts init_mapping_counts(const KmerHashTable& target)
 {
-    return MappedIndexCounts(target.second, 0);
+    return MappedIndexCounts(target.size(), 0);
 }
 
 inline void reset_mapping_counts(MappedIndexCounts& mapping_counts)
@@ -136,7 +156,11 @@ OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable
     unsigned num_max_hits {0};
     
     for (std::size_t query_index {0}; query_index < query.size(); ++query_index) {
-        for (const auto target_index : target.first[query[query_index]]) {
+        const auto hash = query[query_index];
+        const auto first_target = std::next(std::cbegin(target.positions), target.offsets[hash]);
+        const auto last_target  = std::next(std::cbegin(target.positions), target.offsets[hash + 1]);
+        for (auto target_itr = first_target; target_itr != last_target; ++target_itr) {
+            const std::size_t target_index {*target_itr};
             if (target_index >= query_index) {
                 const auto mapping_begin = target_index - query_index;
                 
@@ -646,8 +646,8 @@ bool has_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
     using MappableTp2 = typename std::iterator_traits<BidirIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    return std::binary_search(first, last, mappable,
-                              [] (const auto& lhs, const auto& rhs) { return is_before(lhs, rhs); });
+    // A binary search with is_before misses empty regions (insertions) on the boundaries of mappable
+    return !overlap_range(first, last, mappable, BidirectionallySortedTag {}).empty();
 }
 
 template <typename BidirIt, typename MappableTp>
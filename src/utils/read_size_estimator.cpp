@@ -95,4 +95,15 @@ std::size_t default_read_size_estimate() noexcept
     return sizeof(AlignedRead) + 300;
 }
 
+std::size_t estimate_memory_footprint(const ReadMap& reads) noexcept
+{
+    std::size_t result {0};
+    for (const auto& p : reads) {
+        for (const auto& read : p.second) {
+            result += estimate_read_size(read);
+        }
+    }
+    return result;
+}
+
 } // namespace octopus
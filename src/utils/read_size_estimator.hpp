@@ -21,6 +21,8 @@ boost::optional<std::size_t> estimate_mean_read_size(const std::vector<SampleNam
 
 std::size_t default_read_size_estimate() noexcept;
 
+std::size_t estimate_memory_footprint(const ReadMap& reads) noexcept;
+
 } // namespace octopus
 
 #endif
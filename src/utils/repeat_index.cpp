@@ -0,0 +1,638 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "repeat_index.hpp"
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+#include <ios>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "basics/cigar_string.hpp"
+#include "core/types/haplotype.hpp"
+#include "exceptions/missing_file_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+#include "exceptions/system_error.hpp"
+
+namespace octopus {
+
+namespace {
+
+// The index file is laid out as a header, then for each contig the encoded repeats followed by
+// the block table and repeat regions, then the contig directory. The last 8 bytes give the offset
+// of the directory. Values use the native byte order.
+//
+// Repeats are sorted by position and grouped into blocks of a fixed number of repeats. Each repeat
+// is stored as two varints: the position difference from the previous repeat in the block
+// (with the period packed into the low bits), and the length. Each block table entry records
+// the largest end position of any repeat up to and including the block, so the first block that
+// can overlap a position is found by binary search.
+
+constexpr char magic[8] {'O', 'C', 'T', 'R', 'P', 'I', 'D', 'X'};
+constexpr std::uint32_t version {1};
+constexpr std::uint32_t repeats_per_block {64};
+
+struct Block
+{
+    std::uint64_t offset;
+    std::uint32_t first_pos, max_end;
+};
+
+constexpr std::size_t block_entry_size {sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t)};
+constexpr std::size_t region_entry_size {2 * sizeof(std::uint32_t)};
+
+class MissingRepeatIndexFile : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "RepeatIndex";
+    }
+public:
+    MissingRepeatIndexFile(boost::filesystem::path file) : MissingFileError {std::move(file), "repeat index"} {}
+};
+
+class MalformedRepeatIndex : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "RepeatIndex";
+    }
+    
+    std::string do_help() const override
+    {
+        return "Rebuild the repeat index with --build-repeat-index";
+    }
+public:
+    MalformedRepeatIndex(boost::filesystem::path file, std::string reason) : MalformedFileError {std::move(file)}
+    {
+        set_reason(std::move(reason));
+    }
+};
+
+class RepeatIndexWriteError : public SystemError
+{
+    std::string do_where() const override
+    {
+        return "build_repeat_index";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "Could not write repeat index " << file_;
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        return "Check there is space on the device and that the output directory is writable";
+    }
+    
+    boost::filesystem::path file_;
+public:
+    RepeatIndexWriteError(boost::filesystem::path file) : file_ {std::move(file)} {}
+};
+
+template <typename T>
+T read(const char* data) noexcept
+{
+    T result;
+    std::memcpy(&result, data, sizeof(T));
+    return result;
+}
+
+Block read_block(const char* blocks, const std::uint32_t n) noexcept
+{
+    const auto data = blocks + n * block_entry_size;
+    return {read<std::uint64_t>(data),
+            read<std::uint32_t>(data + sizeof(std::uint64_t)),
+            read<std::uint32_t>(data + sizeof(std::uint64_t) + sizeof(std::uint32_t))};
+}
+
+ContigRegion read_region(const char* regions, const std::uint32_t n) noexcept
+{
+    const auto data = regions + n * region_entry_size;
+    return ContigRegion {read<std::uint32_t>(data), read<std::uint32_t>(data + sizeof(std::uint32_t))};
+}
+
+std::uint64_t read_varint(const char*& data) noexcept
+{
+    std::uint64_t result {0};
+    for (unsigned shift {0};; shift += 7) {
+        const auto byte = static_cast<std::uint8_t>(*data++);
+        result |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return result;
+}
+
+void put_varint(std::string& buffer, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+template <typename T>
+void put(std::string& buffer, const T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+unsigned count_bits(unsigned value) noexcept
+{
+    unsigned result {0};
+    for (; value > 0; value >>= 1) ++result;
+    return result;
+}
+
+auto repeat_end(const tandem::Repeat& repeat) noexcept
+{
+    return repeat.pos + repeat.length;
+}
+
+bool is_less(const tandem::Repeat& lhs, const tandem::Repeat& rhs) noexcept
+{
+    if (lhs.pos != rhs.pos) return lhs.pos < rhs.pos;
+    if (lhs.period != rhs.period) return lhs.period < rhs.period;
+    return lhs.length < rhs.length;
+}
+
+bool is_same(const tandem::Repeat& lhs, const tandem::Repeat& rhs) noexcept
+{
+    return lhs == rhs && lhs.period == rhs.period;
+}
+
+template <typename Sequence>
+bool is_unknown_sequence_repeat(const Sequence& sequence, const tandem::Repeat& repeat)
+{
+    const auto first = std::next(std::cbegin(sequence), repeat.pos);
+    return std::find(first, std::next(first, repeat.period), 'N') != std::next(first, repeat.period);
+}
+
+struct ContigRepeats
+{
+    std::vector<tandem::Repeat> repeats;
+    std::vector<ContigRegion> regions;
+};
+
+ContigRepeats find_contig_repeats(const ReferenceGenome& reference, const GenomicRegion::ContigName& contig,
+                                  const RepeatIndex::BuildOptions& options)
+{
+    ContigRepeats result {};
+    const auto contig_size = reference.contig_size(contig);
+    const auto chunk_size = std::max(options.chunk_size, GenomicRegion::Size {1});
+    // Repeats are assigned to the chunk containing their first position, and each chunk is searched
+    // with flanking overlap so repeats shorter than the overlap are not truncated.
+    for (GenomicRegion::Position chunk_begin {0}; chunk_begin < contig_size; chunk_begin += chunk_size) {
+        const auto chunk_end = std::min(chunk_begin + chunk_size, contig_size);
+        const auto window_begin = chunk_begin > options.chunk_overlap ? chunk_begin - options.chunk_overlap : 0;
+        const auto window_end = std::min(chunk_end + options.chunk_overlap, contig_size);
+        const GenomicRegion window {contig, window_begin, window_end};
+        const auto sequence = reference.fetch_sequence(window);
+        auto repeats = tandem::extract_exact_tandem_repeats(sequence, 1, options.max_period);
+        const auto num_repeats = result.repeats.size();
+        for (auto repeat : repeats) {
+            if (is_unknown_sequence_repeat(sequence, repeat)) continue;
+            repeat.pos += window_begin;
+            if (repeat.pos >= chunk_begin && repeat.pos < chunk_end) {
+                result.repeats.push_back(repeat);
+            }
+        }
+        std::sort(std::next(std::begin(result.repeats), num_repeats), std::end(result.repeats), is_less);
+        for (const auto& region : find_repeat_regions(sequence, window, options.repeat_region_definition)) {
+            if (region.begin() >= chunk_begin && region.begin() < chunk_end) {
+                result.regions.push_back(region.contig_region());
+            }
+        }
+    }
+    std::sort(std::begin(result.regions), std::end(result.regions));
+    if (!result.regions.empty()) {
+        std::vector<ContigRegion> joined_regions {};
+        joined_regions.reserve(result.regions.size());
+        joined_regions.push_back(result.regions.front());
+        for (auto itr = std::next(std::cbegin(result.regions)); itr != std::cend(result.regions); ++itr) {
+            auto& prev = joined_regions.back();
+            if (itr->begin() <= prev.end() + options.repeat_region_definition.max_seed_join_distance) {
+                prev = ContigRegion {prev.begin(), std::max(prev.end(), itr->end())};
+            } else {
+                joined_regions.push_back(*itr);
+            }
+        }
+        result.regions = std::move(joined_regions);
+    }
+    return result;
+}
+
+struct DirectoryEntry
+{
+    GenomicRegion::ContigName contig;
+    std::uint32_t size;
+    std::uint64_t blocks_offset;
+    std::uint32_t num_blocks;
+    std::uint64_t regions_offset;
+    std::uint32_t num_regions;
+};
+
+std::string encode(const ContigRepeats& repeats, const std::uint64_t offset, const unsigned period_bits,
+                   DirectoryEntry& entry)
+{
+    std::string data {}, blocks {};
+    std::uint32_t max_end {0}, prev_pos {0};
+    for (std::size_t i {0}; i < repeats.repeats.size(); ++i) {
+        const auto& repeat = repeats.repeats[i];
+        if (i % repeats_per_block == 0) {
+            put(blocks, static_cast<std::uint64_t>(offset + data.size()));
+            put(blocks, repeat.pos);
+            put(blocks, std::uint32_t {0});
+            prev_pos = repeat.pos;
+        }
+        put_varint(data, (static_cast<std::uint64_t>(repeat.pos - prev_pos) << period_bits) | repeat.period);
+        put_varint(data, repeat.length);
+        prev_pos = repeat.pos;
+        max_end = std::max(max_end, repeat_end(repeat));
+        std::memcpy(&blocks[blocks.size() - sizeof(std::uint32_t)], &max_end, sizeof(std::uint32_t));
+    }
+    entry.blocks_offset = offset + data.size();
+    entry.num_blocks = static_cast<std::uint32_t>(blocks.size() / block_entry_size);
+    entry.regions_offset = entry.blocks_offset + blocks.size();
+    entry.num_regions = static_cast<std::uint32_t>(repeats.regions.size());
+    data += blocks;
+    for (const auto& region : repeats.regions) {
+        put(data, static_cast<std::uint32_t>(region.begin()));
+        put(data, static_cast<std::uint32_t>(region.end()));
+    }
+    return data;
+}
+
+} // namespace
+
+RepeatIndex::RepeatIndex(Path path)
+: path_ {std::move(path)}
+, file_ {}
+, max_period_ {}
+, period_bits_ {}
+, contigs_ {}
+{
+    if (!boost::filesystem::exists(path_)) {
+        throw MissingRepeatIndexFile {path_};
+    }
+    try {
+        file_.open(path_.string());
+    } catch (const std::ios_base::failure&) {
+        throw MalformedRepeatIndex {path_, "it could not be memory mapped"};
+    }
+    if (!file_.is_open()) {
+        throw MalformedRepeatIndex {path_, "it could not be memory mapped"};
+    }
+    read_directory();
+}
+
+const RepeatIndex::Path& RepeatIndex::path() const noexcept
+{
+    return path_;
+}
+
+unsigned RepeatIndex::max_period() const noexcept
+{
+    return max_period_;
+}
+
+bool RepeatIndex::has_contig(const GenomicRegion::ContigName& contig) const noexcept
+{
+    return contigs_.count(contig) == 1;
+}
+
+ContigRegion::Size RepeatIndex::contig_size(const GenomicRegion::ContigName& contig) const
+{
+    return contigs_.at(contig).size;
+}
+
+std::vector<GenomicRegion::ContigName> RepeatIndex::contig_names() const
+{
+    std::vector<GenomicRegion::ContigName> result {};
+    result.reserve(contigs_.size());
+    for (const auto& p : contigs_) {
+        result.push_back(p.first);
+    }
+    return result;
+}
+
+std::vector<tandem::Repeat>
+RepeatIndex::fetch_tandem_repeats(const GenomicRegion& region, const unsigned min_period, const unsigned max_period) const
+{
+    std::vector<tandem::Repeat> result {};
+    const auto itr = contigs_.find(region.contig_name());
+    if (itr == std::cend(contigs_) || itr->second.num_blocks == 0) return result;
+    const auto& contig = itr->second;
+    // The first block with a repeat ending after the region begin
+    std::uint32_t first_block {0}, last_block {contig.num_blocks};
+    while (first_block < last_block) {
+        const auto mid = first_block + (last_block - first_block) / 2;
+        if (read_block(contig.blocks, mid).max_end <= region.begin()) {
+            first_block = mid + 1;
+        } else {
+            last_block = mid;
+        }
+    }
+    const auto period_mask = (std::uint64_t {1} << period_bits_) - 1;
+    const auto data_end = contig.blocks;
+    for (auto block_idx = first_block; block_idx < contig.num_blocks; ++block_idx) {
+        const auto block = read_block(contig.blocks, block_idx);
+        if (block.first_pos >= region.end()) break;
+        auto data = file_.data() + block.offset;
+        std::uint32_t pos {block.first_pos};
+        for (std::uint32_t i {0}; i < repeats_per_block && data < data_end; ++i) {
+            const auto pos_period = read_varint(data);
+            const auto length = static_cast<std::uint32_t>(read_varint(data));
+            pos += static_cast<std::uint32_t>(pos_period >> period_bits_);
+            if (pos >= region.end()) break;
+            const auto period = static_cast<std::uint32_t>(pos_period & period_mask);
+            if (pos + length > region.begin() && period >= min_period && period <= max_period) {
+                result.emplace_back(pos, length, period);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<GenomicRegion> RepeatIndex::fetch_repeat_regions(const GenomicRegion& region) const
+{
+    std::vector<GenomicRegion> result {};
+    const auto itr = contigs_.find(region.contig_name());
+    if (itr == std::cend(contigs_)) return result;
+    const auto& contig = itr->second;
+    // Regions are sorted and disjoint, so find the first ending after the region begin
+    std::uint32_t first {0}, last {contig.num_regions};
+    while (first < last) {
+        const auto mid = first + (last - first) / 2;
+        if (read_region(contig.regions, mid).end() <= region.begin()) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    for (; first < contig.num_regions; ++first) {
+        const auto repeat_region = read_region(contig.regions, first);
+        if (repeat_region.begin() >= region.end()) break;
+        result.emplace_back(region.contig_name(),
+                            std::max(repeat_region.begin(), region.begin()),
+                            std::min(repeat_region.end(), region.end()));
+    }
+    return result;
+}
+
+// private methods
+
+void RepeatIndex::read_directory()
+{
+    const auto data = file_.data();
+    const auto file_size = file_.size();
+    const auto header_size = sizeof(magic) + 2 * sizeof(std::uint32_t);
+    if (file_size < header_size + sizeof(std::uint64_t) || std::memcmp(data, magic, sizeof(magic)) != 0) {
+        throw MalformedRepeatIndex {path_, "it is not a repeat index"};
+    }
+    if (read<std::uint32_t>(data + sizeof(magic)) != version) {
+        throw MalformedRepeatIndex {path_, "it was built with an unsupported repeat index version"};
+    }
+    max_period_ = read<std::uint32_t>(data + sizeof(magic) + sizeof(std::uint32_t));
+    period_bits_ = count_bits(max_period_);
+    // Every offset and count in the directory is checked against the file size so truncated or
+    // corrupted files are rejected here rather than read out of bounds when queried
+    const auto directory_end = file_size - sizeof(std::uint64_t);
+    const auto directory_offset = read<std::uint64_t>(data + directory_end);
+    const auto check_fits = [&] (const std::uint64_t offset, const std::uint64_t size) {
+        if (offset > directory_end || size > directory_end - offset) {
+            throw MalformedRepeatIndex {path_, "it is truncated or corrupted"};
+        }
+    };
+    check_fits(directory_offset, sizeof(std::uint32_t));
+    auto directory = data + directory_offset;
+    const auto num_contigs = read<std::uint32_t>(directory);
+    directory += sizeof(std::uint32_t);
+    contigs_.reserve(num_contigs);
+    // Contig size, block count and region count, then the block and region offsets
+    const auto fixed_entry_size = 3 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+    for (std::uint32_t i {0}; i < num_contigs; ++i) {
+        check_fits(directory - data, sizeof(std::uint32_t));
+        const auto name_length = read<std::uint32_t>(directory);
+        check_fits(directory - data, sizeof(std::uint32_t) + std::uint64_t {name_length} + fixed_entry_size);
+        directory += sizeof(std::uint32_t);
+        GenomicRegion::ContigName contig {directory, name_length};
+        directory += name_length;
+        ContigIndex index {};
+        index.size = read<std::uint32_t>(directory);
+        directory += sizeof(std::uint32_t);
+        const auto blocks_offset = read<std::uint64_t>(directory);
+        directory += sizeof(std::uint64_t);
+        index.num_blocks = read<std::uint32_t>(directory);
+        directory += sizeof(std::uint32_t);
+        const auto regions_offset = read<std::uint64_t>(directory);
+        directory += sizeof(std::uint64_t);
+        index.num_regions = read<std::uint32_t>(directory);
+        directory += sizeof(std::uint32_t);
+        check_fits(blocks_offset, std::uint64_t {index.num_blocks} * block_entry_size);
+        check_fits(regions_offset, std::uint64_t {index.num_regions} * region_entry_size);
+        index.blocks = data + blocks_offset;
+        index.regions = data + regions_offset;
+        contigs_.emplace(std::move(contig), index);
+    }
+}
+
+void build_repeat_index(const ReferenceGenome& reference, const RepeatIndex::Path& path,
+                        RepeatIndex::BuildOptions options)
+{
+    if (options.max_period == 0) {
+        throw std::invalid_argument {"build_repeat_index: max_period must be positive"};
+    }
+    std::ofstream file {path.string(), std::ios::binary | std::ios::trunc};
+    if (!file) {
+        throw RepeatIndexWriteError {path};
+    }
+    const auto period_bits = count_bits(options.max_period);
+    std::string header {magic, sizeof(magic)};
+    put(header, version);
+    put(header, static_cast<std::uint32_t>(options.max_period));
+    file.write(header.data(), header.size());
+    std::uint64_t offset {header.size()};
+    std::vector<DirectoryEntry> directory {};
+    for (const auto& contig : reference.contig_names()) {
+        DirectoryEntry entry {};
+        entry.contig = contig;
+        entry.size = static_cast<std::uint32_t>(reference.contig_size(contig));
+        const auto data = encode(find_contig_repeats(reference, contig, options), offset, period_bits, entry);
+        file.write(data.data(), data.size());
+        offset += data.size();
+        directory.push_back(std::move(entry));
+    }
+    std::string footer {};
+    put(footer, static_cast<std::uint32_t>(directory.size()));
+    for (const auto& entry : directory) {
+        put(footer, static_cast<std::uint32_t>(entry.contig.size()));
+        footer.append(entry.contig);
+        put(footer, entry.size);
+        put(footer, entry.blocks_offset);
+        put(footer, entry.num_blocks);
+        put(footer, entry.regions_offset);
+        put(footer, entry.num_regions);
+    }
+    put(footer, offset);
+    file.write(footer.data(), footer.size());
+    if (!file) {
+        throw RepeatIndexWriteError {path};
+    }
+}
+
+namespace {
+
+// A run of haplotype cigar operations that are not sequence matches
+struct Edit
+{
+    std::uint32_t reference_begin, reference_end, sequence_begin, sequence_end;
+};
+
+auto find_edits(const Haplotype& haplotype)
+{
+    std::vector<Edit> result {};
+    auto reference_pos = static_cast<std::uint32_t>(mapped_begin(haplotype));
+    std::uint32_t sequence_pos {0};
+    bool in_edit {false};
+    for (const auto& op : haplotype.cigar()) {
+        if (op.flag() == CigarOperation::Flag::sequenceMatch) {
+            in_edit = false;
+            reference_pos += op.size();
+            sequence_pos += op.size();
+            continue;
+        }
+        if (!in_edit) {
+            result.push_back({reference_pos, reference_pos, sequence_pos, sequence_pos});
+            in_edit = true;
+        }
+        if (op.advances_reference()) reference_pos += op.size();
+        if (op.advances_sequence()) sequence_pos += op.size();
+        result.back().reference_end = reference_pos;
+        result.back().sequence_end = sequence_pos;
+    }
+    return result;
+}
+
+// Insertions at the position are included if the position is an end position
+std::uint32_t to_sequence_position(const std::uint32_t reference_pos, const std::uint32_t haplotype_begin,
+                                   const std::vector<Edit>& edits, const bool is_end)
+{
+    std::int64_t result {reference_pos - haplotype_begin};
+    for (const auto& edit : edits) {
+        if (edit.reference_end > reference_pos) break;
+        if (edit.reference_end == reference_pos && edit.reference_begin == reference_pos && !is_end) break;
+        result += static_cast<std::int64_t>(edit.sequence_end - edit.sequence_begin)
+                  - static_cast<std::int64_t>(edit.reference_end - edit.reference_begin);
+    }
+    return static_cast<std::uint32_t>(result);
+}
+
+struct Window
+{
+    std::uint32_t begin, end;
+};
+
+bool overlaps(const Window& window, const tandem::Repeat& repeat) noexcept
+{
+    return repeat.pos < window.end && repeat_end(repeat) > window.begin;
+}
+
+void merge_overlapping(std::vector<Window>& windows)
+{
+    if (windows.empty()) return;
+    std::sort(std::begin(windows), std::end(windows), [] (const auto& lhs, const auto& rhs) { return lhs.begin < rhs.begin; });
+    auto last = std::begin(windows);
+    for (auto itr = std::next(std::begin(windows)); itr != std::end(windows); ++itr) {
+        if (itr->begin <= last->end) {
+            last->end = std::max(last->end, itr->end);
+        } else {
+            *++last = *itr;
+        }
+    }
+    windows.erase(std::next(last), std::end(windows));
+}
+
+} // namespace
+
+std::vector<tandem::Repeat>
+find_tandem_repeats(const Haplotype& haplotype, const RepeatIndex& index, const unsigned min_period, const unsigned max_period)
+{
+    const auto& region = mapped_region(haplotype);
+    const auto& sequence = haplotype.sequence();
+    if (max_period > index.max_period() || !index.has_contig(region.contig_name())) {
+        return tandem::extract_exact_tandem_repeats(sequence, min_period, max_period);
+    }
+    const auto region_begin = static_cast<std::uint32_t>(region.begin());
+    const auto region_end = static_cast<std::uint32_t>(region.end());
+    auto reference_repeats = index.fetch_tandem_repeats(region, min_period, max_period);
+    const auto edits = find_edits(haplotype);
+    // Variant alleles can create, extend, or break repeats up to a repeat unit either side, so
+    // any reference repeat near an edit is discarded and the surrounding sequence searched directly.
+    const std::uint32_t pad {2 * max_period};
+    std::vector<Window> windows {};
+    windows.reserve(edits.size());
+    for (const auto& edit : edits) {
+        windows.push_back({edit.reference_begin - std::min(pad, edit.reference_begin - region_begin),
+                           std::min(edit.reference_end + pad, region_end)});
+    }
+    std::vector<bool> is_clean(reference_repeats.size(), true);
+    for (bool changed {true}; changed && !windows.empty();) {
+        merge_overlapping(windows);
+        changed = false;
+        for (std::size_t i {0}; i < reference_repeats.size(); ++i) {
+            if (!is_clean[i]) continue;
+            const auto& repeat = reference_repeats[i];
+            for (auto& window : windows) {
+                if (overlaps(window, repeat)) {
+                    window.begin = std::max(std::min(window.begin, repeat.pos), region_begin);
+                    window.end = std::min(std::max(window.end, repeat_end(repeat)), region_end);
+                    is_clean[i] = false;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    std::vector<tandem::Repeat> result {};
+    result.reserve(reference_repeats.size());
+    for (std::size_t i {0}; i < reference_repeats.size(); ++i) {
+        if (!is_clean[i]) continue;
+        const auto& repeat = reference_repeats[i];
+        const auto begin = std::max(repeat.pos, region_begin);
+        const auto end = std::min(repeat_end(repeat), region_end);
+        if (end - begin >= 2 * repeat.period) {
+            result.emplace_back(to_sequence_position(begin, region_begin, edits, false), end - begin, repeat.period);
+        }
+    }
+    const auto sequence_size = static_cast<std::uint32_t>(sequence.size());
+    for (const auto& window : windows) {
+        const auto window_begin = to_sequence_position(window.begin, region_begin, edits, false);
+        const auto window_end = to_sequence_position(window.end, region_begin, edits, true);
+        const auto search_begin = window_begin > pad ? window_begin - pad : 0;
+        const auto search_end = std::min(window_end + pad, sequence_size);
+        if (search_begin >= search_end) continue;
+        const auto search_sequence = sequence.substr(search_begin, search_end - search_begin);
+        for (auto repeat : tandem::extract_exact_tandem_repeats(search_sequence, min_period, max_period)) {
+            repeat.pos += search_begin;
+            if (repeat.pos < window_end && repeat_end(repeat) > window_begin) {
+                result.push_back(repeat);
+            }
+        }
+    }
+    std::sort(std::begin(result), std::end(result), is_less);
+    result.erase(std::unique(std::begin(result), std::end(result), is_same), std::end(result));
+    return result;
+}
+
+} // namespace octopus
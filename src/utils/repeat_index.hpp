@@ -0,0 +1,94 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef repeat_index_hpp
+#define repeat_index_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "tandem/tandem.hpp"
+#include "repeat_finder.hpp"
+
+namespace octopus {
+
+class Haplotype;
+
+// A precomputed index of the reference tandem repeats, built once with build_repeat_index and
+// memory mapped when loaded. Exact repeats up to max_period are stored for the whole reference,
+// so short period repeat annotation becomes a lookup, along with the inexact repeat regions
+// given by find_repeat_regions.
+class RepeatIndex
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    struct BuildOptions
+    {
+        unsigned max_period = 3;
+        InexactRepeatDefinition repeat_region_definition = {};
+        GenomicRegion::Size chunk_size = 1'000'000, chunk_overlap = 10'000;
+    };
+    
+    RepeatIndex() = delete;
+    
+    RepeatIndex(Path path);
+    
+    RepeatIndex(const RepeatIndex&)            = delete;
+    RepeatIndex& operator=(const RepeatIndex&) = delete;
+    RepeatIndex(RepeatIndex&&)                 = delete;
+    RepeatIndex& operator=(RepeatIndex&&)      = delete;
+    
+    ~RepeatIndex() = default;
+    
+    const Path& path() const noexcept;
+    
+    unsigned max_period() const noexcept;
+    
+    bool has_contig(const GenomicRegion::ContigName& contig) const noexcept;
+    ContigRegion::Size contig_size(const GenomicRegion::ContigName& contig) const;
+    std::vector<GenomicRegion::ContigName> contig_names() const;
+    
+    // Repeats overlapping the region, sorted by position. Positions are reference positions.
+    std::vector<tandem::Repeat> fetch_tandem_repeats(const GenomicRegion& region,
+                                                     unsigned min_period = 1, unsigned max_period = -1) const;
+    
+    // The same as find_repeat_regions on the region sequence, apart from the region boundaries
+    std::vector<GenomicRegion> fetch_repeat_regions(const GenomicRegion& region) const;
+
+private:
+    struct ContigIndex
+    {
+        ContigRegion::Size size;
+        const char* blocks;
+        std::uint32_t num_blocks;
+        const char* regions;
+        std::uint32_t num_regions;
+    };
+    
+    Path path_;
+    boost::iostreams::mapped_file_source file_;
+    unsigned max_period_, period_bits_;
+    std::unordered_map<GenomicRegion::ContigName, ContigIndex> contigs_;
+    
+    void read_directory();
+};
+
+void build_repeat_index(const ReferenceGenome& reference, const RepeatIndex::Path& path,
+                        RepeatIndex::BuildOptions options = {});
+
+// The exact tandem repeats in the haplotype sequence, in sequence coordinates. Reference repeats
+// are taken from the index and only the sequence around the haplotype's variant alleles is searched.
+std::vector<tandem::Repeat>
+find_tandem_repeats(const Haplotype& haplotype, const RepeatIndex& index, unsigned min_period, unsigned max_period);
+
+} // namespace octopus
+
+#endif
@@ -0,0 +1,136 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "stable_hash.hpp"
+
+#include <algorithm>
+
+namespace octopus { namespace utils {
+
+namespace {
+
+constexpr std::uint64_t prime1 {11400714785074694791ULL};
+constexpr std::uint64_t prime2 {14029467366897019727ULL};
+constexpr std::uint64_t prime3 {1609587929392839161ULL};
+constexpr std::uint64_t prime4 {9650029242287828579ULL};
+constexpr std::uint64_t prime5 {2870177450012600261ULL};
+constexpr std::uint64_t seed {0};
+
+std::uint64_t rotate_left(const std::uint64_t x, const int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// Assembled byte by byte so the result does not depend on the host byte order
+std::uint64_t read64(const unsigned char* p) noexcept
+{
+    std::uint64_t result {0};
+    for (int i {7}; i >= 0; --i) result = (result << 8) | p[i];
+    return result;
+}
+
+std::uint64_t read32(const unsigned char* p) noexcept
+{
+    std::uint64_t result {0};
+    for (int i {3}; i >= 0; --i) result = (result << 8) | p[i];
+    return result;
+}
+
+std::uint64_t round(std::uint64_t accumulator, const std::uint64_t input) noexcept
+{
+    accumulator += input * prime2;
+    return rotate_left(accumulator, 31) * prime1;
+}
+
+std::uint64_t merge_round(std::uint64_t accumulator, const std::uint64_t value) noexcept
+{
+    accumulator ^= round(0, value);
+    return accumulator * prime1 + prime4;
+}
+
+} // namespace
+
+StableHasher::StableHasher() noexcept
+: accumulators_ {{seed + prime1 + prime2, seed + prime2, seed, seed - prime1}}
+, buffer_ {}
+, buffer_size_ {0}
+, total_length_ {0}
+{}
+
+void StableHasher::update(const void* data, std::size_t length) noexcept
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    total_length_ += length;
+    if (buffer_size_ > 0) {
+        const auto num_copied = std::min(length, stripeSize - buffer_size_);
+        std::copy(bytes, bytes + num_copied, std::begin(buffer_) + buffer_size_);
+        buffer_size_ += num_copied;
+        bytes += num_copied;
+        length -= num_copied;
+        if (buffer_size_ < stripeSize) return;
+        consume_stripe(buffer_.data());
+        buffer_size_ = 0;
+    }
+    for (; length >= stripeSize; bytes += stripeSize, length -= stripeSize) {
+        consume_stripe(bytes);
+    }
+    std::copy(bytes, bytes + length, std::begin(buffer_));
+    buffer_size_ = length;
+}
+
+void StableHasher::update(const std::uint64_t value) noexcept
+{
+    std::array<unsigned char, 8> bytes;
+    for (unsigned i {0}; i < bytes.size(); ++i) bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+    update(bytes.data(), bytes.size());
+}
+
+void StableHasher::update(const std::string& value) noexcept
+{
+    update(static_cast<std::uint64_t>(value.size()));
+    update(value.data(), value.size());
+}
+
+StableHasher::Digest StableHasher::digest() const noexcept
+{
+    std::uint64_t result;
+    if (total_length_ >= stripeSize) {
+        const auto& v = accumulators_;
+        result = rotate_left(v[0], 1) + rotate_left(v[1], 7) + rotate_left(v[2], 12) + rotate_left(v[3], 18);
+        for (const auto accumulator : v) result = merge_round(result, accumulator);
+    } else {
+        result = seed + prime5;
+    }
+    result += total_length_;
+    auto p = buffer_.data();
+    const auto last = p + buffer_size_;
+    for (; p + 8 <= last; p += 8) {
+        result ^= round(0, read64(p));
+        result = rotate_left(result, 27) * prime1 + prime4;
+    }
+    if (p + 4 <= last) {
+        result ^= read32(p) * prime1;
+        result = rotate_left(result, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < last; ++p) {
+        result ^= *p * prime5;
+        result = rotate_left(result, 11) * prime1;
+    }
+    result ^= result >> 33;
+    result *= prime2;
+    result ^= result >> 29;
+    result *= prime3;
+    result ^= result >> 32;
+    return result;
+}
+
+void StableHasher::consume_stripe(const unsigned char* stripe) noexcept
+{
+    for (unsigned i {0}; i < accumulators_.size(); ++i) {
+        accumulators_[i] = round(accumulators_[i], read64(stripe + 8 * i));
+    }
+}
+
+} // namespace utils
+} // namespace octopus
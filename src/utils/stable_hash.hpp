@@ -0,0 +1,53 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef stable_hash_hpp
+#define stable_hash_hpp
+
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace octopus { namespace utils {
+
+// Streaming XXH64 with a fixed seed. Unlike std::hash and boost::hash, the digest only depends on
+// the bytes given, so it is the same on every platform, compiler, and library version, and can be
+// written to files that are read by later runs.
+class StableHasher
+{
+public:
+    using Digest = std::uint64_t;
+
+    StableHasher() noexcept;
+
+    StableHasher(const StableHasher&)            = default;
+    StableHasher& operator=(const StableHasher&) = default;
+    StableHasher(StableHasher&&)                 = default;
+    StableHasher& operator=(StableHasher&&)      = default;
+
+    ~StableHasher() = default;
+
+    void update(const void* data, std::size_t length) noexcept;
+    // Integers are hashed as 8 little-endian bytes
+    void update(std::uint64_t value) noexcept;
+    // Strings are hashed with their length, so adjacent strings cannot run together
+    void update(const std::string& value) noexcept;
+
+    Digest digest() const noexcept;
+
+private:
+    static constexpr std::size_t stripeSize {32};
+
+    std::array<std::uint64_t, 4> accumulators_;
+    std::array<unsigned char, stripeSize> buffer_;
+    std::size_t buffer_size_;
+    std::uint64_t total_length_;
+
+    void consume_stripe(const unsigned char* stripe) noexcept;
+};
+
+} // namespace utils
+} // namespace octopus
+
+#endif
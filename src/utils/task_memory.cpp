@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "task_memory.hpp"
+
+#include <algorithm>
+
+namespace octopus {
+
+namespace {
+
+struct TaskFootprint
+{
+    std::size_t peak = 0;
+};
+
+TaskFootprint& local_footprint() noexcept
+{
+    thread_local TaskFootprint result {};
+    return result;
+}
+
+} // namespace
+
+void reset_task_footprint() noexcept
+{
+    local_footprint().peak = 0;
+}
+
+void note_task_footprint(const std::size_t num_bytes) noexcept
+{
+    auto& footprint = local_footprint();
+    footprint.peak = std::max(footprint.peak, num_bytes);
+}
+
+std::size_t peak_task_footprint() noexcept
+{
+    return local_footprint().peak;
+}
+
+TaskMemoryBudget::TaskMemoryBudget(const std::size_t budget_bytes, const unsigned max_concurrent_tasks)
+: budget_ {budget_bytes}
+, reserved_ {0}
+, max_concurrent_tasks_ {std::max(max_concurrent_tasks, 1u)}
+, bytes_per_base_ {0}
+, has_measurements_ {false}
+{}
+
+std::size_t TaskMemoryBudget::budget() const noexcept
+{
+    return budget_;
+}
+
+std::size_t TaskMemoryBudget::reserved() const noexcept
+{
+    return reserved_;
+}
+
+std::size_t TaskMemoryBudget::project(const std::size_t num_bases) const noexcept
+{
+    if (!has_measurements_) return budget_ / max_concurrent_tasks_;
+    return static_cast<std::size_t>(bytes_per_base_ * num_bases);
+}
+
+bool TaskMemoryBudget::can_admit(const std::size_t projected_bytes) const noexcept
+{
+    return reserved_ == 0 || (reserved_ <= budget_ && projected_bytes <= budget_ - reserved_);
+}
+
+void TaskMemoryBudget::reserve(const std::size_t projected_bytes) noexcept
+{
+    reserved_ += projected_bytes;
+}
+
+void TaskMemoryBudget::release(const std::size_t projected_bytes, const std::size_t num_bases,
+                               const std::size_t measured_bytes) noexcept
+{
+    // Decaying the estimate, rather than averaging it, means a dense region raises projections straight
+    // away, but doesn't throttle the rest of the run once calling moves past it.
+    static constexpr double decay {0.9};
+    reserved_ -= std::min(projected_bytes, reserved_);
+    if (num_bases > 0) {
+        const auto bytes_per_base = static_cast<double>(measured_bytes) / num_bases;
+        bytes_per_base_ = has_measurements_ ? std::max(bytes_per_base, decay * bytes_per_base_) : bytes_per_base;
+        has_measurements_ = true;
+    }
+}
+
+} // namespace octopus
@@ -0,0 +1,55 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef task_memory_hpp
+#define task_memory_hpp
+
+#include <cstddef>
+
+namespace octopus {
+
+// Working memory accounting for the calling task running on this thread. Tasks note the size of their
+// large working sets (buffered reads, haplotypes, likelihoods, genotypes) as they build them, and the
+// scheduler reads back the peak once the task completes.
+void reset_task_footprint() noexcept;
+void note_task_footprint(std::size_t num_bytes) noexcept;
+std::size_t peak_task_footprint() noexcept;
+
+// Admits tasks while the sum of their projected footprints stays within budget. Projections are
+// per reference base and learned from the measured peaks of completed tasks. Until a task completes,
+// each task is projected an equal share of the budget.
+class TaskMemoryBudget
+{
+public:
+    TaskMemoryBudget() = delete;
+    
+    TaskMemoryBudget(std::size_t budget_bytes, unsigned max_concurrent_tasks);
+    
+    TaskMemoryBudget(const TaskMemoryBudget&)            = default;
+    TaskMemoryBudget& operator=(const TaskMemoryBudget&) = default;
+    TaskMemoryBudget(TaskMemoryBudget&&)                 = default;
+    TaskMemoryBudget& operator=(TaskMemoryBudget&&)      = default;
+    
+    ~TaskMemoryBudget() = default;
+    
+    std::size_t budget() const noexcept;
+    std::size_t reserved() const noexcept;
+    
+    std::size_t project(std::size_t num_bases) const noexcept;
+    
+    // Always true when nothing is reserved, so a single oversized task can still run
+    bool can_admit(std::size_t projected_bytes) const noexcept;
+    
+    void reserve(std::size_t projected_bytes) noexcept;
+    void release(std::size_t projected_bytes, std::size_t num_bases, std::size_t measured_bytes) noexcept;
+    
+private:
+    std::size_t budget_, reserved_;
+    unsigned max_concurrent_tasks_;
+    double bytes_per_base_;
+    bool has_measurements_;
+};
+
+} // namespace octopus
+
+#endif
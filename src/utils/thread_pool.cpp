@@ -3,6 +3,8 @@
 
 #include "thread_pool.hpp"
 
+#include <algorithm>
+
 namespace octopus {
 
 ThreadPool::ThreadPool() : ThreadPool {0} {}
@@ -64,4 +66,80 @@ void ThreadPool::clear() noexcept
     while (!tasks_.empty()) tasks_.pop();
 }
 
+namespace {
+
+std::atomic<unsigned> thread_budget {1};
+
+// Threads currently running a task or pool job. A thread is only counted once however many
+// scopes it has entered.
+std::atomic<unsigned> num_busy_threads {0};
+
+thread_local bool is_parallel_task_thread {false};
+thread_local bool is_pool_job_thread {false};
+
+} // namespace
+
+void set_shared_thread_budget(const unsigned num_threads)
+{
+    thread_budget = std::max(num_threads, 1u);
+}
+
+unsigned shared_thread_budget() noexcept
+{
+    return thread_budget;
+}
+
+ParallelTaskScope::ParallelTaskScope() noexcept : previous_ {is_parallel_task_thread}
+{
+    if (!previous_) ++num_busy_threads;
+    is_parallel_task_thread = true;
+}
+
+ParallelTaskScope::~ParallelTaskScope() noexcept
+{
+    is_parallel_task_thread = previous_;
+    if (!previous_) --num_busy_threads;
+}
+
+bool in_parallel_task() noexcept
+{
+    return is_parallel_task_thread;
+}
+
+unsigned num_free_threads() noexcept
+{
+    if (is_pool_job_thread) return 0;
+    const auto busy = num_busy_threads + (in_parallel_task() ? 0u : 1u);
+    const auto budget = shared_thread_budget();
+    return budget > busy ? budget - busy : 0;
+}
+
+unsigned num_parallel_blocks(const std::size_t num_items, const std::size_t min_items_per_block) noexcept
+{
+    const auto max_blocks = std::min(static_cast<std::size_t>(num_free_threads()) + 1,
+                                     num_items / std::max(min_items_per_block, std::size_t {1}));
+    return static_cast<unsigned>(std::max(max_blocks, std::size_t {1}));
+}
+
+namespace detail {
+
+PoolJobScope::PoolJobScope() noexcept : task_ {}, previous_ {is_pool_job_thread}
+{
+    is_pool_job_thread = true;
+}
+
+PoolJobScope::~PoolJobScope() noexcept
+{
+    is_pool_job_thread = previous_;
+}
+
+ThreadPool& shared_pool()
+{
+    // The calling thread runs a block too, so the pool only needs the rest of the budget
+    static ThreadPool result {shared_thread_budget() - 1};
+    return result;
+}
+
+} // namespace detail
+
 } // namespace octopus
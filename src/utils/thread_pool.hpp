@@ -20,6 +20,8 @@
 #include <utility>
 #include <exception>
 
+#include "logging/profiler.hpp"
+
 namespace octopus {
 
 class ThreadPool
@@ -54,6 +56,121 @@ private:
     std::queue<std::function<void()>> tasks_;
 };
 
+// Data parallelism within a single step of a run (e.g. over the reads or samples of one region)
+// shares one process wide pool, sized from the run's thread budget. Threads running one of several
+// concurrent tasks are marked with a ParallelTaskScope, and count against the budget while they run.
+// A task may only hand work to the pool if some of the budget is unused (e.g. when there are fewer
+// tasks than threads, as at the end of a contig), so nested parallelism never oversubscribes the
+// machine. Work already running on the pool is never split further.
+
+// Must be called before the shared pool is first used; the default budget is a single thread
+void set_shared_thread_budget(unsigned num_threads);
+unsigned shared_thread_budget() noexcept;
+
+class ParallelTaskScope
+{
+public:
+    ParallelTaskScope() noexcept;
+    
+    ParallelTaskScope(const ParallelTaskScope&)            = delete;
+    ParallelTaskScope& operator=(const ParallelTaskScope&) = delete;
+    ParallelTaskScope(ParallelTaskScope&&)                 = delete;
+    ParallelTaskScope& operator=(ParallelTaskScope&&)      = delete;
+    
+    ~ParallelTaskScope() noexcept;
+    
+private:
+    bool previous_;
+};
+
+bool in_parallel_task() noexcept;
+
+// The number of threads in the budget not currently running a task or pool job, excluding the
+// calling thread. Always 0 on a pool thread.
+unsigned num_free_threads() noexcept;
+
+// The number of blocks num_items should be split into for parallel processing, given each block
+// should have at least min_items_per_block items. The calling thread runs one block and the
+// others use free threads, so this is 1 if there are none.
+unsigned num_parallel_blocks(std::size_t num_items, std::size_t min_items_per_block) noexcept;
+
+namespace detail {
+
+ThreadPool& shared_pool();
+
+class PoolJobScope
+{
+public:
+    PoolJobScope() noexcept;
+    
+    PoolJobScope(const PoolJobScope&)            = delete;
+    PoolJobScope& operator=(const PoolJobScope&) = delete;
+    PoolJobScope(PoolJobScope&&)                 = delete;
+    PoolJobScope& operator=(PoolJobScope&&)      = delete;
+    
+    ~PoolJobScope() noexcept;
+    
+private:
+    ParallelTaskScope task_;
+    bool previous_;
+};
+
+} // namespace detail
+
+// Runs f on the shared pool, or lazily on the thread that gets the result if the pool has no threads
+template <typename F>
+auto async_shared(F&& f) -> std::future<std::result_of_t<F()>>
+{
+    auto& pool = detail::shared_pool();
+    if (pool.empty()) return std::async(std::launch::deferred, std::forward<F>(f));
+    return pool.push([f = std::forward<F>(f), task = profiling::current_task()] () mutable {
+        const detail::PoolJobScope scope {};
+        const profiling::JobScope profile {std::move(task)};
+        return f();
+    });
+}
+
+// Calls f(block) for each block in [0, num_blocks), using the shared pool for all but the first block,
+// which is run on the calling thread. Returns when all blocks are done.
+template <typename F>
+void parallel_for_each_block(const unsigned num_blocks, F f)
+{
+    if (num_blocks < 2) {
+        if (num_blocks == 1) f(0u);
+        return;
+    }
+    std::vector<std::future<void>> blocks {};
+    blocks.reserve(num_blocks - 1);
+    for (unsigned block {1}; block < num_blocks; ++block) {
+        blocks.push_back(async_shared([&f, block] () { f(block); }));
+    }
+    std::exception_ptr error {};
+    try {
+        const detail::PoolJobScope scope {};
+        f(0u);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Blocks reference f so must all finish before returning, even on error
+    for (auto& block : blocks) {
+        try {
+            block.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+// Splits [0, num_items) into num_blocks contiguous ranges and calls f(first, last) for each in parallel
+template <typename F>
+void parallel_for_ranges(const std::size_t num_items, const unsigned num_blocks, F f)
+{
+    parallel_for_each_block(num_blocks, [&] (const unsigned block) {
+        f(block * num_items / num_blocks, (block + 1) * num_items / num_blocks);
+    });
+}
+
 template <typename F, typename... Args>
 auto ThreadPool::push(F&& f, Args&&... args) -> std::future<std::result_of_t<F(Args...)>>
 {
@@ -58,3 +58,6 @@ if ret == 0:
             run_unit_tests(octopus_build_dir, args["verbose"])
         elif args["type"] == "valgrind":
             call(["make", "install"])
+        elif args["type"] == "regression":
+            call(["make", "install"])
+            call([octopus_dir + "/test/regression/sharding.py", "--octopus", octopus_dir + "/bin/octopus"])
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+
+# Checks that calling a small simulated genome in shards, and merging the shard outputs, gives the same calls
+# as calling it in one run. Needs a built octopus and samtools.
+
+import os
+import sys
+import random
+import shutil
+import tempfile
+import argparse
+from subprocess import check_call, check_output
+
+contig_sizes = {"1": 40000, "2": 25000}
+read_length, fragment_depth = 100, 30
+
+def simulate_reference(rng):
+    return {contig: "".join(rng.choice("ACGT") for _ in range(size)) for contig, size in contig_sizes.items()}
+
+def simulate_haplotypes(reference, rng):
+    # Heterozygous SNVs and small deletions every few hundred bases, so shard cuts fall near calls. Haplotypes
+    # are kept as one string per reference position, with deleted positions empty.
+    result = {}
+    for contig, sequence in reference.items():
+        haplotype = list(sequence)
+        pos = rng.randint(100, 300)
+        while pos < len(sequence) - 100:
+            if rng.random() < 0.8:
+                haplotype[pos] = rng.choice([base for base in "ACGT" if base != sequence[pos]])
+            else:
+                for i in range(pos + 1, pos + rng.randint(2, 6)):
+                    haplotype[i] = ""
+            pos += rng.randint(150, 500)
+        result[contig] = [list(sequence), haplotype]
+    return result
+
+def write_reference(reference, path):
+    with open(path, "w") as fasta:
+        for contig, sequence in reference.items():
+            fasta.write(">" + contig + "\n")
+            for i in range(0, len(sequence), 60):
+                fasta.write(sequence[i:i + 60] + "\n")
+
+def write_reads(reference, haplotypes, path, rng):
+    with open(path, "w") as sam:
+        sam.write("@HD\tVN:1.6\tSO:unsorted\n")
+        for contig, sequence in reference.items():
+            sam.write("@SQ\tSN:" + contig + "\tLN:" + str(len(sequence)) + "\n")
+        sam.write("@RG\tID:simulated\tSM:SIMULATED\n")
+        read_id = 0
+        for contig, sequence in reference.items():
+            num_reads = fragment_depth * len(sequence) // read_length
+            for _ in range(num_reads):
+                haplotype = rng.choice(haplotypes[contig])
+                begin = rng.randint(0, len(sequence) - read_length - 10)
+                bases, cigar, ref_pos = "", [], begin
+                while len(bases) < read_length and ref_pos < len(sequence):
+                    base = haplotype[ref_pos]
+                    op = "M" if base else "D"
+                    if op == "M": bases += base
+                    if cigar and cigar[-1][0] == op:
+                        cigar[-1][1] += 1
+                    else:
+                        cigar.append([op, 1])
+                    ref_pos += 1
+                if cigar[0][0] == "D" or cigar[-1][0] == "D": continue
+                cigar_str = "".join(str(n) + op for op, n in cigar)
+                read_id += 1
+                sam.write("\t".join(["read" + str(read_id), "0", contig, str(begin + 1), "60", cigar_str, "*", "0", "0",
+                                     bases, "I" * len(bases), "RG:Z:simulated"]) + "\n")
+
+def make_fixture(directory, samtools, seed):
+    rng = random.Random(seed)
+    reference = simulate_reference(rng)
+    haplotypes = simulate_haplotypes(reference, rng)
+    reference_path = os.path.join(directory, "reference.fa")
+    write_reference(reference, reference_path)
+    check_call([samtools, "faidx", reference_path])
+    sam_path, bam_path = os.path.join(directory, "reads.sam"), os.path.join(directory, "reads.bam")
+    write_reads(reference, haplotypes, sam_path, rng)
+    check_call([samtools, "sort", "-o", bam_path, sam_path])
+    check_call([samtools, "index", bam_path])
+    return reference_path, bam_path
+
+def read_records(vcf_path):
+    records = check_output(["gzip", "-cdf", vcf_path])
+    return [line for line in records.decode().splitlines() if not line.startswith("#")]
+
+# Tiny read buffers make many tasks, so shard cuts land inside contigs
+def run_octopus(octopus, reference, reads, output, extra_options):
+    check_call([octopus, "-R", reference, "-I", reads, "-o", output, "--threads", "2",
+                "--target-read-buffer-footprint", "1MB"] + extra_options)
+
+def main(args):
+    directory = tempfile.mkdtemp(prefix="octopus_sharding_")
+    try:
+        reference, reads = make_fixture(directory, args.samtools, args.seed)
+        unsharded = os.path.join(directory, "unsharded.vcf")
+        run_octopus(args.octopus, reference, reads, unsharded, [])
+        shard_outputs = []
+        for i in range(1, args.shards + 1):
+            shard_output = os.path.join(directory, "shard" + str(i) + ".vcf.gz")
+            run_octopus(args.octopus, reference, reads, shard_output, ["--shard", str(i) + "/" + str(args.shards)])
+            shard_outputs.append(shard_output)
+        merged = os.path.join(directory, "merged.vcf")
+        run_octopus(args.octopus, reference, reads, merged, ["--merge-shards"] + shard_outputs)
+        expected, actual = read_records(unsharded), read_records(merged)
+        if expected != actual:
+            mismatches = [(lhs, rhs) for lhs, rhs in zip(expected, actual) if lhs != rhs]
+            print("Merged shard calls differ from unsharded calls: " + str(len(expected)) + " unsharded and "
+                  + str(len(actual)) + " merged records, " + str(len(mismatches)) + " differ")
+            for lhs, rhs in mismatches[:10]:
+                print("unsharded: " + lhs)
+                print("merged:    " + rhs)
+            return 1
+        print("Merged shard calls match unsharded calls (" + str(len(expected)) + " records)")
+        return 0
+    finally:
+        if args.keep:
+            print("Kept test files in " + directory)
+        else:
+            shutil.rmtree(directory)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--octopus', help='octopus binary path', default=os.path.join(os.path.dirname(os.path.dirname(os.path.dirname(os.path.realpath(__file__)))), "bin", "octopus"))
+parser.add_argument('--samtools', help='samtools binary path', default="samtools")
+parser.add_argument('--shards', help='Number of shards', type=int, default=3)
+parser.add_argument('--seed', help='Simulation seed', type=int, default=42)
+parser.add_argument('--keep', help='Keep the simulated data and outputs', action='store_true')
+sys.exit(main(parser.parse_args()))
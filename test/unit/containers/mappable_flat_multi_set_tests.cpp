@@ -0,0 +1,158 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <initializer_list>
+
+#include "basics/contig_region.hpp"
+#include "containers/mappable_flat_multi_set.hpp"
+
+namespace octopus { namespace test {
+
+using octopus::MappableFlatMultiSet;
+
+namespace {
+
+using RegionSet = MappableFlatMultiSet<ContigRegion>;
+
+auto make_regions(std::initializer_list<std::pair<ContigRegion::Position, ContigRegion::Position>> bounds)
+{
+    std::vector<ContigRegion> result {};
+    result.reserve(bounds.size());
+    for (const auto& p : bounds) result.emplace_back(p.first, p.second);
+    return result;
+}
+
+auto find_overlapped(const std::vector<ContigRegion>& regions, const ContigRegion& query)
+{
+    std::vector<ContigRegion> result {};
+    std::copy_if(std::cbegin(regions), std::cend(regions), std::back_inserter(result),
+                 [&query] (const auto& region) { return overlaps(region, query); });
+    std::sort(std::begin(result), std::end(result));
+    return result;
+}
+
+// Checks overlap queries against a linear scan for every query with bounds up to max_position
+void check_overlap_queries(const RegionSet& set, const std::vector<ContigRegion>& regions,
+                           const ContigRegion::Position max_position)
+{
+    BOOST_REQUIRE_EQUAL(set.size(), regions.size());
+    for (ContigRegion::Position begin {0}; begin <= max_position; ++begin) {
+        for (auto end = begin; end <= max_position; ++end) {
+            const ContigRegion query {begin, end};
+            const auto expected = find_overlapped(regions, query);
+            const auto overlapped = set.overlap_range(query);
+            const std::vector<ContigRegion> actual {std::cbegin(overlapped), std::cend(overlapped)};
+            BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(actual), std::cend(actual), std::cbegin(expected), std::cend(expected));
+            BOOST_CHECK_EQUAL(set.count_overlapped(query), expected.size());
+            BOOST_CHECK_EQUAL(set.has_overlapped(query), !expected.empty());
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(containers)
+BOOST_AUTO_TEST_SUITE(mappable_flat_multi_set)
+
+BOOST_AUTO_TEST_CASE(overlap_range_finds_duplicates)
+{
+    const auto regions = make_regions({{0, 3}, {2, 4}, {2, 4}, {2, 4}, {3, 3}, {3, 3}, {3, 9}, {5, 6}, {5, 6}});
+    const RegionSet set {std::cbegin(regions), std::cend(regions)};
+    check_overlap_queries(set, regions, 10);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_range_finds_long_elements_far_before_the_query)
+{
+    // The long first element overlaps queries after many short elements that do not
+    const auto regions = make_regions({{0, 100}, {1, 2}, {3, 4}, {5, 6}, {10, 11}, {20, 21},
+                                             {30, 31}, {40, 41}, {50, 51}, {60, 90}, {70, 71}, {95, 96}});
+    const RegionSet set {std::cbegin(regions), std::cend(regions)};
+    check_overlap_queries(set, regions, 105);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_range_is_correct_after_inserting_and_erasing_long_elements)
+{
+    auto regions = make_regions({{0, 1}, {2, 3}, {4, 5}, {6, 7}, {8, 9}, {10, 11}});
+    RegionSet set {std::cbegin(regions), std::cend(regions)};
+    check_overlap_queries(set, regions, 12);
+    // Inserting a long element in the middle raises the max ends after it
+    set.insert(ContigRegion {3, 11});
+    regions.emplace_back(3, 11);
+    check_overlap_queries(set, regions, 12);
+    set.emplace(1, 10);
+    regions.emplace_back(1, 10);
+    check_overlap_queries(set, regions, 12);
+    // Erasing the long elements must lower the max ends again
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {1, 10}), 1);
+    regions.erase(std::find(std::begin(regions), std::end(regions), ContigRegion {1, 10}));
+    check_overlap_queries(set, regions, 12);
+    const auto itr = std::find(std::cbegin(set), std::cend(set), ContigRegion {3, 11});
+    BOOST_REQUIRE(itr != std::cend(set));
+    set.erase(itr);
+    regions.erase(std::find(std::begin(regions), std::end(regions), ContigRegion {3, 11}));
+    check_overlap_queries(set, regions, 12);
+    // Erasing a range that starts before the long elements
+    set.insert(ContigRegion {2, 12});
+    set.insert(ContigRegion {2, 12});
+    regions.emplace_back(2, 12);
+    regions.emplace_back(2, 12);
+    check_overlap_queries(set, regions, 13);
+    set.erase(std::next(std::cbegin(set)), std::next(std::cbegin(set), 4));
+    std::sort(std::begin(regions), std::end(regions));
+    regions.erase(std::next(std::begin(regions)), std::next(std::begin(regions), 4));
+    check_overlap_queries(set, regions, 13);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_range_is_correct_after_erasing_overlapped_elements)
+{
+    auto regions = make_regions({{0, 2}, {0, 20}, {1, 3}, {4, 6}, {5, 15}, {7, 8}, {9, 10}, {12, 14}, {16, 18}});
+    RegionSet set {std::cbegin(regions), std::cend(regions)};
+    const ContigRegion erased {6, 9};
+    set.erase_overlapped(erased);
+    regions.erase(std::remove_if(std::begin(regions), std::end(regions),
+                                 [&erased] (const auto& region) { return overlaps(region, erased); }),
+                  std::end(regions));
+    check_overlap_queries(set, regions, 21);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_range_is_correct_after_random_inserts_and_erases)
+{
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<ContigRegion::Position> position_dist {0, 50};
+    std::geometric_distribution<ContigRegion::Size> size_dist {0.3};
+    std::bernoulli_distribution erase_dist {0.3}, long_dist {0.1};
+    RegionSet set {};
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 200; ++i) {
+        if (!regions.empty() && erase_dist(generator)) {
+            std::uniform_int_distribution<std::size_t> index_dist {0, regions.size() - 1};
+            const auto index = index_dist(generator);
+            BOOST_CHECK_GE(set.erase(regions[index]), 1);
+            const auto erased = regions[index];
+            regions.erase(std::remove(std::begin(regions), std::end(regions), erased), std::end(regions));
+        } else {
+            const auto begin = position_dist(generator);
+            const auto size = long_dist(generator) ? 30 + size_dist(generator) : size_dist(generator);
+            set.emplace(begin, begin + size);
+            regions.emplace_back(begin, begin + size);
+        }
+        if (i % 20 == 0) check_overlap_queries(set, regions, 90);
+    }
+    check_overlap_queries(set, regions, 90);
+    set.clear();
+    regions.clear();
+    check_overlap_queries(set, regions, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
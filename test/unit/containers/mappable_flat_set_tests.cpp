@@ -291,6 +291,32 @@ BOOST_AUTO_TEST_CASE(erase_all_only_erases_given_elements_and_maintains_order)
     BOOST_CHECK(std::is_sorted(std::cbegin(set), std::cend(set)));
 }
 
+BOOST_AUTO_TEST_CASE(overlap_range_works_when_not_bidirectionally_sorted)
+{
+    const ContigRegion r1 {0, 100}, r2 {1, 2}, r3 {3, 5}, r4 {10, 11}, r5 {50, 60}, r6 {101, 102}, r7 {150, 151};
+    
+    MappableFlatSet<ContigRegion> set {r2, r3, r4, r6, r7};
+    
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {4, 12}), 2);
+    
+    set.insert(r1);
+    set.insert(r5);
+    
+    const std::vector<ContigRegion> expected1 {r1, r4, r5};
+    const auto overlapped1 = set.overlap_range(ContigRegion {10, 55});
+    BOOST_CHECK(std::equal(std::cbegin(overlapped1), std::cend(overlapped1), std::cbegin(expected1), std::cend(expected1)));
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {10, 55}), 3);
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {99, 101}), 1);
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {100, 150}), 1);
+    BOOST_CHECK(set.has_overlapped(ContigRegion {140, 145}) == false);
+    
+    set.erase(r1);
+    
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {10, 55}), 2);
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {99, 101}), 0);
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {0, 200}), 6);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <boost/optional.hpp>
+
+#include "core/csr/filters/measure_store.hpp"
+
+namespace octopus { namespace test {
+
+using csr::MeasureStore;
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(measure_store)
+
+BOOST_AUTO_TEST_CASE(measures_are_read_back_as_recorded_across_chunks)
+{
+    MeasureStore store {3, 4};
+    for (std::size_t row {0}; row < 10; ++row) {
+        boost::optional<double> optional_value {};
+        if (row % 2 == 0) optional_value = row / 2.0;
+        store.push_back({static_cast<double>(row), optional_value, row});
+    }
+    store.finalise();
+    BOOST_REQUIRE_EQUAL(store.size(), 10);
+    for (std::size_t row {0}; row < 10; ++row) {
+        BOOST_CHECK_EQUAL(store.value(row, 0), static_cast<double>(row));
+        BOOST_CHECK_EQUAL(store.is_missing(row, 1), row % 2 != 0);
+        const auto count = boost::get<std::size_t>(store.get(row, 2));
+        BOOST_CHECK_EQUAL(count, row);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stores_without_measures_only_count_rows)
+{
+    MeasureStore store {0, 2};
+    for (int row {0}; row < 5; ++row) store.push_back({});
+    BOOST_CHECK_NO_THROW(store.finalise());
+    BOOST_CHECK_EQUAL(store.size(), 5);
+    BOOST_CHECK(store.get(0).empty());
+    BOOST_CHECK_THROW(store.push_back({}), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(empty_stores_can_be_finalised)
+{
+    MeasureStore store {2};
+    BOOST_CHECK_NO_THROW(store.finalise());
+    BOOST_CHECK(store.empty());
+    BOOST_CHECK_THROW(store.value(0, 0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "basics/phred.hpp"
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/mutation/denovo_model.hpp"
+#include "core/models/pairhmm/pair_hmm.hpp"
+#include "utils/thread_pool.hpp"
+#include "tandem/tandem.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+constexpr double snv_mutation_rate {1e-8}, indel_mutation_rate {1e-9};
+
+// A sequence with no tandem repeats at all, so the model aligns against it with flat gap penalties.
+// Uses the square free ternary word given by the number of 1s between consecutive 0s of the
+// Thue-Morse sequence.
+std::string make_repeat_free_sequence(const std::size_t length)
+{
+    const auto thue_morse = [] (unsigned n) { unsigned result {0}; for (; n; n >>= 1) result ^= n & 1; return result; };
+    const std::string bases {"ACG"};
+    std::string result {};
+    unsigned num_ones {0};
+    for (unsigned n {1}; result.size() < length; ++n) {
+        if (thue_morse(n) == 0) {
+            result += bases[num_ones];
+            num_ones = 0;
+        } else {
+            ++num_ones;
+        }
+    }
+    return result;
+}
+
+// The likelihood the model gave before alignments were trimmed to the differing sequence
+double full_length_likelihood(const std::string& target, const std::string& given)
+{
+    const auto mutation_penalty = static_cast<std::int8_t>(probability_to_phred(snv_mutation_rate).score());
+    const auto gap_extend_penalty = static_cast<std::int8_t>(probability_to_phred(std::min(100 * indel_mutation_rate, 0.5)).score());
+    const hmm::FlatGapMutationModel model {mutation_penalty, mutation_penalty, gap_extend_penalty};
+    std::string padded_given(std::max(target.size(), given.size()) + 2 * hmm::min_flank_pad(), 'N');
+    std::copy(std::cbegin(given), std::cend(given), std::next(std::begin(padded_given), hmm::min_flank_pad()));
+    return std::max(hmm::evaluate(target, padded_given, model), std::log(snv_mutation_rate) + std::log(indel_mutation_rate));
+}
+
+struct Fixture
+{
+    Fixture()
+    : reference {mock::make_reference()}
+    , model {{snv_mutation_rate, indel_mutation_rate}, 1, DeNovoModel::CachingStrategy::none}
+    {}
+
+    Haplotype make_haplotype(std::string sequence) const
+    {
+        return Haplotype {GenomicRegion {"1", 0, static_cast<GenomicRegion::Position>(sequence.size())}, std::move(sequence), reference};
+    }
+
+    void check_matches_full_length(const std::string& target, const std::string& given) const
+    {
+        BOOST_REQUIRE(tandem::extract_exact_tandem_repeats(given, 1, 3).empty());
+        const auto expected = full_length_likelihood(target, given);
+        BOOST_CHECK_EQUAL(model.evaluate(make_haplotype(target), make_haplotype(given)), expected);
+    }
+
+    ReferenceGenome reference;
+    DeNovoModel model;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(models)
+BOOST_AUTO_TEST_SUITE(denovo_model)
+
+BOOST_AUTO_TEST_CASE(snv_likelihoods_match_full_length_alignment)
+{
+    const Fixture fixture {};
+    for (const std::size_t length : {50, 200, 500}) {
+        const auto given = make_repeat_free_sequence(length);
+        BOOST_REQUIRE_EQUAL(given.size(), length);
+        for (const auto pos : {std::size_t {0}, std::size_t {10}, length / 3, length / 2, length - 70, length - 1}) {
+            if (pos >= length) continue;
+            auto target = given;
+            target[pos] = 'T';
+            fixture.check_matches_full_length(target, given);
+            fixture.check_matches_full_length(given, target);
+            if (pos + 20 < length) {
+                target[pos + 20] = 'T';
+                fixture.check_matches_full_length(target, given);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(indel_likelihoods_match_full_length_alignment)
+{
+    const Fixture fixture {};
+    for (const std::size_t length : {50, 200, 500}) {
+        const auto given = make_repeat_free_sequence(length);
+        for (const auto pos : {std::size_t {5}, length / 3, length / 2, length - 70, length - 5}) {
+            if (pos + 5 >= length) continue;
+            for (const std::size_t indel_size : {1, 2, 5}) {
+                auto deletion = given;
+                deletion.erase(pos, indel_size);
+                fixture.check_matches_full_length(deletion, given);
+                auto insertion = given;
+                insertion.insert(pos, std::string(indel_size, 'T'));
+                fixture.check_matches_full_length(insertion, given);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_primed_likelihoods_match_unprimed)
+{
+    set_shared_thread_budget(4);
+    Fixture fixture {};
+    const auto given = make_repeat_free_sequence(300);
+    std::vector<Haplotype> haplotypes {fixture.make_haplotype(given)};
+    for (const std::size_t pos : {10, 50, 100, 120, 150, 200, 250, 290}) {
+        auto snv = given;
+        snv[pos] = 'T';
+        haplotypes.push_back(fixture.make_haplotype(snv));
+        auto deletion = given;
+        deletion.erase(pos, 2);
+        haplotypes.push_back(fixture.make_haplotype(deletion));
+    }
+    DeNovoModel primed_model {{snv_mutation_rate, indel_mutation_rate}, haplotypes.size(),
+                              DeNovoModel::CachingStrategy::none, ExecutionPolicy::par};
+    primed_model.prime(haplotypes);
+    for (unsigned target {0}; target < haplotypes.size(); ++target) {
+        for (unsigned given {0}; given < haplotypes.size(); ++given) {
+            if (target != given) {
+                BOOST_CHECK_EQUAL(primed_model.evaluate(target, given), fixture.model.evaluate(haplotypes[target], haplotypes[given]));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
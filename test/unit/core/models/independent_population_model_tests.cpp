@@ -0,0 +1,148 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <random>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_cache.hpp"
+#include "core/models/genotype/genotype_prior_model.hpp"
+#include "core/models/genotype/individual_model.hpp"
+#include "core/models/genotype/independent_population_model.hpp"
+#include "utils/thread_pool.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+using model::IndividualModel;
+using model::IndependentPopulationModel;
+
+// Favours genotypes with fewer distinct haplotypes, so priors differ between genotypes and ploidies
+class ZygosityPriorModel : public GenotypePriorModel
+{
+    virtual double do_evaluate(const Genotype<Haplotype>& genotype) const override
+    {
+        return -1.0 * genotype.zygosity() - 0.5 * genotype.ploidy();
+    }
+    virtual double do_evaluate(const std::vector<unsigned>& genotype) const override { return 0; }
+    virtual bool check_is_primed() const noexcept override { return true; }
+};
+
+auto make_haplotypes(const ReferenceGenome& reference, const unsigned num_haplotypes)
+{
+    const GenomicRegion region {"1", 10, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (unsigned i {0}; i < num_haplotypes; ++i) {
+        auto sequence = reference_sequence;
+        sequence[i % sequence.size()] = 'N';
+        sequence += std::string(i / sequence.size(), 'A');
+        result.emplace_back(region, std::move(sequence), reference);
+    }
+    return result;
+}
+
+auto make_likelihoods(const std::vector<SampleName>& samples, const std::vector<Haplotype>& haplotypes,
+                      const unsigned num_reads)
+{
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<double> likelihood {-20.0, 0.0};
+    HaplotypeLikelihoodCache result {static_cast<unsigned>(haplotypes.size()), samples};
+    for (const auto& sample : samples) {
+        for (const auto& haplotype : haplotypes) {
+            std::vector<double> likelihoods(num_reads);
+            for (auto& l : likelihoods) l = likelihood(generator);
+            result.insert(sample, haplotype, std::move(likelihoods));
+        }
+    }
+    return result;
+}
+
+auto make_samples(const unsigned num_samples)
+{
+    std::vector<SampleName> result {};
+    for (unsigned s {0}; s < num_samples; ++s) result.push_back("sample" + std::to_string(s));
+    return result;
+}
+
+void check_matches_individual_model(const IndependentPopulationModel::InferredLatents& inferences,
+                                    const std::vector<SampleName>& samples,
+                                    const std::vector<std::reference_wrapper<const std::vector<Genotype<Haplotype>>>>& genotypes,
+                                    const HaplotypeLikelihoodCache& likelihoods,
+                                    const GenotypePriorModel& prior_model)
+{
+    const IndividualModel individual_model {prior_model};
+    BOOST_REQUIRE_EQUAL(inferences.posteriors.genotype_probabilities.size(), samples.size());
+    double log_evidence {0};
+    for (std::size_t s {0}; s < samples.size(); ++s) {
+        likelihoods.prime(samples[s]);
+        const auto expected = individual_model.evaluate(genotypes[s], likelihoods);
+        const auto& posteriors = inferences.posteriors.genotype_probabilities[s];
+        const auto& expected_posteriors = expected.posteriors.genotype_probabilities;
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(posteriors), std::cend(posteriors),
+                                      std::cbegin(expected_posteriors), std::cend(expected_posteriors));
+        log_evidence += expected.log_evidence;
+    }
+    likelihoods.unprime();
+    BOOST_CHECK_EQUAL(inferences.log_evidence, log_evidence);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(models)
+BOOST_AUTO_TEST_SUITE(independent_population_model)
+
+BOOST_AUTO_TEST_CASE(sample_posteriors_match_the_individual_model)
+{
+    set_shared_thread_budget(4);
+    const auto reference = mock::make_reference();
+    const ZygosityPriorModel prior_model {};
+    // Enough sample genotypes that the parallel policy actually splits the samples
+    const auto haplotypes = make_haplotypes(reference, 12);
+    const auto samples = make_samples(40);
+    const auto genotypes = generate_all_genotypes(haplotypes, 3);
+    const auto likelihoods = make_likelihoods(samples, haplotypes, 5);
+    const std::vector<std::reference_wrapper<const std::vector<Genotype<Haplotype>>>> sample_genotypes(samples.size(), std::cref(genotypes));
+    for (const auto policy : {ExecutionPolicy::seq, ExecutionPolicy::par}) {
+        const IndependentPopulationModel model {prior_model, policy};
+        check_matches_individual_model(model.evaluate(samples, genotypes, likelihoods),
+                                       samples, sample_genotypes, likelihoods, prior_model);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(samples_with_different_ploidies_share_priors_by_genotype_set)
+{
+    set_shared_thread_budget(4);
+    const auto reference = mock::make_reference();
+    const ZygosityPriorModel prior_model {};
+    const auto haplotypes = make_haplotypes(reference, 12);
+    const auto samples = make_samples(40);
+    const auto diploid_genotypes = generate_all_genotypes(haplotypes, 2);
+    const auto triploid_genotypes = generate_all_genotypes(haplotypes, 3);
+    const auto likelihoods = make_likelihoods(samples, haplotypes, 5);
+    std::vector<std::reference_wrapper<const std::vector<Genotype<Haplotype>>>> sample_genotypes {};
+    for (std::size_t s {0}; s < samples.size(); ++s) {
+        sample_genotypes.push_back(s % 3 == 0 ? std::cref(diploid_genotypes) : std::cref(triploid_genotypes));
+    }
+    for (const auto policy : {ExecutionPolicy::seq, ExecutionPolicy::par}) {
+        const IndependentPopulationModel model {prior_model, policy};
+        check_matches_individual_model(model.evaluate(samples, sample_genotypes, likelihoods),
+                                       samples, sample_genotypes, likelihoods, prior_model);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
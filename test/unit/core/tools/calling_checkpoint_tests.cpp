@@ -0,0 +1,103 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "core/tools/calling_checkpoint.hpp"
+
+namespace octopus { namespace test {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void touch(const fs::path& file)
+{
+    fs::ofstream {file} << "x";
+}
+
+struct TempDirectory
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path("octopus-checkpoint-test-%%%%-%%%%");
+    ~TempDirectory() { boost::system::error_code ec {}; fs::remove_all(path, ec); }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(calling_checkpoint)
+
+BOOST_AUTO_TEST_CASE(calls_at_the_resume_point_are_not_resumed)
+{
+    const CallingCheckpoint::ResumePoint resume_point {100, 101};
+    BOOST_CHECK(!is_after(resume_point, 50, 51));
+    BOOST_CHECK(!is_after(resume_point, 99, 150));
+    // The last written call itself, and calls ordered before it at the same position
+    BOOST_CHECK(!is_after(resume_point, 100, 101));
+    BOOST_CHECK(!is_after(resume_point, 100, 100));
+    // Calls ordered after it at the same position were not written
+    BOOST_CHECK(is_after(resume_point, 100, 102));
+    BOOST_CHECK(is_after(resume_point, 101, 101));
+    BOOST_CHECK(is_after(resume_point, 101, 102));
+}
+
+BOOST_AUTO_TEST_CASE(resuming_keeps_recorded_segments_and_their_indices)
+{
+    const TempDirectory temp {};
+    const std::vector<SampleName> samples {"NA12878"};
+    const std::vector<CallingCheckpoint::ContigName> contigs {"1", "2"};
+    const CallingCheckpoint::Digest inputs {0x0123456789abcdef};
+    fs::path recorded, unrecorded;
+    {
+        CallingCheckpoint checkpoint {temp.path, samples, contigs, inputs, false};
+        recorded = checkpoint.make_segment_path("1");
+        unrecorded = checkpoint.make_segment_path("1");
+        touch(recorded);
+        touch(fs::path {recorded.string() + ".csi"});
+        checkpoint.record("1", recorded, {100, 101});
+        touch(unrecorded);
+        touch(fs::path {unrecorded.string() + ".csi"});
+    }
+    BOOST_CHECK_THROW((CallingCheckpoint {temp.path, samples, contigs, inputs, false}), std::exception);
+    const CallingCheckpoint checkpoint {temp.path, samples, contigs, inputs, true};
+    BOOST_CHECK(fs::exists(recorded));
+    BOOST_CHECK(fs::exists(recorded.string() + ".csi"));
+    BOOST_CHECK(!fs::exists(unrecorded));
+    BOOST_CHECK(!fs::exists(unrecorded.string() + ".csi"));
+    BOOST_REQUIRE(checkpoint.resume_point("1"));
+    BOOST_CHECK_EQUAL(checkpoint.resume_point("1")->begin, 100);
+    BOOST_CHECK_EQUAL(checkpoint.resume_point("1")->end, 101);
+    BOOST_CHECK(!checkpoint.resume_point("2"));
+    BOOST_REQUIRE_EQUAL(checkpoint.segments("1").size(), 1);
+    BOOST_CHECK_EQUAL(checkpoint.segments("1").front(), recorded);
+}
+
+BOOST_AUTO_TEST_CASE(checkpoints_are_not_resumed_with_different_inputs)
+{
+    const TempDirectory temp {};
+    const std::vector<SampleName> samples {"NA12878"};
+    const std::vector<CallingCheckpoint::ContigName> contigs {"1", "2"};
+    const CallingCheckpoint::Digest inputs {42};
+    {
+        CallingCheckpoint checkpoint {temp.path, samples, contigs, inputs, false};
+        const auto segment = checkpoint.make_segment_path("1");
+        touch(segment);
+        checkpoint.record("1", segment, {100, 101});
+    }
+    BOOST_CHECK_THROW((CallingCheckpoint {temp.path, samples, contigs, inputs + 1, true}), std::exception);
+    BOOST_CHECK_THROW((CallingCheckpoint {temp.path, {"NA24385"}, contigs, inputs, true}), std::exception);
+    const CallingCheckpoint checkpoint {temp.path, samples, contigs, inputs, true};
+    BOOST_CHECK(checkpoint.resume_point("1"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
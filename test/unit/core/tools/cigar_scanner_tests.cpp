@@ -3,25 +3,77 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "core/types/variant.hpp"
 #include "core/tools/vargen/variant_generator.hpp"
+#include "core/tools/vargen/cigar_scanner.hpp"
+#include "mock/mock_reference.hpp"
 
 namespace octopus { namespace test {
 
 namespace {
-    auto make_cigar_scanner()
-    {
-        using Builder = VariantGenerator::Builder;
-        return Builder().add_generator(Builder::Generator::Alignment);
-    }
+
+using coretools::CigarScanner;
+
+auto make_cigar_scanner(const ReferenceGenome& reference)
+{
+    CigarScanner::Options options {};
+    options.include = [] (const CigarScanner::ObservedVariant&) { return true; };
+    coretools::VariantGenerator result {};
+    result.add(std::make_unique<CigarScanner>(reference, options));
+    return result;
 }
 
+auto make_read(const GenomicRegion& region, std::string sequence, const std::string& cigar)
+{
+    const AlignedRead::BaseQualityVector qualities(sequence.size(), 40);
+    return AlignedRead {"read", region, std::move(sequence), qualities, parse_cigar(cigar), 60, AlignedRead::Flags {}};
+}
+
+char other_base(const char base) noexcept
+{
+    return base == 'A' ? 'C' : 'A';
+}
+
+} // namespace
+
 BOOST_AUTO_TEST_SUITE(core)
 BOOST_AUTO_TEST_SUITE(cigar_scanner)
 
-
+BOOST_AUTO_TEST_CASE(reads_overhanging_the_contig_end_only_give_candidates_on_the_contig)
+{
+    const auto reference = mock::make_reference();
+    const auto contig_size = reference.contig_size("1");
+    constexpr GenomicRegion::Size num_overhanging_bases {40}, num_contig_bases {20};
+    const GenomicRegion read_region {"1", contig_size - num_contig_bases, contig_size + num_overhanging_bases};
+    auto sequence = reference.fetch_sequence(GenomicRegion {"1", contig_size - num_contig_bases, contig_size});
+    BOOST_REQUIRE_EQUAL(sequence.size(), num_contig_bases);
+    const auto snv_offset = num_contig_bases - 3;
+    const auto ref_base = sequence[snv_offset];
+    sequence[snv_offset] = other_base(ref_base);
+    sequence.append(num_overhanging_bases, 'T');
+    const auto cigar = std::to_string(sequence.size()) + "M";
+    auto scanner = make_cigar_scanner(reference);
+    for (int i {0}; i < 3; ++i) {
+        scanner.add_read("sample", make_read(read_region, sequence, cigar));
+    }
+    const auto variants = scanner.generate(GenomicRegion {"1", contig_size - 100, contig_size});
+    BOOST_REQUIRE_EQUAL(variants.size(), 1);
+    const auto& snv = variants.front();
+    BOOST_CHECK_EQUAL(snv.mapped_region(), (GenomicRegion {"1", contig_size - num_contig_bases + snv_offset,
+                                                          contig_size - num_contig_bases + snv_offset + 1}));
+    BOOST_CHECK_EQUAL(ref_sequence(snv), std::string(1, ref_base));
+    BOOST_CHECK_EQUAL(alt_sequence(snv), std::string(1, other_base(ref_base)));
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
-    
+
 } // namespace test
 } // namespace octopus
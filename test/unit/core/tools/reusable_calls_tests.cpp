@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "core/tools/input_digest.hpp"
+#include "core/tools/reusable_calls.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+constexpr auto blockSize = InputDigest::blockSize;
+constexpr auto margin = ReusableCalls::boundaryMargin;
+
+GenomicRegion make_region(const GenomicRegion::Position begin, const GenomicRegion::Position end)
+{
+    return GenomicRegion {"1", begin, end};
+}
+
+auto make_region_map(const std::vector<GenomicRegion>& regions)
+{
+    InputRegionMap result {};
+    for (const auto& region : regions) result[region.contig_name()].insert(region);
+    return result;
+}
+
+auto get_regions(const InputRegionMap& regions, const GenomicRegion::ContigName& contig)
+{
+    const auto itr = regions.find(contig);
+    if (itr == std::cend(regions)) return std::vector<GenomicRegion> {};
+    return std::vector<GenomicRegion> {std::cbegin(itr->second), std::cend(itr->second)};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(reusable_calls)
+
+BOOST_AUTO_TEST_CASE(reads_changed_only_in_the_next_block_recall_the_end_of_the_unchanged_block)
+{
+    const auto regions = make_region_map({make_region(0, 2 * blockSize)});
+    // The first block's digest is unchanged, but reads changed in the second block
+    const auto unchanged_blocks = make_region_map({make_region(0, blockSize)});
+    const auto split = split_reusable(regions, unchanged_blocks);
+    const std::vector<GenomicRegion> expected_reusable {make_region(0, blockSize - margin)};
+    const std::vector<GenomicRegion> expected_split {make_region(0, blockSize - margin),
+                                                     make_region(blockSize - margin, 2 * blockSize)};
+    const auto reusable = get_regions(split.second, "1");
+    const auto split_regions = get_regions(split.first, "1");
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(reusable), std::cend(reusable),
+                                  std::cbegin(expected_reusable), std::cend(expected_reusable));
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(split_regions), std::cend(split_regions),
+                                  std::cbegin(expected_split), std::cend(expected_split));
+}
+
+BOOST_AUTO_TEST_CASE(reusable_regions_only_shrink_where_they_border_recalled_regions)
+{
+    const auto regions = make_region_map({make_region(0, 5 * blockSize)});
+    const auto unchanged_blocks = make_region_map({make_region(0, blockSize), make_region(2 * blockSize, 3 * blockSize),
+                                                   make_region(3 * blockSize, 4 * blockSize),
+                                                   make_region(4 * blockSize, 5 * blockSize)});
+    const auto split = split_reusable(regions, unchanged_blocks);
+    const std::vector<GenomicRegion> expected_reusable {make_region(0, blockSize - margin),
+                                                        make_region(2 * blockSize + margin, 5 * blockSize)};
+    const std::vector<GenomicRegion> expected_split {make_region(0, blockSize - margin),
+                                                     make_region(blockSize - margin, 2 * blockSize + margin),
+                                                     make_region(2 * blockSize + margin, 5 * blockSize)};
+    const auto reusable = get_regions(split.second, "1");
+    const auto split_regions = get_regions(split.first, "1");
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(reusable), std::cend(reusable),
+                                  std::cbegin(expected_reusable), std::cend(expected_reusable));
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(split_regions), std::cend(split_regions),
+                                  std::cbegin(expected_split), std::cend(expected_split));
+}
+
+BOOST_AUTO_TEST_CASE(reusable_regions_smaller_than_the_margins_are_called_again)
+{
+    const auto search_region = make_region(0, 3 * blockSize);
+    const auto regions = make_region_map({search_region});
+    // A partial block in the middle of the search region, with recalled regions on both sides
+    const auto unchanged_blocks = make_region_map({make_region(blockSize, blockSize + margin)});
+    const auto split = split_reusable(regions, unchanged_blocks);
+    BOOST_CHECK(get_regions(split.second, "1").empty());
+    const auto split_regions = get_regions(split.first, "1");
+    BOOST_REQUIRE_EQUAL(split_regions.size(), 1);
+    BOOST_CHECK_EQUAL(split_regions.front(), search_region);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,201 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "io/variant/vcf.hpp"
+#include "io/variant/bcf_record.hpp"
+
+namespace octopus { namespace test {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Records are written through VcfWriter, which encodes INFO and FORMAT values with strtol/strtof,
+// and read back with BcfRecord, so both sides of the typed encoding are checked.
+class BcfRoundTrip
+{
+public:
+    BcfRoundTrip(std::vector<VcfRecord> records)
+    {
+        {
+            VcfWriter writer {path, make_header()};
+            for (const auto& record : records) writer.write(record);
+        } // indexed on destruction
+        reader = VcfReader {path};
+    }
+    
+    ~BcfRoundTrip()
+    {
+        boost::system::error_code ec {};
+        fs::remove(path, ec);
+        fs::remove(path.string() + ".csi", ec);
+    }
+    
+    std::vector<BcfRecord> read() const
+    {
+        std::vector<BcfRecord> result {};
+        for (auto p = reader.iterate_raw(GenomicRegion {"1", 0, 1'000}); p.first != p.second; ++p.first) {
+            result.push_back(*p.first); // copies keep their own buffer
+        }
+        return result;
+    }
+    
+    fs::path path = fs::temp_directory_path() / fs::unique_path("octopus-bcf-record-test-%%%%-%%%%.bcf");
+    VcfReader reader;
+    
+private:
+    static VcfHeader make_header()
+    {
+        VcfHeader::Builder result {};
+        result.set_file_format("VCFv4.3");
+        result.add_sample("S1").add_sample("S2");
+        result.add_contig("1", {{"length", "1000"}});
+        result.add_filter("q10", "Quality below 10");
+        result.add_info("DP", "1", "Integer", "Read depth");
+        result.add_info("AF", "A", "Float", "Allele frequency");
+        result.add_info("NAME", "1", "String", "A name");
+        result.add_info("FLAG", "0", "Flag", "A flag");
+        result.add_format("GT", "1", "String", "Genotype");
+        result.add_format("GQ", "1", "Integer", "Genotype quality");
+        result.add_format("AD", "R", "Integer", "Allele depths");
+        result.add_format("FR", "1", "Float", "Fraction");
+        return result.build_once();
+    }
+};
+
+VcfRecord::Builder make_site(const GenomicRegion::Position pos)
+{
+    VcfRecord::Builder result {};
+    result.set_chrom("1").set_pos(pos).set_ref("A").set_alt(std::vector<std::string> {"C", "G"});
+    return result;
+}
+
+auto key(const BcfRecord& record, const char* name)
+{
+    const auto result = record.find_key(name);
+    BOOST_REQUIRE(result);
+    return *result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(bcf_record)
+
+BOOST_AUTO_TEST_CASE(site_fields_round_trip)
+{
+    auto passed = make_site(10);
+    passed.set_id("rs1").set_qual(30).set_passed();
+    auto filtered = make_site(20);
+    filtered.set_filter({"q10"});
+    const BcfRoundTrip file {{passed.build_once(), filtered.build_once()}};
+    const auto records = file.read();
+    BOOST_REQUIRE_EQUAL(records.size(), 2);
+    BOOST_CHECK_EQUAL(records[0].chrom(), std::string {"1"});
+    BOOST_CHECK_EQUAL(records[0].pos(), 10);
+    BOOST_CHECK_EQUAL(records[0].mapped_region(), (GenomicRegion {"1", 9, 10}));
+    BOOST_CHECK_EQUAL(records[0].id(), "rs1");
+    BOOST_CHECK_EQUAL(records[0].ref(), "A");
+    BOOST_REQUIRE_EQUAL(records[0].num_alt(), 2);
+    BOOST_CHECK_EQUAL(records[0].alt(0), "C");
+    BOOST_CHECK_EQUAL(records[0].alt(1), "G");
+    BOOST_REQUIRE(records[0].qual());
+    BOOST_CHECK_EQUAL(*records[0].qual(), 30);
+    BOOST_CHECK(!records[0].is_filtered());
+    BOOST_CHECK(!records[1].qual());
+    BOOST_CHECK(records[1].is_filtered());
+    BOOST_CHECK(records[1].has_filter(key(records[1], "q10")));
+}
+
+BOOST_AUTO_TEST_CASE(info_values_round_trip)
+{
+    // Depths are chosen to be encoded as 8, 16 and 32 bit integers
+    std::vector<VcfRecord> written {};
+    GenomicRegion::Position pos {10};
+    for (const std::string depth : {"3", "-120", "300", "70000", "."}) {
+        auto site = make_site(pos++);
+        site.set_info("DP", depth).set_info("AF", {"0.25", "0.1"}).set_info("NAME", std::string {"abc"});
+        if (depth == "3") site.set_info_flag("FLAG");
+        written.push_back(site.build_once());
+    }
+    auto missing = make_site(pos++);
+    missing.set_info("AF", {".", "0.5"});
+    written.push_back(missing.build_once());
+    const BcfRoundTrip file {written};
+    const auto records = file.read();
+    BOOST_REQUIRE_EQUAL(records.size(), written.size());
+    const auto dp = key(records.front(), "DP"), af = key(records.front(), "AF");
+    const auto name = key(records.front(), "NAME"), flag = key(records.front(), "FLAG");
+    const std::vector<boost::optional<std::int32_t>> expected_depths {3, -120, 300, 70'000, boost::none};
+    for (std::size_t i {0}; i < expected_depths.size(); ++i) {
+        BOOST_CHECK(records[i].info_int(dp) == expected_depths[i]);
+        BOOST_CHECK_EQUAL(records[i].info_cardinality(af), 2);
+        BOOST_CHECK(records[i].info_float(af, 0) == boost::optional<float> {0.25f});
+        // The value read back is exactly the one strtof encoded
+        BOOST_CHECK(records[i].info_float(af, 1) == boost::optional<float> {std::strtof("0.1", nullptr)});
+        BOOST_CHECK(!records[i].info_float(af, 2));
+        BOOST_CHECK(!records[i].info_int(af)); // wrong type
+        BOOST_CHECK_EQUAL(records[i].info_string(name), "abc");
+        BOOST_CHECK_EQUAL(records[i].has_info(flag), i == 0);
+    }
+    const auto& last = records.back();
+    BOOST_CHECK(!last.has_info(dp));
+    BOOST_CHECK(!last.info_int(dp));
+    BOOST_CHECK(!last.info_float(af, 0));
+    BOOST_CHECK(last.info_float(af, 1) == boost::optional<float> {0.5f});
+    BOOST_CHECK(last.info_string(name).empty());
+}
+
+BOOST_AUTO_TEST_CASE(format_values_round_trip)
+{
+    using Phasing = VcfRecord::Builder::Phasing;
+    auto site = make_site(10);
+    site.set_format({"GT", "GQ", "AD", "FR"});
+    site.set_genotype("S1", std::vector<boost::optional<unsigned>> {0u, 2u}, Phasing::phased);
+    site.set_format("S1", "GQ", std::string {"99"}).set_format("S1", "AD", {"10", "200", "70000"}).set_format("S1", "FR", std::string {"0.125"});
+    site.set_genotype("S2", std::vector<boost::optional<unsigned>> {boost::none, 1u}, Phasing::unphased);
+    site.set_format_missing("S2", "GQ").set_format("S2", "AD", {"1", ".", "3"}).set_format("S2", "FR", std::string {"0.1"});
+    const BcfRoundTrip file {{site.build_once()}};
+    const auto records = file.read();
+    BOOST_REQUIRE_EQUAL(records.size(), 1);
+    const auto& record = records.front();
+    BOOST_REQUIRE_EQUAL(record.num_samples(), 2);
+    const auto gq = key(record, "GQ"), ad = key(record, "AD"), fr = key(record, "FR");
+    BOOST_CHECK(record.has_format(ad));
+    BOOST_CHECK_EQUAL(record.format_cardinality(ad), 3);
+    BOOST_CHECK(record.format_int(gq, 0) == boost::optional<std::int32_t> {99});
+    BOOST_CHECK(!record.format_int(gq, 1));
+    BOOST_CHECK(record.format_int(ad, 0, 0) == boost::optional<std::int32_t> {10});
+    BOOST_CHECK(record.format_int(ad, 0, 1) == boost::optional<std::int32_t> {200});
+    BOOST_CHECK(record.format_int(ad, 0, 2) == boost::optional<std::int32_t> {70'000});
+    BOOST_CHECK(record.format_int(ad, 1, 0) == boost::optional<std::int32_t> {1});
+    BOOST_CHECK(!record.format_int(ad, 1, 1));
+    BOOST_CHECK(record.format_int(ad, 1, 2) == boost::optional<std::int32_t> {3});
+    BOOST_CHECK(!record.format_int(ad, 0, 3));
+    BOOST_CHECK(!record.format_int(ad, 2, 0));
+    BOOST_CHECK(record.format_float(fr, 0) == boost::optional<float> {0.125f});
+    BOOST_CHECK(record.format_float(fr, 1) == boost::optional<float> {std::strtof("0.1", nullptr)});
+    BOOST_CHECK_EQUAL(record.ploidy(0), 2);
+    BOOST_CHECK(record.genotype_allele(0, 0) == boost::optional<unsigned> {0});
+    BOOST_CHECK(record.genotype_allele(0, 1) == boost::optional<unsigned> {2});
+    BOOST_CHECK(record.is_sample_phased(0));
+    BOOST_CHECK(!record.genotype_allele(1, 0));
+    BOOST_CHECK(record.genotype_allele(1, 1) == boost::optional<unsigned> {1});
+    BOOST_CHECK(!record.is_sample_phased(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
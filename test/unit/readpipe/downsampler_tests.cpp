@@ -1,4 +1,121 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <random>
+
+#include "readpipe/downsampling/streaming_downsampler.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+auto make_template_names(const unsigned n)
+{
+    std::vector<std::string> result(n);
+    for (unsigned i {0}; i < n; ++i) result[i] = "HWI-ST700:8:1101:" + std::to_string(i);
+    return result;
+}
+
+using octopus::readpipe::StreamingDownsampler;
+using octopus::readpipe::template_rank;
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(readpipe)
+BOOST_AUTO_TEST_SUITE(streaming_downsampler)
+
+BOOST_AUTO_TEST_CASE(template_rank_is_a_deterministic_fraction)
+{
+    const auto names = make_template_names(10'000);
+    double total {0};
+    for (const auto& name : names) {
+        const auto rank = template_rank(name.c_str());
+        BOOST_REQUIRE(rank >= 0 && rank < 1);
+        BOOST_REQUIRE_EQUAL(rank, template_rank(std::string {name}.c_str()));
+        total += rank;
+    }
+    BOOST_CHECK_CLOSE(total / names.size(), 0.5, 5);
+    BOOST_CHECK_NE(template_rank("read1"), template_rank("read2"));
+}
+
+BOOST_AUTO_TEST_CASE(reads_are_kept_at_or_below_max_coverage)
+{
+    const auto names = make_template_names(1'000);
+    StreamingDownsampler stacked {100};
+    for (unsigned i {0}; i < 100; ++i) {
+        BOOST_CHECK(stacked.keep(0, 100, names[i].c_str()));
+    }
+    // Reads that no longer overlap do not count towards the coverage
+    StreamingDownsampler tiled {100};
+    for (unsigned i {0}; i < names.size(); ++i) {
+        BOOST_CHECK(tiled.keep(i, i + 100, names[i].c_str()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(coverage_far_above_max_coverage_is_reduced)
+{
+    const auto names = make_template_names(10'000);
+    StreamingDownsampler downsampler {100};
+    unsigned num_kept {0};
+    for (const auto& name : names) {
+        if (downsampler.keep(0, 100, name.c_str())) ++num_kept;
+    }
+    BOOST_CHECK_GE(num_kept, 100);
+    BOOST_CHECK_LT(num_kept, 1'000);
+    // Coverage recovers once the pileup has been passed
+    BOOST_CHECK(downsampler.keep(100, 200, names.front().c_str()));
+}
+
+BOOST_AUTO_TEST_CASE(mates_are_kept_or_removed_together)
+{
+    // Ten reads begin at each position, giving a coverage of 1000 over most of each pileup
+    const auto names = make_template_names(10'000);
+    auto mate_order = names;
+    std::shuffle(std::begin(mate_order), std::end(mate_order), std::mt19937 {42});
+    StreamingDownsampler downsampler {100};
+    std::vector<std::string> kept_first, kept_second;
+    for (unsigned i {0}; i < names.size(); ++i) {
+        const StreamingDownsampler::Position begin = i / 10;
+        if (downsampler.keep(begin, begin + 100, names[i].c_str())) kept_first.push_back(names[i]);
+    }
+    for (unsigned i {0}; i < mate_order.size(); ++i) {
+        const StreamingDownsampler::Position begin = 5'000 + i / 10;
+        if (downsampler.keep(begin, begin + 100, mate_order[i].c_str())) kept_second.push_back(mate_order[i]);
+    }
+    BOOST_CHECK_LT(kept_first.size(), 2'000);
+    std::sort(std::begin(kept_first), std::end(kept_first));
+    std::sort(std::begin(kept_second), std::end(kept_second));
+    std::vector<std::string> kept_both {};
+    std::set_intersection(std::cbegin(kept_first), std::cend(kept_first),
+                          std::cbegin(kept_second), std::cend(kept_second),
+                          std::back_inserter(kept_both));
+    // Mates are only treated differently if one lies where the pileup is still building up
+    BOOST_CHECK_GE(kept_both.size(), 0.75 * std::min(kept_first.size(), kept_second.size()));
+}
+
+BOOST_AUTO_TEST_CASE(mates_in_the_same_order_get_the_same_decision)
+{
+    const auto names = make_template_names(5'000);
+    StreamingDownsampler downsampler {100};
+    std::vector<bool> first_decisions {};
+    for (std::size_t i {0}; i < names.size(); ++i) {
+        const StreamingDownsampler::Position begin = i / 10;
+        first_decisions.push_back(downsampler.keep(begin, begin + 100, names[i].c_str()));
+    }
+    for (std::size_t i {0}; i < names.size(); ++i) {
+        const StreamingDownsampler::Position begin = 1'000 + i / 10;
+        BOOST_REQUIRE_EQUAL(downsampler.keep(begin, begin + 100, names[i].c_str()), first_decisions[i]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,172 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "utils/allele_membership.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+using GenotypeProbabilityVector = std::vector<std::pair<Genotype<Haplotype>, double>>;
+
+char other_base(const char base)
+{
+    return base == 'A' ? 'C' : 'A';
+}
+
+// Haplotypes over four SNV sites, and the alleles to look up: the alt allele at each site, a
+// reference allele, an MNV over two sites, and an allele in none of the haplotypes
+struct Fixture
+{
+    Fixture(const unsigned num_haplotypes)
+    {
+        const auto ref_sequence = reference.fetch_sequence(region);
+        std::vector<Allele> snvs {};
+        for (GenomicRegion::Position site {0}; site < 4; ++site) {
+            const GenomicRegion snv_region {"1", region.begin() + site, region.begin() + site + 1};
+            snvs.emplace_back(snv_region, std::string(1, other_base(ref_sequence[site])));
+        }
+        for (unsigned h {0}; h < num_haplotypes; ++h) {
+            Haplotype::Builder builder {region, reference};
+            for (unsigned site {0}; site < 4; ++site) {
+                if ((h >> site) & 1) builder.push_back(snvs[site]);
+            }
+            haplotypes.push_back(builder.build());
+        }
+        alleles = snvs;
+        alleles.emplace_back(GenomicRegion {"1", region.begin(), region.begin() + 1}, ref_sequence.substr(0, 1));
+        alleles.emplace_back(GenomicRegion {"1", region.begin(), region.begin() + 2},
+                             std::string {other_base(ref_sequence[0]), other_base(ref_sequence[1])});
+        const std::string bases {"ACGT"};
+        const auto absent_base = *std::find_if(std::cbegin(bases), std::cend(bases), [&] (const char base) {
+            return base != ref_sequence[3] && base != other_base(ref_sequence[3]);
+        });
+        alleles.emplace_back(GenomicRegion {"1", region.begin() + 3, region.begin() + 4}, std::string(1, absent_base));
+    }
+
+    GenotypeProbabilityVector make_genotypes(const unsigned ploidy) const
+    {
+        std::mt19937 generator {42};
+        std::uniform_real_distribution<double> dist {0, 1};
+        GenotypeProbabilityVector result {};
+        for (auto& genotype : generate_all_genotypes(haplotypes, ploidy)) {
+            result.emplace_back(std::move(genotype), dist(generator));
+        }
+        return result;
+    }
+
+    ReferenceGenome reference = mock::make_reference();
+    GenomicRegion region {"1", 100, 104};
+    std::vector<Haplotype> haplotypes;
+    std::vector<Allele> alleles;
+};
+
+// The marginalisation AlleleMembership replaced
+double naive_sum_excluded(const Allele& allele, const GenotypeProbabilityVector& genotypes)
+{
+    return std::accumulate(std::cbegin(genotypes), std::cend(genotypes), 0.0, [&allele] (const auto curr, const auto& p) {
+        return curr + (contains(p.first, allele) ? 0.0 : p.second);
+    });
+}
+
+unsigned naive_count(const Genotype<Haplotype>& genotype, const Allele& allele)
+{
+    return std::count_if(std::cbegin(genotype), std::cend(genotype),
+                         [&allele] (const Haplotype& haplotype) { return haplotype.contains(allele); });
+}
+
+void check_matches_naive(const std::vector<Allele>& alleles, const GenotypeProbabilityVector& genotypes)
+{
+    const AlleleMembership membership {alleles, std::cbegin(genotypes), std::cend(genotypes)};
+    BOOST_REQUIRE_EQUAL(membership.num_alleles(), alleles.size());
+    BOOST_REQUIRE_EQUAL(membership.num_genotypes(), genotypes.size());
+    const auto probabilities = extract_probabilities(std::cbegin(genotypes), std::cend(genotypes));
+    BOOST_REQUIRE_EQUAL(probabilities.size(), genotypes.size());
+    for (std::size_t a {0}; a < alleles.size(); ++a) {
+        std::size_t num_containing {0};
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            const auto expected = contains(genotypes[g].first, alleles[a]);
+            BOOST_REQUIRE_EQUAL(membership.contains(g, a), expected);
+            BOOST_REQUIRE_EQUAL(membership.count(g, a), naive_count(genotypes[g].first, alleles[a]));
+            if (expected) ++num_containing;
+        }
+        BOOST_REQUIRE_EQUAL(membership.num_genotypes_containing(a), num_containing);
+        BOOST_REQUIRE_CLOSE(membership.sum_excluded(a, probabilities) + 1, naive_sum_excluded(alleles[a], genotypes) + 1, 1e-9);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(allele_membership)
+
+BOOST_AUTO_TEST_CASE(membership_matches_genotype_contains)
+{
+    const Fixture fixture {12};
+    // 78 diploid genotypes and 364 triploid genotypes, so rows span more than one block
+    for (const unsigned ploidy : {1u, 2u, 3u}) {
+        check_matches_naive(fixture.alleles, fixture.make_genotypes(ploidy));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(haplotypes_are_tested_once_per_distinct_haplotype)
+{
+    const Fixture fixture {12};
+    const auto genotypes = fixture.make_genotypes(2);
+    const AlleleMembership membership {fixture.alleles, std::cbegin(genotypes), std::cend(genotypes)};
+    BOOST_CHECK_EQUAL(membership.num_haplotypes(), fixture.haplotypes.size());
+    // Genotypes that do not share haplotype copies give the same answers
+    GenotypeProbabilityVector copies {};
+    for (const auto& p : genotypes) {
+        Genotype<Haplotype> copy {p.first.ploidy()};
+        for (const auto& haplotype : p.first) copy.emplace(haplotype);
+        copies.emplace_back(std::move(copy), p.second);
+    }
+    check_matches_naive(fixture.alleles, copies);
+}
+
+BOOST_AUTO_TEST_CASE(allele_in_no_genotype_excludes_all_probability)
+{
+    const Fixture fixture {12};
+    const auto genotypes = fixture.make_genotypes(2);
+    const AlleleMembership membership {fixture.alleles, std::cbegin(genotypes), std::cend(genotypes)};
+    const auto probabilities = extract_probabilities(std::cbegin(genotypes), std::cend(genotypes));
+    const auto absent = fixture.alleles.size() - 1;
+    BOOST_CHECK_EQUAL(membership.num_genotypes_containing(absent), 0);
+    BOOST_CHECK_CLOSE(membership.sum_excluded(absent, probabilities),
+                      std::accumulate(std::cbegin(probabilities), std::cend(probabilities), 0.0), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(empty_genotypes_have_no_membership)
+{
+    const Fixture fixture {4};
+    const GenotypeProbabilityVector genotypes {};
+    const AlleleMembership membership {fixture.alleles, std::cbegin(genotypes), std::cend(genotypes)};
+    BOOST_CHECK_EQUAL(membership.num_genotypes(), 0);
+    BOOST_CHECK_EQUAL(membership.num_haplotypes(), 0);
+    for (std::size_t a {0}; a < fixture.alleles.size(); ++a) {
+        BOOST_CHECK_EQUAL(membership.num_genotypes_containing(a), 0);
+        BOOST_CHECK_EQUAL(membership.sum_excluded(a, {}), 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
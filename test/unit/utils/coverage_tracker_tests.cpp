@@ -0,0 +1,159 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <stdexcept>
+
+#include "basics/contig_region.hpp"
+#include "utils/coverage_tracker.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+// Per-position coverage, for checking CoverageTracker against
+class NaiveCoverage
+{
+public:
+    NaiveCoverage(ContigRegion::Position size) : depths_(size, 0) {}
+
+    void add(const ContigRegion& region)
+    {
+        for (auto p = region.begin(); p < region.end(); ++p) ++depths_[p];
+    }
+
+    // Only positions within the encompassing region of added regions are considered
+    std::vector<unsigned> coverage(const ContigRegion& region, const ContigRegion& encompassing) const
+    {
+        std::vector<unsigned> result {};
+        for (auto p = region.begin(); p < region.end(); ++p) {
+            if (p >= encompassing.begin() && p < encompassing.end()) result.push_back(depths_[p]);
+        }
+        return result;
+    }
+
+    std::vector<unsigned> all(const ContigRegion& region) const
+    {
+        return {std::next(std::cbegin(depths_), region.begin()), std::next(std::cbegin(depths_), region.end())};
+    }
+
+private:
+    std::vector<unsigned> depths_;
+};
+
+void check_matches(const CoverageTracker<ContigRegion>& tracker, const NaiveCoverage& naive, const ContigRegion& region)
+{
+    const auto encompassing = *tracker.encompassing_region();
+    const auto expected = naive.coverage(region, encompassing);
+    BOOST_REQUIRE(tracker.coverage(region) == naive.all(region));
+    if (expected.empty()) {
+        BOOST_CHECK_EQUAL(tracker.total_coverage(region), 0);
+        BOOST_CHECK_EQUAL(tracker.max_coverage(region), 0);
+        BOOST_CHECK_EQUAL(tracker.min_coverage(region), 0);
+        BOOST_CHECK_EQUAL(tracker.mean_coverage(region), 0);
+        return;
+    }
+    const auto total = std::accumulate(std::cbegin(expected), std::cend(expected), std::size_t {0});
+    BOOST_REQUIRE_EQUAL(tracker.total_coverage(region), total);
+    BOOST_REQUIRE_EQUAL(tracker.max_coverage(region), *std::max_element(std::cbegin(expected), std::cend(expected)));
+    BOOST_REQUIRE_EQUAL(tracker.min_coverage(region), *std::min_element(std::cbegin(expected), std::cend(expected)));
+    const auto mean = static_cast<double>(total) / expected.size();
+    BOOST_REQUIRE_CLOSE(tracker.mean_coverage(region) + 1, mean + 1, 1e-9);
+    double sum_sq_diff {0};
+    for (const auto depth : expected) sum_sq_diff += (depth - mean) * (depth - mean);
+    BOOST_REQUIRE_CLOSE(tracker.stdev_coverage(region) + 1, std::sqrt(sum_sq_diff / expected.size()) + 1, 1e-6);
+    auto sorted = naive.all(region);
+    std::nth_element(std::begin(sorted), std::next(std::begin(sorted), sorted.size() / 2), std::end(sorted));
+    BOOST_REQUIRE_EQUAL(tracker.median_coverage(region), sorted[sorted.size() / 2]);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(coverage_tracker)
+
+BOOST_AUTO_TEST_CASE(empty_tracker_has_no_coverage)
+{
+    CoverageTracker<ContigRegion> tracker {};
+    BOOST_CHECK(tracker.is_empty());
+    BOOST_CHECK(!tracker.encompassing_region());
+    BOOST_CHECK_EQUAL(tracker.total_coverage(), 0);
+    BOOST_CHECK_EQUAL(tracker.max_coverage(ContigRegion {0, 100}), 0);
+    BOOST_CHECK(tracker.coverage(ContigRegion {0, 3}) == std::vector<unsigned>(3, 0));
+}
+
+BOOST_AUTO_TEST_CASE(queries_require_added_regions_to_be_flushed)
+{
+    CoverageTracker<ContigRegion> tracker {};
+    tracker.add(ContigRegion {10, 20});
+    BOOST_CHECK(!tracker.is_flushed());
+    BOOST_CHECK_THROW(tracker.max_coverage(), std::runtime_error);
+    tracker.flush();
+    BOOST_CHECK(tracker.is_flushed());
+    BOOST_CHECK_EQUAL(tracker.max_coverage(), 1);
+    BOOST_CHECK_EQUAL(tracker.total_coverage(), 10);
+    BOOST_CHECK_EQUAL(tracker.num_tracked(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(range_statistics_match_per_position_coverage)
+{
+    constexpr ContigRegion::Position contig_size {20'000};
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {5'000, 15'000}, size_dist {1, 600};
+    CoverageTracker<ContigRegion> tracker {};
+    NaiveCoverage naive {contig_size};
+    for (int batch {0}; batch < 5; ++batch) {
+        // Later batches extend the tracked range either side, which moves the block origin
+        const auto spread = static_cast<ContigRegion::Position>(batch * 1'000);
+        std::uniform_int_distribution<ContigRegion::Position> batch_begin_dist {begin_dist.a() - spread, begin_dist.b() + spread};
+        for (int i {0}; i < 500; ++i) {
+            const auto begin = batch_begin_dist(generator);
+            const ContigRegion region {begin, std::min(begin + size_dist(generator), contig_size)};
+            tracker.add(region);
+            naive.add(region);
+        }
+        tracker.flush();
+        check_matches(tracker, naive, ContigRegion {0, contig_size});
+        check_matches(tracker, naive, *tracker.encompassing_region());
+        std::uniform_int_distribution<ContigRegion::Position> query_dist {0, contig_size};
+        for (int q {0}; q < 200; ++q) {
+            auto first = query_dist(generator), last = query_dist(generator);
+            if (last < first) std::swap(first, last);
+            if (first == last) ++last;
+            check_matches(tracker, naive, ContigRegion {first, last});
+        }
+        for (ContigRegion::Position begin {4'990}; begin < 5'300; begin += 7) {
+            check_matches(tracker, naive, ContigRegion {begin, begin + 1});
+            check_matches(tracker, naive, ContigRegion {begin, begin + 256});
+            check_matches(tracker, naive, ContigRegion {begin, begin + 513});
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(clear_resets_coverage)
+{
+    CoverageTracker<ContigRegion> tracker {};
+    tracker.add(ContigRegion {10, 20});
+    tracker.flush();
+    tracker.clear();
+    BOOST_CHECK(tracker.is_empty());
+    tracker.add(ContigRegion {1'000, 1'010});
+    tracker.add(ContigRegion {1'005, 1'010});
+    tracker.flush();
+    BOOST_CHECK_EQUAL(tracker.total_coverage(), 15);
+    BOOST_CHECK_EQUAL(tracker.max_coverage(ContigRegion {0, 2'000}), 2);
+    BOOST_CHECK_EQUAL(tracker.min_coverage(ContigRegion {1'000, 1'010}), 1);
+    BOOST_CHECK_EQUAL(tracker.total_coverage(ContigRegion {10, 20}), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,108 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include "utils/genome_shard.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+// Proposes tasks of a fixed size, like a genome with uniform read depth
+auto make_fixed_size_task_proposer(const GenomicRegion::Size task_size)
+{
+    return [task_size] (const GenomicRegion& remaining_region) {
+        if (size(remaining_region) <= task_size) return remaining_region;
+        return expand_rhs(head_region(remaining_region), task_size);
+    };
+}
+
+auto make_test_regions()
+{
+    InputRegionMap result {};
+    result["1"].emplace("1", 0, 100);
+    result["1"].emplace("1", 200, 250);
+    result["2"].emplace("2", 0, 150);
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(genome_shard)
+
+BOOST_AUTO_TEST_CASE(parse_shard_reads_one_based_shards)
+{
+    const auto shard = parse_shard("2/3");
+    BOOST_REQUIRE(shard);
+    BOOST_CHECK_EQUAL(shard->index(), 1);
+    BOOST_CHECK_EQUAL(shard->count(), 3);
+    BOOST_CHECK(!parse_shard("0/3"));
+    BOOST_CHECK(!parse_shard("4/3"));
+    BOOST_CHECK(!parse_shard("1/0"));
+    BOOST_CHECK(!parse_shard("1"));
+    BOOST_CHECK(!parse_shard("a/3"));
+}
+
+BOOST_AUTO_TEST_CASE(shards_partition_regions_in_contig_order)
+{
+    const auto regions = make_test_regions();
+    const std::vector<ContigName> contigs {"2", "1"};
+    const auto first = select_shard(regions, contigs, GenomeShard {0, 3});
+    BOOST_REQUIRE_EQUAL(first.size(), 1);
+    BOOST_REQUIRE_EQUAL(first.at("2").size(), 1);
+    BOOST_CHECK_EQUAL(first.at("2").front(), GenomicRegion("2", 0, 100));
+    const auto second = select_shard(regions, contigs, GenomeShard {1, 3});
+    BOOST_REQUIRE_EQUAL(second.size(), 2);
+    BOOST_CHECK_EQUAL(second.at("2").front(), GenomicRegion("2", 100, 150));
+    BOOST_CHECK_EQUAL(second.at("1").front(), GenomicRegion("1", 0, 50));
+    const auto third = select_shard(regions, contigs, GenomeShard {2, 3});
+    BOOST_REQUIRE_EQUAL(third.size(), 1);
+    BOOST_REQUIRE_EQUAL(third.at("1").size(), 2);
+    BOOST_CHECK_EQUAL(third.at("1").front(), GenomicRegion("1", 50, 100));
+    BOOST_CHECK_EQUAL(third.at("1").back(), GenomicRegion("1", 200, 250));
+}
+
+BOOST_AUTO_TEST_CASE(shards_are_cut_at_the_end_of_the_task_containing_each_cut)
+{
+    const auto regions = make_test_regions();
+    const std::vector<ContigName> contigs {"2", "1"};
+    const auto propose_task = make_fixed_size_task_proposer(40);
+    // The equal cuts are at 2:100 and 1:50, which are inside the tasks 2:80-120 and 1:40-80
+    const auto first = select_shard(regions, contigs, GenomeShard {0, 3}, propose_task);
+    BOOST_REQUIRE_EQUAL(first.size(), 1);
+    BOOST_REQUIRE_EQUAL(first.at("2").size(), 1);
+    BOOST_CHECK_EQUAL(first.at("2").front(), GenomicRegion("2", 0, 120));
+    const auto second = select_shard(regions, contigs, GenomeShard {1, 3}, propose_task);
+    BOOST_REQUIRE_EQUAL(second.size(), 2);
+    BOOST_CHECK_EQUAL(second.at("2").front(), GenomicRegion("2", 120, 150));
+    BOOST_CHECK_EQUAL(second.at("1").front(), GenomicRegion("1", 0, 80));
+    const auto third = select_shard(regions, contigs, GenomeShard {2, 3}, propose_task);
+    BOOST_REQUIRE_EQUAL(third.size(), 1);
+    BOOST_REQUIRE_EQUAL(third.at("1").size(), 2);
+    BOOST_CHECK_EQUAL(third.at("1").front(), GenomicRegion("1", 80, 100));
+    BOOST_CHECK_EQUAL(third.at("1").back(), GenomicRegion("1", 200, 250));
+}
+
+BOOST_AUTO_TEST_CASE(shards_inside_a_single_task_are_empty)
+{
+    const auto regions = make_test_regions();
+    const std::vector<ContigName> contigs {"2", "1"};
+    const auto propose_task = make_fixed_size_task_proposer(150);
+    // The cuts at 2:50 and 2:100 both move to the end of contig 2, and cuts between regions do not move
+    const auto first = select_shard(regions, contigs, GenomeShard {0, 6}, propose_task);
+    BOOST_REQUIRE_EQUAL(first.size(), 1);
+    BOOST_CHECK_EQUAL(first.at("2").front(), GenomicRegion("2", 0, 150));
+    BOOST_CHECK(select_shard(regions, contigs, GenomeShard {1, 6}, propose_task).empty());
+    BOOST_CHECK(select_shard(regions, contigs, GenomeShard {2, 6}, propose_task).empty());
+    const auto fourth = select_shard(regions, contigs, GenomeShard {3, 6}, propose_task);
+    BOOST_REQUIRE_EQUAL(fourth.size(), 1);
+    BOOST_CHECK_EQUAL(fourth.at("1").front(), GenomicRegion("1", 0, 100));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
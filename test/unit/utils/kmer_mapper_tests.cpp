@@ -0,0 +1,58 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <iterator>
+
+#include "utils/kmer_mapper.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(kmer_mapper)
+
+BOOST_AUTO_TEST_CASE(compute_kmer_hashes_matches_perfect_kmer_hash)
+{
+    const std::string sequence {"ACGTTGCANNACGTACGGGTCAAT"};
+    const auto hashes = compute_kmer_hashes<6>(sequence);
+    BOOST_REQUIRE_EQUAL(hashes.size(), sequence.size() - 5);
+    for (std::size_t i {0}; i < hashes.size(); ++i) {
+        BOOST_CHECK_EQUAL(hashes[i], perfect_kmer_hash<6>(std::next(std::cbegin(sequence), i)));
+    }
+    BOOST_CHECK(compute_kmer_hashes<6>("ACGTA").empty());
+}
+
+BOOST_AUTO_TEST_CASE(kmer_hash_table_stores_positions_in_order)
+{
+    const std::string sequence {"ACGTACGTACGT"};
+    const auto table = make_kmer_hash_table<4>(sequence);
+    BOOST_CHECK_EQUAL(table.size(), sequence.size() - 3);
+    const auto hash = perfect_kmer_hash<4>(std::cbegin(sequence));
+    const std::vector<KmerHashTable::Position> positions {std::next(std::cbegin(table.positions), table.offsets[hash]),
+                                                          std::next(std::cbegin(table.positions), table.offsets[hash + 1])};
+    BOOST_CHECK((positions == std::vector<KmerHashTable::Position> {0, 4, 8}));
+}
+
+BOOST_AUTO_TEST_CASE(map_query_to_target_finds_best_offsets)
+{
+    const std::string target {"TTTTTTACGTAGCTAGCTAGGGCATTTTTT"};
+    const std::string query {"ACGTAGCTAGCTAGGGCA"};
+    auto table = make_kmer_hash_table<6>(target);
+    auto mapping = map_query_to_target(compute_kmer_hashes<6>(query), table);
+    BOOST_REQUIRE_EQUAL(mapping.size(), 1);
+    BOOST_CHECK_EQUAL(mapping.front(), 6);
+    // Repopulating a table must not leave stale positions
+    populate_kmer_hash_table<6>(query, table);
+    mapping = map_query_to_target(compute_kmer_hashes<6>(query), table);
+    BOOST_REQUIRE_EQUAL(mapping.size(), 1);
+    BOOST_CHECK_EQUAL(mapping.front(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
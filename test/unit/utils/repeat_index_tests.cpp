@@ -0,0 +1,189 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "exceptions/error.hpp"
+#include "utils/repeat_index.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+struct TempIndex
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path("octopus-repeat-index-test-%%%%-%%%%.bin");
+    ~TempIndex() { boost::system::error_code ec {}; fs::remove(path, ec); }
+};
+
+bool is_less(const tandem::Repeat& lhs, const tandem::Repeat& rhs) noexcept
+{
+    if (lhs.pos != rhs.pos) return lhs.pos < rhs.pos;
+    if (lhs.period != rhs.period) return lhs.period < rhs.period;
+    return lhs.length < rhs.length;
+}
+
+struct RepeatTuple
+{
+    std::uint32_t pos, length, period;
+    bool operator==(const RepeatTuple& other) const noexcept
+    {
+        return pos == other.pos && length == other.length && period == other.period;
+    }
+    bool operator!=(const RepeatTuple& other) const noexcept { return !(*this == other); }
+};
+
+std::ostream& operator<<(std::ostream& os, const RepeatTuple& repeat)
+{
+    os << repeat.pos << ':' << repeat.length << ':' << repeat.period;
+    return os;
+}
+
+auto to_tuples(std::vector<tandem::Repeat> repeats)
+{
+    std::sort(std::begin(repeats), std::end(repeats), is_less);
+    std::vector<RepeatTuple> result {};
+    result.reserve(repeats.size());
+    for (const auto& repeat : repeats) result.push_back({repeat.pos, repeat.length, repeat.period});
+    return result;
+}
+
+// The repeats found by searching the whole contig, in reference coordinates
+auto find_reference_repeats(const ReferenceGenome& reference, const GenomicRegion& region, const unsigned max_period)
+{
+    const auto contig_sequence = reference.fetch_sequence(reference.contig_region(region.contig_name()));
+    std::vector<tandem::Repeat> result {};
+    for (const auto& repeat : tandem::extract_exact_tandem_repeats(contig_sequence, 1, max_period)) {
+        if (repeat.pos < region.end() && repeat.pos + repeat.length > region.begin()) {
+            result.push_back(repeat);
+        }
+    }
+    return to_tuples(std::move(result));
+}
+
+RepeatIndex::BuildOptions make_small_chunk_options()
+{
+    // Chunks much smaller than the contigs so repeats spanning chunk boundaries are tested
+    RepeatIndex::BuildOptions result {};
+    result.max_period = 3;
+    result.chunk_size = 97;
+    result.chunk_overlap = 200;
+    return result;
+}
+
+void check_matches_direct_search(const Haplotype& haplotype, const RepeatIndex& index)
+{
+    const auto indexed = to_tuples(find_tandem_repeats(haplotype, index, 1, 3));
+    const auto direct = to_tuples(tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, 3));
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(indexed), std::cend(indexed), std::cbegin(direct), std::cend(direct));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(repeat_index)
+
+BOOST_AUTO_TEST_CASE(index_lookups_match_searching_the_reference)
+{
+    const auto reference = mock::make_reference();
+    const TempIndex temp {};
+    build_repeat_index(reference, temp.path, make_small_chunk_options());
+    const RepeatIndex index {temp.path};
+    BOOST_CHECK_EQUAL(index.max_period(), 3);
+    for (const auto& contig : reference.contig_names()) {
+        BOOST_REQUIRE(index.has_contig(contig));
+        BOOST_CHECK_EQUAL(index.contig_size(contig), reference.contig_size(contig));
+        const auto contig_region = reference.contig_region(contig);
+        std::vector<GenomicRegion> regions {contig_region};
+        for (GenomicRegion::Position begin {0}; begin + 150 <= contig_region.end(); begin += 137) {
+            regions.emplace_back(contig, begin, begin + 150);
+        }
+        for (const auto& region : regions) {
+            const auto indexed = to_tuples(index.fetch_tandem_repeats(region));
+            const auto direct = find_reference_repeats(reference, region, 3);
+            BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(indexed), std::cend(indexed), std::cbegin(direct), std::cend(direct));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(period_filtered_lookups_match_searching_the_reference)
+{
+    const auto reference = mock::make_reference();
+    const TempIndex temp {};
+    build_repeat_index(reference, temp.path, make_small_chunk_options());
+    const RepeatIndex index {temp.path};
+    const GenomicRegion region {"4", 550, 750};
+    auto direct = find_reference_repeats(reference, region, 3);
+    direct.erase(std::remove_if(std::begin(direct), std::end(direct),
+                                [] (const auto& repeat) { return repeat.period < 2; }),
+                 std::end(direct));
+    const auto indexed = to_tuples(index.fetch_tandem_repeats(region, 2, 3));
+    BOOST_CHECK(!direct.empty());
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(indexed), std::cend(indexed), std::cbegin(direct), std::cend(direct));
+}
+
+BOOST_AUTO_TEST_CASE(haplotype_repeats_match_searching_the_haplotype_sequence)
+{
+    const auto reference = mock::make_reference();
+    const TempIndex temp {};
+    build_repeat_index(reference, temp.path, make_small_chunk_options());
+    const RepeatIndex index {temp.path};
+    // Contig 4 has a long CAG repeat starting at 603
+    const GenomicRegion region {"4", 580, 700};
+    check_matches_direct_search(Haplotype {region, reference.fetch_sequence(region), reference}, index);
+    {
+        // A SNV that breaks the CAG repeat
+        Haplotype::Builder builder {region, reference};
+        builder.push_back(Allele {"4", 630, "T"});
+        check_matches_direct_search(builder.build(), index);
+    }
+    {
+        // An insertion that extends the CAG repeat
+        Haplotype::Builder builder {region, reference};
+        builder.push_back(Allele {GenomicRegion {"4", 615, 615}, "CAGCAG"});
+        check_matches_direct_search(builder.build(), index);
+    }
+    {
+        // A deletion that makes a new repeat outside the CAG repeat
+        Haplotype::Builder builder {region, reference};
+        builder.push_back(Allele {GenomicRegion {"4", 585, 590}, ""});
+        check_matches_direct_search(builder.build(), index);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(malformed_index_files_are_rejected)
+{
+    const auto reference = mock::make_reference();
+    const TempIndex temp {};
+    BOOST_CHECK_THROW(RepeatIndex {temp.path}, Error);
+    {
+        fs::ofstream file {temp.path};
+        file << "this is not a repeat index";
+    }
+    BOOST_CHECK_THROW(RepeatIndex {temp.path}, Error);
+    build_repeat_index(reference, temp.path, make_small_chunk_options());
+    BOOST_CHECK_NO_THROW(RepeatIndex {temp.path});
+    // Truncating the file moves the directory offset, which must be caught before any lookups
+    fs::resize_file(temp.path, fs::file_size(temp.path) / 2);
+    BOOST_CHECK_THROW(RepeatIndex {temp.path}, Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "utils/stable_hash.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+auto hash_bytes(const std::string& bytes)
+{
+    octopus::utils::StableHasher hasher {};
+    hasher.update(bytes.data(), bytes.size());
+    return hasher.digest();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(stable_hash)
+
+BOOST_AUTO_TEST_CASE(digests_match_reference_xxh64)
+{
+    BOOST_CHECK_EQUAL(hash_bytes(""), 0xEF46DB3751D8E999ULL);
+    BOOST_CHECK_EQUAL(hash_bytes("a"), 0xD24EC4F1A98C6E5BULL);
+    BOOST_CHECK_EQUAL(hash_bytes("abc"), 0x44BC2CF5AD770999ULL);
+    BOOST_CHECK_EQUAL(hash_bytes("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+}
+
+BOOST_AUTO_TEST_CASE(digests_do_not_depend_on_how_input_is_split)
+{
+    const std::string bytes {"ACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGT"};
+    const auto expected = hash_bytes(bytes);
+    for (std::size_t split_size : {1, 3, 7, 31, 32, 33}) {
+        octopus::utils::StableHasher hasher {};
+        for (std::size_t pos {0}; pos < bytes.size(); pos += split_size) {
+            const auto chunk = bytes.substr(pos, split_size);
+            hasher.update(chunk.data(), chunk.size());
+        }
+        BOOST_CHECK_EQUAL(hasher.digest(), expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(strings_are_hashed_with_their_length)
+{
+    octopus::utils::StableHasher lhs {}, rhs {};
+    lhs.update(std::string {"ab"});
+    lhs.update(std::string {"c"});
+    rhs.update(std::string {"a"});
+    rhs.update(std::string {"bc"});
+    BOOST_CHECK_NE(lhs.digest(), rhs.digest());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
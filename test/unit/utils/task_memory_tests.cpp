@@ -0,0 +1,63 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include "utils/task_memory.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(task_memory)
+
+BOOST_AUTO_TEST_CASE(task_footprint_records_peak_since_reset)
+{
+    reset_task_footprint();
+    note_task_footprint(100);
+    note_task_footprint(300);
+    note_task_footprint(200);
+    BOOST_CHECK_EQUAL(peak_task_footprint(), 300);
+    reset_task_footprint();
+    BOOST_CHECK_EQUAL(peak_task_footprint(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(budget_projects_equal_shares_until_measured)
+{
+    TaskMemoryBudget budget {1000, 4};
+    BOOST_CHECK_EQUAL(budget.project(10), 250);
+    BOOST_CHECK_EQUAL(budget.project(100'000), 250);
+    budget.reserve(250);
+    budget.release(250, 100, 500);
+    BOOST_CHECK_EQUAL(budget.reserved(), 0);
+    BOOST_CHECK_EQUAL(budget.project(10), 50);
+}
+
+BOOST_AUTO_TEST_CASE(budget_admits_within_remaining_budget)
+{
+    TaskMemoryBudget budget {1000, 2};
+    BOOST_CHECK(budget.can_admit(2000)); // nothing reserved
+    budget.reserve(600);
+    BOOST_CHECK(budget.can_admit(400));
+    BOOST_CHECK(!budget.can_admit(401));
+    budget.reserve(400);
+    BOOST_CHECK(!budget.can_admit(1));
+    budget.release(600, 1, 0);
+    BOOST_CHECK(budget.can_admit(600));
+}
+
+BOOST_AUTO_TEST_CASE(budget_projections_decay_after_dense_regions)
+{
+    TaskMemoryBudget budget {1'000'000, 1};
+    budget.release(0, 100, 10'000);
+    BOOST_CHECK_EQUAL(budget.project(100), 10'000);
+    budget.release(0, 100, 100);
+    BOOST_CHECK_EQUAL(budget.project(100), 9'000);
+    budget.release(0, 100, 9'500);
+    BOOST_CHECK_EQUAL(budget.project(100), 9'500);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
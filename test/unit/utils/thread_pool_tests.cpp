@@ -0,0 +1,124 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "utils/thread_pool.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(thread_pool)
+
+BOOST_AUTO_TEST_CASE(parallel_for_ranges_visits_every_item_once)
+{
+    set_shared_thread_budget(4);
+    for (const std::size_t num_items : {0, 1, 3, 4, 1000, 1001}) {
+        for (const unsigned num_blocks : {1u, 2u, 3u, 4u}) {
+            std::vector<std::atomic<int>> visits(num_items);
+            parallel_for_ranges(num_items, num_blocks, [&] (const std::size_t first, const std::size_t last) {
+                for (auto i = first; i < last; ++i) ++visits[i];
+            });
+            for (const auto& count : visits) {
+                BOOST_REQUIRE_EQUAL(count, 1);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(num_parallel_blocks_respects_the_thread_budget)
+{
+    set_shared_thread_budget(4);
+    BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 4);
+    BOOST_CHECK_EQUAL(num_parallel_blocks(20, 10), 2);
+    BOOST_CHECK_EQUAL(num_parallel_blocks(5, 10), 1);
+    BOOST_CHECK_EQUAL(num_parallel_blocks(0, 10), 1);
+}
+
+BOOST_AUTO_TEST_CASE(tasks_split_work_over_free_threads)
+{
+    set_shared_thread_budget(4);
+    BOOST_CHECK(!in_parallel_task());
+    BOOST_CHECK_EQUAL(num_free_threads(), 3);
+    {
+        const ParallelTaskScope scope {};
+        BOOST_CHECK(in_parallel_task());
+        BOOST_CHECK_EQUAL(num_free_threads(), 3);
+        BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 4);
+        BOOST_CHECK_EQUAL(num_parallel_blocks(20, 10), 2);
+        {
+            const ParallelTaskScope nested {};
+            BOOST_CHECK_EQUAL(num_free_threads(), 3);
+        }
+        BOOST_CHECK_EQUAL(num_free_threads(), 3);
+    }
+    BOOST_CHECK(!in_parallel_task());
+}
+
+BOOST_AUTO_TEST_CASE(running_tasks_use_the_thread_budget)
+{
+    set_shared_thread_budget(4);
+    std::mutex mutex {};
+    std::condition_variable cv {};
+    unsigned num_started {0};
+    bool finish {false};
+    std::vector<std::thread> tasks {};
+    const auto run_task = [&] () {
+        const ParallelTaskScope scope {};
+        std::unique_lock<std::mutex> lock {mutex};
+        ++num_started;
+        cv.notify_all();
+        cv.wait(lock, [&] () { return finish; });
+    };
+    const auto start_task = [&] () {
+        tasks.emplace_back(run_task);
+        std::unique_lock<std::mutex> lock {mutex};
+        cv.wait(lock, [&] () { return num_started == tasks.size(); });
+    };
+    const ParallelTaskScope scope {};
+    start_task();
+    BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 3);
+    start_task();
+    BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 2);
+    start_task();
+    BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 1);
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        finish = true;
+    }
+    cv.notify_all();
+    for (auto& task : tasks) task.join();
+    BOOST_CHECK_EQUAL(num_parallel_blocks(1000, 10), 4);
+}
+
+BOOST_AUTO_TEST_CASE(pool_jobs_do_not_split_work)
+{
+    set_shared_thread_budget(4);
+    std::atomic<unsigned> nested_blocks {0};
+    parallel_for_each_block(4, [&] (unsigned) {
+        nested_blocks += num_parallel_blocks(1000, 10);
+    });
+    BOOST_CHECK_EQUAL(nested_blocks, 4);
+    BOOST_CHECK_EQUAL(async_shared([] () { return num_free_threads(); }).get(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for_each_block_propagates_exceptions)
+{
+    set_shared_thread_budget(4);
+    BOOST_CHECK_THROW(parallel_for_each_block(4, [] (const unsigned block) {
+        if (block == 2) throw std::runtime_error {"block failed"};
+    }), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus